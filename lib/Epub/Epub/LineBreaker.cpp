@@ -0,0 +1,311 @@
+#include "LineBreaker.h"
+
+#include <Utf8.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+// TeX's \linepenalty, \hyphenpenalty and \doublehyphendemerits
+constexpr uint32_t LINE_PENALTY = 10;
+constexpr uint32_t HYPHEN_PENALTY = 50;
+constexpr uint32_t DOUBLE_HYPHEN_DEMERITS = 3000;
+// Breaking against kinsoku rules costs about as much as a very loose line. Breaking before a word that attaches to
+// the previous one (e.g. trailing punctuation) is only done when nothing else fits, and then at this extra cost.
+constexpr uint32_t KINSOKU_PENALTY = 3000;
+constexpr uint32_t ATTACHED_PENALTY = 5000;
+constexpr uint32_t INF_BADNESS = 10000;
+constexpr uint32_t INF_DEMERITS = std::numeric_limits<uint32_t>::max();
+// Ragged (left aligned) lines get this fraction of the line width as notional stretch
+constexpr int RAGGED_STRETCH_DIVISOR = 8;
+// Upper bound on start candidates visited per break, keeps pathological paragraphs linear
+constexpr size_t MAX_ACTIVE_CANDIDATES = 128;
+
+constexpr uint8_t FLAG_HYPHENATED = 1;  // Line ending here ends in a hyphenated prefix
+constexpr uint8_t FLAG_ATTACHED = 2;    // Break before a word that attaches to the previous one
+constexpr uint8_t FLAG_KINSOKU = 4;     // Next line starts with closing or this one ends with opening punctuation
+
+struct Candidate {
+  int32_t startX;     // Position of a line starting here, on one infinitely long line
+  int32_t endX;       // Position where a line ending here stops, inserted hyphen included
+  uint32_t demerits;  // Cheapest total demerits of a layout ending here
+  uint16_t word;
+  uint16_t byteOffset;
+  uint16_t gapsAtStart;  // Stretchable gaps before (and including) the first word of a line starting here
+  uint16_t gapsAtEnd;    // Stretchable gaps before (and including) the last word of a line ending here
+  uint16_t previous;
+  uint8_t flags;
+};
+
+bool isClosingPunctuation(const uint32_t cp) {
+  switch (cp) {
+    case 0x3001:  // 、
+    case 0x3002:  // 。
+    case 0x3009:  // 〉
+    case 0x300B:  // 》
+    case 0x300D:  // 」
+    case 0x300F:  // 』
+    case 0x3011:  // 】
+    case 0x3015:  // 〕
+    case 0x3017:  // 〗
+    case 0x301F:  // 〟
+    case 0x30FB:  // ・
+    case 0x30FC:  // ー
+    case 0x3005:  // 々
+    case 0x2019:  // ’
+    case 0x201D:  // ”
+    case 0x2026:  // …
+    case 0xFF01:  // ！
+    case 0xFF09:  // ）
+    case 0xFF0C:  // ，
+    case 0xFF0E:  // ．
+    case 0xFF1A:  // ：
+    case 0xFF1B:  // ；
+    case 0xFF1F:  // ？
+    case 0xFF3D:  // ］
+    case 0xFF5D:  // ｝
+      return true;
+    default:
+      break;
+  }
+  // Small kana
+  switch (cp) {
+    case 0x3041:
+    case 0x3043:
+    case 0x3045:
+    case 0x3047:
+    case 0x3049:
+    case 0x3063:
+    case 0x3083:
+    case 0x3085:
+    case 0x3087:
+    case 0x30A1:
+    case 0x30A3:
+    case 0x30A5:
+    case 0x30A7:
+    case 0x30A9:
+    case 0x30C3:
+    case 0x30E3:
+    case 0x30E5:
+    case 0x30E7:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool isOpeningPunctuation(const uint32_t cp) {
+  switch (cp) {
+    case 0x3008:  // 〈
+    case 0x300A:  // 《
+    case 0x300C:  // 「
+    case 0x300E:  // 『
+    case 0x3010:  // 【
+    case 0x3014:  // 〔
+    case 0x3016:  // 〖
+    case 0x301D:  // 〝
+    case 0x2018:  // ‘
+    case 0x201C:  // “
+    case 0xFF08:  // （
+    case 0xFF3B:  // ［
+    case 0xFF5B:  // ｛
+      return true;
+    default:
+      return false;
+  }
+}
+
+// A line may not hold just the middle piece of a word that is hyphenated on both ends
+bool splitsTwice(const Candidate& from, const Candidate& to) {
+  return from.word == to.word && from.byteOffset != 0 && to.byteOffset != 0;
+}
+
+uint32_t saturatingAdd(const uint32_t a, const uint32_t b) { return a > INF_DEMERITS - b ? INF_DEMERITS : a + b; }
+}  // namespace
+
+uint8_t LineBreaker::classifyWord(const std::string& word) {
+  if (word.empty()) {
+    return 0;
+  }
+
+  const auto* ptr = reinterpret_cast<const unsigned char*>(word.c_str());
+  const uint32_t first = utf8NextCodepoint(&ptr);
+
+  size_t lastStart = word.size() - 1;
+  while (lastStart > 0 && (static_cast<unsigned char>(word[lastStart]) & 0xC0) == 0x80) {
+    lastStart--;
+  }
+  const auto* lastPtr = reinterpret_cast<const unsigned char*>(word.c_str() + lastStart);
+  const uint32_t last = utf8NextCodepoint(&lastPtr);
+
+  uint8_t classes = 0;
+  if (isClosingPunctuation(first)) {
+    classes |= NO_LINE_START;
+  }
+  if (isOpeningPunctuation(last)) {
+    classes |= NO_LINE_END;
+  }
+  return classes;
+}
+
+size_t LineBreaker::requiredMemory(const size_t wordCount, const size_t splitCount) {
+  return (wordCount + 1 + splitCount) * sizeof(Candidate);
+}
+
+bool LineBreaker::computeBreaks(const std::vector<uint16_t>& wordWidths, const std::vector<bool>& continuesVec,
+                                const std::vector<bool>& wordIsCjkVec, const std::vector<uint8_t>& wordClasses,
+                                const std::vector<Split>& splits, const Params& params, std::vector<Break>& breaks) {
+  const size_t wordCount = wordWidths.size();
+  const size_t candidateCount = wordCount + 1 + splits.size();
+  if (wordCount == 0 || candidateCount > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+
+  // Lay the paragraph out on one infinitely long line and record every place it may be broken
+  std::vector<Candidate> candidates;
+  candidates.reserve(candidateCount);
+  int32_t x = 0;
+  uint16_t gaps = 0;
+  size_t splitIdx = 0;
+  for (size_t w = 0; w <= wordCount; w++) {
+    int32_t gap = 0;
+    if (w > 0 && w < wordCount) {
+      const bool cjkAdj = wordIsCjkVec[w] && wordIsCjkVec[w - 1];
+      gap = continuesVec[w] || cjkAdj ? 0 : params.spaceWidth;
+    }
+    const uint16_t gapsBeforePrevious = gaps;
+    if (w > 0 && w < wordCount && !continuesVec[w]) {
+      gaps++;
+    }
+    x += gap;
+
+    Candidate breakBefore{};
+    breakBefore.startX = x;
+    breakBefore.endX = x - gap;
+    breakBefore.demerits = INF_DEMERITS;
+    breakBefore.word = static_cast<uint16_t>(w);
+    breakBefore.gapsAtStart = gaps;
+    breakBefore.gapsAtEnd = gapsBeforePrevious;
+    if (w > 0 && w < wordCount) {
+      if (continuesVec[w]) {
+        breakBefore.flags |= FLAG_ATTACHED;
+      }
+      if ((wordClasses[w] & NO_LINE_START) || (wordClasses[w - 1] & NO_LINE_END)) {
+        breakBefore.flags |= FLAG_KINSOKU;
+      }
+    }
+    candidates.push_back(breakBefore);
+
+    if (w == wordCount) {
+      break;
+    }
+
+    for (; splitIdx < splits.size() && splits[splitIdx].word == w; splitIdx++) {
+      const Split& split = splits[splitIdx];
+      Candidate inside{};
+      inside.startX = x + wordWidths[w] - split.remainderWidth;
+      inside.endX = x + split.prefixWidth;
+      inside.demerits = INF_DEMERITS;
+      inside.word = static_cast<uint16_t>(w);
+      inside.byteOffset = split.byteOffset;
+      inside.gapsAtStart = gaps;
+      inside.gapsAtEnd = gaps;
+      inside.flags = FLAG_HYPHENATED;
+      candidates.push_back(inside);
+    }
+    x += wordWidths[w];
+  }
+
+  const auto widthFrom = [&params](const size_t start) {
+    return start == 0 ? params.firstLineWidth : params.lineWidth;
+  };
+
+  // Demerits of a single line between two candidates
+  const auto lineDemerits = [&](const Candidate& from, const Candidate& to, const int width, const bool last) {
+    const int32_t natural = to.endX - from.startX;
+    uint32_t badness = 0;
+    if (natural > width) {
+      badness = INF_BADNESS;
+    } else if (!last) {
+      const int64_t slack = width - natural;
+      const int64_t stretch = params.justified
+                                  ? static_cast<int64_t>(to.gapsAtEnd - from.gapsAtStart) * params.spaceWidth
+                                  : width / RAGGED_STRETCH_DIVISOR;
+      if (stretch <= 0) {
+        badness = slack == 0 ? 0 : INF_BADNESS;
+      } else {
+        badness = static_cast<uint32_t>(
+            std::min<int64_t>(INF_BADNESS, 100 * slack * slack * slack / (stretch * stretch * stretch)));
+      }
+    }
+
+    uint32_t penalty = 0;
+    if (to.flags & FLAG_HYPHENATED) {
+      penalty += HYPHEN_PENALTY;
+    }
+    if (to.flags & FLAG_ATTACHED) {
+      penalty += ATTACHED_PENALTY;
+    }
+    if (to.flags & FLAG_KINSOKU) {
+      penalty += KINSOKU_PENALTY;
+    }
+
+    uint32_t demerits = (LINE_PENALTY + badness) * (LINE_PENALTY + badness) + penalty * penalty;
+    if ((from.flags & FLAG_HYPHENATED) && (to.flags & FLAG_HYPHENATED)) {
+      demerits += DOUBLE_HYPHEN_DEMERITS;
+    }
+    return demerits;
+  };
+
+  candidates[0].demerits = 0;
+  size_t windowStart = 0;
+  for (size_t b = 1; b < candidates.size(); b++) {
+    Candidate& to = candidates[b];
+    const bool last = b + 1 == candidates.size();
+
+    // Starts whose line already overflows can only get worse from here on
+    while (windowStart < b && to.endX - candidates[windowStart].startX > widthFrom(windowStart)) {
+      windowStart++;
+    }
+
+    uint32_t best = INF_DEMERITS;
+    size_t bestFrom = b;
+    const size_t firstStart =
+        to.flags & FLAG_ATTACHED ? b : std::max(windowStart, b > MAX_ACTIVE_CANDIDATES ? b - MAX_ACTIVE_CANDIDATES : 0);
+    for (size_t a = firstStart; a < b; a++) {
+      const Candidate& from = candidates[a];
+      if (from.demerits == INF_DEMERITS || splitsTwice(from, to)) {
+        continue;
+      }
+      const uint32_t total = saturatingAdd(from.demerits, lineDemerits(from, to, widthFrom(a), last));
+      if (total < best) {
+        best = total;
+        bestFrom = a;
+      }
+    }
+
+    if (bestFrom == b) {
+      // Nothing fits (e.g. an unsplittable word wider than the line) or the break is before an attached word: accept
+      // an overfull line from the nearest start
+      for (size_t a = b; a-- > 0;) {
+        const Candidate& from = candidates[a];
+        if (from.demerits != INF_DEMERITS && !splitsTwice(from, to)) {
+          best = saturatingAdd(from.demerits, lineDemerits(from, to, widthFrom(a), last));
+          bestFrom = a;
+          break;
+        }
+      }
+    }
+
+    to.demerits = best;
+    to.previous = static_cast<uint16_t>(bestFrom);
+  }
+
+  // Walk back from the end of the paragraph
+  breaks.clear();
+  for (size_t c = candidates.size() - 1; c > 0; c = candidates[c].previous) {
+    breaks.push_back({candidates[c].word, candidates[c].byteOffset});
+  }
+  std::reverse(breaks.begin(), breaks.end());
+  return true;
+}
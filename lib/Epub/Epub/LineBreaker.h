@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Paragraph-wide ("optimal fit") line breaking in the style of Knuth and Plass.
+ *
+ * Every word boundary and every hyphenation point is a candidate break. Each candidate remembers the cheapest way
+ * to lay out the paragraph up to it, where a line costs (LINE_PENALTY + badness)^2 + penalty^2: badness grows with
+ * the cube of how far its spaces have to stretch, penalties are charged for hyphens, consecutive hyphenated lines and
+ * CJK punctuation at the wrong end of a line (kinsoku). Breaks before attached words are only taken when nothing else
+ * fits. Only candidates that can still start a line reaching the current one are visited, and that window is capped,
+ * so the work is linear in the paragraph length.
+ *
+ * Works on plain widths so it can be exercised on the host without a renderer.
+ */
+class LineBreaker {
+ public:
+  // Kinsoku classes of a word, see classifyWord()
+  static constexpr uint8_t NO_LINE_START = 1;  // Closing punctuation: 。，」） etc.
+  static constexpr uint8_t NO_LINE_END = 2;    // Opening punctuation: 「（《 etc.
+
+  // Hyphenation point inside a word
+  struct Split {
+    uint16_t word;
+    uint16_t byteOffset;      // Start of the remainder within the word
+    uint16_t prefixWidth;     // Including the inserted hyphen, if any
+    uint16_t remainderWidth;  // Width of the text from byteOffset on
+  };
+
+  // A line ends before `word` (byteOffset 0) or inside it, after the prefix ending at byteOffset
+  struct Break {
+    uint16_t word;
+    uint16_t byteOffset;
+  };
+
+  struct Params {
+    int firstLineWidth;
+    int lineWidth;
+    int spaceWidth;
+    bool justified;
+  };
+
+  // Kinsoku class for a word, based on its first (NO_LINE_START) and last (NO_LINE_END) codepoint
+  static uint8_t classifyWord(const std::string& word);
+
+  // Heap needed by computeBreaks() for a paragraph of this size
+  static size_t requiredMemory(size_t wordCount, size_t splitCount);
+
+  // Computes the line breaks of a paragraph. `splits` must be ordered by word and offset, and must not reference
+  // words that attach to the previous one. The last break is always {wordCount, 0}. Returns false without touching
+  // `breaks` if the paragraph is too large for the candidate index type.
+  static bool computeBreaks(const std::vector<uint16_t>& wordWidths, const std::vector<bool>& continuesVec,
+                            const std::vector<bool>& wordIsCjkVec, const std::vector<uint8_t>& wordClasses,
+                            const std::vector<Split>& splits, const Params& params, std::vector<Break>& breaks);
+};
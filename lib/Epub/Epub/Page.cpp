@@ -3,6 +3,9 @@
 #include <HardwareSerial.h>
 #include <Serialization.h>
 
+#include <algorithm>
+#include <cctype>
+
 void PageLine::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) {
   block->render(renderer, fontId, xPos + xOffset, yPos + yOffset);
 }
@@ -13,7 +16,13 @@ void PageLine::collectCodepoints(std::vector<uint32_t>& out, size_t max) const {
   }
 }
 
-bool PageLine::serialize(FsFile& file) {
+void PageLine::appendText(std::string& out) const {
+  if (block) {
+    block->appendText(out);
+  }
+}
+
+bool PageLine::serialize(BufferedFile& file) {
   serialization::writePod(file, xPos);
   serialization::writePod(file, yPos);
 
@@ -21,13 +30,16 @@ bool PageLine::serialize(FsFile& file) {
   return block->serialize(file);
 }
 
-std::unique_ptr<PageLine> PageLine::deserialize(FsFile& file) {
-  int16_t xPos;
-  int16_t yPos;
-  serialization::readPod(file, xPos);
-  serialization::readPod(file, yPos);
+std::unique_ptr<PageLine> PageLine::deserialize(serialization::BufferReader& reader) {
+  int16_t xPos = 0;
+  int16_t yPos = 0;
+  serialization::readPod(reader, xPos);
+  serialization::readPod(reader, yPos);
 
-  auto tb = TextBlock::deserialize(file);
+  auto tb = TextBlock::deserialize(reader);
+  if (!tb) {
+    return nullptr;
+  }
   return std::unique_ptr<PageLine>(new PageLine(std::move(tb), xPos, yPos));
 }
 
@@ -49,7 +61,20 @@ void Page::collectCodepoints(std::vector<uint32_t>& out, size_t max) const {
   }
 }
 
-bool Page::serialize(FsFile& file) const {
+void Page::appendText(std::string& out) const {
+  for (const auto& element : elements) {
+    element->appendText(out);
+    // Rejoin words hyphenated across lines so they can be found as a whole
+    const size_t length = out.size();
+    if (length >= 2 && out[length - 1] == '-' && isalpha(static_cast<unsigned char>(out[length - 2]))) {
+      out.pop_back();
+    } else {
+      out += '\n';
+    }
+  }
+}
+
+bool Page::serialize(BufferedFile& file) const {
   const uint16_t count = elements.size();
   serialization::writePod(file, count);
 
@@ -64,18 +89,25 @@ bool Page::serialize(FsFile& file) const {
   return true;
 }
 
-std::unique_ptr<Page> Page::deserialize(FsFile& file) {
+std::unique_ptr<Page> Page::deserialize(std::shared_ptr<const std::vector<uint8_t>> blob) {
   auto page = std::unique_ptr<Page>(new Page());
+  serialization::BufferReader reader(blob->data(), blob->size());
+  page->blob = std::move(blob);
 
-  uint16_t count;
-  serialization::readPod(file, count);
+  uint16_t count = 0;
+  serialization::readPod(reader, count);
+  // A corrupt count must not turn into a huge allocation
+  page->elements.reserve(std::min<size_t>(count, page->blob->size()));
 
   for (uint16_t i = 0; i < count; i++) {
-    uint8_t tag;
-    serialization::readPod(file, tag);
+    uint8_t tag = 0;
+    serialization::readPod(reader, tag);
 
     if (tag == TAG_PageLine) {
-      auto pl = PageLine::deserialize(file);
+      auto pl = PageLine::deserialize(reader);
+      if (!pl) {
+        return nullptr;
+      }
       page->elements.push_back(std::move(pl));
     } else {
       Serial.printf("[%lu] [PGE] Deserialization failed: Unknown tag %u\n", millis(), tag);
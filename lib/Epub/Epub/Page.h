@@ -1,7 +1,9 @@
 #pragma once
-#include <HalStorage.h>
+#include <BufferedFile.h>
 
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -19,8 +21,9 @@ class PageElement {
   explicit PageElement(const int16_t xPos, const int16_t yPos) : xPos(xPos), yPos(yPos) {}
   virtual ~PageElement() = default;
   virtual void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) = 0;
-  virtual bool serialize(FsFile& file) = 0;
+  virtual bool serialize(BufferedFile& file) = 0;
   virtual void collectCodepoints(std::vector<uint32_t>& out, size_t max) const {}
+  virtual void appendText(std::string& out) const {}
 };
 
 // a line from a block element
@@ -31,17 +34,24 @@ class PageLine final : public PageElement {
   PageLine(std::shared_ptr<TextBlock> block, const int16_t xPos, const int16_t yPos)
       : PageElement(xPos, yPos), block(std::move(block)) {}
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) override;
-  bool serialize(FsFile& file) override;
+  bool serialize(BufferedFile& file) override;
   void collectCodepoints(std::vector<uint32_t>& out, size_t max) const override;
-  static std::unique_ptr<PageLine> deserialize(FsFile& file);
+  void appendText(std::string& out) const override;
+  static std::unique_ptr<PageLine> deserialize(serialization::BufferReader& reader);
 };
 
 class Page {
+  // Serialized page the text of a loaded page points into
+  std::shared_ptr<const std::vector<uint8_t>> blob;
+
  public:
   // the list of block index and line numbers on this page
   std::vector<std::shared_ptr<PageElement>> elements;
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) const;
   void collectCodepoints(std::vector<uint32_t>& out, size_t max) const;
-  bool serialize(FsFile& file) const;
-  static std::unique_ptr<Page> deserialize(FsFile& file);
+  // Plain text of the page, one line per element, used for search
+  void appendText(std::string& out) const;
+  bool serialize(BufferedFile& file) const;
+  // Parses a page read from the section file in one piece. The page keeps `blob` alive for as long as it exists.
+  static std::unique_ptr<Page> deserialize(std::shared_ptr<const std::vector<uint8_t>> blob);
 };
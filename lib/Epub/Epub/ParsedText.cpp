@@ -1,5 +1,6 @@
 #include "ParsedText.h"
 
+#include <Arduino.h>
 #include <GfxRenderer.h>
 
 #include <algorithm>
@@ -8,10 +9,14 @@
 #include <iterator>
 #include <vector>
 
+#include "LineBreaker.h"
 #include "hyphenation/Hyphenator.h"
 
 namespace {
 
+// Below this much free heap paragraphs are broken greedily instead of optimally
+constexpr size_t MIN_FREE_HEAP_FOR_OPTIMAL_BREAKS = 32 * 1024;
+
 // Soft hyphen byte pattern used throughout EPUBs (UTF-8 for U+00AD).
 constexpr char SOFT_HYPHEN_UTF8[] = "\xC2\xAD";
 constexpr size_t SOFT_HYPHEN_BYTES = 2;
@@ -123,13 +128,20 @@ void ParsedText::layoutAndExtractLines(const GfxRenderer& renderer, const int fo
   }
 
   std::vector<size_t> lineBreakIndices;
-  if (hyphenationEnabled) {
-    // Use greedy layout that can split words mid-loop when a hyphenated prefix fits.
-    lineBreakIndices =
-        computeHyphenatedLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, continuesVec, wordIsCjkVec);
-  } else {
+  if (blockStyle.alignment == CssTextAlign::Justify || blockStyle.alignment == CssTextAlign::Left) {
+    // Break the whole paragraph at once; comes back empty when memory is too tight for it
     lineBreakIndices =
-        computeLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, continuesVec, wordIsCjkVec);
+        computeOptimalLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, continuesVec, wordIsCjkVec);
+  }
+  if (lineBreakIndices.empty()) {
+    if (hyphenationEnabled) {
+      // Use greedy layout that can split words mid-loop when a hyphenated prefix fits.
+      lineBreakIndices =
+          computeHyphenatedLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, continuesVec, wordIsCjkVec);
+    } else {
+      lineBreakIndices =
+          computeLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, continuesVec, wordIsCjkVec);
+    }
   }
   const size_t lineCount = includeLastLine ? lineBreakIndices.size() : lineBreakIndices.size() - 1;
 
@@ -157,6 +169,46 @@ std::vector<uint16_t> ParsedText::calculateWordWidths(const GfxRenderer& rendere
   return wordWidths;
 }
 
+// Splits every word that would overflow even as the first entry on a line, using fallback hyphenation.
+void ParsedText::splitOverflowingWords(const GfxRenderer& renderer, const int fontId, const int pageWidth,
+                                       const int effectiveIndent, std::vector<uint16_t>& wordWidths,
+                                       std::vector<bool>& continuesVec, std::vector<bool>& wordIsCjkVec) {
+  // Collect the overflowing words in one pass and resolve their breakpoints in a single batch
+  std::vector<size_t> overflowIndexes;
+  std::vector<const std::string*> overflowWords;
+  auto wordIt = words.begin();
+  for (size_t i = 0; i < wordWidths.size(); ++i, ++wordIt) {
+    // First word needs to fit in reduced width if there's an indent
+    const int effectiveWidth = i == 0 ? pageWidth - effectiveIndent : pageWidth;
+    if (wordWidths[i] > effectiveWidth) {
+      overflowIndexes.push_back(i);
+      overflowWords.push_back(&*wordIt);
+    }
+  }
+
+  if (!overflowIndexes.empty()) {
+    const auto overflowBreaks = Hyphenator::breakOffsets(overflowWords, /*includeFallback=*/true);
+    size_t nextOverflow = 0;
+    size_t insertedWords = 0;
+    for (size_t i = 0; i < wordWidths.size(); ++i) {
+      const int effectiveWidth = i == 0 ? pageWidth - effectiveIndent : pageWidth;
+      // Batched breaks only apply to the original word; remainders produced by a split are resolved on demand
+      const std::vector<Hyphenator::BreakInfo>* breaks = nullptr;
+      if (nextOverflow < overflowIndexes.size() && overflowIndexes[nextOverflow] + insertedWords == i) {
+        breaks = &overflowBreaks[nextOverflow++];
+      }
+      while (wordWidths[i] > effectiveWidth) {
+        if (!hyphenateWordAtIndex(i, effectiveWidth, renderer, fontId, wordWidths, /*allowFallbackBreaks=*/true,
+                                  &continuesVec, &wordIsCjkVec, breaks)) {
+          break;
+        }
+        breaks = nullptr;
+        insertedWords++;
+      }
+    }
+  }
+}
+
 std::vector<size_t> ParsedText::computeLineBreaks(const GfxRenderer& renderer, const int fontId, const int pageWidth,
                                                   const int spaceWidth, std::vector<uint16_t>& wordWidths,
                                                   std::vector<bool>& continuesVec, std::vector<bool>& wordIsCjkVec) {
@@ -171,17 +223,7 @@ std::vector<size_t> ParsedText::computeLineBreaks(const GfxRenderer& renderer, c
           ? blockStyle.textIndent
           : 0;
 
-  // Ensure any word that would overflow even as the first entry on a line is split using fallback hyphenation.
-  for (size_t i = 0; i < wordWidths.size(); ++i) {
-    // First word needs to fit in reduced width if there's an indent
-    const int effectiveWidth = i == 0 ? pageWidth - effectiveIndent : pageWidth;
-    while (wordWidths[i] > effectiveWidth) {
-      if (!hyphenateWordAtIndex(i, effectiveWidth, renderer, fontId, wordWidths, /*allowFallbackBreaks=*/true,
-                                &continuesVec, &wordIsCjkVec)) {
-        break;
-      }
-    }
-  }
+  splitOverflowingWords(renderer, fontId, pageWidth, effectiveIndent, wordWidths, continuesVec, wordIsCjkVec);
 
   // Greedy forward scan — O(n) instead of O(n²) DP
   std::vector<size_t> lineBreakIndices;
@@ -310,12 +352,93 @@ std::vector<size_t> ParsedText::computeHyphenatedLineBreaks(const GfxRenderer& r
   return lineBreakIndices;
 }
 
+// Breaks the whole paragraph with LineBreaker, trying every hyphenation point when hyphenation is enabled. Returns an
+// empty vector when there is not enough free heap, in which case the caller falls back to a greedy layout.
+std::vector<size_t> ParsedText::computeOptimalLineBreaks(const GfxRenderer& renderer, const int fontId,
+                                                         const int pageWidth, const int spaceWidth,
+                                                         std::vector<uint16_t>& wordWidths,
+                                                         std::vector<bool>& continuesVec,
+                                                         std::vector<bool>& wordIsCjkVec) {
+  if (ESP.getFreeHeap() < MIN_FREE_HEAP_FOR_OPTIMAL_BREAKS) {
+    return {};
+  }
+
+  // Apply CSS text-indent when firstLineIndent is enabled (user toggle controls CSS indent)
+  const int effectiveIndent =
+      firstLineIndent && blockStyle.textIndent > 0 &&
+              (blockStyle.alignment == CssTextAlign::Justify || blockStyle.alignment == CssTextAlign::Left)
+          ? blockStyle.textIndent
+          : 0;
+
+  splitOverflowingWords(renderer, fontId, pageWidth, effectiveIndent, wordWidths, continuesVec, wordIsCjkVec);
+
+  std::vector<uint8_t> wordClasses;
+  wordClasses.reserve(words.size());
+  std::vector<LineBreaker::Split> splits;
+  std::vector<bool> splitNeedsHyphen;
+  auto wordIt = words.begin();
+  auto styleIt = wordStyles.begin();
+  for (size_t i = 0; i < wordWidths.size(); ++i, ++wordIt, ++styleIt) {
+    wordClasses.push_back(LineBreaker::classifyWord(*wordIt));
+    // Attached words are left whole, splitting them would detach the prefix (see splitWordAt)
+    if (!hyphenationEnabled || continuesVec[i] || wordIsCjkVec[i]) {
+      continue;
+    }
+    for (const auto& info : Hyphenator::breakOffsets(*wordIt, false)) {
+      if (info.byteOffset == 0 || info.byteOffset >= wordIt->size()) {
+        continue;
+      }
+      const uint16_t prefixWidth =
+          measureWordWidth(renderer, fontId, wordIt->substr(0, info.byteOffset), *styleIt, info.requiresInsertedHyphen);
+      const uint16_t remainderWidth = measureWordWidth(renderer, fontId, wordIt->substr(info.byteOffset), *styleIt);
+      splits.push_back({static_cast<uint16_t>(i), static_cast<uint16_t>(info.byteOffset), prefixWidth, remainderWidth});
+      splitNeedsHyphen.push_back(info.requiresInsertedHyphen);
+    }
+  }
+
+  if (ESP.getFreeHeap() < LineBreaker::requiredMemory(words.size(), splits.size()) + MIN_FREE_HEAP_FOR_OPTIMAL_BREAKS) {
+    return {};
+  }
+
+  const LineBreaker::Params params{pageWidth - effectiveIndent, pageWidth, spaceWidth,
+                                   blockStyle.alignment == CssTextAlign::Justify};
+  std::vector<LineBreaker::Break> breaks;
+  if (!LineBreaker::computeBreaks(wordWidths, continuesVec, wordIsCjkVec, wordClasses, splits, params, breaks)) {
+    return {};
+  }
+
+  // Carry out the chosen hyphenations, each of which inserts its remainder as a new word
+  std::vector<size_t> lineBreakIndices;
+  lineBreakIndices.reserve(breaks.size());
+  size_t insertedWords = 0;
+  size_t splitIdx = 0;
+  for (const auto& lineBreak : breaks) {
+    const size_t wordIndex = lineBreak.word + insertedWords;
+    if (lineBreak.byteOffset == 0) {
+      lineBreakIndices.push_back(wordIndex);
+      continue;
+    }
+
+    while (splits[splitIdx].word != lineBreak.word || splits[splitIdx].byteOffset != lineBreak.byteOffset) {
+      splitIdx++;
+    }
+    const auto& split = splits[splitIdx];
+    splitWordAt(wordIndex, split.byteOffset, splitNeedsHyphen[splitIdx], split.prefixWidth, split.remainderWidth,
+                wordWidths, &continuesVec, &wordIsCjkVec);
+    insertedWords++;
+    lineBreakIndices.push_back(wordIndex + 1);
+  }
+
+  return lineBreakIndices;
+}
+
 // Splits words[wordIndex] into prefix (adding a hyphen only when needed) and remainder when a legal breakpoint fits the
 // available width.
 bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availableWidth, const GfxRenderer& renderer,
                                       const int fontId, std::vector<uint16_t>& wordWidths,
                                       const bool allowFallbackBreaks, std::vector<bool>* continuesVec,
-                                      std::vector<bool>* wordIsCjkVec) {
+                                      std::vector<bool>* wordIsCjkVec,
+                                      const std::vector<Hyphenator::BreakInfo>* precomputedBreaks) {
   // Guard against invalid indices or zero available width before attempting to split.
   if (availableWidth <= 0 || wordIndex >= words.size()) {
     return false;
@@ -330,8 +453,12 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
   const std::string& word = *wordIt;
   const auto style = *styleIt;
 
-  // Collect candidate breakpoints (byte offsets and hyphen requirements).
-  auto breakInfos = Hyphenator::breakOffsets(word, allowFallbackBreaks);
+  // Collect candidate breakpoints (byte offsets and hyphen requirements) unless the caller already resolved them.
+  std::vector<Hyphenator::BreakInfo> resolvedBreaks;
+  if (!precomputedBreaks) {
+    resolvedBreaks = Hyphenator::breakOffsets(word, allowFallbackBreaks);
+  }
+  const auto& breakInfos = precomputedBreaks ? *precomputedBreaks : resolvedBreaks;
   if (breakInfos.empty()) {
     return false;
   }
@@ -340,22 +467,24 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
   int chosenWidth = -1;
   bool chosenNeedsHyphen = true;
 
-  // Iterate over each legal breakpoint and retain the widest prefix that still fits.
-  for (const auto& info : breakInfos) {
-    const size_t offset = info.byteOffset;
+  // Breakpoints are in ascending order and prefix widths only grow with length, so the first prefix that fits when
+  // walking backwards is the widest one; this measures one or two prefixes instead of all of them.
+  for (auto it = breakInfos.rbegin(); it != breakInfos.rend(); ++it) {
+    const size_t offset = it->byteOffset;
     if (offset == 0 || offset >= word.size()) {
       continue;
     }
 
-    const bool needsHyphen = info.requiresInsertedHyphen;
+    const bool needsHyphen = it->requiresInsertedHyphen;
     const int prefixWidth = measureWordWidth(renderer, fontId, word.substr(0, offset), style, needsHyphen);
-    if (prefixWidth > availableWidth || prefixWidth <= chosenWidth) {
-      continue;  // Skip if too wide or not an improvement
+    if (prefixWidth > availableWidth) {
+      continue;  // Too wide, try a shorter prefix
     }
 
     chosenWidth = prefixWidth;
     chosenOffset = offset;
     chosenNeedsHyphen = needsHyphen;
+    break;
   }
 
   if (chosenWidth < 0) {
@@ -364,9 +493,26 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
   }
 
   // Split the word at the selected breakpoint and append a hyphen if required.
-  std::string remainder = word.substr(chosenOffset);
-  wordIt->resize(chosenOffset);
-  if (chosenNeedsHyphen) {
+  const uint16_t remainderWidth = measureWordWidth(renderer, fontId, word.substr(chosenOffset), style);
+  splitWordAt(wordIndex, chosenOffset, chosenNeedsHyphen, static_cast<uint16_t>(chosenWidth), remainderWidth,
+              wordWidths, continuesVec, wordIsCjkVec);
+  return true;
+}
+
+// Splits words[wordIndex] at byteOffset into a prefix (plus a hyphen if needed) and a remainder word inserted after it.
+void ParsedText::splitWordAt(const size_t wordIndex, const size_t byteOffset, const bool needsHyphen,
+                             const uint16_t prefixWidth, const uint16_t remainderWidth,
+                             std::vector<uint16_t>& wordWidths, std::vector<bool>* continuesVec,
+                             std::vector<bool>* wordIsCjkVec) {
+  auto wordIt = words.begin();
+  auto styleIt = wordStyles.begin();
+  std::advance(wordIt, wordIndex);
+  std::advance(styleIt, wordIndex);
+  const auto style = *styleIt;
+
+  std::string remainder = wordIt->substr(byteOffset);
+  wordIt->resize(byteOffset);
+  if (needsHyphen) {
     wordIt->push_back('-');
   }
 
@@ -399,10 +545,8 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
   }
 
   // Update cached widths to reflect the new prefix/remainder pairing.
-  wordWidths[wordIndex] = static_cast<uint16_t>(chosenWidth);
-  const uint16_t remainderWidth = measureWordWidth(renderer, fontId, remainder, style);
+  wordWidths[wordIndex] = prefixWidth;
   wordWidths.insert(wordWidths.begin() + wordIndex + 1, remainderWidth);
-  return true;
 }
 
 void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const int spaceWidth,
@@ -10,6 +10,7 @@
 
 #include "blocks/BlockStyle.h"
 #include "blocks/TextBlock.h"
+#include "hyphenation/Hyphenator.h"
 
 class GfxRenderer;
 
@@ -28,9 +29,18 @@ class ParsedText {
   std::vector<size_t> computeHyphenatedLineBreaks(const GfxRenderer& renderer, int fontId, int pageWidth,
                                                   int spaceWidth, std::vector<uint16_t>& wordWidths,
                                                   std::vector<bool>& continuesVec, std::vector<bool>& wordIsCjkVec);
+  std::vector<size_t> computeOptimalLineBreaks(const GfxRenderer& renderer, int fontId, int pageWidth, int spaceWidth,
+                                               std::vector<uint16_t>& wordWidths, std::vector<bool>& continuesVec,
+                                               std::vector<bool>& wordIsCjkVec);
+  void splitOverflowingWords(const GfxRenderer& renderer, int fontId, int pageWidth, int effectiveIndent,
+                             std::vector<uint16_t>& wordWidths, std::vector<bool>& continuesVec,
+                             std::vector<bool>& wordIsCjkVec);
   bool hyphenateWordAtIndex(size_t wordIndex, int availableWidth, const GfxRenderer& renderer, int fontId,
                             std::vector<uint16_t>& wordWidths, bool allowFallbackBreaks,
-                            std::vector<bool>* continuesVec = nullptr, std::vector<bool>* wordIsCjkVec = nullptr);
+                            std::vector<bool>* continuesVec = nullptr, std::vector<bool>* wordIsCjkVec = nullptr,
+                            const std::vector<Hyphenator::BreakInfo>* precomputedBreaks = nullptr);
+  void splitWordAt(size_t wordIndex, size_t byteOffset, bool needsHyphen, uint16_t prefixWidth, uint16_t remainderWidth,
+                   std::vector<uint16_t>& wordWidths, std::vector<bool>* continuesVec, std::vector<bool>* wordIsCjkVec);
   void extractLine(size_t breakIndex, int pageWidth, int spaceWidth, const std::vector<uint16_t>& wordWidths,
                    const std::vector<bool>& continuesVec, const std::vector<bool>& wordIsCjkVec,
                    const std::vector<size_t>& lineBreakIndices,
@@ -0,0 +1,483 @@
+#include "SearchIndex.h"
+
+#include <Serialization.h>
+#include <Utf8.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "Page.h"
+
+namespace {
+constexpr uint8_t SEARCH_INDEX_VERSION = 1;
+constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t);
+constexpr uint32_t DIRECTORY_ENTRY_SIZE = sizeof(uint16_t) + sizeof(uint32_t);
+// Pending (term, page) pairs before a block is written out, bounds builder memory to ~12KB
+constexpr size_t BLOCK_PAIR_LIMIT = 3072;
+
+void appendUtf8(std::string& out, const uint32_t cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+bool isSpace(const uint32_t cp) { return cp <= 0x20 || cp == 0xA0 || cp == 0x3000 || (cp >= 0x2000 && cp <= 0x200A); }
+
+// Letters and digits outside of CJK scripts, i.e. everything that forms a space-delimited word
+bool isWordChar(const uint32_t cp) {
+  if (cp < 0x80) {
+    return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+  }
+  if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7) {
+    return false;
+  }
+  if ((cp >= 0x2000 && cp <= 0x2BFF) || (cp >= 0xFF00 && cp <= 0xFFEF)) {
+    return false;  // Punctuation, symbols and full-width forms
+  }
+  return !SearchIndex::isCjk(cp);
+}
+
+uint16_t foldHash(const uint32_t hash) { return static_cast<uint16_t>(hash ^ (hash >> 16)); }
+
+uint16_t wordSignature(const unsigned char* start, const size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ start[i]) * 16777619u;
+  }
+  return foldHash(hash);
+}
+
+uint16_t cjkSignature(const uint32_t first, const uint32_t second) {
+  // Mixed differently from words so a bigram and a word with the same bytes do not share a signature
+  uint32_t hash = 0x9E3779B9u ^ first;
+  hash = (hash ^ (hash >> 15)) * 0x85EBCA6Bu;
+  hash ^= second;
+  hash = (hash ^ (hash >> 13)) * 0xC2B2AE35u;
+  return foldHash(hash ^ (hash >> 16));
+}
+
+// Calls `emit` for the signature of every term in normalized `text`. Returns false if a lone CJK character sits at
+// the start or end of the text: as a query that character may be part of a longer run on the page, where only its
+// bigrams are indexed.
+template <typename Emit>
+bool forEachTerm(const std::string& text, Emit&& emit) {
+  const auto* const begin = reinterpret_cast<const unsigned char*>(text.c_str());
+  const unsigned char* ptr = begin;
+  const unsigned char* wordStart = nullptr;
+  uint32_t previousCjk = 0;
+  int cjkRun = 0;
+  bool runAtStart = false;
+  bool answerable = true;
+
+  const auto endWord = [&](const unsigned char* end) {
+    if (wordStart) {
+      emit(wordSignature(wordStart, end - wordStart));
+      wordStart = nullptr;
+    }
+  };
+  const auto endRun = [&](const bool atEnd) {
+    if (cjkRun == 1) {
+      emit(cjkSignature(previousCjk, 0));
+      if (runAtStart || atEnd) {
+        answerable = false;
+      }
+    }
+    cjkRun = 0;
+  };
+
+  while (true) {
+    const unsigned char* charStart = ptr;
+    const uint32_t cp = utf8NextCodepoint(&ptr);
+    if (cp == 0) {
+      endWord(charStart);
+      endRun(true);
+      break;
+    }
+
+    if (SearchIndex::isCjk(cp)) {
+      endWord(charStart);
+      if (cjkRun == 0) {
+        runAtStart = charStart == begin;
+      } else {
+        emit(cjkSignature(previousCjk, cp));
+      }
+      previousCjk = cp;
+      cjkRun++;
+      continue;
+    }
+
+    endRun(false);
+    if (isWordChar(cp)) {
+      if (!wordStart) {
+        wordStart = charStart;
+      }
+    } else {
+      endWord(charStart);
+    }
+  }
+  return answerable;
+}
+
+uint32_t codepointAt(const std::string& text, const size_t pos) {
+  const auto* ptr = reinterpret_cast<const unsigned char*>(text.c_str() + pos);
+  return utf8NextCodepoint(&ptr);
+}
+
+uint32_t codepointBefore(const std::string& text, size_t pos) {
+  if (pos == 0) {
+    return 0;
+  }
+  do {
+    pos--;
+  } while (pos > 0 && (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80);
+  return codepointAt(text, pos);
+}
+
+void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(FsFile& file, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 32; shift += 7) {
+    const int byte = file.read();
+    if (byte < 0) {
+      return false;
+    }
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Binary search of the block directory; returns false if the signature is not present
+bool findTerm(FsFile& file, const uint32_t directoryStart, const uint16_t termCount, const uint16_t term,
+              uint32_t& offset) {
+  int low = 0;
+  int high = static_cast<int>(termCount) - 1;
+  while (low <= high) {
+    const int mid = (low + high) / 2;
+    file.seek(directoryStart + mid * DIRECTORY_ENTRY_SIZE);
+    uint16_t signature;
+    serialization::readPod(file, signature);
+    if (signature == term) {
+      serialization::readPod(file, offset);
+      return true;
+    }
+    if (signature < term) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+bool SearchIndex::isCjk(const uint32_t cp) {
+  return (cp >= 0x2E80 && cp <= 0x2FDF) ||  // CJK radicals
+         (cp >= 0x3040 && cp <= 0x31FF) ||  // Kana, Bopomofo
+         (cp >= 0x3400 && cp <= 0x4DBF) ||  // CJK Extension A
+         (cp >= 0x4E00 && cp <= 0x9FFF) ||  // CJK Unified Ideographs
+         (cp >= 0xAC00 && cp <= 0xD7AF) ||  // Hangul syllables
+         (cp >= 0xF900 && cp <= 0xFAFF) ||  // CJK compatibility ideographs
+         (cp >= 0x20000 && cp <= 0x2FA1F);  // Supplementary ideographs
+}
+
+void SearchIndex::Normalizer::push(uint32_t cp, std::string& out) {
+  if (cp == 0xAD || (cp >= 0x200B && cp <= 0x200D) || cp == 0xFEFF) {
+    return;  // Soft hyphens and zero-width characters never affect matching
+  }
+  if (isSpace(cp)) {
+    pendingSpace = !out.empty();
+    return;
+  }
+  if (cp >= 'A' && cp <= 'Z') {
+    cp += 'a' - 'A';
+  }
+
+  const bool cjk = isCjk(cp);
+  if (pendingSpace && !(cjk && lastWasCjk)) {
+    out += ' ';
+  }
+  pendingSpace = false;
+  lastWasCjk = cjk;
+  appendUtf8(out, cp);
+}
+
+void SearchIndex::Normalizer::append(const std::string& text, std::string& out) {
+  const auto* ptr = reinterpret_cast<const unsigned char*>(text.c_str());
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(&ptr))) {
+    push(cp, out);
+  }
+}
+
+std::string SearchIndex::normalize(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  Normalizer normalizer;
+  normalizer.append(text, out);
+  return out;
+}
+
+size_t SearchIndex::findMatch(const std::string& text, const std::string& query, size_t from) {
+  if (query.empty()) {
+    return std::string::npos;
+  }
+  const bool wordStart = isWordChar(codepointAt(query, 0));
+  const bool wordEnd = isWordChar(codepointBefore(query, query.size()));
+
+  while ((from = text.find(query, from)) != std::string::npos) {
+    const size_t end = from + query.size();
+    const bool startOk = !wordStart || !isWordChar(codepointBefore(text, from));
+    const bool endOk = !wordEnd || end >= text.size() || !isWordChar(codepointAt(text, end));
+    if (startOk && endOk) {
+      return from;
+    }
+    from++;
+  }
+  return std::string::npos;
+}
+
+std::string SearchIndex::snippet(const std::string& text, const size_t matchPos, const size_t matchLength,
+                                 const size_t context) {
+  size_t start = matchPos > context ? matchPos - context : 0;
+  while (start < matchPos && (static_cast<unsigned char>(text[start]) & 0xC0) == 0x80) {
+    start++;
+  }
+  size_t end = std::min(text.size(), matchPos + matchLength + context);
+  while (end < text.size() && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) {
+    end++;
+  }
+
+  std::string result;
+  if (start > 0) {
+    result += "...";
+  }
+  result.append(text, start, end - start);
+  if (end < text.size()) {
+    result += "...";
+  }
+  return result;
+}
+
+bool SearchIndex::queryTerms(const std::string& query, std::vector<uint16_t>& terms) {
+  terms.clear();
+  const bool answerable = forEachTerm(query, [&terms](const uint16_t term) { terms.push_back(term); });
+  std::sort(terms.begin(), terms.end());
+  terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+  return answerable && !terms.empty();
+}
+
+bool SearchIndex::findPages(const std::string& path, const std::string& query, std::vector<uint16_t>& pages) {
+  pages.clear();
+  std::vector<uint16_t> terms;
+  if (!queryTerms(query, terms)) {
+    return false;
+  }
+
+  FsFile file;
+  if (!Storage.exists(path.c_str()) || !Storage.openFileForRead("SIX", path, file)) {
+    return false;
+  }
+
+  uint8_t version;
+  uint16_t pageCount;
+  uint16_t blockCount;
+  serialization::readPod(file, version);
+  serialization::readPod(file, pageCount);
+  serialization::readPod(file, blockCount);
+  if (version != SEARCH_INDEX_VERSION) {
+    Serial.printf("[%lu] [SIX] Unknown index version %u\n", millis(), version);
+    file.close();
+    return false;
+  }
+
+  std::vector<uint16_t> blockPages;
+  std::vector<uint16_t> termPages;
+  std::vector<uint16_t> commonPages;
+  uint32_t blockStart = HEADER_SIZE;
+  for (uint16_t block = 0; block < blockCount; block++) {
+    file.seek(blockStart);
+    uint16_t termCount;
+    uint32_t postingsSize;
+    serialization::readPod(file, termCount);
+    serialization::readPod(file, postingsSize);
+    const uint32_t directoryStart = blockStart + sizeof(termCount) + sizeof(postingsSize);
+    const uint32_t postingsStart = directoryStart + termCount * DIRECTORY_ENTRY_SIZE;
+    blockStart = postingsStart + postingsSize;
+
+    // Intersect the page lists of all terms; pages never span blocks so results can simply be concatenated
+    blockPages.clear();
+    bool first = true;
+    for (const uint16_t term : terms) {
+      uint32_t offset;
+      if (!findTerm(file, directoryStart, termCount, term, offset)) {
+        blockPages.clear();
+        break;
+      }
+
+      file.seek(postingsStart + offset);
+      uint32_t count;
+      if (!readVarint(file, count)) {
+        file.close();
+        return false;
+      }
+      termPages.clear();
+      uint32_t page = 0;
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t delta;
+        if (!readVarint(file, delta)) {
+          file.close();
+          return false;
+        }
+        page += delta;
+        termPages.push_back(static_cast<uint16_t>(page));
+      }
+
+      if (first) {
+        blockPages.swap(termPages);
+        first = false;
+      } else {
+        // The output may not overlap the inputs
+        commonPages.clear();
+        std::set_intersection(blockPages.begin(), blockPages.end(), termPages.begin(), termPages.end(),
+                              std::back_inserter(commonPages));
+        blockPages.swap(commonPages);
+      }
+      if (blockPages.empty()) {
+        break;
+      }
+    }
+    pages.insert(pages.end(), blockPages.begin(), blockPages.end());
+  }
+
+  file.close();
+  return true;
+}
+
+bool SearchIndexBuilder::begin(const std::string& indexPath) {
+  path = indexPath;
+  pending.clear();
+  pageCount = 0;
+  blockCount = 0;
+  failed = false;
+
+  if (!Storage.openFileForWrite("SIX", path, file)) {
+    failed = true;
+    return false;
+  }
+  serialization::writePod(file, SEARCH_INDEX_VERSION);
+  serialization::writePod(file, pageCount);   // Placeholder, patched by finish()
+  serialization::writePod(file, blockCount);  // Placeholder, patched by finish()
+  return true;
+}
+
+void SearchIndexBuilder::addPage(const uint16_t pageIndex, const Page& page) {
+  if (failed) {
+    return;
+  }
+
+  textBuffer.clear();
+  page.appendText(textBuffer);
+  const std::string normalized = SearchIndex::normalize(textBuffer);
+
+  const size_t pageStart = pending.size();
+  forEachTerm(normalized, [this, pageIndex](const uint16_t term) {
+    pending.push_back(static_cast<uint32_t>(term) << 16 | pageIndex);
+  });
+  std::sort(pending.begin() + pageStart, pending.end());
+  pending.erase(std::unique(pending.begin() + pageStart, pending.end()), pending.end());
+  pageCount = pageIndex + 1;
+
+  // Only cut blocks between pages so a page's terms never end up in two blocks
+  if (pending.size() >= BLOCK_PAIR_LIMIT && !flushBlock()) {
+    failed = true;
+  }
+}
+
+bool SearchIndexBuilder::flushBlock() {
+  if (pending.empty()) {
+    return true;
+  }
+  std::sort(pending.begin(), pending.end());
+
+  std::vector<std::pair<uint16_t, uint32_t>> directory;
+  std::vector<uint8_t> postings;
+  postings.reserve(pending.size() * 2);
+  for (size_t i = 0; i < pending.size();) {
+    const uint16_t term = pending[i] >> 16;
+    size_t end = i;
+    while (end < pending.size() && (pending[end] >> 16) == term) {
+      end++;
+    }
+
+    directory.emplace_back(term, static_cast<uint32_t>(postings.size()));
+    writeVarint(postings, static_cast<uint32_t>(end - i));
+    uint16_t previous = 0;
+    for (size_t j = i; j < end; j++) {
+      const uint16_t page = pending[j] & 0xFFFF;
+      writeVarint(postings, page - previous);
+      previous = page;
+    }
+    i = end;
+  }
+
+  serialization::writePod(file, static_cast<uint16_t>(directory.size()));
+  serialization::writePod(file, static_cast<uint32_t>(postings.size()));
+  for (const auto& entry : directory) {
+    serialization::writePod(file, entry.first);
+    serialization::writePod(file, entry.second);
+  }
+  if (file.write(postings.data(), postings.size()) != postings.size()) {
+    Serial.printf("[%lu] [SIX] Failed to write index block %u\n", millis(), blockCount);
+    return false;
+  }
+
+  blockCount++;
+  pending.clear();
+  return true;
+}
+
+bool SearchIndexBuilder::finish() {
+  if (failed || !flushBlock()) {
+    abort();
+    return false;
+  }
+
+  file.seek(sizeof(SEARCH_INDEX_VERSION));
+  serialization::writePod(file, pageCount);
+  serialization::writePod(file, blockCount);
+  file.close();
+  Serial.printf("[%lu] [SIX] Search index written: %u pages, %u blocks\n", millis(), pageCount, blockCount);
+  return true;
+}
+
+void SearchIndexBuilder::abort() {
+  if (file) {
+    file.close();
+  }
+  pending.clear();
+  pending.shrink_to_fit();
+  failed = true;
+  Storage.remove(path.c_str());
+}
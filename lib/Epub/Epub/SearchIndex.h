@@ -0,0 +1,69 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Page;
+
+/**
+ * Per-section full-text search index (sections/<n>.idx), written while the section file is built.
+ *
+ * Text is normalized (ASCII lowercased, whitespace collapsed, spaces between CJK characters dropped) and split into
+ * terms: Latin words and CJK character bigrams, with a lone CJK character indexed on its own. Every term is reduced
+ * to a 16-bit signature, so a lookup yields candidate pages that callers verify against the page text.
+ *
+ * Layout: u8 version, u16 pageCount, u16 blockCount, then the blocks. A block covers a run of consecutive pages and
+ * holds u16 termCount, u32 postingsSize, a sorted directory of (u16 signature, u32 postingsOffset) and the postings
+ * themselves: a varint page count followed by delta-coded varint page numbers for every term.
+ */
+namespace SearchIndex {
+// Incremental normalizer, keeps whitespace/CJK state across calls so text can be fed in pieces
+class Normalizer {
+  bool pendingSpace = false;
+  bool lastWasCjk = false;
+
+ public:
+  void reset() {
+    pendingSpace = false;
+    lastWasCjk = false;
+  }
+  void push(uint32_t cp, std::string& out);
+  void append(const std::string& text, std::string& out);
+};
+
+bool isCjk(uint32_t cp);
+std::string normalize(const std::string& text);
+
+// Position of the first occurrence of `query` in `text` at or after `from` (both normalized), or npos.
+// Latin words in the query only match whole words, mirroring what the index can answer.
+size_t findMatch(const std::string& text, const std::string& query, size_t from = 0);
+// Up to `context` bytes of `text` on both sides of a match, cut on UTF-8 boundaries
+std::string snippet(const std::string& text, size_t matchPos, size_t matchLength, size_t context);
+
+// Term signatures of a normalized query. Returns false if the index cannot answer it (e.g. a single CJK character
+// next to other CJK text, which is only covered by bigrams) and pages have to be scanned instead.
+bool queryTerms(const std::string& query, std::vector<uint16_t>& terms);
+// Candidate pages of the index at `path` containing every term of `query`. Returns false if the index is missing,
+// unreadable or cannot answer the query.
+bool findPages(const std::string& path, const std::string& query, std::vector<uint16_t>& pages);
+}  // namespace SearchIndex
+
+class SearchIndexBuilder {
+  FsFile file;
+  std::string path;
+  std::vector<uint32_t> pending;  // (signature << 16) | page of the current block
+  std::string textBuffer;
+  uint16_t pageCount = 0;
+  uint16_t blockCount = 0;
+  bool failed = false;
+
+  bool flushBlock();
+
+ public:
+  bool begin(const std::string& indexPath);
+  void addPage(uint16_t pageIndex, const Page& page);
+  bool finish();
+  void abort();
+};
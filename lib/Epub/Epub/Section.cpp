@@ -3,25 +3,55 @@
 #include <HalStorage.h>
 #include <Serialization.h>
 
+#include <algorithm>
+
 #include "Page.h"
+#include "SearchIndex.h"
 #include "hyphenation/Hyphenator.h"
 #include "parsers/ChapterHtmlSlimParser.h"
 
 namespace {
-constexpr uint8_t SECTION_FILE_VERSION = 14;
+constexpr uint8_t SECTION_FILE_VERSION = 17;
 constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(int) + sizeof(float) + sizeof(bool) + sizeof(uint8_t) +
                                  sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(bool) + sizeof(bool) +
                                  sizeof(bool) + sizeof(uint32_t);
+
+// LUT entry: where a page starts and how long it is, so it can be loaded with a single read
+struct PageLocation {
+  uint32_t offset;
+  uint32_t length;
+};
+constexpr uint32_t LUT_ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint32_t);
+// Anything larger is a corrupt LUT entry, a full page of text is a few KB
+constexpr uint32_t MAX_PAGE_SIZE = 64 * 1024;
+
+// The anchor table follows the LUT: a u16 count, then (u32 hash, u16 page) entries sorted by hash
+struct AnchorEntry {
+  uint32_t hash;
+  uint16_t page;
+};
+constexpr uint32_t ANCHOR_ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+constexpr size_t MAX_ANCHORS = UINT16_MAX;
+
+// FNV-1a
+uint32_t hashAnchor(const std::string& anchor) {
+  uint32_t hash = 2166136261u;
+  for (const char c : anchor) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
 }  // namespace
 
-uint32_t Section::onPageComplete(std::unique_ptr<Page> page) {
+uint32_t Section::onPageComplete(BufferedFile& out, std::unique_ptr<Page> page) {
   if (!file) {
     Serial.printf("[%lu] [SCT] File not open for writing page %d\n", millis(), pageCount);
     return 0;
   }
 
-  const uint32_t position = file.position();
-  if (!page->serialize(file)) {
+  const uint32_t position = out.position();
+  if (!page->serialize(out)) {
     Serial.printf("[%lu] [SCT] Failed to serialize page %d\n", millis(), pageCount);
     return 0;
   }
@@ -31,10 +61,11 @@ uint32_t Section::onPageComplete(std::unique_ptr<Page> page) {
   return position;
 }
 
-void Section::writeSectionFileHeader(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
-                                     const uint8_t paragraphAlignment, const uint16_t viewportWidth,
-                                     const uint16_t viewportHeight, const bool hyphenationEnabled,
-                                     const bool firstLineIndent, const bool embeddedStyle) {
+void Section::writeSectionFileHeader(BufferedFile& out, const int fontId, const float lineCompression,
+                                     const bool extraParagraphSpacing, const uint8_t paragraphAlignment,
+                                     const uint16_t viewportWidth, const uint16_t viewportHeight,
+                                     const bool hyphenationEnabled, const bool firstLineIndent,
+                                     const bool embeddedStyle) {
   if (!file) {
     Serial.printf("[%lu] [SCT] File not open for writing header\n", millis());
     return;
@@ -44,18 +75,18 @@ void Section::writeSectionFileHeader(const int fontId, const float lineCompressi
                                    sizeof(viewportHeight) + sizeof(pageCount) + sizeof(hyphenationEnabled) +
                                    sizeof(firstLineIndent) + sizeof(embeddedStyle) + sizeof(uint32_t),
                 "Header size mismatch");
-  serialization::writePod(file, SECTION_FILE_VERSION);
-  serialization::writePod(file, fontId);
-  serialization::writePod(file, lineCompression);
-  serialization::writePod(file, extraParagraphSpacing);
-  serialization::writePod(file, paragraphAlignment);
-  serialization::writePod(file, viewportWidth);
-  serialization::writePod(file, viewportHeight);
-  serialization::writePod(file, hyphenationEnabled);
-  serialization::writePod(file, firstLineIndent);
-  serialization::writePod(file, embeddedStyle);
-  serialization::writePod(file, pageCount);  // Placeholder for page count (will be initially 0 when written)
-  serialization::writePod(file, static_cast<uint32_t>(0));  // Placeholder for LUT offset
+  serialization::writePod(out, SECTION_FILE_VERSION);
+  serialization::writePod(out, fontId);
+  serialization::writePod(out, lineCompression);
+  serialization::writePod(out, extraParagraphSpacing);
+  serialization::writePod(out, paragraphAlignment);
+  serialization::writePod(out, viewportWidth);
+  serialization::writePod(out, viewportHeight);
+  serialization::writePod(out, hyphenationEnabled);
+  serialization::writePod(out, firstLineIndent);
+  serialization::writePod(out, embeddedStyle);
+  serialization::writePod(out, pageCount);  // Placeholder for page count (will be initially 0 when written)
+  serialization::writePod(out, static_cast<uint32_t>(0));  // Placeholder for LUT offset
 }
 
 bool Section::loadSectionFile(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
@@ -65,13 +96,14 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
   if (!Storage.openFileForRead("SCT", filePath, file)) {
     return false;
   }
+  BufferedFile in(file);
 
   // Match parameters
   {
     uint8_t version;
-    serialization::readPod(file, version);
+    serialization::readPod(in, version);
     if (version != SECTION_FILE_VERSION) {
-      file.close();
+      in.close();
       Serial.printf("[%lu] [SCT] Deserialization failed: Unknown version %u\n", millis(), version);
       clearCache();
       return false;
@@ -85,36 +117,58 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
     bool fileHyphenationEnabled;
     bool fileFirstLineIndent;
     bool fileEmbeddedStyle;
-    serialization::readPod(file, fileFontId);
-    serialization::readPod(file, fileLineCompression);
-    serialization::readPod(file, fileExtraParagraphSpacing);
-    serialization::readPod(file, fileParagraphAlignment);
-    serialization::readPod(file, fileViewportWidth);
-    serialization::readPod(file, fileViewportHeight);
-    serialization::readPod(file, fileHyphenationEnabled);
-    serialization::readPod(file, fileFirstLineIndent);
-    serialization::readPod(file, fileEmbeddedStyle);
+    serialization::readPod(in, fileFontId);
+    serialization::readPod(in, fileLineCompression);
+    serialization::readPod(in, fileExtraParagraphSpacing);
+    serialization::readPod(in, fileParagraphAlignment);
+    serialization::readPod(in, fileViewportWidth);
+    serialization::readPod(in, fileViewportHeight);
+    serialization::readPod(in, fileHyphenationEnabled);
+    serialization::readPod(in, fileFirstLineIndent);
+    serialization::readPod(in, fileEmbeddedStyle);
 
     if (fontId != fileFontId || lineCompression != fileLineCompression ||
         extraParagraphSpacing != fileExtraParagraphSpacing || paragraphAlignment != fileParagraphAlignment ||
         viewportWidth != fileViewportWidth || viewportHeight != fileViewportHeight ||
         hyphenationEnabled != fileHyphenationEnabled || firstLineIndent != fileFirstLineIndent ||
         embeddedStyle != fileEmbeddedStyle) {
-      file.close();
+      in.close();
       Serial.printf("[%lu] [SCT] Deserialization failed: Parameters do not match\n", millis());
       clearCache();
       return false;
     }
   }
 
+  serialization::readPod(in, pageCount);
+  in.close();
+  Serial.printf("[%lu] [SCT] Deserialization succeeded: %d pages\n", millis(), pageCount);
+  return true;
+}
+
+bool Section::loadPageCount() {
+  if (!Storage.exists(filePath.c_str()) || !Storage.openFileForRead("SCT", filePath, file)) {
+    return false;
+  }
+
+  uint8_t version;
+  serialization::readPod(file, version);
+  if (version != SECTION_FILE_VERSION) {
+    file.close();
+    return false;
+  }
+  file.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
   serialization::readPod(file, pageCount);
   file.close();
-  Serial.printf("[%lu] [SCT] Deserialization succeeded: %d pages\n", millis(), pageCount);
   return true;
 }
 
 // Your updated class method (assuming you are using the 'SD' object, which is a wrapper for a specific filesystem)
 bool Section::clearCache() const {
+  // The search index refers to page numbers of this section file and goes with it
+  if (Storage.exists(searchIndexPath.c_str())) {
+    Storage.remove(searchIndexPath.c_str());
+  }
+
   if (!Storage.exists(filePath.c_str())) {
     Serial.printf("[%lu] [SCT] Cache does not exist, no action needed\n", millis());
     return true;
@@ -133,7 +187,8 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
                                 const uint8_t paragraphAlignment, const uint16_t viewportWidth,
                                 const uint16_t viewportHeight, const bool hyphenationEnabled,
                                 const bool firstLineIndent, const bool embeddedStyle,
-                                const std::function<void()>& popupFn) {
+                                const std::function<void()>& popupFn, const bool buildSearchIndex,
+                                const std::function<bool()>& abortFn) {
   const auto localPath = epub->getSpineItem(spineIndex).href;
   const auto tmpHtmlPath = epub->getCachePath() + "/.tmp_" + std::to_string(spineIndex) + ".html";
 
@@ -182,52 +237,154 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
   if (!Storage.openFileForWrite("SCT", filePath, file)) {
     return false;
   }
-  writeSectionFileHeader(fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
+  BufferedFile out(file);
+  writeSectionFileHeader(out, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
                          viewportHeight, hyphenationEnabled, firstLineIndent, embeddedStyle);
-  std::vector<uint32_t> lut = {};
+  std::vector<PageLocation> lut = {};
+
+  // An index left over from a previous build would point at the wrong pages
+  if (Storage.exists(searchIndexPath.c_str())) {
+    Storage.remove(searchIndexPath.c_str());
+  }
+  std::unique_ptr<SearchIndexBuilder> searchIndex;
+  if (buildSearchIndex) {
+    searchIndex.reset(new SearchIndexBuilder());
+    if (!searchIndex->begin(searchIndexPath)) {
+      searchIndex.reset();
+    }
+  }
 
+  std::vector<AnchorEntry> anchors;
   ChapterHtmlSlimParser visitor(
       tmpHtmlPath, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
       viewportHeight, hyphenationEnabled, firstLineIndent,
-      [this, &lut](std::unique_ptr<Page> page) { lut.emplace_back(this->onPageComplete(std::move(page))); },
-      embeddedStyle, popupFn, embeddedStyle ? epub->getCssParser() : nullptr);
+      [this, &out, &lut, &searchIndex](std::unique_ptr<Page> page) {
+        if (searchIndex) {
+          searchIndex->addPage(pageCount, *page);
+        }
+        const uint32_t offset = this->onPageComplete(out, std::move(page));
+        lut.push_back({offset, offset == 0 ? 0 : static_cast<uint32_t>(out.position()) - offset});
+      },
+      embeddedStyle, popupFn, embeddedStyle ? epub->getCssParser() : nullptr,
+      [&anchors](const std::string& id, const uint16_t page) {
+        if (anchors.size() < MAX_ANCHORS) {
+          anchors.push_back({hashAnchor(id), page});
+        }
+      },
+      abortFn);
   Hyphenator::setPreferredLanguage(epub->getLanguage());
   success = visitor.parseAndBuildPages();
 
   Storage.remove(tmpHtmlPath.c_str());
   if (!success) {
     Serial.printf("[%lu] [SCT] Failed to parse XML and build pages\n", millis());
-    file.close();
+    out.close();
     Storage.remove(filePath.c_str());
+    if (searchIndex) {
+      searchIndex->abort();
+    }
     return false;
   }
 
-  const uint32_t lutOffset = file.position();
+  const uint32_t lutOffset = out.position();
   bool hasFailedLutRecords = false;
   // Write LUT
-  for (const uint32_t& pos : lut) {
-    if (pos == 0) {
+  for (const PageLocation& location : lut) {
+    if (location.offset == 0) {
       hasFailedLutRecords = true;
       break;
     }
-    serialization::writePod(file, pos);
+    serialization::writePod(out, location.offset);
+    serialization::writePod(out, location.length);
   }
 
   if (hasFailedLutRecords) {
     Serial.printf("[%lu] [SCT] Failed to write LUT due to invalid page positions\n", millis());
-    file.close();
+    out.close();
     Storage.remove(filePath.c_str());
+    if (searchIndex) {
+      searchIndex->abort();
+    }
     return false;
   }
 
+  // Write anchor table. Ids are unique within a document, so on a hash collision the earlier element wins.
+  std::stable_sort(anchors.begin(), anchors.end(),
+                   [](const AnchorEntry& a, const AnchorEntry& b) { return a.hash < b.hash; });
+  anchors.erase(std::unique(anchors.begin(), anchors.end(),
+                            [](const AnchorEntry& a, const AnchorEntry& b) { return a.hash == b.hash; }),
+                anchors.end());
+  serialization::writePod(out, static_cast<uint16_t>(anchors.size()));
+  for (const auto& anchor : anchors) {
+    serialization::writePod(out, anchor.hash);
+    serialization::writePod(out, anchor.page);
+  }
+
   // Go back and write LUT offset
-  file.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
-  serialization::writePod(file, pageCount);
-  serialization::writePod(file, lutOffset);
-  file.close();
+  out.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
+  serialization::writePod(out, pageCount);
+  serialization::writePod(out, lutOffset);
+  if (!out.close()) {
+    Serial.printf("[%lu] [SCT] Failed to write section file\n", millis());
+    Storage.remove(filePath.c_str());
+    if (searchIndex) {
+      searchIndex->abort();
+    }
+    return false;
+  }
+
+  // A missing index only makes search fall back to scanning pages, so its failure is not fatal
+  if (searchIndex) {
+    searchIndex->finish();
+  }
   return true;
 }
 
+int Section::findAnchorPage(const std::string& anchor) {
+  if (anchor.empty() || !Storage.openFileForRead("SCT", filePath, file)) {
+    return -1;
+  }
+  // The last probes of the binary search land in the block that is already buffered
+  BufferedFile in(file);
+
+  in.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
+  uint16_t filePageCount;
+  uint32_t lutOffset;
+  serialization::readPod(in, filePageCount);
+  serialization::readPod(in, lutOffset);
+  const uint32_t tableOffset = lutOffset + LUT_ENTRY_SIZE * filePageCount;
+  in.seek(tableOffset);
+  uint16_t anchorCount = 0;
+  serialization::readPod(in, anchorCount);
+
+  const uint32_t hash = hashAnchor(anchor);
+  int page = -1;
+  size_t low = 0;
+  size_t high = anchorCount;
+  while (low < high) {
+    const size_t mid = (low + high) / 2;
+    in.seek(tableOffset + sizeof(anchorCount) + mid * ANCHOR_ENTRY_SIZE);
+    AnchorEntry entry{};
+    serialization::readPod(in, entry.hash);
+    serialization::readPod(in, entry.page);
+    if (entry.hash == hash) {
+      page = entry.page < filePageCount ? entry.page : filePageCount - 1;
+      break;
+    }
+    if (entry.hash < hash) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  in.close();
+
+  if (page < 0) {
+    Serial.printf("[%lu] [SCT] Anchor #%s not found\n", millis(), anchor.c_str());
+  }
+  return page;
+}
+
 std::unique_ptr<Page> Section::loadPageFromSectionFile() {
   if (!Storage.openFileForRead("SCT", filePath, file)) {
     return nullptr;
@@ -236,12 +393,28 @@ std::unique_ptr<Page> Section::loadPageFromSectionFile() {
   file.seek(HEADER_SIZE - sizeof(uint32_t));
   uint32_t lutOffset;
   serialization::readPod(file, lutOffset);
-  file.seek(lutOffset + sizeof(uint32_t) * currentPage);
-  uint32_t pagePos;
-  serialization::readPod(file, pagePos);
-  file.seek(pagePos);
+  file.seek(lutOffset + LUT_ENTRY_SIZE * currentPage);
+  PageLocation location{};
+  serialization::readPod(file, location.offset);
+  serialization::readPod(file, location.length);
+  if (location.length == 0 || location.length > MAX_PAGE_SIZE) {
+    Serial.printf("[%lu] [SCT] Invalid length %u for page %d\n", millis(), location.length, currentPage);
+    file.close();
+    return nullptr;
+  }
 
-  auto page = Page::deserialize(file);
+  // The previous page usually is gone by now, in which case its buffer is reused
+  if (!pageBuffer || pageBuffer.use_count() > 1) {
+    pageBuffer = std::make_shared<std::vector<uint8_t>>();
+  }
+  pageBuffer->resize(location.length);
+  file.seek(location.offset);
+  const auto bytesRead = file.read(pageBuffer->data(), location.length);
   file.close();
-  return page;
+  if (bytesRead != static_cast<int>(location.length)) {
+    Serial.printf("[%lu] [SCT] Short read for page %d\n", millis(), currentPage);
+    return nullptr;
+  }
+
+  return Page::deserialize(pageBuffer);
 }
@@ -1,9 +1,11 @@
 #pragma once
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "Epub.h"
 
+class BufferedFile;
 class Page;
 class GfxRenderer;
 
@@ -12,12 +14,15 @@ class Section {
   const int spineIndex;
   GfxRenderer& renderer;
   std::string filePath;
+  std::string searchIndexPath;
   FsFile file;
+  // Blob of the last loaded page, reused once that page has been released
+  std::shared_ptr<std::vector<uint8_t>> pageBuffer;
 
-  void writeSectionFileHeader(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
-                              uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled,
-                              bool firstLineIndent, bool embeddedStyle);
-  uint32_t onPageComplete(std::unique_ptr<Page> page);
+  void writeSectionFileHeader(BufferedFile& out, int fontId, float lineCompression, bool extraParagraphSpacing,
+                              uint8_t paragraphAlignment, uint16_t viewportWidth, uint16_t viewportHeight,
+                              bool hyphenationEnabled, bool firstLineIndent, bool embeddedStyle);
+  uint32_t onPageComplete(BufferedFile& out, std::unique_ptr<Page> page);
 
  public:
   uint16_t pageCount = 0;
@@ -27,14 +32,22 @@ class Section {
       : epub(epub),
         spineIndex(spineIndex),
         renderer(renderer),
-        filePath(epub->getCachePath() + "/sections/" + std::to_string(spineIndex) + ".bin") {}
+        filePath(epub->getCachePath() + "/sections/" + std::to_string(spineIndex) + ".bin"),
+        searchIndexPath(epub->getCachePath() + "/sections/" + std::to_string(spineIndex) + ".idx") {}
   ~Section() = default;
   bool loadSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
                        uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled, bool firstLineIndent,
                        bool embeddedStyle);
+  // Read the page count of an existing section file regardless of the layout it was built with (used by search)
+  bool loadPageCount();
   bool clearCache() const;
+  // `abortFn` is checked while the chapter is laid out, returning true stops it and leaves no section file
   bool createSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
                          uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled, bool firstLineIndent,
-                         bool embeddedStyle, const std::function<void()>& popupFn = nullptr);
+                         bool embeddedStyle, const std::function<void()>& popupFn = nullptr,
+                         bool buildSearchIndex = false, const std::function<bool()>& abortFn = nullptr);
+  const std::string& getSearchIndexPath() const { return searchIndexPath; }
+  // Page the element with this id starts on, -1 if the chapter has no such anchor
+  int findAnchorPage(const std::string& anchor);
   std::unique_ptr<Page> loadPageFromSectionFile();
 };
@@ -4,13 +4,40 @@
 #include <Serialization.h>
 #include <Utf8.h>
 
+#include <cstring>
+
+TextBlock::TextBlock(const std::list<std::string>& words, const std::list<uint16_t>& word_xpos,
+                     const std::list<EpdFontFamily::Style>& word_styles, const BlockStyle& blockStyle)
+    : blockStyle(blockStyle) {
+  if (words.size() != word_xpos.size() || words.size() != word_styles.size()) {
+    Serial.printf("[%lu] [TXB] Size mismatch (words=%u, xpos=%u, styles=%u), dropping line\n", millis(),
+                  (uint32_t)words.size(), (uint32_t)word_xpos.size(), (uint32_t)word_styles.size());
+    return;
+  }
+
+  size_t textSize = 0;
+  for (const auto& w : words) {
+    textSize += w.size() + 1;
+  }
+  // Reserved up front so the word pointers stay valid
+  ownedText.reserve(textSize);
+  this->words.reserve(words.size());
+
+  auto xposIt = word_xpos.begin();
+  auto styleIt = word_styles.begin();
+  for (const auto& w : words) {
+    this->words.push_back({ownedText.data() + ownedText.size(), *xposIt++, *styleIt++});
+    ownedText.append(w.c_str(), w.size() + 1);
+  }
+}
+
 void TextBlock::collectCodepoints(std::vector<uint32_t>& out, size_t max) const {
   if (max == 0 || out.size() >= max) {
     return;
   }
 
   for (const auto& word : words) {
-    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(word.c_str());
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(word.text);
     uint32_t cp;
     while ((cp = utf8NextCodepoint(&ptr))) {
       // Check if already exists (simple linear search, OK for small sets)
@@ -31,25 +58,26 @@ void TextBlock::collectCodepoints(std::vector<uint32_t>& out, size_t max) const
   }
 }
 
-void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
-  // Validate iterator bounds before rendering
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    Serial.printf("[%lu] [TXB] Render skipped: size mismatch (words=%u, xpos=%u, styles=%u)\n", millis(),
-                  (uint32_t)words.size(), (uint32_t)wordXpos.size(), (uint32_t)wordStyles.size());
-    return;
+void TextBlock::appendText(std::string& out) const {
+  bool first = true;
+  for (const auto& word : words) {
+    if (!first) {
+      out += ' ';
+    }
+    out += word.text;
+    first = false;
   }
+}
 
-  auto wordIt = words.begin();
-  auto wordStylesIt = wordStyles.begin();
-  auto wordXposIt = wordXpos.begin();
-  for (size_t i = 0; i < words.size(); i++) {
-    const int wordX = *wordXposIt + x;
-    const EpdFontFamily::Style currentStyle = *wordStylesIt;
-    renderer.drawText(fontId, wordX, y, wordIt->c_str(), true, currentStyle);
+void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
+  for (const auto& word : words) {
+    const int wordX = word.xPos + x;
+    const EpdFontFamily::Style currentStyle = word.style;
+    renderer.drawText(fontId, wordX, y, word.text, true, currentStyle);
 
     if ((currentStyle & EpdFontFamily::UNDERLINE) != 0) {
-      const std::string& w = *wordIt;
-      const int fullWordWidth = renderer.getTextWidth(fontId, w.c_str(), currentStyle);
+      const char* w = word.text;
+      const int fullWordWidth = renderer.getTextWidth(fontId, w, currentStyle);
       // y is the top of the text line; add ascender to reach baseline, then offset 2px below
       const int underlineY = y + renderer.getFontAscenderSize(fontId) + 2;
 
@@ -57,10 +85,9 @@ void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int
       int underlineWidth = fullWordWidth;
 
       // if word starts with em-space ("\xe2\x80\x83"), account for the additional indent before drawing the line
-      if (w.size() >= 3 && static_cast<uint8_t>(w[0]) == 0xE2 && static_cast<uint8_t>(w[1]) == 0x80 &&
-          static_cast<uint8_t>(w[2]) == 0x83) {
-        const char* visiblePtr = w.c_str() + 3;
-        const int prefixWidth = renderer.getTextAdvanceX(fontId, std::string("\xe2\x80\x83").c_str());
+      if (strncmp(w, "\xe2\x80\x83", 3) == 0) {
+        const char* visiblePtr = w + 3;
+        const int prefixWidth = renderer.getTextAdvanceX(fontId, "\xe2\x80\x83");
         const int visibleWidth = renderer.getTextWidth(fontId, visiblePtr, currentStyle);
         startX = wordX + prefixWidth;
         underlineWidth = visibleWidth;
@@ -68,25 +95,14 @@ void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int
 
       renderer.drawLine(startX, underlineY, startX + underlineWidth, underlineY, true);
     }
-
-    std::advance(wordIt, 1);
-    std::advance(wordStylesIt, 1);
-    std::advance(wordXposIt, 1);
   }
 }
 
-bool TextBlock::serialize(FsFile& file) const {
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    Serial.printf("[%lu] [TXB] Serialization failed: size mismatch (words=%u, xpos=%u, styles=%u)\n", millis(),
-                  words.size(), wordXpos.size(), wordStyles.size());
-    return false;
-  }
-
-  // Word data
+bool TextBlock::serialize(BufferedFile& file) const {
+  // Word data: positions and styles first, the NUL-terminated words last so they can be used in place when loaded
   serialization::writePod(file, static_cast<uint16_t>(words.size()));
-  for (const auto& w : words) serialization::writeString(file, w);
-  for (auto x : wordXpos) serialization::writePod(file, x);
-  for (auto s : wordStyles) serialization::writePod(file, s);
+  for (const auto& w : words) serialization::writePod(file, w.xPos);
+  for (const auto& w : words) serialization::writePod(file, w.style);
 
   // Style (alignment + margins/padding/indent)
   serialization::writePod(file, blockStyle.alignment);
@@ -102,47 +118,52 @@ bool TextBlock::serialize(FsFile& file) const {
   serialization::writePod(file, blockStyle.textIndent);
   serialization::writePod(file, blockStyle.textIndentDefined);
 
+  for (const auto& w : words) {
+    file.write(reinterpret_cast<const uint8_t*>(w.text), strlen(w.text) + 1);
+  }
+
   return true;
 }
 
-std::unique_ptr<TextBlock> TextBlock::deserialize(FsFile& file) {
-  uint16_t wc;
-  std::list<std::string> words;
-  std::list<uint16_t> wordXpos;
-  std::list<EpdFontFamily::Style> wordStyles;
-  BlockStyle blockStyle;
+std::unique_ptr<TextBlock> TextBlock::deserialize(serialization::BufferReader& reader) {
+  uint16_t wc = 0;
 
   // Word count
-  serialization::readPod(file, wc);
+  serialization::readPod(reader, wc);
 
-  // Sanity check: prevent allocation of unreasonably large lists (max 10000 words per block)
+  // Sanity check: prevent allocation of unreasonably large lines (max 10000 words per block)
+  if (!reader.ok) {
+    return nullptr;
+  }
   if (wc > 10000) {
     Serial.printf("[%lu] [TXB] Deserialization failed: word count %u exceeds maximum\n", millis(), wc);
     return nullptr;
   }
 
-  // Word data
-  words.resize(wc);
-  wordXpos.resize(wc);
-  wordStyles.resize(wc);
-  for (auto& w : words) serialization::readString(file, w);
-  for (auto& x : wordXpos) serialization::readPod(file, x);
-  for (auto& s : wordStyles) serialization::readPod(file, s);
+  auto block = std::unique_ptr<TextBlock>(new TextBlock(BlockStyle()));
+  block->words.resize(wc);
+  for (auto& w : block->words) serialization::readPod(reader, w.xPos);
+  for (auto& w : block->words) serialization::readPod(reader, w.style);
 
   // Style (alignment + margins/padding/indent)
-  serialization::readPod(file, blockStyle.alignment);
-  serialization::readPod(file, blockStyle.textAlignDefined);
-  serialization::readPod(file, blockStyle.marginTop);
-  serialization::readPod(file, blockStyle.marginBottom);
-  serialization::readPod(file, blockStyle.marginLeft);
-  serialization::readPod(file, blockStyle.marginRight);
-  serialization::readPod(file, blockStyle.paddingTop);
-  serialization::readPod(file, blockStyle.paddingBottom);
-  serialization::readPod(file, blockStyle.paddingLeft);
-  serialization::readPod(file, blockStyle.paddingRight);
-  serialization::readPod(file, blockStyle.textIndent);
-  serialization::readPod(file, blockStyle.textIndentDefined);
-
-  return std::unique_ptr<TextBlock>(
-      new TextBlock(std::move(words), std::move(wordXpos), std::move(wordStyles), blockStyle));
+  serialization::readPod(reader, block->blockStyle.alignment);
+  serialization::readPod(reader, block->blockStyle.textAlignDefined);
+  serialization::readPod(reader, block->blockStyle.marginTop);
+  serialization::readPod(reader, block->blockStyle.marginBottom);
+  serialization::readPod(reader, block->blockStyle.marginLeft);
+  serialization::readPod(reader, block->blockStyle.marginRight);
+  serialization::readPod(reader, block->blockStyle.paddingTop);
+  serialization::readPod(reader, block->blockStyle.paddingBottom);
+  serialization::readPod(reader, block->blockStyle.paddingLeft);
+  serialization::readPod(reader, block->blockStyle.paddingRight);
+  serialization::readPod(reader, block->blockStyle.textIndent);
+  serialization::readPod(reader, block->blockStyle.textIndentDefined);
+
+  for (auto& w : block->words) w.text = serialization::readCString(reader);
+
+  if (!reader.ok) {
+    Serial.printf("[%lu] [TXB] Deserialization failed: line runs past the end of the page\n", millis());
+    return nullptr;
+  }
+  return block;
 }
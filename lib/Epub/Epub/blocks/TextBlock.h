@@ -1,6 +1,6 @@
 #pragma once
+#include <BufferedFile.h>
 #include <EpdFontFamily.h>
-#include <HalStorage.h>
 
 #include <cstddef>
 #include <list>
@@ -11,21 +11,31 @@
 #include "Block.h"
 #include "BlockStyle.h"
 
+namespace serialization {
+struct BufferReader;
+}
+
 // Represents a line of text on a page
 class TextBlock final : public Block {
  private:
-  std::list<std::string> words;
-  std::list<uint16_t> wordXpos;
-  std::list<EpdFontFamily::Style> wordStyles;
+  struct Word {
+    const char* text;  // NUL-terminated, points into ownedText or into the page blob the line was loaded from
+    uint16_t xPos;
+    EpdFontFamily::Style style;
+  };
+  std::vector<Word> words;
+  // Words of a freshly laid out line, packed back to back. Empty for lines loaded from a section file.
+  std::string ownedText;
   BlockStyle blockStyle;
 
+  explicit TextBlock(const BlockStyle& blockStyle) : blockStyle(blockStyle) {}
+
  public:
-  explicit TextBlock(std::list<std::string> words, std::list<uint16_t> word_xpos,
-                     std::list<EpdFontFamily::Style> word_styles, const BlockStyle& blockStyle = BlockStyle())
-      : words(std::move(words)),
-        wordXpos(std::move(word_xpos)),
-        wordStyles(std::move(word_styles)),
-        blockStyle(blockStyle) {}
+  explicit TextBlock(const std::list<std::string>& words, const std::list<uint16_t>& word_xpos,
+                     const std::list<EpdFontFamily::Style>& word_styles, const BlockStyle& blockStyle = BlockStyle());
+  // Words point into ownedText, so the block cannot be copied or moved
+  TextBlock(const TextBlock&) = delete;
+  TextBlock& operator=(const TextBlock&) = delete;
   ~TextBlock() override = default;
   void setBlockStyle(const BlockStyle& blockStyle) { this->blockStyle = blockStyle; }
   const BlockStyle& getBlockStyle() const { return blockStyle; }
@@ -34,7 +44,10 @@ class TextBlock final : public Block {
   // given a renderer works out where to break the words into lines
   void render(const GfxRenderer& renderer, int fontId, int x, int y) const;
   void collectCodepoints(std::vector<uint32_t>& out, size_t max) const;
+  // Append the words separated by spaces
+  void appendText(std::string& out) const;
   BlockType getType() override { return TEXT_BLOCK; }
-  bool serialize(FsFile& file) const;
-  static std::unique_ptr<TextBlock> deserialize(FsFile& file);
+  bool serialize(BufferedFile& file) const;
+  // The words are views into the reader's buffer, which must outlive the block
+  static std::unique_ptr<TextBlock> deserialize(serialization::BufferReader& reader);
 };
@@ -1,5 +1,6 @@
 #include "CssParser.h"
 
+#include <BufferedFile.h>
 #include <HardwareSerial.h>
 
 #include <algorithm>
@@ -480,10 +481,11 @@ CssStyle CssParser::parseInlineStyle(const std::string& styleValue) { return par
 // Cache format version - increment when format changes
 constexpr uint8_t CSS_CACHE_VERSION = 2;
 
-bool CssParser::saveToCache(FsFile& file) const {
-  if (!file) {
+bool CssParser::saveToCache(FsFile& cacheFile) const {
+  if (!cacheFile) {
     return false;
   }
+  BufferedFile file(cacheFile);
 
   // Write version
   file.write(CSS_CACHE_VERSION);
@@ -540,14 +542,19 @@ bool CssParser::saveToCache(FsFile& file) const {
     file.write(reinterpret_cast<const uint8_t*>(&definedBits), sizeof(definedBits));
   }
 
+  if (!file.flush()) {
+    Serial.printf("[%lu] [CSS] Failed to write cache\n", millis());
+    return false;
+  }
   Serial.printf("[%lu] [CSS] Saved %u rules to cache\n", millis(), ruleCount);
   return true;
 }
 
-bool CssParser::loadFromCache(FsFile& file) {
-  if (!file) {
+bool CssParser::loadFromCache(FsFile& cacheFile) {
+  if (!cacheFile) {
     return false;
   }
+  BufferedFile file(cacheFile);
 
   // Clear existing rules
   clear();
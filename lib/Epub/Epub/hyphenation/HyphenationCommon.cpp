@@ -168,7 +168,12 @@ void trimSurroundingPunctuationAndFootnote(std::vector<CodepointInfo>& cps) {
 std::vector<CodepointInfo> collectCodepoints(const std::string& word) {
   std::vector<CodepointInfo> cps;
   cps.reserve(word.size());
+  collectCodepoints(word, cps);
+  return cps;
+}
 
+void collectCodepoints(const std::string& word, std::vector<CodepointInfo>& cps) {
+  cps.clear();
   const unsigned char* base = reinterpret_cast<const unsigned char*>(word.c_str());
   const unsigned char* ptr = base;
   while (*ptr != 0) {
@@ -176,6 +181,4 @@ std::vector<CodepointInfo> collectCodepoints(const std::string& word) {
     const uint32_t cp = utf8NextCodepoint(&ptr);
     cps.push_back({cp, static_cast<size_t>(current - base)});
   }
-
-  return cps;
 }
@@ -5,6 +5,14 @@
 #include <string>
 #include <vector>
 
+// Hyphenation keeps its caches in globals. The host cache compiler lays out chapters on several threads, so there
+// every thread gets its own copy.
+#ifdef CROSSPOINT_HOST_THREADS
+#define HYPHENATION_THREAD_LOCAL thread_local
+#else
+#define HYPHENATION_THREAD_LOCAL
+#endif
+
 struct CodepointInfo {
   uint32_t value;
   size_t byteOffset;
@@ -23,3 +31,5 @@ bool isExplicitHyphen(uint32_t cp);
 bool isSoftHyphen(uint32_t cp);
 void trimSurroundingPunctuationAndFootnote(std::vector<CodepointInfo>& cps);
 std::vector<CodepointInfo> collectCodepoints(const std::string& word);
+// Same as above but fills a caller-owned buffer so batch callers can reuse its capacity.
+void collectCodepoints(const std::string& word, std::vector<CodepointInfo>& cps);
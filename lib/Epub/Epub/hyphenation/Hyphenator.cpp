@@ -1,14 +1,60 @@
 #include "Hyphenator.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "HyphenationCommon.h"
 #include "LanguageRegistry.h"
 
-const LanguageHyphenator* Hyphenator::cachedHyphenator_ = nullptr;
+HYPHENATION_THREAD_LOCAL const LanguageHyphenator* Hyphenator::cachedHyphenator_ = nullptr;
 
 namespace {
 
+// Small LRU of Liang results keyed by a hash of the word's codepoints. Novels repeat the same words thousands of
+// times, and the break mask is all the layout needs, so each slot is 16 bytes (2 KB in total).
+constexpr size_t BREAK_CACHE_SIZE = 128;
+
+struct CachedBreaks {
+  uint64_t mask;
+  uint32_t key;
+  uint32_t lastUse;  // 0 = empty slot
+};
+
+HYPHENATION_THREAD_LOCAL CachedBreaks breakCache[BREAK_CACHE_SIZE] = {};
+HYPHENATION_THREAD_LOCAL uint32_t breakCacheClock = 0;
+
+// FNV-1a over the codepoints, with the length mixed in to separate prefixes of the same word
+uint32_t hashCodepoints(const std::vector<CodepointInfo>& cps) {
+  uint32_t hash = 2166136261u;
+  for (const auto& info : cps) {
+    hash = (hash ^ info.value) * 16777619u;
+  }
+  return (hash ^ static_cast<uint32_t>(cps.size())) * 16777619u;
+}
+
+// Returns the Liang break mask for `cps`, consulting the LRU first.
+uint64_t cachedBreakMask(const LanguageHyphenator& hyphenator, const std::vector<CodepointInfo>& cps) {
+  if (cps.size() > kLiangMaxWordLength) {
+    return 0;
+  }
+
+  const uint32_t key = hashCodepoints(cps);
+  CachedBreaks* victim = &breakCache[0];
+  for (auto& entry : breakCache) {
+    if (entry.lastUse != 0 && entry.key == key) {
+      entry.lastUse = ++breakCacheClock;
+      return entry.mask;
+    }
+    if (entry.lastUse < victim->lastUse) {
+      victim = &entry;
+    }
+  }
+
+  const uint64_t mask = hyphenator.breakMask(cps);
+  *victim = {mask, key, ++breakCacheClock};
+  return mask;
+}
+
 // Maps a BCP-47 language tag to a language-specific hyphenator.
 const LanguageHyphenator* hyphenatorForLanguage(const std::string& langTag) {
   if (langTag.empty()) return nullptr;
@@ -48,17 +94,17 @@ std::vector<Hyphenator::BreakInfo> buildExplicitBreakInfos(const std::vector<Cod
   return breaks;
 }
 
-}  // namespace
-
-std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& word, const bool includeFallback) {
+// Shared implementation of both breakOffsets variants; `cps` is scratch space owned by the caller.
+std::vector<Hyphenator::BreakInfo> breakOffsetsWithBuffer(const LanguageHyphenator* hyphenator, const std::string& word,
+                                                          const bool includeFallback,
+                                                          std::vector<CodepointInfo>& cps) {
   if (word.empty()) {
     return {};
   }
 
   // Convert to codepoints and normalize word boundaries.
-  auto cps = collectCodepoints(word);
+  collectCodepoints(word, cps);
   trimSurroundingPunctuationAndFootnote(cps);
-  const auto* hyphenator = cachedHyphenator_;
 
   // Explicit hyphen markers (soft or hard) take precedence over language breaks.
   auto explicitBreakInfos = buildExplicitBreakInfos(cps);
@@ -67,31 +113,58 @@ std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& w
   }
 
   // Ask language hyphenator for legal break points.
-  std::vector<size_t> indexes;
-  if (hyphenator) {
-    indexes = hyphenator->breakIndexes(cps);
+  const uint64_t mask = hyphenator ? cachedBreakMask(*hyphenator, cps) : 0;
+
+  std::vector<Hyphenator::BreakInfo> breaks;
+  if (mask != 0) {
+    for (size_t idx = 1; idx < cps.size(); ++idx) {
+      if (mask & (uint64_t{1} << idx)) {
+        breaks.push_back({byteOffsetForIndex(cps, idx), true});
+      }
+    }
+    return breaks;
   }
 
   // Only add fallback breaks if needed
-  if (includeFallback && indexes.empty()) {
+  if (includeFallback) {
     const size_t minPrefix = hyphenator ? hyphenator->minPrefix() : LiangWordConfig::kDefaultMinPrefix;
     const size_t minSuffix = hyphenator ? hyphenator->minSuffix() : LiangWordConfig::kDefaultMinSuffix;
     for (size_t idx = minPrefix; idx + minSuffix <= cps.size(); ++idx) {
-      indexes.push_back(idx);
+      breaks.push_back({byteOffsetForIndex(cps, idx), true});
     }
   }
 
-  if (indexes.empty()) {
-    return {};
-  }
+  return breaks;
+}
 
-  std::vector<Hyphenator::BreakInfo> breaks;
-  breaks.reserve(indexes.size());
-  for (const size_t idx : indexes) {
-    breaks.push_back({byteOffsetForIndex(cps, idx), true});
+}  // namespace
+
+std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& word, const bool includeFallback) {
+  std::vector<CodepointInfo> cps;
+  cps.reserve(word.size());
+  return breakOffsetsWithBuffer(cachedHyphenator_, word, includeFallback, cps);
+}
+
+std::vector<std::vector<Hyphenator::BreakInfo>> Hyphenator::breakOffsets(const std::vector<const std::string*>& words,
+                                                                         const bool includeFallback) {
+  std::vector<std::vector<BreakInfo>> results;
+  results.reserve(words.size());
+  std::vector<CodepointInfo> cps;
+  cps.reserve(kLiangMaxWordLength);
+  for (const std::string* word : words) {
+    results.push_back(breakOffsetsWithBuffer(cachedHyphenator_, *word, includeFallback, cps));
   }
+  return results;
+}
 
-  return breaks;
+void Hyphenator::setPreferredLanguage(const std::string& lang) {
+  cachedHyphenator_ = hyphenatorForLanguage(lang);
+  clearCache();
 }
 
-void Hyphenator::setPreferredLanguage(const std::string& lang) { cachedHyphenator_ = hyphenatorForLanguage(lang); }
+void Hyphenator::clearCache() {
+  for (auto& entry : breakCache) {
+    entry = {};
+  }
+  breakCacheClock = 0;
+}
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "HyphenationCommon.h"
+
 class LanguageHyphenator;
 
 class Hyphenator {
@@ -16,9 +18,18 @@ class Hyphenator {
   // minimum prefix/suffix constraints are returned even if no language-specific rule matches.
   static std::vector<BreakInfo> breakOffsets(const std::string& word, bool includeFallback);
 
+  // Batch variant for all overflow candidates of a paragraph: resolves every word in one pass, reusing a single
+  // codepoint buffer. Result i holds the breaks of words[i].
+  static std::vector<std::vector<BreakInfo>> breakOffsets(const std::vector<const std::string*>& words,
+                                                          bool includeFallback);
+
   // Provide a publication-level language hint (e.g. "en", "en-US", "ru") used to select hyphenation rules.
+  // Also drops the word cache, so calling this once per section keeps the cache scoped to that section.
   static void setPreferredLanguage(const std::string& lang);
 
+  // Forget all cached Liang results.
+  static void clearCache();
+
  private:
-  static const LanguageHyphenator* cachedHyphenator_;
+  static HYPHENATION_THREAD_LOCAL const LanguageHyphenator* cachedHyphenator_;
 };
\ No newline at end of file
@@ -14,6 +14,10 @@ class LanguageHyphenator {
     return liangBreakIndexes(cps, patterns_, config_);
   }
 
+  uint64_t breakMask(const std::vector<CodepointInfo>& cps) const {
+    return liangBreakMask(cps.data(), cps.size(), patterns_, config_);
+  }
+
   size_t minPrefix() const { return config_.minPrefix; }
   size_t minSuffix() const { return config_.minSuffix; }
 
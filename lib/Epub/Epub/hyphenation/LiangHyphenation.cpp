@@ -7,8 +7,8 @@
  * Liang hyphenation pipeline overview (Typst-style binary trie variant)
  * --------------------------------------------------------------------
  * 1.  Input normalization (buildAugmentedWord)
- *     - Accepts a vector of CodepointInfo structs emitted by the EPUB text
- *       parser. Each codepoint is validated with LiangWordConfig::isLetter so
+ *     - Accepts up to kLiangMaxWordLength CodepointInfo structs emitted by the
+ *       EPUB text parser. Each codepoint is validated with LiangWordConfig::isLetter so
  *       we abort early on digits, punctuation, etc. If the word is valid we
  *       build an "augmented" byte sequence: leading '.', lowercase UTF-8 bytes
  *       for every letter, then a trailing '.'. While doing this we capture the
@@ -38,89 +38,91 @@
  *       "max digit wins" rule.
  *
  * 4.  Output filtering
- *     - collectBreakIndexes converts odd-valued score entries back to codepoint
- *       break positions while enforcing `minPrefix`/`minSuffix` constraints from
- *       LiangWordConfig. The caller (language-specific hyphenators) can then
+ *     - collectBreakMask converts odd-valued score entries back to a bitmask of
+ *       codepoint break positions while enforcing `minPrefix`/`minSuffix`
+ *       constraints from LiangWordConfig. The caller (language-specific hyphenators) can then
  *       translate these indexes into renderer glyph offsets, page layout data,
  *       etc.
  *
  * Keeping the entire algorithm small and deterministic is critical on the
  * ESP32-C3: we avoid recursion, dynamic allocations per node, or copying the
  * trie. All lookups stay within the generated blob, which lives in flash, and
- * the working buffers (augmented bytes/scores) scale with the word length rather
- * than the pattern corpus.
+ * the working buffers (augmented bytes/scores) are fixed-size stack arrays sized
+ * for the longest supported word rather than per-call heap vectors.
  */
 
 namespace {
 
+constexpr size_t kMaxAugmentedChars = kLiangMaxWordLength + 2;
+constexpr size_t kMaxAugmentedBytes = kLiangMaxWordLength * 4 + 2;
+
+// Fixed-size working buffers for a single word. Words are capped at kLiangMaxWordLength codepoints, so everything
+// fits in well under a kilobyte of stack and no heap allocation happens per call.
 struct AugmentedWord {
-  std::vector<uint8_t> bytes;
-  std::vector<size_t> charByteOffsets;
-  std::vector<int32_t> byteToCharIndex;
+  uint8_t bytes[kMaxAugmentedBytes];
+  uint16_t charByteOffsets[kMaxAugmentedChars];
+  int8_t byteToCharIndex[kMaxAugmentedBytes];
+  size_t byteCount = 0;
+  size_t charCount = 0;
 
-  bool empty() const { return bytes.empty(); }
-  size_t charCount() const { return charByteOffsets.size(); }
+  bool empty() const { return byteCount == 0; }
 };
 
-// Encode a single Unicode codepoint into UTF-8 and append to the provided buffer.
-size_t encodeUtf8(uint32_t cp, std::vector<uint8_t>& out) {
+// Encode a single Unicode codepoint into UTF-8 at `out`, returning the number of bytes written.
+size_t encodeUtf8(uint32_t cp, uint8_t* out) {
   if (cp <= 0x7Fu) {
-    out.push_back(static_cast<uint8_t>(cp));
+    out[0] = static_cast<uint8_t>(cp);
     return 1;
   }
   if (cp <= 0x7FFu) {
-    out.push_back(static_cast<uint8_t>(0xC0u | ((cp >> 6) & 0x1Fu)));
-    out.push_back(static_cast<uint8_t>(0x80u | (cp & 0x3Fu)));
+    out[0] = static_cast<uint8_t>(0xC0u | ((cp >> 6) & 0x1Fu));
+    out[1] = static_cast<uint8_t>(0x80u | (cp & 0x3Fu));
     return 2;
   }
   if (cp <= 0xFFFFu) {
-    out.push_back(static_cast<uint8_t>(0xE0u | ((cp >> 12) & 0x0Fu)));
-    out.push_back(static_cast<uint8_t>(0x80u | ((cp >> 6) & 0x3Fu)));
-    out.push_back(static_cast<uint8_t>(0x80u | (cp & 0x3Fu)));
+    out[0] = static_cast<uint8_t>(0xE0u | ((cp >> 12) & 0x0Fu));
+    out[1] = static_cast<uint8_t>(0x80u | ((cp >> 6) & 0x3Fu));
+    out[2] = static_cast<uint8_t>(0x80u | (cp & 0x3Fu));
     return 3;
   }
-  out.push_back(static_cast<uint8_t>(0xF0u | ((cp >> 18) & 0x07u)));
-  out.push_back(static_cast<uint8_t>(0x80u | ((cp >> 12) & 0x3Fu)));
-  out.push_back(static_cast<uint8_t>(0x80u | ((cp >> 6) & 0x3Fu)));
-  out.push_back(static_cast<uint8_t>(0x80u | (cp & 0x3Fu)));
+  out[0] = static_cast<uint8_t>(0xF0u | ((cp >> 18) & 0x07u));
+  out[1] = static_cast<uint8_t>(0x80u | ((cp >> 12) & 0x3Fu));
+  out[2] = static_cast<uint8_t>(0x80u | ((cp >> 6) & 0x3Fu));
+  out[3] = static_cast<uint8_t>(0x80u | (cp & 0x3Fu));
   return 4;
 }
 
-// Build the dotted, lowercase UTF-8 representation plus lookup tables.
-AugmentedWord buildAugmentedWord(const std::vector<CodepointInfo>& cps, const LiangWordConfig& config) {
-  AugmentedWord word;
-  if (cps.empty()) {
-    return word;
+// Build the dotted, lowercase UTF-8 representation plus lookup tables into `word`.
+// Returns false (leaving `word` empty) for words that are too long or contain non-letters.
+bool buildAugmentedWord(const CodepointInfo* cps, const size_t count, const LiangWordConfig& config,
+                        AugmentedWord& word) {
+  word.byteCount = 0;
+  word.charCount = 0;
+  if (count == 0 || count > kLiangMaxWordLength) {
+    return false;
   }
 
-  word.bytes.reserve(cps.size() * 2 + 2);
-  word.charByteOffsets.reserve(cps.size() + 2);
-
-  word.charByteOffsets.push_back(0);
-  word.bytes.push_back('.');
+  word.charByteOffsets[word.charCount++] = 0;
+  word.bytes[word.byteCount++] = '.';
 
-  for (const auto& info : cps) {
-    if (!config.isLetter(info.value)) {
-      word.bytes.clear();
-      word.charByteOffsets.clear();
-      word.byteToCharIndex.clear();
-      return word;
+  for (size_t i = 0; i < count; ++i) {
+    if (!config.isLetter(cps[i].value)) {
+      word.byteCount = 0;
+      word.charCount = 0;
+      return false;
     }
-    word.charByteOffsets.push_back(word.bytes.size());
-    encodeUtf8(config.toLower(info.value), word.bytes);
+    word.charByteOffsets[word.charCount++] = static_cast<uint16_t>(word.byteCount);
+    word.byteCount += encodeUtf8(config.toLower(cps[i].value), word.bytes + word.byteCount);
   }
 
-  word.charByteOffsets.push_back(word.bytes.size());
-  word.bytes.push_back('.');
+  word.charByteOffsets[word.charCount++] = static_cast<uint16_t>(word.byteCount);
+  word.bytes[word.byteCount++] = '.';
 
-  word.byteToCharIndex.assign(word.bytes.size(), -1);
-  for (size_t i = 0; i < word.charByteOffsets.size(); ++i) {
-    const size_t offset = word.charByteOffsets[i];
-    if (offset < word.byteToCharIndex.size()) {
-      word.byteToCharIndex[offset] = static_cast<int32_t>(i);
-    }
+  std::fill(word.byteToCharIndex, word.byteToCharIndex + word.byteCount, static_cast<int8_t>(-1));
+  for (size_t i = 0; i < word.charCount; ++i) {
+    word.byteToCharIndex[word.charByteOffsets[i]] = static_cast<int8_t>(i);
   }
-  return word;
+  return true;
 }
 
 // Decoded view of a single trie node pulled straight out of the serialized blob.
@@ -178,7 +180,7 @@ const EmbeddedAutomaton& getAutomaton(const SerializedHyphenationPatterns& patte
     const SerializedHyphenationPatterns* key;
     EmbeddedAutomaton automaton;
   };
-  static std::vector<CacheEntry> cache;
+  static HYPHENATION_THREAD_LOCAL std::vector<CacheEntry> cache;
 
   for (const auto& entry : cache) {
     if (entry.key == &patterns) {
@@ -300,15 +302,13 @@ bool transition(const EmbeddedAutomaton& automaton, const AutomatonState& state,
   return false;
 }
 
-// Converts odd score positions back into codepoint indexes, honoring min prefix/suffix constraints.
+// Converts odd score positions into a bitmask of codepoint break indexes, honoring min prefix/suffix constraints.
 // Each break corresponds to scores[breakIndex + 1] because of the leading '.' sentinel.
-// Convert odd score entries into hyphen positions while honoring prefix/suffix limits.
-std::vector<size_t> collectBreakIndexes(const std::vector<CodepointInfo>& cps, const std::vector<uint8_t>& scores,
-                                        const size_t minPrefix, const size_t minSuffix) {
-  std::vector<size_t> indexes;
-  const size_t cpCount = cps.size();
+uint64_t collectBreakMask(const size_t cpCount, const uint8_t* scores, const size_t scoreCount,
+                          const size_t minPrefix, const size_t minSuffix) {
+  uint64_t mask = 0;
   if (cpCount < 2) {
-    return indexes;
+    return mask;
   }
 
   for (size_t breakIndex = 1; breakIndex < cpCount; ++breakIndex) {
@@ -322,47 +322,47 @@ std::vector<size_t> collectBreakIndexes(const std::vector<CodepointInfo>& cps, c
     }
 
     const size_t scoreIdx = breakIndex + 1;
-    if (scoreIdx >= scores.size()) {
+    if (scoreIdx >= scoreCount) {
       break;
     }
     if ((scores[scoreIdx] & 1u) == 0) {
       continue;
     }
-    indexes.push_back(breakIndex);
+    mask |= uint64_t{1} << breakIndex;
   }
 
-  return indexes;
+  return mask;
 }
 
 }  // namespace
 
 // Entry point that runs the full Liang pipeline for a single word.
-std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
-                                      const SerializedHyphenationPatterns& patterns, const LiangWordConfig& config) {
-  const auto augmented = buildAugmentedWord(cps, config);
-  if (augmented.empty()) {
-    return {};
+uint64_t liangBreakMask(const CodepointInfo* cps, const size_t count, const SerializedHyphenationPatterns& patterns,
+                        const LiangWordConfig& config) {
+  AugmentedWord augmented;
+  if (!buildAugmentedWord(cps, count, config, augmented)) {
+    return 0;
   }
 
   const EmbeddedAutomaton& automaton = getAutomaton(patterns);
   if (!automaton.valid()) {
-    return {};
+    return 0;
   }
 
   const AutomatonState root = decodeState(automaton, automaton.rootOffset);
   if (!root.valid()) {
-    return {};
+    return 0;
   }
 
   // Liang scores: one entry per augmented char (leading/trailing dots included).
-  std::vector<uint8_t> scores(augmented.charCount(), 0);
+  uint8_t scores[kMaxAugmentedChars] = {};
 
   // Walk every starting character position and stream bytes through the trie.
-  for (size_t charStart = 0; charStart < augmented.charByteOffsets.size(); ++charStart) {
+  for (size_t charStart = 0; charStart < augmented.charCount; ++charStart) {
     const size_t byteStart = augmented.charByteOffsets[charStart];
     AutomatonState state = root;
 
-    for (size_t cursor = byteStart; cursor < augmented.bytes.size(); ++cursor) {
+    for (size_t cursor = byteStart; cursor < augmented.byteCount; ++cursor) {
       AutomatonState next;
       if (!transition(automaton, state, augmented.bytes[cursor], next)) {
         break;  // No more matches for this prefix.
@@ -379,7 +379,7 @@ std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
 
           offset += dist;
           const size_t splitByte = byteStart + offset;
-          if (splitByte >= augmented.byteToCharIndex.size()) {
+          if (splitByte >= augmented.byteCount) {
             continue;
           }
 
@@ -387,12 +387,12 @@ std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
           if (boundary < 0) {
             continue;  // Mid-codepoint byte, wait for the next one.
           }
-          if (boundary < 2 || boundary + 2 > static_cast<int32_t>(augmented.charCount())) {
+          if (boundary < 2 || boundary + 2 > static_cast<int32_t>(augmented.charCount)) {
             continue;  // Skip splits that land in the leading/trailing sentinels.
           }
 
           const size_t idx = static_cast<size_t>(boundary);
-          if (idx >= scores.size()) {
+          if (idx >= augmented.charCount) {
             continue;
           }
           scores[idx] = std::max(scores[idx], level);
@@ -401,5 +401,17 @@ std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
     }
   }
 
-  return collectBreakIndexes(cps, scores, config.minPrefix, config.minSuffix);
+  return collectBreakMask(count, scores, augmented.charCount, config.minPrefix, config.minSuffix);
+}
+
+std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
+                                      const SerializedHyphenationPatterns& patterns, const LiangWordConfig& config) {
+  std::vector<size_t> indexes;
+  const uint64_t mask = liangBreakMask(cps.data(), cps.size(), patterns, config);
+  for (size_t idx = 1; idx < kLiangMaxWordLength; ++idx) {
+    if (mask & (uint64_t{1} << idx)) {
+      indexes.push_back(idx);
+    }
+  }
+  return indexes;
 }
@@ -33,6 +33,15 @@ struct LiangWordConfig {
       : isLetter(letterFn), toLower(lowerFn), minPrefix(prefix), minSuffix(suffix) {}
 };
 
-// Shared Liang pattern evaluator used by every language-specific hyphenator.
+// Longest word (in codepoints) the evaluator hyphenates. Break positions of shorter words fit in a uint64_t mask;
+// longer "words" are virtually always URLs or similar runs that fallback breaking handles anyway.
+constexpr size_t kLiangMaxWordLength = 64;
+
+// Shared Liang pattern evaluator used by every language-specific hyphenator. Bit i of the result is set when the
+// word may be broken before codepoint i. Works entirely on stack buffers.
+uint64_t liangBreakMask(const CodepointInfo* cps, size_t count, const SerializedHyphenationPatterns& patterns,
+                        const LiangWordConfig& config);
+
+// Convenience wrapper returning the set bits of liangBreakMask as ascending codepoint indexes.
 std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
                                       const SerializedHyphenationPatterns& patterns, const LiangWordConfig& config);
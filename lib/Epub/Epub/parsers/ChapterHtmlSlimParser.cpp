@@ -172,6 +172,19 @@ void ChapterHtmlSlimParser::flushPartWordBuffer() {
   nextWordContinues = false;
 }
 
+void ChapterHtmlSlimParser::addAnchor(const char* id) {
+  if (anchorFn && id != nullptr && id[0] != '\0') {
+    pendingAnchors.emplace_back(id);
+  }
+}
+
+void ChapterHtmlSlimParser::resolvePendingAnchors() {
+  for (const auto& id : pendingAnchors) {
+    anchorFn(id, completedPages);
+  }
+  pendingAnchors.clear();
+}
+
 // start a new text block if needed
 void ChapterHtmlSlimParser::startNewTextBlock(const BlockStyle& blockStyle) {
   nextWordContinues = false;  // New block = new paragraph, no continuation
@@ -199,15 +212,18 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
     return;
   }
 
-  // Extract class and style attributes for CSS processing
+  // Extract class and style attributes for CSS processing, and the id as a link target
   std::string classAttr;
   std::string styleAttr;
+  const char* idAttr = nullptr;
   if (atts != nullptr) {
     for (int i = 0; atts[i]; i += 2) {
       if (strcmp(atts[i], "class") == 0) {
         classAttr = atts[i + 1];
       } else if (strcmp(atts[i], "style") == 0) {
         styleAttr = atts[i + 1];
+      } else if (strcmp(atts[i], "id") == 0) {
+        idAttr = atts[i + 1];
       }
     }
   }
@@ -220,6 +236,7 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
   if (strcmp(name, "table") == 0) {
     // Add placeholder text
     self->startNewTextBlock(centeredBlockStyle);
+    self->addAnchor(idAttr);
 
     self->italicUntilDepth = min(self->italicUntilDepth, self->depth);
     // Advance depth before processing character data (like you would for an element with text)
@@ -248,6 +265,7 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
     Serial.printf("[%lu] [EHP] Image alt: %s\n", millis(), alt.c_str());
 
     self->startNewTextBlock(centeredBlockStyle);
+    self->addAnchor(idAttr);
     self->italicUntilDepth = min(self->italicUntilDepth, self->depth);
     // Advance depth before processing character data (like you would for an element with text)
     self->depth += 1;
@@ -270,6 +288,8 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
     for (int i = 0; atts[i]; i += 2) {
       if (strcmp(atts[i], "role") == 0 && strcmp(atts[i + 1], "doc-pagebreak") == 0 ||
           strcmp(atts[i], "epub:type") == 0 && strcmp(atts[i + 1], "pagebreak") == 0) {
+        // Page markers are common link targets (page lists), keep them even though their content is dropped
+        self->addAnchor(idAttr);
         self->skipUntilDepth = self->depth;
         self->depth += 1;
         return;
@@ -412,6 +432,9 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
     }
   }
 
+  // Block elements have laid out the previous block by now, so the id resolves to the first line of this one
+  self->addAnchor(idAttr);
+
   // Unprocessed tag, just increasing depth and continue forward
   self->depth += 1;
 }
@@ -636,6 +659,16 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   XML_SetCharacterDataHandler(parser, characterData);
 
   do {
+    if (abortFn && abortFn()) {
+      Serial.printf("[%lu] [EHP] Aborted\n", millis());
+      XML_StopParser(parser, XML_FALSE);                // Stop any pending processing
+      XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
+      XML_SetCharacterDataHandler(parser, nullptr);
+      XML_ParserFree(parser);
+      file.close();
+      return false;
+    }
+
     void* const buf = XML_GetBuffer(parser, 1024);
     if (!buf) {
       Serial.printf("[%lu] [EHP] Couldn't allocate memory for buffer\n", millis());
@@ -682,6 +715,8 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   // Process last page if there is still text
   if (currentTextBlock) {
     makePages();
+    // Ids after the last line of the chapter point at its last page
+    resolvePendingAnchors();
     completePageFn(std::move(currentPage));
     currentPage.reset();
     currentTextBlock.reset();
@@ -695,10 +730,15 @@ void ChapterHtmlSlimParser::addLineToPage(std::shared_ptr<TextBlock> line) {
 
   if (currentPageNextY + lineHeight > viewportHeight) {
     completePageFn(std::move(currentPage));
+    completedPages++;
     currentPage.reset(new Page());
     currentPageNextY = 0;
   }
 
+  if (!pendingAnchors.empty()) {
+    resolvePendingAnchors();
+  }
+
   // Apply horizontal left inset (margin + padding) as x position offset
   const int16_t xOffset = line->getBlockStyle().leftInset();
   currentPage->elements.push_back(std::make_shared<PageLine>(line, xOffset, currentPageNextY));
@@ -21,6 +21,11 @@ class ChapterHtmlSlimParser {
   GfxRenderer& renderer;
   std::function<void(std::unique_ptr<Page>)> completePageFn;
   std::function<void()> popupFn;  // Popup callback
+  std::function<void(const std::string& id, uint16_t page)> anchorFn;
+  std::function<bool()> abortFn;  // Checked between chunks, true stops the layout
+  // Element ids seen since the last line was placed; they resolve to the page that line lands on
+  std::vector<std::string> pendingAnchors;
+  uint16_t completedPages = 0;
   int depth = 0;
   int skipUntilDepth = INT_MAX;
   int boldUntilDepth = INT_MAX;
@@ -61,6 +66,8 @@ class ChapterHtmlSlimParser {
   void updateEffectiveInlineStyle();
   void startNewTextBlock(const BlockStyle& blockStyle);
   void flushPartWordBuffer();
+  void addAnchor(const char* id);
+  void resolvePendingAnchors();
   void makePages();
   // XML callbacks
   static void XMLCALL startElement(void* userData, const XML_Char* name, const XML_Char** atts);
@@ -75,7 +82,9 @@ class ChapterHtmlSlimParser {
                                  const bool firstLineIndent,
                                  const std::function<void(std::unique_ptr<Page>)>& completePageFn,
                                  const bool embeddedStyle, const std::function<void()>& popupFn = nullptr,
-                                 const CssParser* cssParser = nullptr)
+                                 const CssParser* cssParser = nullptr,
+                                 const std::function<void(const std::string& id, uint16_t page)>& anchorFn = nullptr,
+                                 const std::function<bool()>& abortFn = nullptr)
 
       : filepath(filepath),
         renderer(renderer),
@@ -89,6 +98,8 @@ class ChapterHtmlSlimParser {
         firstLineIndent(firstLineIndent),
         completePageFn(completePageFn),
         popupFn(popupFn),
+        anchorFn(anchorFn),
+        abortFn(abortFn),
         cssParser(cssParser),
         embeddedStyle(embeddedStyle) {}
 
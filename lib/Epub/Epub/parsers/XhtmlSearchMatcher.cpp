@@ -0,0 +1,178 @@
+#include "XhtmlSearchMatcher.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// Text window size that triggers a scan, and the context kept on each side of a match for its snippet
+constexpr size_t WINDOW_SCAN_SIZE = 1024;
+constexpr size_t SNIPPET_CONTEXT = 32;
+
+// Elements whose boundaries separate words even without surrounding whitespace
+constexpr const char* BREAKING_TAGS[] = {"p",  "div", "br", "li", "h1", "h2", "h3",         "h4", "h5", "h6",
+                                         "tr", "td",  "th", "dt", "dd", "hr", "blockquote", "section"};
+constexpr const char* SKIPPED_TAGS[] = {"script", "style", "rt", "rp"};
+
+bool matchesAny(const std::string& name, const char* const* names, const size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (name == names[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+size_t XhtmlSearchMatcher::write(const uint8_t data) { return write(&data, 1); }
+
+size_t XhtmlSearchMatcher::write(const uint8_t* buffer, const size_t size) {
+  for (size_t i = 0; i < size; i++, position++) {
+    const uint8_t c = buffer[i];
+
+    if (state == TAG) {
+      if (c == '>') {
+        endTag();
+        state = TEXT;
+      } else if (!tagNameDone) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || (c == '/' && !tagName.empty())) {
+          tagNameDone = true;
+        } else if (tagName.size() < 12) {
+          tagName += static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+      }
+      continue;
+    }
+
+    if (state == ENTITY) {
+      if (c == ';') {
+        endEntity();
+        state = TEXT;
+      } else if (entity.size() < 10 && c != '<' && c != '&') {
+        entity += static_cast<char>(c);
+      } else {
+        // Not an entity after all, drop it and reprocess this byte as text
+        state = TEXT;
+        i--;
+        position--;
+      }
+      continue;
+    }
+
+    if (c == '<') {
+      state = TAG;
+      tagName.clear();
+      tagNameDone = false;
+      continuationBytes = 0;
+      continue;
+    }
+    if (!inBody || skipContent) {
+      continue;
+    }
+    if (c == '&') {
+      state = ENTITY;
+      entity.clear();
+      continue;
+    }
+
+    // UTF-8 decoding
+    if (continuationBytes > 0 && (c & 0xC0) == 0x80) {
+      codepoint = (codepoint << 6) | (c & 0x3F);
+      if (--continuationBytes == 0) {
+        pushCodepoint(codepoint);
+      }
+      continue;
+    }
+    continuationBytes = 0;
+    if (c < 0x80) {
+      pushCodepoint(c);
+    } else if ((c & 0xE0) == 0xC0) {
+      codepoint = c & 0x1F;
+      continuationBytes = 1;
+    } else if ((c & 0xF0) == 0xE0) {
+      codepoint = c & 0x0F;
+      continuationBytes = 2;
+    } else if ((c & 0xF8) == 0xF0) {
+      codepoint = c & 0x07;
+      continuationBytes = 3;
+    }
+  }
+  return size;
+}
+
+void XhtmlSearchMatcher::pushCodepoint(const uint32_t cp) {
+  normalizer.push(cp, window);
+  windowOffsets.resize(window.size(), position);
+  if (window.size() >= WINDOW_SCAN_SIZE) {
+    scan(false);
+  }
+}
+
+void XhtmlSearchMatcher::endTag() {
+  const bool closing = !tagName.empty() && tagName[0] == '/';
+  const std::string name = closing ? tagName.substr(1) : tagName;
+
+  if (name == "body") {
+    inBody = !closing;
+  } else if (matchesAny(name, SKIPPED_TAGS, sizeof(SKIPPED_TAGS) / sizeof(SKIPPED_TAGS[0]))) {
+    skipContent = !closing;
+  } else if (matchesAny(name, BREAKING_TAGS, sizeof(BREAKING_TAGS) / sizeof(BREAKING_TAGS[0]))) {
+    pushCodepoint(' ');
+  }
+}
+
+void XhtmlSearchMatcher::endEntity() {
+  uint32_t cp = 0;
+  if (entity == "amp") {
+    cp = '&';
+  } else if (entity == "lt") {
+    cp = '<';
+  } else if (entity == "gt") {
+    cp = '>';
+  } else if (entity == "quot") {
+    cp = '"';
+  } else if (entity == "apos") {
+    cp = '\'';
+  } else if (entity == "nbsp") {
+    cp = ' ';
+  } else if (entity.size() > 1 && entity[0] == '#') {
+    const bool hex = entity[1] == 'x' || entity[1] == 'X';
+    cp = strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10);
+  }
+  if (cp != 0) {
+    pushCodepoint(cp);
+  }
+}
+
+void XhtmlSearchMatcher::scan(const bool final) {
+  while (matches.size() < maxMatches) {
+    const size_t pos = SearchIndex::findMatch(window, query, scanFrom);
+    if (pos == std::string::npos) {
+      scanFrom = window.size() >= query.size() ? window.size() - query.size() + 1 : 0;
+      break;
+    }
+    if (!final && pos + query.size() + SNIPPET_CONTEXT > window.size()) {
+      // Wait for the right-hand context (and the word boundary) to arrive
+      scanFrom = pos;
+      break;
+    }
+    matches.push_back({windowOffsets[pos], SearchIndex::snippet(window, pos, query.size(), SNIPPET_CONTEXT)});
+    scanFrom = pos + query.size();
+  }
+
+  if (final) {
+    return;
+  }
+
+  // Drop everything that can no longer be part of a match or its snippet
+  size_t cut = scanFrom > SNIPPET_CONTEXT ? scanFrom - SNIPPET_CONTEXT : 0;
+  while (cut > 0 && cut < window.size() && (static_cast<unsigned char>(window[cut]) & 0xC0) == 0x80) {
+    cut--;
+  }
+  if (cut > 0) {
+    window.erase(0, cut);
+    windowOffsets.erase(windowOffsets.begin(), windowOffsets.begin() + cut);
+    scanFrom -= cut;
+  }
+}
+
+void XhtmlSearchMatcher::finish() { scan(true); }
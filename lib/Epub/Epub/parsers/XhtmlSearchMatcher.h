@@ -0,0 +1,62 @@
+#pragma once
+#include <Print.h>
+
+#include <string>
+#include <vector>
+
+#include "../SearchIndex.h"
+
+/**
+ * Streaming text matcher for chapters that have not been laid out yet.
+ *
+ * Receives the raw XHTML of a spine item (e.g. from Epub::readItemContentsToStream), strips markup, decodes the
+ * common entities and looks for a normalized query in a small sliding window of body text. Only the window is held
+ * in memory, so the chapter never has to be inflated or parsed as a whole.
+ */
+class XhtmlSearchMatcher final : public Print {
+ public:
+  struct Match {
+    uint32_t offset;  // Byte offset of the match in the XHTML
+    std::string snippet;
+  };
+
+ private:
+  enum State { TEXT, TAG, ENTITY };
+
+  std::string query;
+  size_t maxMatches;
+  std::vector<Match> matches;
+
+  State state = TEXT;
+  bool inBody = false;
+  bool skipContent = false;  // Inside <script>, <style> or ruby annotations
+  std::string tagName;
+  bool tagNameDone = false;
+  std::string entity;
+
+  uint32_t codepoint = 0;
+  int continuationBytes = 0;
+  uint32_t position = 0;
+
+  SearchIndex::Normalizer normalizer;
+  std::string window;
+  std::vector<uint32_t> windowOffsets;  // XHTML offset of every byte in the window
+  size_t scanFrom = 0;
+
+  void pushCodepoint(uint32_t cp);
+  void endTag();
+  void endEntity();
+  void scan(bool final);
+
+ public:
+  explicit XhtmlSearchMatcher(std::string normalizedQuery, const size_t maxMatches)
+      : query(std::move(normalizedQuery)), maxMatches(maxMatches) {}
+
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  // Flush the remaining window once the whole item has been streamed
+  void finish();
+  const std::vector<Match>& getMatches() const { return matches; }
+  uint32_t getBytesProcessed() const { return position; }
+};
@@ -23,6 +23,8 @@ void ExternalFont::unload() {
   _accessCounter = 0;
   _lastReadOffset = 0;
   _hasLastReadOffset = false;
+  _hasCoverage = false;
+  _glyphCount = 0;
 
   // Clear cache and hash table
   for (int i = 0; i < CACHE_SIZE; i++) {
@@ -127,6 +129,28 @@ bool ExternalFont::load(const char* filepath) {
   return true;
 }
 
+void ExternalFont::setCoverage(const uint8_t* coverage, const uint32_t glyphCount) {
+  memcpy(_coverage, coverage, COVERAGE_BYTES);
+  _glyphCount = glyphCount;
+  _hasCoverage = true;
+}
+
+bool ExternalFont::lacksGlyph(const uint32_t codepoint) const {
+  // ASCII and the U+2000-U+200F spaces are returned even when empty
+  if (!_hasCoverage || codepoint <= 0x7F || (codepoint >= 0x2000 && codepoint <= 0x200F)) {
+    return false;
+  }
+  if (codepoint >= _glyphCount) {
+    // Past the end of the file fullwidth forms fall back to halfwidth glyphs
+    return codepoint < 0xFF01 || codepoint > 0xFF5E;
+  }
+  if (codepoint >= COVERAGE_BYTES * 8 * 256) {
+    return false;
+  }
+  const uint32_t block = codepoint >> 8;
+  return !(_coverage[block / 8] & (1 << (block % 8)));
+}
+
 int ExternalFont::findInCache(uint32_t codepoint) {
   // O(1) hash table lookup with linear probing for collisions
   int hash = hashCodepoint(codepoint);
@@ -198,7 +222,7 @@ bool ExternalFont::readGlyphFromSD(uint32_t codepoint, uint8_t* buffer) {
 }
 
 const uint8_t* ExternalFont::getGlyph(uint32_t codepoint) {
-  if (!_isLoaded) {
+  if (!_isLoaded || lacksGlyph(codepoint)) {
     return nullptr;
   }
 
@@ -17,6 +17,10 @@
  */
 class ExternalFont {
  public:
+  static constexpr int MAX_GLYPH_BYTES = 200;  // Max 200 bytes per glyph (enough for 33x39)
+  // Coverage bitmap: one bit per 256-codepoint block of the BMP, set if the block has a non-empty glyph
+  static constexpr int COVERAGE_BYTES = 32;
+
   ExternalFont() {
     // Initialize cache and hash table
     for (int i = 0; i < CACHE_SIZE; i++) {
@@ -42,6 +46,14 @@ class ExternalFont {
    */
   bool load(const char* filepath);
 
+  /**
+   * Tell the font which codepoints it has glyphs for, as recorded by FontManager's registry.
+   * getGlyph() then returns nullptr for the others without reading the SD card.
+   * @param coverage COVERAGE_BYTES bytes, bit (b & 7) of byte b / 8 for codepoints b * 256 to b * 256 + 255
+   * @param glyphCount Glyphs in the file, codepoints 0 to glyphCount - 1
+   */
+  void setCoverage(const uint8_t* coverage, uint32_t glyphCount);
+
   /**
    * Get glyph bitmap data (with LRU cache)
    * @param codepoint Unicode codepoint
@@ -94,8 +106,7 @@ class ExternalFont {
 
   // LRU cache - 256 glyphs for better Chinese text performance
   // Memory: ~52KB (256 * 204 bytes per entry)
-  static constexpr int CACHE_SIZE = 256;       // 256 glyphs
-  static constexpr int MAX_GLYPH_BYTES = 200;  // Max 200 bytes per glyph (enough for 33x39)
+  static constexpr int CACHE_SIZE = 256;  // 256 glyphs
 
   // Flag to mark cached "non-existent" glyphs (avoid repeated SD reads)
   static constexpr uint8_t GLYPH_NOT_FOUND_MARKER = 0xFE;
@@ -111,6 +122,11 @@ class ExternalFont {
   CacheEntry _cache[CACHE_SIZE];
   uint32_t _accessCounter = 0;
 
+  // Coverage from setCoverage(), unknown until then
+  bool _hasCoverage = false;
+  uint8_t _coverage[COVERAGE_BYTES] = {};
+  uint32_t _glyphCount = 0;
+
   // Sequential read fast path - skip seek if reading consecutive glyphs
   uint32_t _lastReadOffset = 0;
   bool _hasLastReadOffset = false;
@@ -125,6 +141,11 @@ class ExternalFont {
    */
   bool readGlyphFromSD(uint32_t codepoint, uint8_t* buffer);
 
+  /**
+   * Whether the coverage says getGlyph() would find no glyph for codepoint
+   */
+  bool lacksGlyph(uint32_t codepoint) const;
+
   /**
    * Parse filename to get font parameters
    * Format: FontName_size_WxH.bin
@@ -4,6 +4,7 @@
 #include <HardwareSerial.h>
 #include <Serialization.h>
 
+#include <algorithm>
 #include <cstring>
 
 // Out-of-class definitions for static constexpr members (required for ODR-use
@@ -12,12 +13,90 @@ constexpr int FontManager::MAX_FONTS;
 constexpr const char* FontManager::FONTS_DIR;
 constexpr const char* FontManager::SETTINGS_FILE;
 constexpr uint8_t FontManager::SETTINGS_VERSION;
+constexpr const char* FontManager::REGISTRY_FILE;
+constexpr uint8_t FontManager::REGISTRY_VERSION;
+constexpr int FontManager::MAX_REGISTRY_ENTRIES;
 
 FontManager& FontManager::getInstance() {
   static FontManager instance;
   return instance;
 }
 
+namespace {
+uint32_t getModifyStamp(FsFile& file) {
+  uint16_t date = 0;
+  uint16_t time = 0;
+  if (!file.getModifyDateTime(&date, &time)) {
+    return 0;
+  }
+  return (static_cast<uint32_t>(date) << 16) | time;
+}
+
+// Parse FontName_size_WxH.bin into info
+bool parseFontFilename(const char* filename, FontInfo& info) {
+  char nameCopy[64];
+  strncpy(nameCopy, filename, sizeof(nameCopy) - 1);
+  nameCopy[sizeof(nameCopy) - 1] = '\0';
+
+  // Remove .bin
+  char* ext = strstr(nameCopy, ".bin");
+  if (ext) *ext = '\0';
+
+  // Parse _WxH
+  char* lastUnderscore = strrchr(nameCopy, '_');
+  if (!lastUnderscore) return false;
+
+  int w, h;
+  if (sscanf(lastUnderscore + 1, "%dx%d", &w, &h) != 2) return false;
+  info.width = (uint8_t)w;
+  info.height = (uint8_t)h;
+  *lastUnderscore = '\0';
+
+  // Parse _size
+  lastUnderscore = strrchr(nameCopy, '_');
+  if (!lastUnderscore) return false;
+
+  int size;
+  if (sscanf(lastUnderscore + 1, "%d", &size) != 1) return false;
+  info.size = (uint8_t)size;
+  *lastUnderscore = '\0';
+
+  // Font name
+  strncpy(info.name, nameCopy, sizeof(info.name) - 1);
+  info.name[sizeof(info.name) - 1] = '\0';
+  return true;
+}
+
+int bytesPerChar(const FontInfo& info) { return (info.width + 7) / 8 * info.height; }
+
+// Set the coverage bit of every 256-codepoint block with a non-empty glyph. A block is read up to its first set
+// byte; blocks that can't be read count as covered.
+void scanCoverage(FsFile& file, FontInfo& info) {
+  memset(info.coverage, 0, sizeof(info.coverage));
+  const uint32_t glyphBytes = bytesPerChar(info);
+  const uint32_t blocks = std::min<uint32_t>((info.glyphCount + 255) / 256, ExternalFont::COVERAGE_BYTES * 8);
+  uint8_t buffer[512];
+
+  for (uint32_t block = 0; block < blocks; block++) {
+    const uint32_t firstGlyph = block * 256;
+    uint32_t remaining = (std::min(info.glyphCount, firstGlyph + 256) - firstGlyph) * glyphBytes;
+    bool covered = !file.seek(firstGlyph * glyphBytes);
+    while (!covered && remaining > 0) {
+      const size_t chunk = std::min<uint32_t>(remaining, sizeof(buffer));
+      if (file.read(buffer, chunk) != static_cast<int>(chunk)) {
+        covered = true;
+        break;
+      }
+      covered = std::any_of(buffer, buffer + chunk, [](const uint8_t byte) { return byte != 0; });
+      remaining -= chunk;
+    }
+    if (covered) {
+      info.coverage[block / 8] |= 1 << (block % 8);
+    }
+  }
+}
+}  // namespace
+
 void FontManager::scanFonts() {
   _fontCount = 0;
 
@@ -33,66 +112,142 @@ void FontManager::scanFonts() {
     return;
   }
 
+  // A directory without a usable modification time is rescanned every time
+  const uint32_t dirMtime = getModifyStamp(dir);
+  uint32_t registryMtime = 0;
+  std::vector<RegistryEntry> entries;
+  if (readRegistry(registryMtime, entries) && dirMtime != 0 && registryMtime == dirMtime) {
+    dir.close();
+    useRegistryEntries(entries);
+    Serial.printf("[FONT_MGR] %d fonts from registry\n", _fontCount);
+    return;
+  }
+
+  rebuildRegistry(dir, dirMtime, entries);
+  dir.close();
+}
+
+bool FontManager::readRegistry(uint32_t& dirMtime, std::vector<RegistryEntry>& entries) const {
+  if (!Storage.exists(REGISTRY_FILE)) {
+    return false;
+  }
+  FsFile registryFile;
+  if (!Storage.openFileForRead("FONT_MGR", REGISTRY_FILE, registryFile)) {
+    return false;
+  }
+  const uint64_t fileSize = registryFile.fileSize();
+  BufferedFile file(registryFile);
+
+  uint8_t version = 0;
+  uint8_t count = 0;
+  serialization::readPod(file, version);
+  serialization::readPod(file, dirMtime);
+  serialization::readPod(file, count);
+  const uint64_t expectedSize = sizeof(version) + sizeof(dirMtime) + sizeof(count) + count * sizeof(RegistryEntry);
+  if (version != REGISTRY_VERSION || count > MAX_REGISTRY_ENTRIES || fileSize != expectedSize) {
+    Serial.printf("[FONT_MGR] Ignoring font registry (version %d, %d entries)\n", version, count);
+    file.close();
+    return false;
+  }
+
+  entries.resize(count);
+  for (auto& entry : entries) {
+    serialization::readPod(file, entry);
+  }
+  file.close();
+  return true;
+}
+
+void FontManager::rebuildRegistry(FsFile& dir, const uint32_t dirMtime, const std::vector<RegistryEntry>& previous) {
+  const unsigned long startTime = millis();
+  std::vector<RegistryEntry> entries;
+  int checked = 0;
+
   FsFile entry;
-  while (_fontCount < MAX_FONTS && entry.openNext(&dir, O_RDONLY)) {
+  while (entries.size() < MAX_REGISTRY_ENTRIES && entry.openNext(&dir, O_RDONLY)) {
     if (entry.isDir()) {
       entry.close();
       continue;
     }
 
-    char filename[64];
-    entry.getName(filename, sizeof(filename));
-    entry.close();
+    RegistryEntry record = {};
+    FontInfo& info = record.info;
+    entry.getName(info.filename, sizeof(info.filename));
 
     // Check .bin extension
-    if (!strstr(filename, ".bin")) {
+    if (!strstr(info.filename, ".bin")) {
+      entry.close();
       continue;
     }
 
-    // Try to parse filename
-    FontInfo& info = _fonts[_fontCount];
-    strncpy(info.filename, filename, sizeof(info.filename) - 1);
-    info.filename[sizeof(info.filename) - 1] = '\0';
-
-    // Parse filename to get font info
-    char nameCopy[64];
-    strncpy(nameCopy, filename, sizeof(nameCopy) - 1);
-    nameCopy[sizeof(nameCopy) - 1] = '\0';
-
-    // Remove .bin
-    char* ext = strstr(nameCopy, ".bin");
-    if (ext) *ext = '\0';
-
-    // Parse _WxH
-    char* lastUnderscore = strrchr(nameCopy, '_');
-    if (!lastUnderscore) continue;
-
-    int w, h;
-    if (sscanf(lastUnderscore + 1, "%dx%d", &w, &h) != 2) continue;
-    info.width = (uint8_t)w;
-    info.height = (uint8_t)h;
-    *lastUnderscore = '\0';
-
-    // Parse _size
-    lastUnderscore = strrchr(nameCopy, '_');
-    if (!lastUnderscore) continue;
+    info.fileSize = static_cast<uint32_t>(entry.fileSize());
+    info.mtime = getModifyStamp(entry);
+    const auto known = std::find_if(previous.begin(), previous.end(), [&info](const RegistryEntry& old) {
+      return old.info.mtime != 0 && old.info.mtime == info.mtime && old.info.fileSize == info.fileSize &&
+             strcmp(old.info.filename, info.filename) == 0;
+    });
+
+    if (known != previous.end()) {
+      record = *known;
+    } else {
+      checked++;
+      const int glyphBytes = parseFontFilename(info.filename, info) ? bytesPerChar(info) : 0;
+      if (glyphBytes > 0 && glyphBytes <= ExternalFont::MAX_GLYPH_BYTES) {
+        info.glyphCount = info.fileSize / glyphBytes;
+      }
+      record.valid = info.glyphCount > 0;
+      if (record.valid) {
+        scanCoverage(entry, info);
+        Serial.printf("[FONT_MGR] Found font: %s (%dpt, %dx%d)\n", info.name, info.size, info.width, info.height);
+      } else {
+        Serial.printf("[FONT_MGR] Not a usable font: %s\n", info.filename);
+      }
+    }
+    entry.close();
+    entries.push_back(record);
+  }
 
-    int size;
-    if (sscanf(lastUnderscore + 1, "%d", &size) != 1) continue;
-    info.size = (uint8_t)size;
-    *lastUnderscore = '\0';
+  useRegistryEntries(entries);
 
-    // Font name
-    strncpy(info.name, nameCopy, sizeof(info.name) - 1);
-    info.name[sizeof(info.name) - 1] = '\0';
+  Storage.mkdir("/.crosspoint");
+  FsFile registryFile;
+  if (Storage.openFileForWrite("FONT_MGR", REGISTRY_FILE, registryFile)) {
+    BufferedFile file(registryFile);
+    serialization::writePod(file, REGISTRY_VERSION);
+    serialization::writePod(file, dirMtime);
+    serialization::writePod(file, static_cast<uint8_t>(entries.size()));
+    for (const auto& record : entries) {
+      serialization::writePod(file, record);
+    }
+    file.close();
+  } else {
+    Serial.printf("[FONT_MGR] Failed to save font registry\n");
+  }
 
-    Serial.printf("[FONT_MGR] Found font: %s (%dpt, %dx%d)\n", info.name, info.size, info.width, info.height);
+  Serial.printf("[FONT_MGR] Scan complete: %d fonts found, %d files checked in %lums\n", _fontCount, checked,
+                millis() - startTime);
+}
 
-    _fontCount++;
+void FontManager::useRegistryEntries(const std::vector<RegistryEntry>& entries) {
+  _fontCount = 0;
+  for (const auto& entry : entries) {
+    if (entry.valid && _fontCount < MAX_FONTS) {
+      _fonts[_fontCount++] = entry.info;
+    }
   }
+}
 
-  dir.close();
-  Serial.printf("[FONT_MGR] Scan complete: %d fonts found\n", _fontCount);
+void FontManager::invalidateRegistry() {
+  // Keep the entries, unchanged fonts are still not read again
+  FsFile file = Storage.open(REGISTRY_FILE, O_RDWR);
+  if (!file) {
+    return;
+  }
+  const uint32_t noMtime = 0;
+  if (file.seek(sizeof(REGISTRY_VERSION))) {
+    serialization::writePod(file, noMtime);
+  }
+  file.close();
 }
 
 const FontInfo* FontManager::getFontInfo(int index) const {
@@ -113,6 +268,9 @@ bool FontManager::loadSelectedFont() {
   snprintf(filepath, sizeof(filepath), "%s/%s", FONTS_DIR, _fonts[_selectedIndex].filename);
 
   const bool loaded = _activeFont.load(filepath);
+  if (loaded) {
+    _activeFont.setCoverage(_fonts[_selectedIndex].coverage, _fonts[_selectedIndex].glyphCount);
+  }
   if (isUiSharingReaderFont()) {
     _activeUiFont.unload();
   }
@@ -138,7 +296,11 @@ bool FontManager::loadSelectedUiFont() {
   char filepath[80];
   snprintf(filepath, sizeof(filepath), "%s/%s", FONTS_DIR, _fonts[_selectedUiIndex].filename);
 
-  return _activeUiFont.load(filepath);
+  if (!_activeUiFont.load(filepath)) {
+    return false;
+  }
+  _activeUiFont.setCoverage(_fonts[_selectedUiIndex].coverage, _fonts[_selectedUiIndex].glyphCount);
+  return true;
 }
 
 void FontManager::selectFont(int index) {
@@ -196,11 +358,12 @@ ExternalFont* FontManager::getActiveUiFont() {
 void FontManager::saveSettings() {
   Storage.mkdir("/.crosspoint");
 
-  FsFile file;
-  if (!Storage.openFileForWrite("FONT_MGR", SETTINGS_FILE, file)) {
+  FsFile settingsFile;
+  if (!Storage.openFileForWrite("FONT_MGR", SETTINGS_FILE, settingsFile)) {
     Serial.printf("[FONT_MGR] Failed to save settings\n");
     return;
   }
+  BufferedFile file(settingsFile);
 
   serialization::writePod(file, SETTINGS_VERSION);
   serialization::writePod(file, _selectedIndex);
@@ -225,11 +388,12 @@ void FontManager::saveSettings() {
 }
 
 void FontManager::loadSettings() {
-  FsFile file;
-  if (!Storage.openFileForRead("FONT_MGR", SETTINGS_FILE, file)) {
+  FsFile settingsFile;
+  if (!Storage.openFileForRead("FONT_MGR", SETTINGS_FILE, settingsFile)) {
     Serial.printf("[FONT_MGR] No settings file, using defaults\n");
     return;
   }
+  BufferedFile file(settingsFile);
 
   uint8_t version;
   serialization::readPod(file, version);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "ExternalFont.h"
 
@@ -8,11 +9,16 @@
  * Font information structure
  */
 struct FontInfo {
-  char filename[64];  // Full filename
-  char name[32];      // Font name
-  uint8_t size;       // Font size (pt)
-  uint8_t width;      // Character width
-  uint8_t height;     // Character height
+  char filename[64];    // Full filename
+  char name[32];        // Font name
+  uint8_t size;         // Font size (pt)
+  uint8_t width;        // Character width
+  uint8_t height;       // Character height
+  uint32_t fileSize;    // File size when the registry entry was made
+  uint32_t mtime;       // File modification time then (FAT date << 16 | FAT time)
+  uint32_t glyphCount;  // Glyphs in the file
+  // Blocks with glyphs, see ExternalFont::setCoverage()
+  uint8_t coverage[ExternalFont::COVERAGE_BYTES];
 };
 
 /**
@@ -30,10 +36,17 @@ class FontManager {
   FontManager& operator=(const FontManager&) = delete;
 
   /**
-   * Scan /fonts/ directory to get available font list
+   * Get available font list from the font registry (/.crosspoint/fonts.bin).
+   * /fonts/ is only scanned when its modification time differs from the one the registry was built for, or after
+   * invalidateRegistry(). Fonts unchanged since the last scan keep their recorded coverage.
    */
   void scanFonts();
 
+  /**
+   * Make the next scanFonts() rescan /fonts/, for changes made on the device
+   */
+  void invalidateRegistry();
+
   /**
    * Get font count
    */
@@ -114,11 +127,7 @@ class FontManager {
   FontManager() {
     // Initialize font array
     for (int i = 0; i < MAX_FONTS; i++) {
-      _fonts[i].filename[0] = '\0';
-      _fonts[i].name[0] = '\0';
-      _fonts[i].size = 0;
-      _fonts[i].width = 0;
-      _fonts[i].height = 0;
+      _fonts[i] = {};
     }
   }
 
@@ -126,6 +135,8 @@ class FontManager {
   static constexpr const char* FONTS_DIR = "/fonts";
   static constexpr const char* SETTINGS_FILE = "/.crosspoint/font_settings.bin";
   static constexpr uint8_t SETTINGS_VERSION = 2;  // Bumped for UI font support
+  static constexpr const char* REGISTRY_FILE = "/.crosspoint/fonts.bin";
+  static constexpr uint8_t REGISTRY_VERSION = 1;
 
   FontInfo _fonts[MAX_FONTS];
   int _fontCount = 0;
@@ -137,6 +148,29 @@ class FontManager {
 
   bool isUiSharingReaderFont() const { return _selectedUiIndex >= 0 && _selectedUiIndex == _selectedIndex; }
 
+  // Registry record of one .bin file in /fonts/, kept for invalid ones too so they aren't checked again
+  struct RegistryEntry {
+    FontInfo info;
+    uint8_t valid;
+  };
+  static_assert(sizeof(RegistryEntry) == 148, "Font registry entries are stored as they are, see docs/file-formats.md");
+  static constexpr int MAX_REGISTRY_ENTRIES = 32;
+
+  /**
+   * Read the registry and the /fonts/ modification time it was built for
+   */
+  bool readRegistry(uint32_t& dirMtime, std::vector<RegistryEntry>& entries) const;
+
+  /**
+   * Enumerate /fonts/ and write the registry, reusing previous entries of files that haven't changed
+   */
+  void rebuildRegistry(FsFile& dir, uint32_t dirMtime, const std::vector<RegistryEntry>& previous);
+
+  /**
+   * Fill _fonts with the valid entries
+   */
+  void useRegistryEntries(const std::vector<RegistryEntry>& entries);
+
   /**
    * Load selected reader font file
    */
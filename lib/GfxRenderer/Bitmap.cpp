@@ -251,6 +251,22 @@ BmpReaderError Bitmap::readNextRow(uint8_t* data, uint8_t* rowBuffer) const {
   return BmpReaderError::Ok;
 }
 
+BmpReaderError Bitmap::skipRows(const int count) const {
+  if (count <= 0) {
+    return BmpReaderError::Ok;
+  }
+  if (!file.seekCur(static_cast<int64_t>(count) * rowBytes)) {
+    return BmpReaderError::SeekPixelDataFailed;
+  }
+  prevRowY += count;
+
+  // The error diffused from the last row read belongs to a row that was skipped
+  if (fsDitherer) fsDitherer->reset();
+  if (atkinsonDitherer) atkinsonDitherer->reset();
+
+  return BmpReaderError::Ok;
+}
+
 BmpReaderError Bitmap::rewindToData() const {
   if (!file.seek(bfOffBits)) {
     return BmpReaderError::SeekPixelDataFailed;
@@ -6,6 +6,7 @@
 #include <Utf8.h>
 
 #include <algorithm>
+#include <cstring>
 
 // Built-in CJK UI font (embedded in flash) - 20px only
 #include "cjk_ui_font_20.h"
@@ -192,171 +193,156 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
   }
 }
 
-int GfxRenderer::getTextWidth(const int fontId, const char* text, const EpdFontFamily::Style style) const {
+GfxRenderer::TextMeasure GfxRenderer::textMeasure(const int fontId, const char* text) const {
+  TextMeasure measure;
+  FontManager& fm = FontManager::getInstance();
   const int effectiveFontId = getEffectiveFontId(fontId);
   if (fontMap.count(effectiveFontId) == 0) {
     // UI fonts may not be in fontMap (they use built-in CJK font)
     if (isUiFont(fontId)) {
-      if (text == nullptr || *text == '\0') {
-        return 0;
-      }
-
-      // Check if external UI font is enabled first
-      FontManager& fm = FontManager::getInstance();
-      ExternalFont* uiExtFont = nullptr;
-      bool hasExternalUiFont = false;
-
+      measure.mode = TextMeasure::BUILTIN_UI;
       if (fm.isUiFontEnabled()) {
-        uiExtFont = fm.getActiveUiFont();
+        ExternalFont* uiExtFont = fm.getActiveUiFont();
         if (uiExtFont && uiExtFont->isLoaded()) {
-          hasExternalUiFont = true;
-        }
-      }
-
-      int width = 0;
-      const char* ptr = text;
-      uint32_t cp;
-      while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&ptr)))) {
-        bool hasChar = false;
-
-        // First check built-in CJK UI font (Flash access is fast)
-        if (CjkUiFont20::hasCjkUiGlyph(cp)) {
-          width += CjkUiFont20::getCjkUiGlyphWidth(cp);
-          hasChar = true;
-        }
-
-        // Fall back to external UI font if enabled (SD card, slow)
-        if (!hasChar && hasExternalUiFont) {
-          if (uiExtFont->getGlyph(cp) != nullptr) {
-            width += uiExtFont->getCharWidth();
-            hasChar = true;
-          }
-        }
-
-        // Default width for unknown characters
-        if (!hasChar) {
-          width += 10;
+          measure.extFont = uiExtFont;
         }
       }
-      return width;
     }
-    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), effectiveFontId);
-    return 0;
+    return measure;
   }
 
-  FontManager& fm = FontManager::getInstance();
-
   // Check if using external font for reader fonts
   if (isReaderFont(fontId)) {
     if (fm.isExternalFontEnabled()) {
       ExternalFont* extFont = fm.getActiveFont();
       if (extFont) {
-        int width = 0;
-        const char* ptr = text;
-        const EpdFontFamily& fontFamily = fontMap.at(effectiveFontId);
-        const int cjkAdvance = clampExternalAdvance(extFont->getCharWidth(), cjkSpacing);
-        uint32_t cp;
-        while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&ptr)))) {
-          // Fast path: CJK characters always use charWidth — skip SD card read entirely
-          if (isCjkCodepoint(cp)) {
-            width += cjkAdvance;
-            continue;
-          }
-          const uint8_t* bitmap = extFont->getGlyph(cp);
-          if (bitmap) {
-            uint8_t advanceX = extFont->getCharWidth();
-            extFont->getGlyphMetrics(cp, nullptr, &advanceX);
-            int spacing = 0;
-            if (isAsciiDigit(cp)) {
-              spacing = asciiDigitSpacing;
-            } else if (isAsciiLetter(cp)) {
-              spacing = asciiLetterSpacing;
-            }
-            width += clampExternalAdvance(advanceX, spacing);
-          } else {
-            // Fall back to built-in reader font width
-            const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
-            if (glyph) {
-              width += glyph->advanceX;
-            } else {
-              width += 10;
-            }
-          }
-        }
-        return width;
+        measure.mode = TextMeasure::EXTERNAL_READER;
+        measure.fontFamily = &fontMap.at(effectiveFontId);
+        measure.extFont = extFont;
+        measure.cjkAdvance = clampExternalAdvance(extFont->getCharWidth(), cjkSpacing);
+        return measure;
       }
     }
   } else {
-    // UI font - calculate width with built-in UI font (includes CJK and
-    // English) Check if text contains any characters in our UI font or
-    // CJK characters that may use external font fallback
+    // UI font - measured glyph by glyph with the built-in UI font (includes CJK and English) if the text contains
+    // any characters in our UI font or CJK characters that may use external font fallback
     const char* checkPtr = text;
-    bool hasUiFontChar = false;
-    bool hasCjkChar = false;
     uint32_t testCp;
     while ((testCp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&checkPtr)))) {
-      if (CjkUiFont20::hasCjkUiGlyph(testCp)) {
-        hasUiFontChar = true;
+      if (CjkUiFont20::hasCjkUiGlyph(testCp) || isCjkCodepoint(testCp)) {
+        measure.mode = TextMeasure::UI_GLYPHS;
+        break;
       }
-      if (isCjkCodepoint(testCp)) {
-        hasCjkChar = true;
+    }
+    if (measure.mode == TextMeasure::UI_GLYPHS) {
+      measure.fontFamily = &fontMap.at(fontId);
+      // CJK characters not in the UI font: try UI external font, then reader
+      if (fm.isUiFontEnabled()) {
+        measure.extFont = fm.getActiveUiFont();
+      } else if (fm.isExternalFontEnabled()) {
+        measure.extFont = fm.getActiveFont();
       }
+      return measure;
     }
+  }
 
-    // Process if text contains UI font chars or CJK chars (for external font
-    // fallback)
-    if (hasUiFontChar || hasCjkChar) {
-      int width = 0;
-      const char* ptr = text;
-      const EpdFontFamily& fontFamily = fontMap.at(fontId);
-      FontManager& fm = FontManager::getInstance();
-      uint32_t cp;
-      while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&ptr)))) {
-        // Check if character is in our UI font (includes CJK and English)
-        uint8_t actualWidth = CjkUiFont20::getCjkUiGlyphWidth(cp);
-
-        if (actualWidth > 0) {
-          // Character is in UI font: use actual proportional width
-          width += actualWidth;
-        } else if (isCjkCodepoint(cp)) {
-          // CJK character not in UI font: try UI external font, then reader
-          ExternalFont* uiExtFont = nullptr;
-          if (fm.isUiFontEnabled()) {
-            uiExtFont = fm.getActiveUiFont();
-          } else if (fm.isExternalFontEnabled()) {
-            uiExtFont = fm.getActiveFont();
-          }
+  measure.mode = TextMeasure::FONT_BOUNDS;
+  measure.fontFamily = &fontMap.at(fontId);
+  return measure;
+}
 
-          if (uiExtFont) {
-            uint8_t minX, advanceX;
-            if (uiExtFont->getGlyphMetrics(cp, &minX, &advanceX)) {
-              width += advanceX;
-            } else {
-              // External font doesn't have this glyph either, use its charWidth
-              width += uiExtFont->getCharWidth();
-            }
-          } else {
-            // No external font, use built-in font width
-            const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
-            if (glyph) {
-              width += glyph->advanceX;
-            }
-          }
-        } else {
-          // Character not in UI font: use built-in font width
-          const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
-          if (glyph) {
-            width += glyph->advanceX;
-          }
+int GfxRenderer::codepointAdvance(const TextMeasure& measure, const uint32_t cp,
+                                  const EpdFontFamily::Style style) const {
+  switch (measure.mode) {
+    case TextMeasure::BUILTIN_UI:
+      // First check built-in CJK UI font (Flash access is fast)
+      if (CjkUiFont20::hasCjkUiGlyph(cp)) {
+        return CjkUiFont20::getCjkUiGlyphWidth(cp);
+      }
+      // Fall back to external UI font if enabled (SD card, slow)
+      if (measure.extFont && measure.extFont->getGlyph(cp) != nullptr) {
+        return measure.extFont->getCharWidth();
+      }
+      // Default width for unknown characters
+      return 10;
+
+    case TextMeasure::EXTERNAL_READER: {
+      // Fast path: CJK characters always use charWidth — skip SD card read entirely
+      if (isCjkCodepoint(cp)) {
+        return measure.cjkAdvance;
+      }
+      if (measure.extFont->getGlyph(cp)) {
+        uint8_t advanceX = measure.extFont->getCharWidth();
+        measure.extFont->getGlyphMetrics(cp, nullptr, &advanceX);
+        int spacing = 0;
+        if (isAsciiDigit(cp)) {
+          spacing = asciiDigitSpacing;
+        } else if (isAsciiLetter(cp)) {
+          spacing = asciiLetterSpacing;
+        }
+        return clampExternalAdvance(advanceX, spacing);
+      }
+      // Fall back to built-in reader font width
+      const EpdGlyph* glyph = measure.fontFamily->getGlyph(cp, style);
+      return glyph ? glyph->advanceX : 10;
+    }
+
+    case TextMeasure::UI_GLYPHS: {
+      // Character is in UI font: use actual proportional width
+      const uint8_t uiWidth = CjkUiFont20::getCjkUiGlyphWidth(cp);
+      if (uiWidth > 0) {
+        return uiWidth;
+      }
+      if (isCjkCodepoint(cp) && measure.extFont) {
+        uint8_t minX, advanceX;
+        if (measure.extFont->getGlyphMetrics(cp, &minX, &advanceX)) {
+          return advanceX;
         }
+        // External font doesn't have this glyph either, use its charWidth
+        return measure.extFont->getCharWidth();
       }
-      return width;
+      // Character not in UI font: use built-in font width
+      const EpdGlyph* glyph = measure.fontFamily->getGlyph(cp, style);
+      return glyph ? glyph->advanceX : 0;
     }
+
+    case TextMeasure::FONT_BOUNDS: {
+      // Missing glyphs are measured as the replacement glyph, like EpdFont::getTextBounds()
+      const EpdGlyph* glyph = measure.fontFamily->getGlyph(cp, style);
+      if (!glyph) {
+        glyph = measure.fontFamily->getGlyph(REPLACEMENT_GLYPH, style);
+      }
+      return glyph ? glyph->advanceX : 0;
+    }
+
+    case TextMeasure::MISSING_FONT:
+    default:
+      return 0;
+  }
+}
+
+int GfxRenderer::getTextWidth(const int fontId, const char* text, const EpdFontFamily::Style style) const {
+  const TextMeasure measure = textMeasure(fontId, text);
+  if (measure.mode == TextMeasure::MISSING_FONT) {
+    Serial.printf("[%lu] [GFX] Font %d not found\n", millis(), getEffectiveFontId(fontId));
+    return 0;
+  }
+  if (measure.mode == TextMeasure::FONT_BOUNDS) {
+    int w = 0, h = 0;
+    measure.fontFamily->getTextDimensions(text, &w, &h, style);
+    return w;
+  }
+  if (text == nullptr) {
+    return 0;
   }
 
-  int w = 0, h = 0;
-  fontMap.at(fontId).getTextDimensions(text, &w, &h, style);
-  return w;
+  int width = 0;
+  const char* ptr = text;
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&ptr)))) {
+    width += codepointAdvance(measure, cp, style);
+  }
+  return width;
 }
 
 void GfxRenderer::drawCenteredText(const int fontId, const int y, const char* text, const bool black,
@@ -488,21 +474,87 @@ void GfxRenderer::drawText(const int fontId, const int x, const int y, const cha
   }
 }
 
+GfxRenderer::SpanOp GfxRenderer::spanOp(const bool state) const {
+  // Same dark mode handling as drawPixel()
+  const bool shouldInvert = darkMode && !skipDarkModeForImages && renderMode == BW;
+  return (shouldInvert ? !state : state) ? SpanOp::Black : SpanOp::White;
+}
+
+void GfxRenderer::fillPanelRect(int left, int top, int right, int bottom, const SpanOp op) const {
+  left = std::max(left, 0);
+  top = std::max(top, 0);
+  right = std::min(right, HalDisplay::DISPLAY_WIDTH - 1);
+  bottom = std::min(bottom, HalDisplay::DISPLAY_HEIGHT - 1);
+  if (left > right || top > bottom) {
+    return;
+  }
+
+  // MSB first, a cleared bit is a black pixel
+  const auto apply = [op](uint8_t& byte, const uint8_t mask) {
+    switch (op) {
+      case SpanOp::Black:
+        byte &= ~mask;
+        break;
+      case SpanOp::White:
+        byte |= mask;
+        break;
+      case SpanOp::Invert:
+        byte ^= mask;
+        break;
+    }
+  };
+  const int firstByte = left / 8;
+  const int lastByte = right / 8;
+  const uint8_t firstMask = 0xFF >> (left % 8);
+  const uint8_t lastMask = 0xFF << (7 - right % 8);
+  uint8_t* row = frameBuffer + top * HalDisplay::DISPLAY_WIDTH_BYTES;
+
+  if (firstByte == lastByte) {
+    // Run down a single byte column, what a horizontal line becomes in portrait
+    const uint8_t mask = firstMask & lastMask;
+    for (int y = top; y <= bottom; y++, row += HalDisplay::DISPLAY_WIDTH_BYTES) {
+      apply(row[firstByte], mask);
+    }
+    return;
+  }
+
+  const int innerBytes = lastByte - firstByte - 1;
+  for (int y = top; y <= bottom; y++, row += HalDisplay::DISPLAY_WIDTH_BYTES) {
+    apply(row[firstByte], firstMask);
+    if (op == SpanOp::Invert) {
+      for (int i = firstByte + 1; i < lastByte; i++) {
+        row[i] = ~row[i];
+      }
+    } else if (innerBytes > 0) {
+      memset(row + firstByte + 1, op == SpanOp::Black ? 0x00 : 0xFF, innerBytes);
+    }
+    apply(row[lastByte], lastMask);
+  }
+}
+
+void GfxRenderer::fillLogicalRect(const int x, const int y, const int width, const int height,
+                                  const SpanOp op) const {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  // Every orientation maps a rectangle to a rectangle, only its corners need rotating
+  int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+  rotateCoordinates(orientation, x, y, &x1, &y1);
+  rotateCoordinates(orientation, x + width - 1, y + height - 1, &x2, &y2);
+  fillPanelRect(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), op);
+}
+
 void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) const {
   if (x1 == x2) {
     if (y2 < y1) {
       std::swap(y1, y2);
     }
-    for (int y = y1; y <= y2; y++) {
-      drawPixel(x1, y, state);
-    }
+    fillLogicalRect(x1, y1, 1, y2 - y1 + 1, spanOp(state));
   } else if (y1 == y2) {
     if (x2 < x1) {
       std::swap(x1, x2);
     }
-    for (int x = x1; x <= x2; x++) {
-      drawPixel(x, y1, state);
-    }
+    fillLogicalRect(x1, y1, x2 - x1 + 1, 1, spanOp(state));
   } else {
     // TODO: Implement
     Serial.printf("[%lu] [GFX] Line drawing not supported\n", millis());
@@ -611,9 +663,11 @@ void GfxRenderer::drawRoundedRect(const int x, const int y, const int width, con
 }
 
 void GfxRenderer::fillRect(const int x, const int y, const int width, const int height, const bool state) const {
-  for (int fillY = y; fillY < y + height; fillY++) {
-    drawLine(x, fillY, x + width - 1, fillY, state);
-  }
+  fillLogicalRect(x, y, width, height, spanOp(state));
+}
+
+void GfxRenderer::invertRect(const int x, const int y, const int width, const int height) const {
+  fillLogicalRect(x, y, width, height, SpanOp::Invert);
 }
 
 // NOTE: Those are in critical path, and need to be templated to avoid runtime checks for every pixel.
@@ -788,187 +842,187 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
     return;
   }
 
-  // Cover art and images should keep their original colors in dark mode
-  skipDarkModeForImages = true;
-  auto cleanup = [this]() { skipDarkModeForImages = false; };
+  // cropX / cropY are the fractions cut off, half on each side
+  const int cropPixX = std::max(0, static_cast<int>(std::floor(bitmap.getWidth() * cropX / 2.0f)));
+  const int cropPixY = std::max(0, static_cast<int>(std::floor(bitmap.getHeight() * cropY / 2.0f)));
+  drawScaledBitmap(bitmap, x, y, maxWidth, maxHeight, cropPixX, cropPixY, false);
+}
+
+void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y, const int maxWidth,
+                                 const int maxHeight) const {
+  drawScaledBitmap(bitmap, x, y, maxWidth, maxHeight, 0, 0, true);
+}
 
-  float scale = 1.0f;
-  bool isScaled = false;
-  int cropPixX = std::floor(bitmap.getWidth() * cropX / 2.0f);
-  int cropPixY = std::floor(bitmap.getHeight() * cropY / 2.0f);
-  Serial.printf("[%lu] [GFX] Cropping %dx%d by %dx%d pix, is %s\n", millis(), bitmap.getWidth(), bitmap.getHeight(),
-                cropPixX, cropPixY, bitmap.isTopDown() ? "top-down" : "bottom-up");
+uint8_t* GfxRenderer::bitmapScratchBuffer(const size_t size) const {
+  if (size > bitmapScratchSize) {
+    free(bitmapScratch);
+    bitmapScratch = static_cast<uint8_t*>(malloc(size));
+    bitmapScratchSize = bitmapScratch ? size : 0;
+  }
+  return bitmapScratch;
+}
+
+void GfxRenderer::drawScaledBitmap(const Bitmap& bitmap, const int x, const int y, const int maxWidth,
+                                   const int maxHeight, const int cropPixX, const int cropPixY,
+                                   const bool oneBit) const {
+  // Source rows averaged into one output row at most, the others are seeked past. Keeps a heavily downscaled cover
+  // as fast to draw as one that fits.
+  constexpr int MAX_ROWS_PER_OUTPUT_ROW = 2;
+
+  const int srcWidth = bitmap.getWidth() - 2 * cropPixX;
+  const int srcHeight = bitmap.getHeight() - 2 * cropPixY;
+  if (srcWidth <= 0 || srcHeight <= 0) {
+    return;
+  }
 
-  if (maxWidth > 0 && (1.0f - cropX) * bitmap.getWidth() > maxWidth) {
-    scale = static_cast<float>(maxWidth) / static_cast<float>((1.0f - cropX) * bitmap.getWidth());
-    isScaled = true;
+  // Fit into maxWidth x maxHeight keeping the aspect ratio, never enlarging
+  int outWidth = srcWidth;
+  int outHeight = srcHeight;
+  if (maxWidth > 0 && outWidth > maxWidth) {
+    outHeight = std::max(1, static_cast<int>(static_cast<int64_t>(srcHeight) * maxWidth / srcWidth));
+    outWidth = maxWidth;
   }
-  if (maxHeight > 0 && (1.0f - cropY) * bitmap.getHeight() > maxHeight) {
-    scale = std::min(scale, static_cast<float>(maxHeight) / static_cast<float>((1.0f - cropY) * bitmap.getHeight()));
-    isScaled = true;
+  if (maxHeight > 0 && outHeight > maxHeight) {
+    outWidth = std::max(1, static_cast<int>(static_cast<int64_t>(srcWidth) * maxHeight / srcHeight));
+    outHeight = maxHeight;
   }
-  Serial.printf("[%lu] [GFX] Scaling by %f - %s\n", millis(), scale, isScaled ? "scaled" : "not scaled");
+
+  // Cover art and images should keep their original colors in dark mode
+  skipDarkModeForImages = true;
 
   if (darkMode && renderMode == BW) {
-    const int sourceWidth = static_cast<int>((1.0f - cropX) * bitmap.getWidth() - cropPixX);
-    const int sourceHeight = static_cast<int>((1.0f - cropY) * bitmap.getHeight() - cropPixY);
-    const int scaledWidth = isScaled ? static_cast<int>(std::floor(sourceWidth * scale)) : sourceWidth;
-    const int scaledHeight = isScaled ? static_cast<int>(std::floor(sourceHeight * scale)) : sourceHeight;
-    fillRect(x, y, scaledWidth, scaledHeight, false);
+    fillRect(x, y, outWidth, outHeight, false);
+  }
+
+  // Which of the 2-bit levels (0 = black ... 3 = white) readNextRow() produces draw what in this render mode
+  uint8_t blackLevels = 0;
+  uint8_t whiteLevels = 0;
+  if (oneBit) {
+    // Every level below white draws black, as drawBitmap1Bit() did
+    blackLevels = 0b0111;
+  } else if (renderMode == BW) {
+    blackLevels = 0b0111;
+  } else if (renderMode == GRAYSCALE_MSB) {
+    whiteLevels = 0b0110;
+  } else {
+    whiteLevels = 0b0010;
   }
 
-  // Calculate output row size (2 bits per pixel, packed into bytes)
-  // IMPORTANT: Use int, not uint8_t, to avoid overflow for images > 1020 pixels
-  // wide
-  const int outputRowSize = (bitmap.getWidth() + 3) / 4;
-  auto* outputRow = static_cast<uint8_t*>(malloc(outputRowSize));
-  auto* rowBytes = static_cast<uint8_t*>(malloc(bitmap.getRowBytes()));
+  // Output rows to draw, the ones above and below the screen are never read
+  const int firstRow = std::max(0, -y);
+  const int lastRow = std::min(outHeight, getScreenHeight() - y) - 1;
+  if (firstRow > lastRow) {
+    skipDarkModeForImages = false;
+    return;
+  }
 
-  if (!outputRow || !rowBytes) {
+  // Column sums and source columns per output column, then the raw and the 2-bit packed source row, then the
+  // averaged output row
+  const size_t columnsSize = static_cast<size_t>(outWidth) * sizeof(uint16_t);
+  const size_t rowBytesSize = bitmap.getRowBytes();
+  const size_t packedSize = (bitmap.getWidth() + 3) / 4;
+  uint8_t* scratch = bitmapScratchBuffer(2 * columnsSize + rowBytesSize + packedSize + outWidth);
+  if (!scratch) {
     Serial.printf("[%lu] [GFX] !! Failed to allocate BMP row buffers\n", millis());
-    free(outputRow);
-    free(rowBytes);
+    skipDarkModeForImages = false;
     return;
   }
-
-  for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
-    // The BMP's (0, 0) is the bottom-left corner (if the height is positive,
-    // top-left if negative). Screen's (0, 0) is the top-left corner.
-    int screenY = -cropPixY + (bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY);
-    if (isScaled) {
-      screenY = std::floor(screenY * scale);
-    }
-    screenY += y;  // the offset should not be scaled
-    if (screenY >= getScreenHeight()) {
-      break;
-    }
-    if (screenY < 0) {
-      continue;
-    }
-
-    if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
-      Serial.printf("[%lu] [GFX] Failed to read row %d from bitmap\n", millis(), bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
-    }
-
-    if (bmpY < cropPixY) {
-      // Skip the row if it's outside the crop area
-      continue;
-    }
-
-    for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
-      int screenX = bmpX - cropPixX;
-      if (isScaled) {
-        screenX = std::floor(screenX * scale);
-      }
-      screenX += x;  // the offset should not be scaled
-      if (screenX >= getScreenWidth()) {
-        break;
+  auto* sums = reinterpret_cast<uint16_t*>(scratch);
+  auto* columnCounts = reinterpret_cast<uint16_t*>(scratch + columnsSize);
+  uint8_t* rowBytes = scratch + 2 * columnsSize;
+  uint8_t* packedRow = rowBytes + rowBytesSize;
+  uint8_t* levels = packedRow + packedSize;
+
+  // Source column sx lands in output column sx * outWidth / srcWidth, stepped without dividing
+  memset(columnCounts, 0, columnsSize);
+  for (int sx = 0, column = 0, error = 0; sx < srcWidth; sx++) {
+    columnCounts[column]++;
+    error += outWidth;
+    if (error >= srcWidth) {
+      error -= srcWidth;
+      column++;
+    }
+  }
+  memset(sums, 0, columnsSize);
+
+  // Output rows are visited in file order, bottom-up files store the last row first
+  const bool topDown = bitmap.isTopDown();
+  const int rowStep = topDown ? 1 : -1;
+  const int endRow = topDown ? lastRow + 1 : firstRow - 1;
+  int nextFileRow = 0;
+  for (int row = topDown ? firstRow : lastRow; row != endRow; row += rowStep) {
+    // Source rows whose row * outHeight / srcHeight is this output row, evenly sampled when there are many
+    const int spanStart = static_cast<int>((static_cast<int64_t>(row) * srcHeight + outHeight - 1) / outHeight);
+    const int spanEnd = static_cast<int>((static_cast<int64_t>(row + 1) * srcHeight + outHeight - 1) / outHeight);
+    const int samples = std::min(spanEnd - spanStart, MAX_ROWS_PER_OUTPUT_ROW);
+
+    for (int i = 0; i < samples; i++) {
+      const int sample = topDown ? i : samples - 1 - i;
+      const int srcRow = cropPixY + spanStart + (spanEnd - spanStart) * (2 * sample + 1) / (2 * samples);
+      const int fileRow = topDown ? srcRow : bitmap.getHeight() - 1 - srcRow;
+
+      if (bitmap.skipRows(fileRow - nextFileRow) != BmpReaderError::Ok ||
+          bitmap.readNextRow(packedRow, rowBytes) != BmpReaderError::Ok) {
+        Serial.printf("[%lu] [GFX] Failed to read row %d from bitmap\n", millis(), fileRow);
+        skipDarkModeForImages = false;
+        return;
       }
-      if (screenX < 0) {
-        continue;
+      nextFileRow = fileRow + 1;
+
+      for (int sx = 0, column = 0, error = 0; sx < srcWidth; sx++) {
+        const int bmpX = cropPixX + sx;
+        sums[column] += packedRow[bmpX >> 2] >> (6 - (bmpX & 3) * 2) & 0x3;
+        error += outWidth;
+        if (error >= srcWidth) {
+          error -= srcWidth;
+          column++;
+        }
       }
+    }
 
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
-
-      if (renderMode == BW && val < 3) {
-        drawPixel(screenX, screenY);
-      } else if (renderMode == GRAYSCALE_MSB && (val == 1 || val == 2)) {
-        drawPixel(screenX, screenY, false);
-      } else if (renderMode == GRAYSCALE_LSB && val == 1) {
-        drawPixel(screenX, screenY, false);
-      }
+    // Box average, rounded to the nearest level
+    for (int column = 0; column < outWidth; column++) {
+      const int pixels = columnCounts[column] * samples;
+      levels[column] = static_cast<uint8_t>((2 * sums[column] + pixels) / (2 * pixels));
+      sums[column] = 0;
     }
+    writeBitmapRow(x, y + row, levels, outWidth, blackLevels, whiteLevels);
   }
 
-  free(outputRow);
-  free(rowBytes);
-  cleanup();
+  skipDarkModeForImages = false;
 }
 
-void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y, const int maxWidth,
-                                 const int maxHeight) const {
-  // Cover art and images should keep their original colors in dark mode
-  skipDarkModeForImages = true;
-  auto cleanup = [this]() { skipDarkModeForImages = false; };
-
-  float scale = 1.0f;
-  bool isScaled = false;
-  if (maxWidth > 0 && bitmap.getWidth() > maxWidth) {
-    scale = static_cast<float>(maxWidth) / static_cast<float>(bitmap.getWidth());
-    isScaled = true;
-  }
-  if (maxHeight > 0 && bitmap.getHeight() > maxHeight) {
-    scale = std::min(scale, static_cast<float>(maxHeight) / static_cast<float>(bitmap.getHeight()));
-    isScaled = true;
+void GfxRenderer::writeBitmapRow(const int x, const int y, const uint8_t* levels, const int count,
+                                 const uint8_t blackLevels, const uint8_t whiteLevels) const {
+  if (y < 0 || y >= getScreenHeight()) {
+    return;
   }
-
-  if (darkMode && renderMode == BW) {
-    const int sourceWidth = bitmap.getWidth();
-    const int sourceHeight = bitmap.getHeight();
-    const int scaledWidth = isScaled ? static_cast<int>(std::floor(sourceWidth * scale)) : sourceWidth;
-    const int scaledHeight = isScaled ? static_cast<int>(std::floor(sourceHeight * scale)) : sourceHeight;
-    fillRect(x, y, scaledWidth, scaledHeight, false);
-  }
-
-  // For 1-bit BMP, output is still 2-bit packed (for consistency with
-  // readNextRow)
-  const int outputRowSize = (bitmap.getWidth() + 3) / 4;
-  auto* outputRow = static_cast<uint8_t*>(malloc(outputRowSize));
-  auto* rowBytes = static_cast<uint8_t*>(malloc(bitmap.getRowBytes()));
-
-  if (!outputRow || !rowBytes) {
-    Serial.printf("[%lu] [GFX] !! Failed to allocate 1-bit BMP row buffers\n", millis());
-    free(outputRow);
-    free(rowBytes);
+  const int first = std::max(0, -x);
+  const int last = std::min(count, getScreenWidth() - x) - 1;
+  if (first > last) {
     return;
   }
 
-  for (int bmpY = 0; bmpY < bitmap.getHeight(); bmpY++) {
-    // Read rows sequentially using readNextRow
-    if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
-      Serial.printf("[%lu] [GFX] Failed to read row %d from 1-bit bitmap\n", millis(), bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
-    }
+  // A logical row is a panel row or column depending on the orientation, either way a fixed step per pixel
+  int phyX = 0, phyY = 0, nextX = 0, nextY = 0;
+  rotateCoordinates(orientation, x + first, y, &phyX, &phyY);
+  rotateCoordinates(orientation, x + first + 1, y, &nextX, &nextY);
+  const int stepX = nextX - phyX;
+  const int stepY = nextY - phyY;
 
-    // Calculate screen Y based on whether BMP is top-down or bottom-up
-    const int bmpYOffset = bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY;
-    int screenY = y + (isScaled ? static_cast<int>(std::floor(bmpYOffset * scale)) : bmpYOffset);
-    if (screenY >= getScreenHeight()) {
-      continue;  // Continue reading to keep row counter in sync
-    }
-    if (screenY < 0) {
+  for (int i = first; i <= last; i++, phyX += stepX, phyY += stepY) {
+    const uint8_t level = 1 << levels[i];
+    if (!((blackLevels | whiteLevels) & level)) {
       continue;
     }
-
-    for (int bmpX = 0; bmpX < bitmap.getWidth(); bmpX++) {
-      int screenX = x + (isScaled ? static_cast<int>(std::floor(bmpX * scale)) : bmpX);
-      if (screenX >= getScreenWidth()) {
-        break;
-      }
-      if (screenX < 0) {
-        continue;
-      }
-
-      // Get 2-bit value (result of readNextRow quantization)
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
-
-      // For 1-bit source: 0 or 1 -> map to black (0,1,2) or white (3)
-      // val < 3 means black pixel (draw it)
-      if (val < 3) {
-        drawPixel(screenX, screenY, true);
-      }
-      // White pixels (val == 3) are not drawn (leave background)
+    uint8_t& byte = frameBuffer[phyY * HalDisplay::DISPLAY_WIDTH_BYTES + (phyX >> 3)];
+    const uint8_t mask = 0x80 >> (phyX & 7);
+    if (blackLevels & level) {
+      byte &= ~mask;  // Clear bit = black pixel
+    } else {
+      byte |= mask;
     }
   }
-
-  free(outputRow);
-  free(rowBytes);
-  cleanup();
 }
 
 void GfxRenderer::fillPolygon(const int* xPoints, const int* yPoints, int numPoints, bool state) const {
@@ -1060,26 +1114,174 @@ void GfxRenderer::invertScreen() const {
 void GfxRenderer::displayBuffer(const HalDisplay::RefreshMode refreshMode) const {
   auto elapsed = millis() - start_ms;
   Serial.printf("[%lu] [GFX] Time = %lu ms from clearScreen to displayBuffer\n", millis(), elapsed);
+  rememberPanelTiles();
   display.displayBuffer(refreshMode, fadingFix);
 }
 
+// FNV-1a over the frame buffer bytes of one tile
+uint32_t GfxRenderer::panelTileChecksum(const int column, const int row) const {
+  constexpr int tileWidthBytes = PANEL_TILE_WIDTH / 8;
+  uint32_t hash = 2166136261u;
+  const uint8_t* line =
+      frameBuffer + row * PANEL_TILE_HEIGHT * HalDisplay::DISPLAY_WIDTH_BYTES + column * tileWidthBytes;
+  for (int y = 0; y < PANEL_TILE_HEIGHT; y++, line += HalDisplay::DISPLAY_WIDTH_BYTES) {
+    for (int i = 0; i < tileWidthBytes; i++) {
+      hash = (hash ^ line[i]) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+void GfxRenderer::rememberPanelTiles() const {
+  for (int row = 0; row < PANEL_TILE_ROWS; row++) {
+    for (int column = 0; column < PANEL_TILE_COLUMNS; column++) {
+      panelTileChecksums[row * PANEL_TILE_COLUMNS + column] = panelTileChecksum(column, row);
+    }
+  }
+  panelTilesKnown = true;
+}
+
+void GfxRenderer::displayChanges() const {
+  if (!panelTilesKnown) {
+    displayBuffer(HalDisplay::FAST_REFRESH);
+    return;
+  }
+
+  // Activities redraw the whole screen after clearScreen(), so changes are found by comparing with what the panel
+  // shows rather than by tracking draw calls. Changed tiles are merged into their bounding window: every windowed
+  // update runs the whole waveform, one larger window is quicker than several small ones.
+  int minColumn = PANEL_TILE_COLUMNS;
+  int maxColumn = -1;
+  int minRow = PANEL_TILE_ROWS;
+  int maxRow = -1;
+  for (int row = 0; row < PANEL_TILE_ROWS; row++) {
+    for (int column = 0; column < PANEL_TILE_COLUMNS; column++) {
+      const uint32_t checksum = panelTileChecksum(column, row);
+      uint32_t& shown = panelTileChecksums[row * PANEL_TILE_COLUMNS + column];
+      if (checksum == shown) {
+        continue;
+      }
+      shown = checksum;
+      minColumn = std::min(minColumn, column);
+      maxColumn = std::max(maxColumn, column);
+      minRow = std::min(minRow, row);
+      maxRow = std::max(maxRow, row);
+    }
+  }
+
+  if (maxRow < 0) {
+    Serial.printf("[%lu] [GFX] Frame unchanged, skipping refresh\n", millis());
+    return;
+  }
+
+  const int x = minColumn * PANEL_TILE_WIDTH;
+  const int y = minRow * PANEL_TILE_HEIGHT;
+  const int width = (maxColumn - minColumn + 1) * PANEL_TILE_WIDTH;
+  const int height = (maxRow - minRow + 1) * PANEL_TILE_HEIGHT;
+  const int areaPercent = width * height * 100 / (HalDisplay::DISPLAY_WIDTH * HalDisplay::DISPLAY_HEIGHT);
+  if (areaPercent > WINDOW_AREA_LIMIT_PERCENT) {
+    Serial.printf("[%lu] [GFX] %d%% of the screen changed, full update\n", millis(), areaPercent);
+    display.displayBuffer(HalDisplay::FAST_REFRESH, fadingFix);
+    return;
+  }
+
+  Serial.printf("[%lu] [GFX] Window update %dx%d at %d,%d (%d%%)\n", millis(), width, height, x, y, areaPercent);
+  display.displayWindow(x, y, width, height, fadingFix);
+}
+
+void GfxRenderer::displayWindow(const int x, const int y, const int width, const int height) const {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  int x1, y1, x2, y2;
+  rotateCoordinates(orientation, x, y, &x1, &y1);
+  rotateCoordinates(orientation, x + width - 1, y + height - 1, &x2, &y2);
+
+  // Panel window widened to whole bytes and clipped to the panel
+  const int left = std::max(0, std::min(x1, x2)) & ~7;
+  const int right = std::min<int>(HalDisplay::DISPLAY_WIDTH, (std::max(x1, x2) + 8) & ~7);
+  const int top = std::max(0, std::min(y1, y2));
+  const int bottom = std::min<int>(HalDisplay::DISPLAY_HEIGHT, std::max(y1, y2) + 1);
+  if (left >= right || top >= bottom) {
+    return;
+  }
+
+  // Tiles the window cuts through no longer match their checksums
+  panelTilesKnown = false;
+  display.displayWindow(left, top, right - left, bottom - top, fadingFix);
+}
+
+GfxRenderer::TextWidthState GfxRenderer::textWidthState() const {
+  const FontManager& fm = FontManager::getInstance();
+  return {readerFallbackFontId,
+          fm.isExternalFontEnabled() ? fm.getSelectedIndex() : -1,
+          fm.isUiFontEnabled() ? fm.getUiSelectedIndex() : -1,
+          asciiLetterSpacing,
+          asciiDigitSpacing,
+          cjkSpacing};
+}
+
 std::string GfxRenderer::truncatedText(const int fontId, const char* text, const int maxWidth,
                                        const EpdFontFamily::Style style) const {
   if (!text || maxWidth <= 0) return "";
 
-  std::string item = text;
   const char* ellipsis = "...";
-  int textWidth = getTextWidth(fontId, item.c_str(), style);
-  if (textWidth <= maxWidth) {
-    // Text fits, return as is
-    return item;
-  }
-
-  while (!item.empty() && getTextWidth(fontId, (item + ellipsis).c_str(), style) >= maxWidth) {
-    utf8RemoveLastChar(item);
+  const TextWidthState state = textWidthState();
+  for (const auto& entry : truncatedTextCache) {
+    if (entry.maxWidth == maxWidth && entry.fontId == fontId && entry.style == style && entry.state == state &&
+        entry.text == text) {
+      return entry.keptBytes == std::string::npos ? entry.text : entry.text.substr(0, entry.keptBytes) + ellipsis;
+    }
+  }
+
+  size_t keptBytes = std::string::npos;
+  if (getTextWidth(fontId, text, style) > maxWidth) {
+    // Walk the advances once and cut after the last codepoint that leaves room for the ellipsis
+    const TextMeasure measure = textMeasure(fontId, text);
+    const int widthBeforeEllipsis = maxWidth - getTextWidth(fontId, ellipsis, style);
+    int width = 0;
+    const char* ptr = text;
+    uint32_t cp;
+    keptBytes = 0;
+    while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&ptr)))) {
+      width += codepointAdvance(measure, cp, style);
+      if (width >= widthBeforeEllipsis) {
+        break;
+      }
+      keptBytes = ptr - text;
+    }
+
+    // The sum of advances can be a pixel off getTextWidth(): FONT_BOUNDS measures ink, and a prefix may be measured
+    // in another mode than the whole text. Settle the cut with getTextWidth() of the truncated text itself.
+    const size_t length = strlen(text);
+    const auto fits = [&](const size_t bytes) {
+      return getTextWidth(fontId, (std::string(text, bytes) + ellipsis).c_str(), style) < maxWidth;
+    };
+    while (keptBytes > 0 && !fits(keptBytes)) {
+      do {
+        keptBytes--;
+      } while (keptBytes > 0 && (static_cast<uint8_t>(text[keptBytes]) & 0xC0) == 0x80);
+    }
+    while (keptBytes < length) {
+      const char* next = text + keptBytes;
+      utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&next));
+      if (!fits(next - text)) {
+        break;
+      }
+      keptBytes = next - text;
+    }
   }
 
-  return item.empty() ? ellipsis : item + ellipsis;
+  TruncatedTextEntry& entry = truncatedTextCache[truncatedTextCacheNext];
+  truncatedTextCacheNext = (truncatedTextCacheNext + 1) % TRUNCATED_TEXT_CACHE_SIZE;
+  entry.fontId = fontId;
+  entry.maxWidth = maxWidth;
+  entry.style = style;
+  entry.state = state;
+  entry.text = text;
+  entry.keptBytes = keptBytes;
+  return keptBytes == std::string::npos ? entry.text : entry.text.substr(0, keptBytes) + ellipsis;
 }
 
 // Note: Internal driver treats screen in command orientation; this library
@@ -1525,13 +1727,21 @@ size_t GfxRenderer::getBufferSize() { return HalDisplay::BUFFER_SIZE; }
 // unused
 // void GfxRenderer::grayscaleRevert() const { display.grayscaleRevert(); }
 
-void GfxRenderer::copyGrayscaleLsbBuffers() const { display.copyGrayscaleLsbBuffers(frameBuffer); }
+// The panel shows grayscale afterwards, the next displayChanges() updates the whole frame
+void GfxRenderer::copyGrayscaleLsbBuffers() const {
+  panelTilesKnown = false;
+  display.copyGrayscaleLsbBuffers(frameBuffer);
+}
 
-void GfxRenderer::copyGrayscaleMsbBuffers() const { display.copyGrayscaleMsbBuffers(frameBuffer); }
+void GfxRenderer::copyGrayscaleMsbBuffers() const {
+  panelTilesKnown = false;
+  display.copyGrayscaleMsbBuffers(frameBuffer);
+}
 
 void GfxRenderer::displayGrayBuffer(const bool turnOffScreen, const bool darkMode) const {
   // Note: HalDisplay::displayGrayBuffer does not support darkMode parameter directly.
   // Dark mode grayscale rendering is handled at the pixel level in renderChar.
+  panelTilesKnown = false;
   display.displayGrayBuffer(turnOffScreen);
 }
 
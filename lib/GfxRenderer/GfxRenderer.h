@@ -3,7 +3,9 @@
 #include <EpdFontFamily.h>
 #include <HalDisplay.h>
 
+#include <cstdlib>
 #include <map>
+#include <string>
 
 #include "Bitmap.h"
 
@@ -40,6 +42,20 @@ class GfxRenderer {
   bool fadingFix;
   uint8_t* frameBuffer = nullptr;
   uint8_t* bwBufferChunks[BW_BUFFER_NUM_CHUNKS] = {nullptr};
+
+  // displayChanges() finds what changed by comparing a checksum per panel tile with the frame the panel last showed
+  static constexpr int PANEL_TILE_WIDTH = 80;  // Multiple of 8, windows start and end on frame buffer bytes
+  static constexpr int PANEL_TILE_HEIGHT = 16;
+  static constexpr int PANEL_TILE_COLUMNS = HalDisplay::DISPLAY_WIDTH / PANEL_TILE_WIDTH;
+  static constexpr int PANEL_TILE_ROWS = HalDisplay::DISPLAY_HEIGHT / PANEL_TILE_HEIGHT;
+  static_assert(PANEL_TILE_COLUMNS * PANEL_TILE_WIDTH == HalDisplay::DISPLAY_WIDTH &&
+                    PANEL_TILE_ROWS * PANEL_TILE_HEIGHT == HalDisplay::DISPLAY_HEIGHT,
+                "Panel tiles do not line up with the display size");
+  // Changed area, in percent of the panel, above which a full-frame update is used instead of a window
+  static constexpr int WINDOW_AREA_LIMIT_PERCENT = 50;
+  mutable uint32_t panelTileChecksums[PANEL_TILE_ROWS * PANEL_TILE_COLUMNS] = {};
+  mutable bool panelTilesKnown = false;
+
   std::map<int, EpdFontFamily> fontMap;
   // Dark mode: true = black background, false = white background
   bool darkMode = false;
@@ -52,6 +68,46 @@ class GfxRenderer {
   int readerFallbackFontId = 0;
   // Skip dark mode inversion for images (cover art should not be inverted)
   mutable bool skipDarkModeForImages = false;
+  // Row buffers of drawBitmap(), kept between calls as covers are drawn once per render mode
+  mutable uint8_t* bitmapScratch = nullptr;
+  mutable size_t bitmapScratchSize = 0;
+
+  // How getTextWidth() measures a string in a given font, decided once per string
+  struct TextMeasure {
+    enum Mode : uint8_t { MISSING_FONT, BUILTIN_UI, EXTERNAL_READER, UI_GLYPHS, FONT_BOUNDS };
+    Mode mode = MISSING_FONT;
+    const EpdFontFamily* fontFamily = nullptr;
+    ExternalFont* extFont = nullptr;
+    int cjkAdvance = 0;
+  };
+  // Everything besides font, style and text that the width of drawn text depends on
+  struct TextWidthState {
+    int readerFallbackFontId;
+    int externalFontIndex;
+    int externalUiFontIndex;
+    int8_t asciiLetterSpacing;
+    int8_t asciiDigitSpacing;
+    int8_t cjkSpacing;
+    bool operator==(const TextWidthState& other) const {
+      return readerFallbackFontId == other.readerFallbackFontId && externalFontIndex == other.externalFontIndex &&
+             externalUiFontIndex == other.externalUiFontIndex && asciiLetterSpacing == other.asciiLetterSpacing &&
+             asciiDigitSpacing == other.asciiDigitSpacing && cjkSpacing == other.cjkSpacing;
+    }
+  };
+  // Recent truncatedText() results, so redrawing an unchanged list does no font work. Sized for the rows and
+  // subtitles of a full list screen.
+  struct TruncatedTextEntry {
+    int fontId = 0;
+    int maxWidth = 0;  // 0 marks an unused entry, truncatedText() never caches it
+    EpdFontFamily::Style style = EpdFontFamily::REGULAR;
+    TextWidthState state{};
+    std::string text;
+    size_t keptBytes = 0;  // Bytes of text kept before the ellipsis, std::string::npos when it fits
+  };
+  static constexpr size_t TRUNCATED_TEXT_CACHE_SIZE = 32;
+  mutable TruncatedTextEntry truncatedTextCache[TRUNCATED_TEXT_CACHE_SIZE];
+  mutable size_t truncatedTextCacheNext = 0;
+
   void renderChar(int fontId, const EpdFontFamily& fontFamily, uint32_t cp, int* x, const int* y, bool pixelState,
                   EpdFontFamily::Style style) const;
   void renderExternalGlyph(const uint8_t* bitmap, ExternalFont* font, int* x, int y, bool pixelState,
@@ -62,7 +118,27 @@ class GfxRenderer {
   static bool isReaderFont(int fontId);
   // Get effective font ID, handling fallback for external reader font IDs
   int getEffectiveFontId(int fontId) const;
+  TextMeasure textMeasure(int fontId, const char* text) const;
+  // Advance of one codepoint. Their sum is getTextWidth(), except that FONT_BOUNDS measures the glyphs' ink.
+  int codepointAdvance(const TextMeasure& measure, uint32_t cp, EpdFontFamily::Style style) const;
+  TextWidthState textWidthState() const;
   void freeBwBufferChunks();
+  // Rectangles are filled straight into the frame buffer: clipped once, then whole bytes plus masked edge bytes
+  enum class SpanOp : uint8_t { Black, White, Invert };
+  SpanOp spanOp(bool state) const;
+  // Inclusive panel coordinates, clipped to the panel
+  void fillPanelRect(int left, int top, int right, int bottom, SpanOp op) const;
+  void fillLogicalRect(int x, int y, int width, int height, SpanOp op) const;
+  uint8_t* bitmapScratchBuffer(size_t size) const;
+  // Fits the cropped bitmap into maxWidth x maxHeight. oneBit draws every pixel that averages to black or dark gray
+  // black, whatever the render mode.
+  void drawScaledBitmap(const Bitmap& bitmap, int x, int y, int maxWidth, int maxHeight, int cropPixX, int cropPixY,
+                        bool oneBit) const;
+  // One row of 2-bit levels (0 = black ... 3 = white) at logical (x, y). Bit n of blackLevels / whiteLevels makes
+  // level n clear / set its pixel, other levels leave the frame buffer alone.
+  void writeBitmapRow(int x, int y, const uint8_t* levels, int count, uint8_t blackLevels, uint8_t whiteLevels) const;
+  uint32_t panelTileChecksum(int column, int row) const;
+  void rememberPanelTiles() const;
   template <Color color>
   void drawPixelDither(int x, int y) const;
   template <Color color>
@@ -71,7 +147,10 @@ class GfxRenderer {
  public:
   explicit GfxRenderer(HalDisplay& halDisplay)
       : display(halDisplay), renderMode(BW), orientation(Portrait), fadingFix(false) {}
-  ~GfxRenderer() { freeBwBufferChunks(); }
+  ~GfxRenderer() {
+    freeBwBufferChunks();
+    free(bitmapScratch);
+  }
 
   static constexpr int VIEWABLE_MARGIN_TOP = 9;
   static constexpr int VIEWABLE_MARGIN_RIGHT = 3;
@@ -110,8 +189,11 @@ class GfxRenderer {
   int getScreenWidth() const;
   int getScreenHeight() const;
   void displayBuffer(HalDisplay::RefreshMode refreshMode = HalDisplay::FAST_REFRESH) const;
-  // EXPERIMENTAL: Windowed update - display only a rectangular region
-  // void displayWindow(int x, int y, int width, int height) const;
+  // Fast refresh of only the part of the screen that differs from what the panel shows, merged into one window.
+  // Falls back to a full-frame fast refresh when most of the screen changed or the panel contents are unknown.
+  void displayChanges() const;
+  // Fast refresh of one rectangle in logical coordinates, widened to whole frame buffer bytes
+  void displayWindow(int x, int y, int width, int height) const;
   void invertScreen() const;
   void clearScreen(uint8_t color = 0xFF) const;
   void getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const;
@@ -127,6 +209,8 @@ class GfxRenderer {
   void drawRoundedRect(int x, int y, int width, int height, int lineWidth, int cornerRadius, bool roundTopLeft,
                        bool roundTopRight, bool roundBottomLeft, bool roundBottomRight, bool state) const;
   void fillRect(int x, int y, int width, int height, bool state = true) const;
+  // Flips every pixel in the rectangle, e.g. to highlight a selection over what is already drawn
+  void invertRect(int x, int y, int width, int height) const;
   void fillRectDither(int x, int y, int width, int height, Color color) const;
   void fillRoundedRect(int x, int y, int width, int height, int cornerRadius, Color color) const;
   void fillRoundedRect(int x, int y, int width, int height, int cornerRadius, bool roundTopLeft, bool roundTopRight,
@@ -370,6 +370,24 @@ const char* const I18n::STRINGS_EN[] = {
     // WiFi Errors
     "Error: General failure",
     "Error: Network not found",
+
+    // Library sorting
+    "Title",
+    "Author",
+    "Recent",
+
+    // Book search
+    "Search",
+    "Search Index",
+    "Searching...",
+    "No matches",
+    "Search Results",
+    "Results limited to first %d",
+
+    // OPDS offline mode
+    "Offline Mode",
+    "Not available offline",
+    "Turn off Offline Mode to download",
 };
 
 // Chinese strings
@@ -772,6 +790,25 @@ const char* const I18n::STRINGS_ZH[] = {
     // WiFi Errors
     "\xE9\x94\x99\xE8\xAF\xAF: \xE8\xBF\x9E\xE6\x8E\xA5\xE5\xA4\xB1\xE8\xB4\xA5",              // 错误: 连接失败
     "\xE9\x94\x99\xE8\xAF\xAF: \xE6\x89\xBE\xE4\xB8\x8D\xE5\x88\xB0\xE7\xBD\x91\xE7\xBB\x9C",  // 错误: 找不到网络
+
+    // Library sorting
+    "\xE4\xB9\xA6\xE5\x90\x8D",  // 书名
+    "\xE4\xBD\x9C\xE8\x80\x85",  // 作者
+    "\xE6\x9C\x80\xE8\xBF\x91",  // 最近
+
+    // Book search
+    "\xE6\x90\x9C\xE7\xB4\xA2",                                          // 搜索
+    "\xE6\x90\x9C\xE7\xB4\xA2\xE7\xB4\xA2\xE5\xBC\x95",                  // 搜索索引
+    "\xE6\x90\x9C\xE7\xB4\xA2\xE4\xB8\xAD...",                           // 搜索中...
+    "\xE6\x9C\xAA\xE6\x89\xBE\xE5\x88\xB0\xE5\x8C\xB9\xE9\x85\x8D",      // 未找到匹配
+    "\xE6\x90\x9C\xE7\xB4\xA2\xE7\xBB\x93\xE6\x9E\x9C",                  // 搜索结果
+    "\xE4\xBB\x85\xE6\x98\xBE\xE7\xA4\xBA\xE5\x89\x8D %d \xE6\x9D\xA1",  // 仅显示前 %d 条
+
+    // OPDS offline mode
+    "\xE7\xA6\xBB\xE7\xBA\xBF\xE6\xA8\xA1\xE5\xBC\x8F",                          // 离线模式
+    "\xE7\xA6\xBB\xE7\xBA\xBF\xE6\x97\xB6\xE4\xB8\x8D\xE5\x8F\xAF\xE7\x94\xA8",  // 离线时不可用
+    "\xE5\x85\xB3\xE9\x97\xAD\xE7\xA6\xBB\xE7\xBA\xBF\xE6\xA8\xA1\xE5\xBC\x8F\xE5\x90\x8E\xE6\x89\x8D\xE8\x83\xBD\xE4"
+    "\xB8\x8B\xE8\xBD\xBD",  // 关闭离线模式后才能下载
 };
 const char* const I18n::STRINGS_JA[] = {
     // Boot/Sleep
@@ -1334,6 +1371,27 @@ const char* const I18n::STRINGS_JA[] = {
     "\xE3\x82\xA8\xE3\x83\xA9\xE3\x83\xBC: "
     "\xE3\x83\x8D\xE3\x83\x83\xE3\x83\x88\xE3\x83\xAF\xE3\x83\xBC\xE3\x82\xAF\xE3\x81\x8C\xE8\xA6\x8B\xE3\x81\xA4\xE3"
     "\x81\x8B\xE3\x82\x8A\xE3\x81\xBE\xE3\x81\x9B\xE3\x82\x93",  // エラー: ネットワークが見つかりません
+
+    // Library sorting
+    "\xE3\x82\xBF\xE3\x82\xA4\xE3\x83\x88\xE3\x83\xAB",  // タイトル
+    "\xE8\x91\x97\xE8\x80\x85",                          // 著者
+    "\xE6\x9C\x80\xE8\xBF\x91",                          // 最近
+
+    // Book search
+    "\xE6\xA4\x9C\xE7\xB4\xA2",                                                                            // 検索
+    "\xE6\xA4\x9C\xE7\xB4\xA2\xE3\x82\xA4\xE3\x83\xB3\xE3\x83\x87\xE3\x83\x83\xE3\x82\xAF\xE3\x82\xB9",    // 検索インデックス
+    "\xE6\xA4\x9C\xE7\xB4\xA2\xE4\xB8\xAD...",                                                             // 検索中...
+    "\xE4\xB8\x80\xE8\x87\xB4\xE3\x81\xAA\xE3\x81\x97",                                                    // 一致なし
+    "\xE6\xA4\x9C\xE7\xB4\xA2\xE7\xB5\x90\xE6\x9E\x9C",                                                    // 検索結果
+    "\xE6\x9C\x80\xE5\x88\x9D\xE3\x81\xAE%d\xE4\xBB\xB6\xE3\x81\xAE\xE3\x81\xBF\xE8\xA1\xA8\xE7\xA4\xBA",  // 最初の%d件のみ表示
+
+    // OPDS offline mode
+    "\xE3\x82\xAA\xE3\x83\x95\xE3\x83\xA9\xE3\x82\xA4\xE3\x83\xB3\xE3\x83\xA2\xE3\x83\xBC\xE3\x83\x89",  // オフラインモード
+    "\xE3\x82\xAA\xE3\x83\x95\xE3\x83\xA9\xE3\x82\xA4\xE3\x83\xB3\xE3\x81\xA7\xE3\x81\xAF\xE5\x88\xA9\xE7\x94\xA8\xE4"
+    "\xB8\x8D\xE5\x8F\xAF",  // オフラインでは利用不可
+    "\xE3\x83\x80\xE3\x82\xA6\xE3\x83\xB3\xE3\x83\xAD\xE3\x83\xBC\xE3\x83\x89\xE3\x81\xAB\xE3\x81\xAF\xE3\x82\xAA\xE3"
+    "\x83\x95\xE3\x83\xA9\xE3\x82\xA4\xE3\x83\xB3\xE3\x83\xA2\xE3\x83\xBC\xE3\x83\x89\xE3\x82\x92\xE8\xA7\xA3\xE9\x99"
+    "\xA4",  // ダウンロードにはオフラインモードを解除
 };
 
 // Compile-time check for array sizes
@@ -368,8 +368,26 @@ enum class StrId : uint16_t {
   WIFI_ERROR_GENERAL,    // "Error: General failure" / "错误: 连接失败"
   WIFI_ERROR_NOT_FOUND,  // "Error: Network not found" / "错误: 找不到网络"
 
+  // === Library sorting ===
+  LIBRARY_SORT_TITLE,   // "Title" / "书名"
+  LIBRARY_SORT_AUTHOR,  // "Author" / "作者"
+  LIBRARY_SORT_RECENT,  // "Recent" / "最近"
+
+  // === Book search ===
+  SEARCH_BOOK,          // "Search" / "搜索"
+  SEARCH_INDEX,         // "Search Index" / "搜索索引"
+  SEARCHING,            // "Searching..." / "搜索中..."
+  SEARCH_NO_MATCHES,    // "No matches" / "未找到匹配"
+  SEARCH_RESULTS,       // "Search Results" / "搜索结果"
+  SEARCH_MORE_RESULTS,  // "Results limited to first %d" / "仅显示前 %d 条"
+
+  // === OPDS offline mode ===
+  OFFLINE_MODE,               // "Offline Mode" / "离线模式"
+  NOT_AVAILABLE_OFFLINE,      // "Not available offline" / "离线时不可用"
+  OFFLINE_DOWNLOAD_DISABLED,  // "Turn off Offline Mode to download" / "关闭离线模式后才能下载"
+
   // Sentinel - must be last
-  _COUNT = 303
+  _COUNT = 315
 };
 
 // Language enum
@@ -0,0 +1,149 @@
+#include "OpdsEntryList.h"
+
+#include <HardwareSerial.h>
+
+#include <algorithm>
+
+namespace {
+// u8 type, then the lengths of title, author and href as u16
+constexpr size_t RECORD_HEADER_SIZE = 7;
+constexpr size_t MAX_FIELD_LENGTH = 0xFFFF;
+
+uint16_t fieldLength(const std::string& value) {
+  return static_cast<uint16_t>(std::min(value.size(), MAX_FIELD_LENGTH));
+}
+
+void putLength(std::string& record, const size_t at, const uint16_t length) {
+  record[at] = static_cast<char>(length & 0xFF);
+  record[at + 1] = static_cast<char>(length >> 8);
+}
+
+uint16_t getLength(const std::string& record, const size_t at) {
+  return static_cast<uint8_t>(record[at]) | static_cast<uint8_t>(record[at + 1]) << 8;
+}
+}  // namespace
+
+bool OpdsEntryList::begin(const std::string& spillPath, const size_t size) {
+  end();
+  path = spillPath;
+  windowSize = std::max<size_t>(size, 1);
+  const size_t slash = path.rfind('/');
+  if (slash != std::string::npos && slash > 0) {
+    Storage.mkdir(path.substr(0, slash).c_str());
+  }
+  file = Storage.open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC);
+  if (!file.isOpen()) {
+    Serial.printf("[%lu] [OPDS] Can't open spill file %s\n", millis(), path.c_str());
+    return false;
+  }
+  clear();
+  return true;
+}
+
+void OpdsEntryList::end() {
+  if (file.isOpen()) {
+    file.close();
+  }
+  if (!path.empty()) {
+    Storage.remove(path.c_str());
+    path.clear();
+  }
+  count = 0;
+  window.clear();
+  window.shrink_to_fit();
+  windowOffsets.clear();
+  windowOffsets.shrink_to_fit();
+}
+
+void OpdsEntryList::clear() {
+  count = 0;
+  fileEnd = 0;
+  windowOffsets.clear();
+  window.clear();
+  windowStart = 0;
+  if (file.isOpen()) {
+    file.truncate(0);
+  }
+}
+
+bool OpdsEntryList::add(const OpdsEntry& entry) {
+  if (!file.isOpen()) {
+    return false;
+  }
+
+  record.assign(RECORD_HEADER_SIZE, '\0');
+  record[0] = static_cast<char>(entry.type);
+  putLength(record, 1, fieldLength(entry.title));
+  putLength(record, 3, fieldLength(entry.author));
+  putLength(record, 5, fieldLength(entry.href));
+  record.append(entry.title, 0, MAX_FIELD_LENGTH);
+  record.append(entry.author, 0, MAX_FIELD_LENGTH);
+  record.append(entry.href, 0, MAX_FIELD_LENGTH);
+
+  if (!file.seekSet(fileEnd) || file.write(record.data(), record.size()) != record.size()) {
+    Serial.printf("[%lu] [OPDS] Failed to write entry %u to spill file\n", millis(), static_cast<unsigned>(count));
+    return false;
+  }
+
+  if (count % windowSize == 0) {
+    windowOffsets.push_back(fileEnd);
+  }
+  // The window being filled grows with the list
+  if (count >= windowStart && count < windowStart + windowSize && window.size() == count - windowStart) {
+    window.push_back(entry);
+  }
+  fileEnd += record.size();
+  count++;
+  return true;
+}
+
+const OpdsEntry* OpdsEntryList::get(const size_t index) {
+  if (index >= count) {
+    return nullptr;
+  }
+  const size_t start = index / windowSize * windowSize;
+  if (start != windowStart || index - start >= window.size()) {
+    if (!loadWindow(start)) {
+      return nullptr;
+    }
+  }
+  return &window[index - start];
+}
+
+bool OpdsEntryList::loadWindow(const size_t start) {
+  window.clear();
+  windowStart = start;
+  if (!file.isOpen() || !file.seekSet(windowOffsets[start / windowSize])) {
+    return false;
+  }
+
+  const size_t end = std::min(start + windowSize, count);
+  for (size_t i = start; i < end; i++) {
+    record.resize(RECORD_HEADER_SIZE);
+    if (file.read(&record[0], RECORD_HEADER_SIZE) != static_cast<int>(RECORD_HEADER_SIZE)) {
+      break;
+    }
+    OpdsEntry entry;
+    entry.type = static_cast<OpdsEntryType>(record[0]);
+    const uint16_t titleLength = getLength(record, 1);
+    const uint16_t authorLength = getLength(record, 3);
+    const uint16_t hrefLength = getLength(record, 5);
+    const size_t bodyLength = static_cast<size_t>(titleLength) + authorLength + hrefLength;
+    record.resize(bodyLength);
+    if (bodyLength > 0 && file.read(&record[0], bodyLength) != static_cast<int>(bodyLength)) {
+      break;
+    }
+    entry.title.assign(record, 0, titleLength);
+    entry.author.assign(record, titleLength, authorLength);
+    entry.href.assign(record, titleLength + authorLength, hrefLength);
+    window.push_back(std::move(entry));
+  }
+
+  if (window.size() != end - start) {
+    Serial.printf("[%lu] [OPDS] Failed to read entries %u-%u from spill file\n", millis(),
+                  static_cast<unsigned>(start), static_cast<unsigned>(end - 1));
+    window.clear();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "OpdsParser.h"
+
+/**
+ * The entries of an OPDS feed, with only a window of them in memory.
+ *
+ * Every entry added is appended to a spill file on the SD card as a compact record: u8 type, then title, author and
+ * href as u16 length and bytes (ids are not kept). The offset of every window's first record is kept, so bringing in
+ * the window holding any entry is one seek and a read per record. The window being filled keeps its entries in memory
+ * as they are added, so the first screen of a feed is shown without reading anything back.
+ *
+ * Entries are numbered in the order they were added and stay valid across feed pages appended to the same list.
+ */
+class OpdsEntryList {
+ public:
+  OpdsEntryList() = default;
+  ~OpdsEntryList() { end(); }
+
+  // Disable copy
+  OpdsEntryList(const OpdsEntryList&) = delete;
+  OpdsEntryList& operator=(const OpdsEntryList&) = delete;
+
+  /**
+   * Start an empty list spilling to `spillPath`, which is created or truncated.
+   * @param windowSize Entries kept in memory, a screen of the list
+   * @return false if the spill file can't be opened
+   */
+  bool begin(const std::string& spillPath, size_t windowSize);
+
+  // Close and remove the spill file
+  void end();
+
+  // Drop all entries, the spill file stays open
+  void clear();
+
+  bool add(const OpdsEntry& entry);
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  /**
+   * The entry at `index`, reading its window from the card if it isn't the one in memory. Valid until the next
+   * get() of another window or clear().
+   * @return nullptr if `index` is out of range or the spill file can't be read
+   */
+  const OpdsEntry* get(size_t index);
+
+ private:
+  bool loadWindow(size_t start);
+
+  std::string path;
+  FsFile file;
+  size_t windowSize = 1;
+  size_t count = 0;
+  uint32_t fileEnd = 0;
+  std::vector<uint32_t> windowOffsets;  // Spill file offset of entry `i * windowSize`
+  std::vector<OpdsEntry> window;
+  size_t windowStart = 0;
+  std::string record;  // Reused for reading and writing records
+};
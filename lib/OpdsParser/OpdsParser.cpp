@@ -2,6 +2,7 @@
 
 #include <HardwareSerial.h>
 
+#include <algorithm>
 #include <cstring>
 
 OpdsParser::OpdsParser() {
@@ -67,6 +68,9 @@ size_t OpdsParser::write(const uint8_t* xmlData, const size_t length) {
 }
 
 void OpdsParser::flush() {
+  if (errorOccured) {
+    return;
+  }
   if (XML_Parse(parser, nullptr, 0, XML_TRUE) != XML_STATUS_OK) {
     errorOccured = true;
     XML_ParserFree(parser);
@@ -78,6 +82,7 @@ bool OpdsParser::error() const { return errorOccured; }
 
 void OpdsParser::clear() {
   entries.clear();
+  nextHref.clear();
   currentEntry = OpdsEntry{};
   currentText.clear();
   inEntry = false;
@@ -116,7 +121,17 @@ void XMLCALL OpdsParser::startElement(void* userData, const XML_Char* name, cons
     return;
   }
 
-  if (!self->inEntry) return;
+  if (!self->inEntry) {
+    // Feed-level link to the next page of a paginated feed
+    if (strcmp(name, "link") == 0 || strstr(name, ":link") != nullptr) {
+      const char* rel = findAttribute(atts, "rel");
+      const char* href = findAttribute(atts, "href");
+      if (rel && href && strcmp(rel, "next") == 0) {
+        self->nextHref = href;
+      }
+    }
+    return;
+  }
 
   // Check for title element
   if (strcmp(name, "title") == 0 || strstr(name, ":title") != nullptr) {
@@ -177,7 +192,11 @@ void XMLCALL OpdsParser::endElement(void* userData, const XML_Char* name) {
   if (strcmp(name, "entry") == 0 || strstr(name, ":entry") != nullptr) {
     // Only add entry if it has required fields (title and href)
     if (!self->currentEntry.title.empty() && !self->currentEntry.href.empty()) {
-      self->entries.push_back(self->currentEntry);
+      if (self->entryCallback) {
+        self->entryCallback(self->currentEntry);
+      } else {
+        self->entries.push_back(self->currentEntry);
+      }
     }
     self->inEntry = false;
     self->currentEntry = OpdsEntry{};
@@ -225,6 +244,13 @@ void XMLCALL OpdsParser::characterData(void* userData, const XML_Char* s, const
 
   // Only accumulate text when in a text element
   if (self->inTitle || self->inAuthorName || self->inId) {
-    self->currentText.append(s, len);
+    size_t count = std::min(static_cast<size_t>(len), MAX_TEXT_LENGTH - self->currentText.size());
+    // A cut text ends before the UTF-8 sequence that didn't fit
+    if (count < static_cast<size_t>(len)) {
+      while (count > 0 && (static_cast<uint8_t>(s[count]) & 0xC0) == 0x80) {
+        count--;
+      }
+    }
+    self->currentText.append(s, count);
   }
 }
@@ -2,6 +2,7 @@
 #include <Print.h>
 #include <expat.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -42,9 +43,18 @@ using OpdsBook = OpdsEntry;
  *       }
  *     }
  *   }
+ *
+ * Feeds can also be written to the parser as they arrive (it is a Print sink, see OpdsParserStream). With an entry
+ * callback set, each entry is handed over when its </entry> is parsed and nothing is collected, so a feed of any
+ * length needs only the memory of one entry.
  */
 class OpdsParser final : public Print {
  public:
+  using EntryCallback = std::function<void(const OpdsEntry& entry)>;
+
+  // Longest title, author or id kept, longer ones are cut
+  static constexpr size_t MAX_TEXT_LENGTH = 512;
+
   OpdsParser();
   ~OpdsParser();
 
@@ -68,6 +78,16 @@ class OpdsParser final : public Print {
   const std::vector<OpdsEntry>& getEntries() const& { return entries; }
   std::vector<OpdsEntry> getEntries() && { return std::move(entries); }
 
+  /**
+   * Hand every entry to `callback` as it is parsed instead of collecting them.
+   */
+  void onEntry(EntryCallback callback) { entryCallback = std::move(callback); }
+
+  /**
+   * The feed's rel="next" link, the next page of a paginated feed. Empty on the last page.
+   */
+  const std::string& getNextHref() const { return nextHref; }
+
   /**
    * Get only book entries (legacy compatibility).
    * @return Vector of book entries
@@ -90,7 +110,9 @@ class OpdsParser final : public Print {
 
   XML_Parser parser = nullptr;
   std::vector<OpdsEntry> entries;
+  EntryCallback entryCallback;
   OpdsEntry currentEntry;
+  std::string nextHref;
   std::string currentText;
 
   // Parser state
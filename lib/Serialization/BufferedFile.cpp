@@ -0,0 +1,184 @@
+#include "BufferedFile.h"
+
+#include <HardwareSerial.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+
+namespace {
+// Forces the next transfer to seek, used when a failed read leaves the file position unknown
+constexpr uint64_t UNKNOWN_POS = std::numeric_limits<uint64_t>::max();
+}  // namespace
+
+BufferedFile::BufferedFile(FsFile& file)
+    : file(file),
+      buffer(new (std::nothrow) uint8_t[BLOCK_SIZE]),
+      filePos(file ? file.position() : 0),
+      bufferStart(filePos) {
+  if (!buffer) {
+    Serial.printf("[%lu] [BUF] Not enough memory for file buffer, unbuffered\n", millis());
+  }
+}
+
+BufferedFile::~BufferedFile() { writeBuffer(); }
+
+void BufferedFile::seekFile(const uint64_t pos) {
+  if (filePos != pos) {
+    file.seek(pos);
+    filePos = pos;
+  }
+}
+
+void BufferedFile::resetTo(const uint64_t pos) {
+  bufferStart = pos;
+  bufferLen = 0;
+  bufferPos = 0;
+  dirty = false;
+}
+
+void BufferedFile::writeBuffer() {
+  if (!dirty) {
+    return;
+  }
+
+  const uint64_t pos = position();
+  if (bufferLen > 0) {
+    seekFile(bufferStart);
+    const size_t written = file.write(buffer.get(), bufferLen);
+    filePos += written;
+    if (written != bufferLen) {
+      writeFailed = true;
+    }
+  }
+  resetTo(pos);
+}
+
+int BufferedFile::read(void* buf, const size_t count) {
+  writeBuffer();
+
+  auto* out = static_cast<uint8_t*>(buf);
+  size_t total = 0;
+  while (total < count) {
+    if (bufferPos < bufferLen) {
+      const size_t n = std::min(count - total, bufferLen - bufferPos);
+      memcpy(out + total, buffer.get() + bufferPos, n);
+      bufferPos += n;
+      total += n;
+      continue;
+    }
+
+    const uint64_t pos = position();
+    const size_t remaining = count - total;
+    if (!buffer || remaining >= BLOCK_SIZE) {
+      // Large enough to go straight into the caller's memory
+      seekFile(pos);
+      const int n = file.read(out + total, remaining);
+      if (n <= 0) {
+        filePos = n < 0 ? UNKNOWN_POS : filePos;
+        break;
+      }
+      filePos += n;
+      total += n;
+      resetTo(pos + n);
+      if (static_cast<size_t>(n) < remaining) {
+        break;
+      }
+      continue;
+    }
+
+    // Refill with the whole block around the position
+    const uint64_t blockStart = pos - pos % BLOCK_SIZE;
+    seekFile(blockStart);
+    const int n = file.read(buffer.get(), BLOCK_SIZE);
+    if (n <= 0 || blockStart + n <= pos) {
+      filePos = n < 0 ? UNKNOWN_POS : filePos + std::max(n, 0);
+      resetTo(pos);
+      break;
+    }
+    filePos += n;
+    bufferStart = blockStart;
+    bufferLen = n;
+    bufferPos = pos - blockStart;
+  }
+  return static_cast<int>(total);
+}
+
+int BufferedFile::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+size_t BufferedFile::write(const uint8_t* buf, const size_t count) {
+  if (!dirty) {
+    // Read-ahead data is stale once we write
+    resetTo(position());
+    dirty = true;
+  }
+
+  size_t total = 0;
+  while (total < count) {
+    // The first buffer may start mid-block, it ends at the block boundary so later ones are aligned
+    const size_t capacity = buffer ? BLOCK_SIZE - bufferStart % BLOCK_SIZE : 0;
+    const size_t remaining = count - total;
+
+    if (bufferLen == 0 && remaining >= capacity) {
+      // Whole blocks go straight to the file
+      const size_t n = buffer ? capacity + (remaining - capacity) / BLOCK_SIZE * BLOCK_SIZE : remaining;
+      seekFile(bufferStart);
+      const size_t written = file.write(buf + total, n);
+      filePos += written;
+      bufferStart += written;
+      total += written;
+      if (written != n) {
+        writeFailed = true;
+        break;
+      }
+      continue;
+    }
+
+    const size_t n = std::min(remaining, capacity - bufferPos);
+    memcpy(buffer.get() + bufferPos, buf + total, n);
+    bufferPos += n;
+    bufferLen = std::max(bufferLen, bufferPos);
+    total += n;
+    if (bufferPos == capacity) {
+      writeBuffer();
+      dirty = true;
+    }
+  }
+  return total;
+}
+
+bool BufferedFile::seek(const uint64_t pos) {
+  if (pos >= bufferStart && pos <= bufferStart + bufferLen) {
+    bufferPos = pos - bufferStart;
+    return true;
+  }
+
+  writeBuffer();
+  if (pos > size()) {
+    return false;
+  }
+  resetTo(pos);
+  return true;
+}
+
+uint64_t BufferedFile::size() const {
+  const uint64_t fileSize = file.size();
+  return dirty ? std::max(fileSize, bufferStart + bufferLen) : fileSize;
+}
+
+bool BufferedFile::flush() {
+  writeBuffer();
+  const bool ok = !writeFailed;
+  writeFailed = false;
+  return ok;
+}
+
+bool BufferedFile::close() {
+  const bool ok = flush();
+  file.close();
+  return ok;
+}
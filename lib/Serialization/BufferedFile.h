@@ -0,0 +1,62 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Read-ahead / write-behind buffer in front of an open FsFile.
+ *
+ * The serialization helpers move one field at a time, which on a bare FsFile is one SD transaction per field.
+ * Through a BufferedFile reads are served from one block-aligned BLOCK_SIZE read and writes are collected until a
+ * block boundary, so a typical cache file costs a handful of transactions. Requests of a block or more bypass the
+ * buffer. Seeks that land inside the buffered block are free.
+ *
+ * The file keeps being owned by the caller. Pending writes go out on flush(), close() or destruction, so close()
+ * this instead of the FsFile. If the buffer cannot be allocated every call is passed straight through.
+ */
+class BufferedFile {
+ public:
+  static constexpr size_t BLOCK_SIZE = 512;
+
+  // Starts at the current position of `file`
+  explicit BufferedFile(FsFile& file);
+  ~BufferedFile();
+
+  BufferedFile(const BufferedFile&) = delete;
+  BufferedFile& operator=(const BufferedFile&) = delete;
+
+  int read(void* buf, size_t count);
+  int read();
+  size_t write(const uint8_t* buf, size_t count);
+  size_t write(uint8_t b) { return write(&b, 1); }
+
+  bool seek(uint64_t pos);
+  uint64_t position() const { return bufferStart + bufferPos; }
+  uint64_t size() const;
+  int available() const { return static_cast<int>(size() - position()); }
+
+  // Write out pending data. False if any write since the last flush came up short.
+  bool flush();
+  // Flush and close the underlying file
+  bool close();
+
+  explicit operator bool() const { return static_cast<bool>(file); }
+
+ private:
+  FsFile& file;
+  std::unique_ptr<uint8_t[]> buffer;
+  uint64_t filePos;      // Position of the underlying file
+  uint64_t bufferStart;  // File offset of buffer[0]
+  size_t bufferLen = 0;  // Valid bytes (reading) or bytes to write (dirty)
+  size_t bufferPos = 0;
+  bool dirty = false;
+  bool writeFailed = false;
+
+  void seekFile(uint64_t pos);
+  // Drop the buffer and continue at `pos`
+  void resetTo(uint64_t pos);
+  // Write out pending data, remembering a short write for flush()
+  void writeBuffer();
+};
@@ -1,8 +1,11 @@
 #pragma once
 #include <HalStorage.h>
 
+#include <cstring>
 #include <iostream>
 
+#include "BufferedFile.h"
+
 namespace serialization {
 template <typename T>
 static void writePod(std::ostream& os, const T& value) {
@@ -14,6 +17,11 @@ static void writePod(FsFile& file, const T& value) {
   file.write(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
 }
 
+template <typename T>
+static void writePod(BufferedFile& file, const T& value) {
+  file.write(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+}
+
 template <typename T>
 static void readPod(std::istream& is, T& value) {
   is.read(reinterpret_cast<char*>(&value), sizeof(T));
@@ -24,6 +32,11 @@ static void readPod(FsFile& file, T& value) {
   file.read(reinterpret_cast<uint8_t*>(&value), sizeof(T));
 }
 
+template <typename T>
+static void readPod(BufferedFile& file, T& value) {
+  file.read(reinterpret_cast<uint8_t*>(&value), sizeof(T));
+}
+
 static void writeString(std::ostream& os, const std::string& s) {
   const uint32_t len = s.size();
   writePod(os, len);
@@ -36,6 +49,12 @@ static void writeString(FsFile& file, const std::string& s) {
   file.write(reinterpret_cast<const uint8_t*>(s.data()), len);
 }
 
+static void writeString(BufferedFile& file, const std::string& s) {
+  const uint32_t len = s.size();
+  writePod(file, len);
+  file.write(reinterpret_cast<const uint8_t*>(s.data()), len);
+}
+
 static void readString(std::istream& is, std::string& s) {
   uint32_t len;
   readPod(is, len);
@@ -49,4 +68,42 @@ static void readString(FsFile& file, std::string& s) {
   s.resize(len);
   file.read(&s[0], len);
 }
+
+static void readString(BufferedFile& file, std::string& s) {
+  uint32_t len;
+  readPod(file, len);
+  s.resize(len);
+  file.read(&s[0], len);
+}
+
+// Cursor over a blob that was read in one piece. A read past the end leaves the value untouched and clears `ok`.
+struct BufferReader {
+  const uint8_t* pos;
+  const uint8_t* end;
+  bool ok = true;
+
+  BufferReader(const uint8_t* data, const size_t size) : pos(data), end(data + size) {}
+};
+
+template <typename T>
+static void readPod(BufferReader& reader, T& value) {
+  if (static_cast<size_t>(reader.end - reader.pos) < sizeof(T)) {
+    reader.ok = false;
+    return;
+  }
+  memcpy(&value, reader.pos, sizeof(T));
+  reader.pos += sizeof(T);
+}
+
+// NUL-terminated string stored in the blob, returned in place. nullptr if it runs past the end.
+static const char* readCString(BufferReader& reader) {
+  const auto* nul = static_cast<const uint8_t*>(memchr(reader.pos, '\0', reader.end - reader.pos));
+  if (!nul) {
+    reader.ok = false;
+    return nullptr;
+  }
+  const auto* str = reinterpret_cast<const char*>(reader.pos);
+  reader.pos = nul + 1;
+  return str;
+}
 }  // namespace serialization
@@ -52,6 +52,30 @@ struct XtcHeader {
 };
 #pragma pack(pop)
 
+// Metadata block (256 bytes), directly after the header when hasMetadata is set
+#pragma pack(push, 1)
+struct XtcMetadata {
+  char title[128];        // 0x00: Title (UTF-8, null-terminated)
+  char author[64];        // 0x80: Author (UTF-8, null-terminated)
+  char publisher[32];     // 0xC0: Publisher (UTF-8, null-terminated)
+  char language[16];      // 0xE0: Language code (e.g. "en")
+  uint32_t createTime;    // 0xF0: Creation time (Unix timestamp)
+  uint16_t coverPage;     // 0xF4: Cover page (0-based)
+  uint16_t chapterCount;  // 0xF6: Number of chapter entries
+  uint8_t reserved[8];    // 0xF8: Reserved (zero)
+};
+#pragma pack(pop)
+
+// Chapter table entry (96 bytes per chapter), at chapterOffset when hasChapters is set
+#pragma pack(push, 1)
+struct XtcChapter {
+  char name[80];         // 0x00: Chapter name (UTF-8, null-terminated)
+  uint16_t startPage;    // 0x50: First page (1-based)
+  uint16_t endPage;      // 0x52: Last page (1-based, inclusive)
+  uint8_t reserved[12];  // 0x54: Reserved (zero)
+};
+#pragma pack(pop)
+
 // Page table entry (16 bytes per page)
 #pragma pack(push, 1)
 struct PageTableEntry {
@@ -9,7 +9,21 @@ void HalGPIO::begin() {
   pinMode(UART0_RXD, INPUT);
 }
 
-void HalGPIO::update() { inputMgr.update(); }
+void HalGPIO::update() {
+  if (pollHeld) {
+    pollHeld = false;
+    return;
+  }
+  inputMgr.update();
+}
+
+bool HalGPIO::pollAnyInput() {
+  if (!pollHeld) {
+    inputMgr.update();
+    pollHeld = inputMgr.wasAnyPressed() || inputMgr.wasAnyReleased();
+  }
+  return pollHeld;
+}
 
 bool HalGPIO::isPressed(uint8_t buttonIndex) const { return inputMgr.isPressed(buttonIndex); }
 
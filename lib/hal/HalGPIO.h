@@ -22,6 +22,8 @@ class HalGPIO {
 #if CROSSPOINT_EMULATED == 0
   InputManager inputMgr;
 #endif
+  // A poll saw a button change that the next update() hands on instead of sampling again
+  bool pollHeld = false;
 
  public:
   HalGPIO() = default;
@@ -37,6 +39,9 @@ class HalGPIO {
   bool wasReleased(uint8_t buttonIndex) const;
   bool wasAnyReleased() const;
   unsigned long getHeldTime() const;
+  // Samples the buttons from inside long work on the loop task, true once one was pressed or released. That change is
+  // kept for the next update(), so the loop still handles it.
+  bool pollAnyInput();
 
   // Setup wake up GPIO and enter deep sleep
   void startDeepSleep();
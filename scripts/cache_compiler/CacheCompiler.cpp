@@ -0,0 +1,336 @@
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "HostTool.h"
+
+// Builds the EPUB caches the reader would build on first open (book.bin, CSS rules, covers and every laid-out
+// chapter with its search index) on a PC, into a copy of the SD card or the mounted card itself.
+//
+// The layout code is the firmware's own, compiled against the stand-ins in host/, so the result is what the reader
+// writes for the same settings. See docs/cache-compiler.md.
+
+namespace {
+
+using HostTool::Profile;
+using HostTool::ThreadPool;
+
+constexpr char CACHE_ROOT[] = "/.crosspoint";
+// Books are built here under the host's cache key and moved to the device's one when done
+constexpr char STAGING_ROOT[] = "/.crosspoint/.compile";
+
+struct Options {
+  std::string card;
+  std::vector<std::string> books;
+  int threads = 0;
+  bool force = false;
+  bool verbose = false;
+  HostTool::LayoutOverrides layout;
+};
+
+// The reader names cache directories after std::hash of the book path. On the device that is libstdc++'s 32-bit
+// _Hash_bytes (MurmurHash2 with its fixed seed); a PC's size_t is 64 bits wide and hashes differently.
+uint32_t deviceHash(const std::string& text) {
+  constexpr uint32_t m = 0x5bd1e995;
+  const auto* buf = reinterpret_cast<const uint8_t*>(text.data());
+  size_t len = text.size();
+  uint32_t hash = 0xc70f6907u ^ static_cast<uint32_t>(len);
+
+  while (len >= 4) {
+    uint32_t k;
+    memcpy(&k, buf, sizeof(k));
+    k *= m;
+    k ^= k >> 24;
+    k *= m;
+    hash *= m;
+    hash ^= k;
+    buf += 4;
+    len -= 4;
+  }
+
+  switch (len) {
+    case 3:
+      hash ^= static_cast<uint32_t>(buf[2]) << 16;
+      [[fallthrough]];
+    case 2:
+      hash ^= static_cast<uint32_t>(buf[1]) << 8;
+      [[fallthrough]];
+    case 1:
+      hash ^= buf[0];
+      hash *= m;
+  }
+
+  hash ^= hash >> 13;
+  hash *= m;
+  hash ^= hash >> 15;
+  return hash;
+}
+
+void printUsage() {
+  fprintf(stderr,
+          "Usage: cache_compiler --card <dir> [options] <book.epub>...\n"
+          "\n"
+          "Builds the reader's caches for the given books, which have to be inside <dir>, a copy of the SD card\n"
+          "or the mounted card. Layout settings come from <dir>/.crosspoint/settings.bin unless overridden.\n"
+          "\n"
+          "  --card <dir>            Root of the SD card\n"
+          "%s%s"
+          "  --threads <n>           Worker threads (default: one per CPU)\n"
+          "  --force                 Rebuild caches that already exist\n"
+          "  --verbose               Print the firmware log\n",
+          HostTool::LAYOUT_USAGE, HostTool::ORIENTATION_USAGE);
+}
+
+bool parseOptions(const int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--force") == 0) {
+      options.force = true;
+      continue;
+    }
+    if (strcmp(arg, "--verbose") == 0) {
+      options.verbose = true;
+      continue;
+    }
+    if (arg[0] != '-') {
+      options.books.emplace_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      fprintf(stderr, "Missing value for %s\n", arg);
+      return false;
+    }
+    const char* value = argv[++i];
+
+    bool valid = true;
+    if (strcmp(arg, "--card") == 0) {
+      options.card = value;
+    } else if (strcmp(arg, "--threads") == 0) {
+      valid = HostTool::parseNumber(arg, value, options.threads);
+    } else if (!HostTool::parseLayoutOption(arg, value, options.layout, valid)) {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      return false;
+    }
+    if (!valid) {
+      return false;
+    }
+  }
+  return !options.card.empty() && !options.books.empty();
+}
+
+// Cover images the reader would generate for the current theme and sleep screen
+struct Covers {
+  int thumbHeight;
+  bool sleepCover;
+  bool croppedSleepCover;
+};
+
+struct BookJob {
+  std::string hostPath;
+  std::string devicePath;
+  std::string cachePath;    // Final directory, named with the device's cache key
+  std::string stagingPath;  // Where it is built, named with the host's cache key
+  bool hadCache = false;
+  std::atomic<int> chaptersLeft{0};
+  std::atomic<int> built{0};
+  std::atomic<int> failed{0};
+  int chapters = 0;
+};
+
+class CacheCompiler {
+  const Profile& profile;
+  const Covers& covers;
+  GfxRenderer& renderer;
+  ThreadPool& pool;
+  std::mutex outputMutex;
+  // picojpeg decodes through globals
+  std::mutex coverMutex;
+  std::atomic<int> failedBooks{0};
+
+  void report(const BookJob& book, const char* result) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    printf("%s: %s (%d chapters, %d built, %d failed) -> %s\n", book.hostPath.c_str(), result, book.chapters,
+           book.built.load(), book.failed.load(), book.cachePath.c_str());
+  }
+
+  void finishBook(BookJob& book) {
+    if (!Storage.rename(book.stagingPath.c_str(), book.cachePath.c_str())) {
+      fprintf(stderr, "%s: could not move %s to %s\n", book.hostPath.c_str(), book.stagingPath.c_str(),
+              book.cachePath.c_str());
+      failedBooks++;
+      return;
+    }
+    if (book.failed > 0) {
+      failedBooks++;
+    }
+    report(book, book.failed > 0 ? "incomplete" : "done");
+  }
+
+  void abandonBook(BookJob& book) {
+    // Leave an existing cache as it was
+    if (book.hadCache) {
+      Storage.rename(book.stagingPath.c_str(), book.cachePath.c_str());
+    } else {
+      Storage.removeDir(book.stagingPath.c_str());
+    }
+    failedBooks++;
+    report(book, "failed");
+  }
+
+  void compileChapter(BookJob& book, const int spineIndex) {
+    // Every chapter gets its own Epub, the metadata cache reads book.bin through a single file handle
+    auto epub = std::make_shared<Epub>(book.devicePath, STAGING_ROOT);
+    bool success = epub->load(false);
+    if (success) {
+      Section section(epub, spineIndex, renderer);
+      if (!section.loadSectionFile(profile.fontId, profile.lineCompression, profile.extraParagraphSpacing,
+                                   profile.paragraphAlignment, profile.viewportWidth, profile.viewportHeight,
+                                   profile.hyphenationEnabled, profile.firstLineIndent, profile.embeddedStyle)) {
+        success = section.createSectionFile(profile.fontId, profile.lineCompression, profile.extraParagraphSpacing,
+                                            profile.paragraphAlignment, profile.viewportWidth,
+                                            profile.viewportHeight, profile.hyphenationEnabled,
+                                            profile.firstLineIndent, profile.embeddedStyle, nullptr,
+                                            profile.searchIndex);
+        if (success) {
+          book.built++;
+        }
+      }
+    }
+    if (!success) {
+      book.failed++;
+    }
+    if (--book.chaptersLeft == 0) {
+      finishBook(book);
+    }
+  }
+
+ public:
+  CacheCompiler(const Profile& profile, const Covers& covers, GfxRenderer& renderer, ThreadPool& pool)
+      : profile(profile), covers(covers), renderer(renderer), pool(pool) {}
+
+  int failures() const { return failedBooks; }
+
+  void compileBook(BookJob& book, const bool force) {
+    auto epub = std::make_shared<Epub>(book.devicePath, STAGING_ROOT);
+    book.stagingPath = epub->getCachePath();
+
+    // Left behind by an interrupted run
+    if (Storage.exists(book.stagingPath.c_str())) {
+      Storage.removeDir(book.stagingPath.c_str());
+    }
+    if (force && Storage.exists(book.cachePath.c_str())) {
+      Storage.removeDir(book.cachePath.c_str());
+    }
+    // Build on top of what is there, the firmware keeps whatever still matches
+    book.hadCache = Storage.exists(book.cachePath.c_str());
+    if (book.hadCache && !Storage.rename(book.cachePath.c_str(), book.stagingPath.c_str())) {
+      fprintf(stderr, "%s: could not move %s aside\n", book.hostPath.c_str(), book.cachePath.c_str());
+      failedBooks++;
+      return;
+    }
+
+    if (!epub->load(true)) {
+      abandonBook(book);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(coverMutex);
+      epub->generateThumbBmp(covers.thumbHeight);
+      if (covers.sleepCover) {
+        epub->generateCoverBmp(covers.croppedSleepCover);
+      }
+    }
+
+    book.chapters = epub->getSpineItemsCount();
+    if (book.chapters == 0) {
+      finishBook(book);
+      return;
+    }
+    book.chaptersLeft = book.chapters;
+    for (int i = 0; i < book.chapters; i++) {
+      pool.add([this, &book, i] { compileChapter(book, i); });
+    }
+  }
+};
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+  Serial.quiet = !options.verbose;
+
+  char cardRoot[PATH_MAX];
+  if (!realpath(options.card.c_str(), cardRoot)) {
+    fprintf(stderr, "Card directory not found: %s\n", options.card.c_str());
+    return 1;
+  }
+  Storage.setRoot(cardRoot);
+
+  HostTool::loadReaderSettings(options.layout);
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  HostTool::setUpReaderRenderer(renderer);
+  const Profile profile = HostTool::readerProfile(renderer);
+
+  Covers covers{};
+  covers.thumbHeight = UITheme::getInstance().getMetrics().homeCoverHeight;
+  covers.sleepCover = SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER ||
+                      SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER_CUSTOM;
+  covers.croppedSleepCover = SETTINGS.sleepScreenCoverMode == CrossPointSettings::SLEEP_SCREEN_COVER_MODE::CROP;
+
+  const int threads = HostTool::workerThreads(options.threads);
+  printf("Font %d, viewport %ux%u, %d thread(s)\n", profile.fontId, profile.viewportWidth, profile.viewportHeight,
+         threads);
+
+  std::vector<std::unique_ptr<BookJob>> books;
+  for (const auto& file : options.books) {
+    const std::string devicePath = HostTool::devicePathOf(cardRoot, file);
+    if (devicePath.empty()) {
+      fprintf(stderr, "%s: not a file on the card, skipped\n", file.c_str());
+      continue;
+    }
+    const bool duplicate = std::any_of(books.begin(), books.end(),
+                                       [&devicePath](const auto& book) { return book->devicePath == devicePath; });
+    if (duplicate) {
+      continue;
+    }
+    auto book = std::make_unique<BookJob>();
+    book->hostPath = file;
+    book->devicePath = devicePath;
+    book->cachePath = std::string(CACHE_ROOT) + "/epub_" + std::to_string(deviceHash(devicePath));
+    books.push_back(std::move(book));
+  }
+  if (books.empty()) {
+    return 1;
+  }
+
+  Storage.mkdir(STAGING_ROOT);
+  ThreadPool pool;
+  CacheCompiler compiler(profile, covers, renderer, pool);
+  for (auto& book : books) {
+    pool.add([&compiler, &book, &options] { compiler.compileBook(*book, options.force); });
+  }
+  pool.run(threads);
+  Storage.rmdir(STAGING_ROOT);
+
+  return compiler.failures() > 0 ? 1 : 0;
+}
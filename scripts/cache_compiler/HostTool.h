@@ -0,0 +1,226 @@
+#pragma once
+
+// Shared by the host tools: command line handling for the layout settings, the reader profile books are laid out
+// for and the thread pool chapters are processed on.
+
+#include <FontManager.h>
+#include <GfxRenderer.h>
+#include <I18n.h>
+
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BuiltinFonts.h"
+#include "CrossPointSettings.h"
+#include "activities/reader/EpubReaderLayout.h"
+#include "components/UITheme.h"
+
+namespace HostTool {
+
+// Layout settings given on the command line, -1 where the card's settings apply
+struct LayoutOverrides {
+  int fontFamily = -1;
+  int fontSize = -1;
+  int lineSpacing = -1;
+  int screenMargin = -1;
+  int orientation = -1;
+};
+
+constexpr char LAYOUT_USAGE[] =
+    "  --font-family <name>    bookerly, notosans or opendyslexic\n"
+    "  --font-size <name>      small, medium, large or extra-large\n"
+    "  --line-spacing <name>   tight, normal or wide\n"
+    "  --margin <px>           Reader screen margin\n";
+constexpr char ORIENTATION_USAGE[] = "  --orientation <name>    portrait, landscape-cw, inverted or landscape-ccw\n";
+
+// Index of `value` in `names`, -1 if it is not one of them
+inline int parseChoice(const char* value, const std::vector<const char*>& names) {
+  for (size_t i = 0; i < names.size(); i++) {
+    if (strcmp(value, names[i]) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+// Whole number from 0 to 255, as the settings and thread counts take
+inline bool parseNumber(const char* arg, const char* value, int& number) {
+  char* end = nullptr;
+  const long parsed = strtol(value, &end, 10);
+  if (*end != '\0' || parsed < 0 || parsed > UINT8_MAX) {
+    fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+    return false;
+  }
+  number = static_cast<int>(parsed);
+  return true;
+}
+
+// Returns false if `arg` is not a layout option. Otherwise `valid` tells whether its value was accepted, an error is
+// printed when it isn't.
+inline bool parseLayoutOption(const char* arg, const char* value, LayoutOverrides& overrides, bool& valid) {
+  int* choice = nullptr;
+  std::vector<const char*> names;
+  if (strcmp(arg, "--margin") == 0) {
+    valid = parseNumber(arg, value, overrides.screenMargin);
+    return true;
+  }
+  if (strcmp(arg, "--font-family") == 0) {
+    choice = &overrides.fontFamily;
+    names = {"bookerly", "notosans", "opendyslexic"};
+  } else if (strcmp(arg, "--font-size") == 0) {
+    choice = &overrides.fontSize;
+    names = {"small", "medium", "large", "extra-large"};
+  } else if (strcmp(arg, "--line-spacing") == 0) {
+    choice = &overrides.lineSpacing;
+    names = {"tight", "normal", "wide"};
+  } else if (strcmp(arg, "--orientation") == 0) {
+    choice = &overrides.orientation;
+    names = {"portrait", "landscape-cw", "inverted", "landscape-ccw"};
+  } else {
+    return false;
+  }
+  *choice = parseChoice(value, names);
+  valid = *choice >= 0;
+  if (!valid) {
+    fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+  }
+  return true;
+}
+
+// Settings, UI theme, external fonts and language from the card, in the firmware's start-up order, then the
+// overrides. Storage has to point at the card.
+inline void loadReaderSettings(const LayoutOverrides& overrides) {
+  if (!SETTINGS.loadFromFile()) {
+    printf("No settings.bin on the card, using the default settings\n");
+  }
+  UITheme::getInstance().reload();
+  FontManager::getInstance().scanFonts();
+  FontManager::getInstance().loadSettings();
+  I18N.loadSettings();
+
+  if (overrides.fontFamily >= 0) SETTINGS.fontFamily = overrides.fontFamily;
+  if (overrides.fontSize >= 0) SETTINGS.fontSize = overrides.fontSize;
+  if (overrides.lineSpacing >= 0) SETTINGS.lineSpacing = overrides.lineSpacing;
+  if (overrides.screenMargin >= 0) SETTINGS.screenMargin = overrides.screenMargin;
+  if (overrides.orientation >= 0) SETTINGS.orientation = overrides.orientation;
+}
+
+// A renderer set up like the reader's: built-in fonts, fallback font and orientation
+inline void setUpReaderRenderer(GfxRenderer& renderer) {
+  registerBuiltinFonts(renderer);
+  renderer.setReaderFallbackFontId(SETTINGS.getBuiltInReaderFontId());
+  EpubReaderLayout::applyReaderOrientation(renderer, SETTINGS.orientation);
+}
+
+// Section layout parameters, the same for every chapter of every book
+struct Profile {
+  int fontId;
+  float lineCompression;
+  bool extraParagraphSpacing;
+  uint8_t paragraphAlignment;
+  EpubReaderLayout::Margins margins;
+  uint16_t viewportWidth;
+  uint16_t viewportHeight;
+  bool hyphenationEnabled;
+  bool firstLineIndent;
+  bool embeddedStyle;
+  bool searchIndex;
+};
+
+inline Profile readerProfile(const GfxRenderer& renderer) {
+  Profile profile{};
+  profile.fontId = SETTINGS.getReaderFontId();
+  profile.lineCompression = SETTINGS.getReaderLineCompression();
+  profile.extraParagraphSpacing = SETTINGS.extraParagraphSpacing;
+  profile.paragraphAlignment = SETTINGS.paragraphAlignment;
+  profile.margins = EpubReaderLayout::pageMargins(renderer, SETTINGS, UITheme::getInstance().getMetrics());
+  profile.viewportWidth = EpubReaderLayout::viewportWidth(renderer, profile.margins);
+  profile.viewportHeight = EpubReaderLayout::viewportHeight(renderer, profile.margins);
+  profile.hyphenationEnabled = SETTINGS.hyphenationEnabled;
+  profile.firstLineIndent = SETTINGS.firstLineIndent;
+  profile.embeddedStyle = SETTINGS.embeddedStyle;
+  profile.searchIndex = SETTINGS.searchIndex;
+  return profile;
+}
+
+// Requested thread count, one per CPU by default
+inline int workerThreads(const int requested) {
+  int threads = requested > 0 ? requested : static_cast<int>(std::thread::hardware_concurrency());
+  if (FontManager::getInstance().isExternalFontEnabled() && threads > 1) {
+    // Glyphs of external fonts are read through one shared file and cache
+    printf("External reader font selected, running on a single thread\n");
+    threads = 1;
+  }
+  return std::max(threads, 1);
+}
+
+// Path of `file` on the card, empty if it is not inside `cardRoot`
+inline std::string devicePathOf(const std::string& cardRoot, const std::string& file) {
+  char resolved[PATH_MAX];
+  if (!realpath(file.c_str(), resolved)) {
+    return "";
+  }
+  const std::string path(resolved);
+  if (path.compare(0, cardRoot.size(), cardRoot) != 0 || path.size() <= cardRoot.size() ||
+      path[cardRoot.size()] != '/') {
+    return "";
+  }
+  return path.substr(cardRoot.size());
+}
+
+// Work queue drained by a fixed set of threads. Jobs may queue more jobs; run() returns once all are done.
+class ThreadPool {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::function<void()>> jobs;
+  int running = 0;
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [this] { return !jobs.empty() || running == 0; });
+      if (jobs.empty()) {
+        return;
+      }
+      auto job = std::move(jobs.front());
+      jobs.pop_front();
+      running++;
+      lock.unlock();
+      job();
+      lock.lock();
+      running--;
+      changed.notify_all();
+    }
+  }
+
+ public:
+  void add(std::function<void()> job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+    changed.notify_one();
+  }
+
+  void run(const int threadCount) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+      threads.emplace_back(&ThreadPool::work, this);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+}  // namespace HostTool
@@ -0,0 +1,578 @@
+#include <Epub.h>
+#include <Epub/Page.h>
+#include <Epub/Section.h>
+#include <FontManager.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Xtc/XtcTypes.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "HostTool.h"
+
+// Converts EPUBs into XTC (1-bit) or XTCH (2-bit) books on a PC. Pages are laid out and drawn by the reader's own
+// code, status bar included, into the frame buffer of a display stand-in and stored as they would be shown, so the
+// XTC reader turns them without any layout work. See docs/cache-compiler.md.
+
+namespace {
+
+using HostTool::Profile;
+using HostTool::ThreadPool;
+
+// Books are laid out into a private cache here, removed once their XTC file is written
+constexpr char WORK_ROOT[] = "/.crosspoint/.xtc";
+
+// The XTC reader shows pages in portrait
+constexpr uint16_t PAGE_WIDTH = xtc::DISPLAY_WIDTH;
+constexpr uint16_t PAGE_HEIGHT = xtc::DISPLAY_HEIGHT;
+constexpr size_t COPY_CHUNK_SIZE = 64 * 1024;
+
+struct Options {
+  std::string card;
+  std::string outputDir;
+  std::vector<std::string> books;
+  bool twoBit = true;
+  int threads = 0;
+  bool verbose = false;
+  HostTool::LayoutOverrides layout;
+};
+
+void printUsage() {
+  fprintf(stderr,
+          "Usage: xtc_converter --card <dir> [options] <book.epub>...\n"
+          "\n"
+          "Converts the given books, which have to be inside <dir>, a copy of the SD card or the mounted card, to\n"
+          "XTC books laid out like the reader would. Layout settings come from <dir>/.crosspoint/settings.bin\n"
+          "unless overridden. Pages are always portrait.\n"
+          "\n"
+          "  --card <dir>            Root of the SD card\n"
+          "  --format <name>         xtch (2-bit grayscale, default) or xtc (1-bit)\n"
+          "  --output <dir>          Where to write the books, created if missing (default: next to each EPUB)\n"
+          "%s"
+          "  --threads <n>           Worker threads (default: one per CPU)\n"
+          "  --verbose               Print the firmware log\n",
+          HostTool::LAYOUT_USAGE);
+}
+
+bool parseOptions(const int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--verbose") == 0) {
+      options.verbose = true;
+      continue;
+    }
+    if (arg[0] != '-') {
+      options.books.emplace_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      fprintf(stderr, "Missing value for %s\n", arg);
+      return false;
+    }
+    const char* value = argv[++i];
+
+    bool valid = true;
+    if (strcmp(arg, "--card") == 0) {
+      options.card = value;
+    } else if (strcmp(arg, "--output") == 0) {
+      options.outputDir = value;
+    } else if (strcmp(arg, "--format") == 0) {
+      const int format = HostTool::parseChoice(value, {"xtc", "xtch"});
+      valid = format >= 0;
+      options.twoBit = format == 1;
+      if (!valid) {
+        fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+      }
+    } else if (strcmp(arg, "--threads") == 0) {
+      valid = HostTool::parseNumber(arg, value, options.threads);
+    } else if (strcmp(arg, "--orientation") == 0) {
+      fprintf(stderr, "XTC pages are always portrait, --orientation does not apply\n");
+      return false;
+    } else if (!HostTool::parseLayoutOption(arg, value, options.layout, valid)) {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      return false;
+    }
+    if (!valid) {
+      return false;
+    }
+  }
+  return !options.card.empty() && !options.books.empty();
+}
+
+// Copy of `text` that fits `size` bytes with its terminator, cut at a character boundary
+void copyUtf8(char* dest, const size_t size, const std::string& text) {
+  size_t length = std::min(text.size(), size - 1);
+  while (length > 0 && length < text.size() && (static_cast<uint8_t>(text[length]) & 0xC0) == 0x80) {
+    length--;
+  }
+  memset(dest, 0, size);
+  memcpy(dest, text.data(), length);
+}
+
+size_t pageDataSize(const bool twoBit) {
+  return twoBit ? ((static_cast<size_t>(PAGE_WIDTH) * PAGE_HEIGHT + 7) / 8) * 2
+                : static_cast<size_t>((PAGE_WIDTH + 7) / 8) * PAGE_HEIGHT;
+}
+
+size_t pageBlobSize(const bool twoBit) { return sizeof(xtc::XtgPageHeader) + pageDataSize(twoBit); }
+
+// The reader's frame buffers of one page: black and white, then the grayscale planes (empty without anti-aliasing)
+struct PageFrames {
+  std::vector<uint8_t> bw;
+  std::vector<uint8_t> lsb;
+  std::vector<uint8_t> msb;
+};
+
+// Bit of portrait pixel (x, y) in a panel frame buffer, rotated like GfxRenderer::drawPixel does for Portrait
+bool frameBit(const std::vector<uint8_t>& frame, const int x, const int y) {
+  const int phyX = y;
+  const int phyY = HalDisplay::DISPLAY_HEIGHT - 1 - x;
+  return (frame[phyY * HalDisplay::DISPLAY_WIDTH_BYTES + phyX / 8] >> (7 - phyX % 8)) & 1;
+}
+
+// XTH pixel value (0 white, 1 dark gray, 2 light gray, 3 black). The black and white pass draws every gray pixel
+// black; the grayscale passes then mark dark gray in the LSB plane (glyphs mark only that one, images both) and
+// light gray in the MSB plane alone, which is what the display's gray LUT lightens.
+uint8_t grayValue(const PageFrames& frames, const int x, const int y) {
+  if (frameBit(frames.bw, x, y)) {
+    return 0;
+  }
+  if (frames.lsb.empty()) {
+    return 3;
+  }
+  if (frameBit(frames.lsb, x, y)) {
+    return 1;
+  }
+  return frameBit(frames.msb, x, y) ? 2 : 3;
+}
+
+// XTG or XTH blob of a page: page header, then the bitmap in the layout XtcReaderActivity reads
+void encodePage(const PageFrames& frames, const bool twoBit, std::vector<uint8_t>& blob) {
+  xtc::XtgPageHeader header{};
+  header.magic = twoBit ? xtc::XTH_MAGIC : xtc::XTG_MAGIC;
+  header.width = PAGE_WIDTH;
+  header.height = PAGE_HEIGHT;
+  header.dataSize = pageDataSize(twoBit);
+  blob.assign(pageBlobSize(twoBit), 0);
+  memcpy(blob.data(), &header, sizeof(header));
+  uint8_t* data = blob.data() + sizeof(header);
+
+  if (!twoBit) {
+    // Row-major, MSB first, set bits are white
+    const size_t rowBytes = (PAGE_WIDTH + 7) / 8;
+    for (int y = 0; y < PAGE_HEIGHT; y++) {
+      for (int x = 0; x < PAGE_WIDTH; x++) {
+        if (frameBit(frames.bw, x, y)) {
+          data[y * rowBytes + x / 8] |= 1 << (7 - x % 8);
+        }
+      }
+    }
+    return;
+  }
+
+  // Two planes of columns from right to left, 8 vertical pixels per byte, MSB at the top
+  uint8_t* highPlane = data;
+  uint8_t* lowPlane = data + pageDataSize(true) / 2;
+  const size_t columnBytes = (PAGE_HEIGHT + 7) / 8;
+  for (int x = 0; x < PAGE_WIDTH; x++) {
+    const size_t column = static_cast<size_t>(PAGE_WIDTH - 1 - x) * columnBytes;
+    for (int y = 0; y < PAGE_HEIGHT; y++) {
+      const uint8_t value = grayValue(frames, x, y);
+      const uint8_t bit = 1 << (7 - y % 8);
+      if (value & 2) {
+        highPlane[column + y / 8] |= bit;
+      }
+      if (value & 1) {
+        lowPlane[column + y / 8] |= bit;
+      }
+    }
+  }
+}
+
+struct TocItem {
+  std::string title;
+  std::string anchor;
+  int spineIndex;
+};
+
+struct BookJob {
+  std::string hostPath;
+  std::string devicePath;
+  std::string outputPath;
+  std::string workPath;  // Cache directory the book is laid out in
+  std::string title;
+  std::string author;
+  std::string language;
+  std::vector<TocItem> toc;
+  // Filled in by the chapter jobs, each writes only the entries of its own spine item
+  std::vector<uint16_t> pageCounts;  // Per spine item
+  std::vector<int> tocPages;         // Page of each TOC item within its spine item
+  std::atomic<int> chaptersLeft{0};
+  std::atomic<int> failed{0};
+};
+
+class XtcConverter {
+  const Profile& profile;
+  const bool twoBit;
+  const bool grayscale;
+  ThreadPool& pool;
+  std::mutex outputMutex;
+  std::atomic<int> failedBooks{0};
+
+  std::string pagesPath(const BookJob& book, const int spineIndex) const {
+    return book.workPath + "/pages/" + std::to_string(spineIndex) + ".bin";
+  }
+
+  void report(const BookJob& book, const char* result, const int pages = 0, const int chapters = 0) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (pages > 0) {
+      printf("%s: %s (%d pages, %d chapters) -> %s\n", book.hostPath.c_str(), result, pages, chapters,
+             book.outputPath.c_str());
+    } else {
+      printf("%s: %s\n", book.hostPath.c_str(), result);
+    }
+  }
+
+  void abandonBook(const BookJob& book, const char* reason) {
+    Storage.removeDir(book.workPath.c_str());
+    failedBooks++;
+    report(book, reason);
+  }
+
+  // Same passes as EpubReaderActivity::renderContents, with the status bar in the black and white one only
+  void renderPage(GfxRenderer& renderer, const Epub& epub, const int spineIndex, const Section& section,
+                  const Page& page, PageFrames& frames) const {
+    const auto& margins = profile.margins;
+    const uint8_t* frameBuffer = renderer.getFrameBuffer();
+
+    renderer.clearScreen();
+    page.render(renderer, profile.fontId, margins.left, margins.top);
+    EpubReaderLayout::renderStatusBar(renderer, epub, spineIndex, section.currentPage, section.pageCount,
+                                      margins.right, margins.bottom, margins.left, false);
+    frames.bw.assign(frameBuffer, frameBuffer + HalDisplay::BUFFER_SIZE);
+
+    frames.lsb.clear();
+    frames.msb.clear();
+    if (!grayscale) {
+      return;
+    }
+    renderer.clearScreen(0x00);
+    renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
+    page.render(renderer, profile.fontId, margins.left, margins.top);
+    frames.lsb.assign(frameBuffer, frameBuffer + HalDisplay::BUFFER_SIZE);
+
+    renderer.clearScreen(0x00);
+    renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+    page.render(renderer, profile.fontId, margins.left, margins.top);
+    frames.msb.assign(frameBuffer, frameBuffer + HalDisplay::BUFFER_SIZE);
+    renderer.setRenderMode(GfxRenderer::BW);
+  }
+
+  bool renderChapter(BookJob& book, const int spineIndex) {
+    // Every chapter gets its own Epub, the metadata cache reads book.bin through a single file handle
+    auto epub = std::make_shared<Epub>(book.devicePath, WORK_ROOT);
+    if (!epub->load(false)) {
+      return false;
+    }
+    // And its own frame buffer
+    auto display = std::make_unique<HalDisplay>();
+    GfxRenderer renderer(*display);
+    renderer.begin();
+    HostTool::setUpReaderRenderer(renderer);
+
+    Section section(epub, spineIndex, renderer);
+    if (!section.createSectionFile(profile.fontId, profile.lineCompression, profile.extraParagraphSpacing,
+                                   profile.paragraphAlignment, profile.viewportWidth, profile.viewportHeight,
+                                   profile.hyphenationEnabled, profile.firstLineIndent, profile.embeddedStyle)) {
+      return false;
+    }
+    for (size_t i = 0; i < book.toc.size(); i++) {
+      if (book.toc[i].spineIndex == spineIndex && !book.toc[i].anchor.empty()) {
+        book.tocPages[i] = std::max(section.findAnchorPage(book.toc[i].anchor), 0);
+      }
+    }
+
+    FsFile out;
+    if (!Storage.openFileForWrite("XTC", pagesPath(book, spineIndex).c_str(), out)) {
+      return false;
+    }
+    PageFrames frames;
+    std::vector<uint8_t> blob;
+    for (int i = 0; i < section.pageCount; i++) {
+      section.currentPage = i;
+      const auto page = section.loadPageFromSectionFile();
+      if (!page) {
+        return false;
+      }
+      renderPage(renderer, *epub, spineIndex, section, *page, frames);
+      encodePage(frames, twoBit, blob);
+      if (out.write(blob.data(), blob.size()) != blob.size()) {
+        return false;
+      }
+    }
+    book.pageCounts[spineIndex] = section.pageCount;
+    return true;
+  }
+
+  void finishChapter(BookJob& book, const int spineIndex) {
+    if (!renderChapter(book, spineIndex)) {
+      fprintf(stderr, "%s: chapter %d failed\n", book.hostPath.c_str(), spineIndex);
+      book.failed++;
+    }
+    if (--book.chaptersLeft > 0) {
+      return;
+    }
+    if (book.failed > 0) {
+      abandonBook(book, "failed");
+      return;
+    }
+    writeBook(book);
+    Storage.removeDir(book.workPath.c_str());
+  }
+
+  // Chapter table from the TOC. Each entry runs up to the next one that starts on a later page.
+  std::vector<xtc::XtcChapter> chapterTable(const BookJob& book, const std::vector<uint32_t>& spineStarts,
+                                            const uint32_t pageCount) const {
+    std::vector<uint32_t> starts;
+    for (size_t i = 0; i < book.toc.size(); i++) {
+      const int spineIndex = book.toc[i].spineIndex;
+      if (spineIndex < 0 || spineIndex >= static_cast<int>(book.pageCounts.size())) {
+        starts.push_back(UINT32_MAX);
+        continue;
+      }
+      const uint32_t start = spineStarts[spineIndex] + book.tocPages[i];
+      starts.push_back(std::min(start, pageCount - 1));
+    }
+
+    std::vector<xtc::XtcChapter> chapters;
+    for (size_t i = 0; i < starts.size(); i++) {
+      if (starts[i] == UINT32_MAX) {
+        continue;
+      }
+      uint32_t end = pageCount - 1;
+      for (size_t j = i + 1; j < starts.size(); j++) {
+        if (starts[j] != UINT32_MAX && starts[j] > starts[i]) {
+          end = starts[j] - 1;
+          break;
+        }
+      }
+      xtc::XtcChapter chapter{};
+      copyUtf8(chapter.name, sizeof(chapter.name), book.toc[i].title);
+      chapter.startPage = starts[i] + 1;
+      chapter.endPage = end + 1;
+      chapters.push_back(chapter);
+    }
+    return chapters;
+  }
+
+  bool writeBook(BookJob& book) {
+    std::vector<uint32_t> spineStarts;
+    uint32_t pageCount = 0;
+    for (const uint16_t pages : book.pageCounts) {
+      spineStarts.push_back(pageCount);
+      pageCount += pages;
+    }
+    if (pageCount == 0 || pageCount > UINT16_MAX) {
+      abandonBook(book, pageCount == 0 ? "failed (no pages)" : "failed (too many pages for XTC)");
+      return false;
+    }
+    const auto chapters = chapterTable(book, spineStarts, pageCount);
+
+    xtc::XtcMetadata metadata{};
+    copyUtf8(metadata.title, sizeof(metadata.title), book.title);
+    copyUtf8(metadata.author, sizeof(metadata.author), book.author);
+    copyUtf8(metadata.language, sizeof(metadata.language), book.language);
+    // Creation time stays 0 so a book always converts to the same file
+    metadata.chapterCount = chapters.size();
+
+    xtc::XtcHeader header{};
+    header.magic = twoBit ? xtc::XTCH_MAGIC : xtc::XTC_MAGIC;
+    header.versionMajor = 1;
+    header.versionMinor = 0;
+    header.pageCount = pageCount;
+    header.hasMetadata = 1;
+    header.hasChapters = chapters.empty() ? 0 : 1;
+    header.metadataOffset = sizeof(header);
+    const uint32_t chapterOffset = sizeof(header) + sizeof(metadata);
+    header.chapterOffset = chapters.empty() ? 0 : chapterOffset;
+    header.pageTableOffset = chapterOffset + chapters.size() * sizeof(xtc::XtcChapter);
+    header.dataOffset = header.pageTableOffset + pageCount * sizeof(xtc::PageTableEntry);
+
+    // Written next to the target and renamed, an interrupted run leaves no half-written book behind
+    const std::string partialPath = book.outputPath + ".part";
+    FILE* out = fopen(partialPath.c_str(), "wb");
+    if (!out) {
+      abandonBook(book, ("failed (cannot write " + partialPath + ")").c_str());
+      return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, out) == 1 && fwrite(&metadata, sizeof(metadata), 1, out) == 1;
+    if (!chapters.empty()) {
+      written &= fwrite(chapters.data(), sizeof(xtc::XtcChapter), chapters.size(), out) == chapters.size();
+    }
+    for (uint32_t i = 0; i < pageCount && written; i++) {
+      xtc::PageTableEntry entry{};
+      entry.dataOffset = header.dataOffset + static_cast<uint64_t>(i) * pageBlobSize(twoBit);
+      entry.dataSize = pageBlobSize(twoBit);
+      entry.width = PAGE_WIDTH;
+      entry.height = PAGE_HEIGHT;
+      written = fwrite(&entry, sizeof(entry), 1, out) == 1;
+    }
+
+    std::vector<uint8_t> chunk(COPY_CHUNK_SIZE);
+    for (size_t spineIndex = 0; spineIndex < book.pageCounts.size() && written; spineIndex++) {
+      FsFile pages;
+      if (!Storage.openFileForRead("XTC", pagesPath(book, spineIndex).c_str(), pages)) {
+        written = false;
+        break;
+      }
+      int bytesRead;
+      while (written && (bytesRead = pages.read(chunk.data(), chunk.size())) > 0) {
+        written = fwrite(chunk.data(), 1, bytesRead, out) == static_cast<size_t>(bytesRead);
+      }
+    }
+
+    written &= fclose(out) == 0;
+    if (!written || rename(partialPath.c_str(), book.outputPath.c_str()) != 0) {
+      remove(partialPath.c_str());
+      abandonBook(book, ("failed (cannot write " + book.outputPath + ")").c_str());
+      return false;
+    }
+    report(book, "done", pageCount, chapters.size());
+    return true;
+  }
+
+ public:
+  XtcConverter(const Profile& profile, const bool twoBit, const bool grayscale, ThreadPool& pool)
+      : profile(profile), twoBit(twoBit), grayscale(grayscale), pool(pool) {}
+
+  int failures() const { return failedBooks; }
+
+  void convertBook(BookJob& book) {
+    auto epub = std::make_shared<Epub>(book.devicePath, WORK_ROOT);
+    book.workPath = epub->getCachePath();
+    // Left behind by an interrupted run
+    if (Storage.exists(book.workPath.c_str())) {
+      Storage.removeDir(book.workPath.c_str());
+    }
+    if (!epub->load(true) || !Storage.mkdir((book.workPath + "/pages").c_str())) {
+      abandonBook(book, "failed");
+      return;
+    }
+
+    book.title = epub->getTitle();
+    book.author = epub->getAuthor();
+    book.language = epub->getLanguage();
+    for (int i = 0; i < epub->getTocItemsCount(); i++) {
+      const auto item = epub->getTocItem(i);
+      book.toc.push_back({item.title, item.anchor, item.spineIndex});
+    }
+    book.tocPages.assign(book.toc.size(), 0);
+
+    const int chapters = epub->getSpineItemsCount();
+    if (chapters == 0) {
+      abandonBook(book, "failed (no chapters)");
+      return;
+    }
+    book.pageCounts.assign(chapters, 0);
+    book.chaptersLeft = chapters;
+    for (int i = 0; i < chapters; i++) {
+      pool.add([this, &book, i] { finishChapter(book, i); });
+    }
+  }
+};
+
+// `file` with its extension replaced, in `outputDir` if one is given
+std::string outputPathOf(const std::string& file, const std::string& outputDir, const bool twoBit) {
+  std::string path = file;
+  if (!outputDir.empty()) {
+    path = outputDir + "/" + path.substr(path.find_last_of('/') + 1);
+  }
+  const size_t dot = path.find_last_of('.');
+  if (dot != std::string::npos && dot > path.find_last_of('/') + 1) {
+    path.resize(dot);
+  }
+  return path + (twoBit ? ".xtch" : ".xtc");
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+  Serial.quiet = !options.verbose;
+
+  char cardRoot[PATH_MAX];
+  if (!realpath(options.card.c_str(), cardRoot)) {
+    fprintf(stderr, "Card directory not found: %s\n", options.card.c_str());
+    return 1;
+  }
+  Storage.setRoot(cardRoot);
+
+  std::error_code error;
+  if (!options.outputDir.empty() && !std::filesystem::create_directories(options.outputDir, error) && error) {
+    fprintf(stderr, "Cannot create output directory %s: %s\n", options.outputDir.c_str(), error.message().c_str());
+    return 1;
+  }
+
+  HostTool::loadReaderSettings(options.layout);
+  SETTINGS.orientation = CrossPointSettings::ORIENTATION::PORTRAIT;
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  HostTool::setUpReaderRenderer(renderer);
+  const Profile profile = HostTool::readerProfile(renderer);
+  // The reader draws external fonts in black and white only
+  const bool grayscale =
+      options.twoBit && SETTINGS.textAntiAliasing && !FontManager::getInstance().isExternalFontEnabled();
+
+  const int threads = HostTool::workerThreads(options.threads);
+  printf("Font %d, viewport %ux%u, %s pages, %d thread(s)\n", profile.fontId, profile.viewportWidth,
+         profile.viewportHeight, grayscale ? "grayscale" : "black and white", threads);
+
+  std::vector<std::unique_ptr<BookJob>> books;
+  for (const auto& file : options.books) {
+    const std::string devicePath = HostTool::devicePathOf(cardRoot, file);
+    if (devicePath.empty()) {
+      fprintf(stderr, "%s: not a file on the card, skipped\n", file.c_str());
+      continue;
+    }
+    const bool duplicate = std::any_of(books.begin(), books.end(),
+                                       [&devicePath](const auto& book) { return book->devicePath == devicePath; });
+    if (duplicate) {
+      continue;
+    }
+    auto book = std::make_unique<BookJob>();
+    book->hostPath = file;
+    book->devicePath = devicePath;
+    book->outputPath = outputPathOf(file, options.outputDir, options.twoBit);
+    books.push_back(std::move(book));
+  }
+  if (books.empty()) {
+    return 1;
+  }
+
+  Storage.mkdir(WORK_ROOT);
+  ThreadPool pool;
+  XtcConverter converter(profile, options.twoBit, grayscale, pool);
+  for (auto& book : books) {
+    pool.add([&converter, &book] { converter.convertBook(*book); });
+  }
+  pool.run(threads);
+  Storage.rmdir(WORK_ROOT);
+
+  return converter.failures() > 0 ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Builds the host tools, cache_compiler and xtc_converter, into build/cache_compiler/. Anything after the tool name is
+# passed to it, e.g. scripts/cache_compiler/build.sh cache_compiler --card /media/SD /media/SD/Books/*.epub
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+TOOL_DIR="$ROOT_DIR/scripts/cache_compiler"
+BUILD_DIR="$ROOT_DIR/build/cache_compiler"
+TOOLS=(cache_compiler xtc_converter)
+
+mkdir -p "$BUILD_DIR"
+
+C_SOURCES=(
+  "$ROOT_DIR/lib/expat/xmlparse.c"
+  "$ROOT_DIR/lib/expat/xmlrole.c"
+  "$ROOT_DIR/lib/expat/xmltok.c"
+  "$ROOT_DIR/lib/miniz/miniz.c"
+  "$ROOT_DIR/lib/picojpeg/picojpeg.c"
+)
+
+TOOL_SOURCES=(
+  "$TOOL_DIR/CacheCompiler.cpp"
+  "$TOOL_DIR/XtcConverter.cpp"
+)
+
+SOURCES=(
+  "$TOOL_DIR/host/HalStorage.cpp"
+  "$ROOT_DIR/src/BuiltinFonts.cpp"
+  "$ROOT_DIR/src/CrossPointSettings.cpp"
+  "$ROOT_DIR/src/activities/reader/EpubReaderLayout.cpp"
+  "$ROOT_DIR/src/components/UITheme.cpp"
+  "$ROOT_DIR/src/components/themes/BaseTheme.cpp"
+  "$ROOT_DIR/src/components/themes/lyra/LyraTheme.cpp"
+  "$ROOT_DIR/lib/Epub/Epub.cpp"
+  "$ROOT_DIR"/lib/Epub/Epub/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/*/*.cpp
+  "$ROOT_DIR"/lib/EpdFont/*.cpp
+  "$ROOT_DIR"/lib/ExternalFont/*.cpp
+  "$ROOT_DIR/lib/FsHelpers/FsHelpers.cpp"
+  "$ROOT_DIR"/lib/GfxRenderer/*.cpp
+  "$ROOT_DIR/lib/I18n/I18n.cpp"
+  "$ROOT_DIR/lib/JpegToBmpConverter/JpegToBmpConverter.cpp"
+  "$ROOT_DIR/lib/Serialization/BufferedFile.cpp"
+  "$ROOT_DIR/lib/Utf8/Utf8.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipFile.cpp"
+)
+
+# Same library configuration as platformio.ini
+DEFINES=(
+  -DMINIZ_NO_ZLIB_COMPATIBLE_NAMES=1
+  -DXML_GE=0
+  -DXML_CONTEXT_BYTES=1024
+  -DCROSSPOINT_HOST_THREADS=1
+)
+
+# host/ stands in for the Arduino core, the SD card and the display. No FMA contraction, so float layout math rounds
+# like the device's.
+INCLUDES=(
+  -I"$TOOL_DIR/host"
+  -I"$ROOT_DIR/src"
+  -I"$ROOT_DIR/lib/Epub"
+  -I"$ROOT_DIR/lib/EpdFont"
+  -I"$ROOT_DIR/lib/ExternalFont"
+  -I"$ROOT_DIR/lib/FsHelpers"
+  -I"$ROOT_DIR/lib/GfxRenderer"
+  -I"$ROOT_DIR/lib/I18n"
+  -I"$ROOT_DIR/lib/JpegToBmpConverter"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/Utf8"
+  -I"$ROOT_DIR/lib/Xtc"
+  -I"$ROOT_DIR/lib/ZipFile"
+  -I"$ROOT_DIR/lib/expat"
+  -I"$ROOT_DIR/lib/miniz"
+  -I"$ROOT_DIR/lib/picojpeg"
+)
+
+CFLAGS=(-O2 -ffp-contract=off -w "${DEFINES[@]}" "${INCLUDES[@]}")
+CXXFLAGS=(-std=c++20 -O2 -ffp-contract=off -pthread "${DEFINES[@]}" "${INCLUDES[@]}")
+# Warnings for the tools themselves, the firmware sources are checked by the firmware build. Its headers leave the
+# parameters of empty virtual defaults unused.
+TOOL_WARNINGS=(-Wall -Wextra -Wno-unused-parameter)
+
+# One object per source, compiled in parallel (the built-in fonts alone take a while)
+OBJECTS=()
+PIDS=()
+for source in "${C_SOURCES[@]}" "${SOURCES[@]}" "${TOOL_SOURCES[@]}"; do
+  name="${source#"$ROOT_DIR"/}"
+  object="$BUILD_DIR/obj/${name//\//_}.o"
+  mkdir -p "$BUILD_DIR/obj"
+  if [[ "$source" == *.c ]]; then
+    cc "${CFLAGS[@]}" -c "$source" -o "$object" &
+  else
+    if [[ "$source" == "$TOOL_DIR"/* ]]; then
+      c++ "${CXXFLAGS[@]}" "${TOOL_WARNINGS[@]}" -c "$source" -o "$object" &
+    else
+      c++ "${CXXFLAGS[@]}" -w -c "$source" -o "$object" &
+    fi
+  fi
+  PIDS+=($!)
+  if [[ ! " ${TOOL_SOURCES[*]} " =~ " $source " ]]; then
+    OBJECTS+=("$object")
+  fi
+done
+for pid in "${PIDS[@]}"; do
+  wait "$pid"
+done
+
+# Each tool is its main source plus everything shared
+for i in "${!TOOLS[@]}"; do
+  main_source="${TOOL_SOURCES[$i]#"$ROOT_DIR"/}"
+  c++ -pthread "$BUILD_DIR/obj/${main_source//\//_}.o" "${OBJECTS[@]}" -o "$BUILD_DIR/${TOOLS[$i]}"
+done
+
+if [[ $# -gt 0 ]]; then
+  tool="$1"
+  shift
+  if [[ ! " ${TOOLS[*]} " =~ " $tool " ]]; then
+    echo "Unknown tool $tool, expected one of: ${TOOLS[*]}" >&2
+    exit 2
+  fi
+  "$BUILD_DIR/$tool" "$@"
+fi
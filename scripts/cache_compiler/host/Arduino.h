@@ -0,0 +1,34 @@
+#pragma once
+
+// Host stand-in for the Arduino core, just what the firmware sources built into the host tools use
+
+#include <Print.h>
+#include <Stream.h>
+#include <pgmspace.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using std::max;
+using std::min;
+
+inline void delay(const unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void yield() {}
+
+struct HostEsp {
+  // Layout falls back to cheaper strategies when the heap runs low (greedy line breaking, early text block flushes).
+  // Report what a reader has free with nothing else going on, so caches match a device that never hits those paths.
+  static constexpr uint32_t FREE_HEAP = 160 * 1024;
+  uint32_t getFreeHeap() const { return FREE_HEAP; }
+  uint32_t getMaxAllocHeap() const { return FREE_HEAP; }
+};
+
+inline HostEsp ESP;
+
+#include <HardwareSerial.h>
@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for the battery monitor. Pre-rendered pages leave the battery out, this only satisfies the UI themes.
+
+#include <cstdint>
+
+class BatteryMonitor {
+ public:
+  uint16_t readPercentage() const { return 100; }
+};
+
+static BatteryMonitor battery;
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the panel driver, only its geometry is needed
+
+#include <cstdint>
+
+class EInkDisplay {
+ public:
+  static constexpr uint16_t DISPLAY_WIDTH = 800;
+  static constexpr uint16_t DISPLAY_HEIGHT = 480;
+};
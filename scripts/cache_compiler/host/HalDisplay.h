@@ -0,0 +1,34 @@
+#pragma once
+
+// Host stand-in for the display HAL. Nothing is ever shown: the frame buffer is plain memory that the XTC converter
+// reads pages back from, and refreshes do nothing.
+
+#include <Arduino.h>
+#include <EInkDisplay.h>
+
+class HalDisplay {
+ public:
+  enum RefreshMode { FULL_REFRESH, HALF_REFRESH, FAST_REFRESH };
+
+  static constexpr uint16_t DISPLAY_WIDTH = EInkDisplay::DISPLAY_WIDTH;
+  static constexpr uint16_t DISPLAY_HEIGHT = EInkDisplay::DISPLAY_HEIGHT;
+  static constexpr uint16_t DISPLAY_WIDTH_BYTES = DISPLAY_WIDTH / 8;
+  static constexpr uint32_t BUFFER_SIZE = DISPLAY_WIDTH_BYTES * DISPLAY_HEIGHT;
+
+  void begin() {}
+  void clearScreen(const uint8_t color = 0xFF) const { memset(frameBuffer, color, BUFFER_SIZE); }
+  void drawImage(const uint8_t*, uint16_t, uint16_t, uint16_t, uint16_t, bool = false) const {}
+  void displayBuffer(RefreshMode = FAST_REFRESH, bool = false) {}
+  void refreshDisplay(RefreshMode = FAST_REFRESH, bool = false) {}
+  void displayWindow(uint16_t, uint16_t, uint16_t, uint16_t, bool = false) {}
+  void deepSleep() {}
+  uint8_t* getFrameBuffer() const { return frameBuffer; }
+  void copyGrayscaleBuffers(const uint8_t*, const uint8_t*) {}
+  void copyGrayscaleLsbBuffers(const uint8_t*) {}
+  void copyGrayscaleMsbBuffers(const uint8_t*) {}
+  void cleanupGrayscaleBuffers(const uint8_t*) {}
+  void displayGrayBuffer(bool = false) {}
+
+ private:
+  mutable uint8_t frameBuffer[BUFFER_SIZE] = {};
+};
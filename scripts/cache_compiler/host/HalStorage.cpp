@@ -0,0 +1,288 @@
+#include "HalStorage.h"
+
+#include <HardwareSerial.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+HalStorage HalStorage::instance;
+
+namespace {
+bool isDirectoryPath(const std::string& hostPath) {
+  struct stat st {};
+  return stat(hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool isPathPresent(const std::string& hostPath) {
+  struct stat st {};
+  return stat(hostPath.c_str(), &st) == 0;
+}
+
+// fopen() mode for SdFat open flags
+const char* stdioMode(const oflag_t oflag, const bool present) {
+  const int access = oflag & O_ACCMODE;
+  if (access == O_RDONLY) {
+    return "rb";
+  }
+  if (oflag & O_APPEND) {
+    return "a+b";
+  }
+  if ((oflag & O_TRUNC) || ((oflag & O_CREAT) && !present)) {
+    return "w+b";
+  }
+  return "r+b";
+}
+}  // namespace
+
+FsFile::Handle::~Handle() {
+  if (fp) fclose(fp);
+  if (dir) closedir(dir);
+}
+
+bool FsFile::openHost(const std::string& hostPath, const oflag_t oflag) {
+  close();
+  auto opened = std::make_shared<Handle>();
+  opened->path = hostPath;
+  if (isDirectoryPath(hostPath)) {
+    opened->dir = opendir(hostPath.c_str());
+    if (!opened->dir) {
+      return false;
+    }
+  } else {
+    if ((oflag & O_CREAT) && (oflag & O_EXCL) && isPathPresent(hostPath)) {
+      return false;
+    }
+    opened->fp = fopen(hostPath.c_str(), stdioMode(oflag, isPathPresent(hostPath)));
+    if (!opened->fp) {
+      return false;
+    }
+  }
+  handle = std::move(opened);
+  return true;
+}
+
+FsFile FsFile::openNextFile() {
+  FsFile next;
+  if (!isDir()) {
+    return next;
+  }
+  while (const dirent* entry = readdir(handle->dir)) {
+    handle->dirPosition++;
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    if (next.openHost(handle->path + "/" + entry->d_name, O_RDONLY)) {
+      break;
+    }
+  }
+  return next;
+}
+
+bool FsFile::openNext(FsFile* dir, oflag_t) {
+  *this = dir->openNextFile();
+  return isOpen();
+}
+
+bool FsFile::close() {
+  handle.reset();
+  return true;
+}
+
+size_t FsFile::getName(char* name, const size_t size) const {
+  if (!handle || size == 0) {
+    return 0;
+  }
+  const std::string base = handle->path.substr(handle->path.find_last_of('/') + 1);
+  const size_t length = std::min(base.size(), size - 1);
+  memcpy(name, base.data(), length);
+  name[length] = '\0';
+  return length;
+}
+
+int FsFile::read(void* buf, const size_t count) {
+  if (!handle || !handle->fp) {
+    return -1;
+  }
+  return static_cast<int>(fread(buf, 1, count, handle->fp));
+}
+
+int FsFile::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+size_t FsFile::write(const uint8_t* buf, const size_t count) {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  const size_t written = fwrite(buf, 1, count, handle->fp);
+  if (Storage.writeLatencyUs > 0 || Storage.writeBytesPerSecond > 0) {
+    const uint64_t transferUs =
+        Storage.writeBytesPerSecond > 0 ? static_cast<uint64_t>(count) * 1000000 / Storage.writeBytesPerSecond : 0;
+    std::this_thread::sleep_for(std::chrono::microseconds(Storage.writeLatencyUs + transferUs));
+  }
+  return written;
+}
+
+bool FsFile::seek(const uint64_t pos) {
+  if (isDir()) {
+    rewinddir(handle->dir);
+    for (handle->dirPosition = 0; handle->dirPosition < pos; handle->dirPosition++) {
+      if (!readdir(handle->dir)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return handle && handle->fp && fseeko(handle->fp, static_cast<off_t>(pos), SEEK_SET) == 0;
+}
+
+bool FsFile::seekCur(const int64_t offset) {
+  return handle && handle->fp && fseeko(handle->fp, static_cast<off_t>(offset), SEEK_CUR) == 0;
+}
+
+uint64_t FsFile::position() const {
+  if (isDir()) {
+    return handle->dirPosition;
+  }
+  return handle && handle->fp ? static_cast<uint64_t>(ftello(handle->fp)) : 0;
+}
+
+bool FsFile::getModifyDateTime(uint16_t* date, uint16_t* time) const {
+  struct stat st {};
+  if (!handle || stat(handle->path.c_str(), &st) != 0) {
+    return false;
+  }
+  struct tm local {};
+  if (!localtime_r(&st.st_mtime, &local) || local.tm_year < 80) {
+    return false;
+  }
+  *date = static_cast<uint16_t>(((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+  *time = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+  return true;
+}
+
+uint64_t FsFile::size() const {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  // Through the stream so data still in the stdio buffer counts
+  const off_t pos = ftello(handle->fp);
+  fseeko(handle->fp, 0, SEEK_END);
+  const off_t end = ftello(handle->fp);
+  fseeko(handle->fp, pos, SEEK_SET);
+  return static_cast<uint64_t>(end);
+}
+
+bool FsFile::sync() { return handle && handle->fp && fflush(handle->fp) == 0; }
+
+bool FsFile::truncate(const uint64_t length) {
+  if (!handle || !handle->fp || fflush(handle->fp) != 0) {
+    return false;
+  }
+  // Like SdFat, the position moves back if it was past the new end
+  if (ftruncate(fileno(handle->fp), static_cast<off_t>(length)) != 0) {
+    return false;
+  }
+  return position() <= length || seek(length);
+}
+
+bool FsFile::rename(const char* newPath) {
+  if (!handle) {
+    return false;
+  }
+  const std::string target = Storage.hostPath(newPath);
+  if (::rename(handle->path.c_str(), target.c_str()) != 0) {
+    return false;
+  }
+  handle->path = target;
+  return true;
+}
+
+std::string HalStorage::hostPath(const char* path) const {
+  if (path[0] == '/') {
+    return root + path;
+  }
+  return root + "/" + path;
+}
+
+FsFile HalStorage::open(const char* path, const oflag_t oflag) {
+  FsFile file;
+  file.openHost(hostPath(path), oflag);
+  return file;
+}
+
+bool HalStorage::mkdir(const char* path, const bool pFlag) {
+  const std::string target = hostPath(path);
+  if (isDirectoryPath(target)) {
+    return true;
+  }
+  if (pFlag) {
+    // Create the missing parents first, like SdFat with pFlag set
+    for (size_t slash = target.find('/', root.size() + 1); slash != std::string::npos;
+         slash = target.find('/', slash + 1)) {
+      ::mkdir(target.substr(0, slash).c_str(), 0755);
+    }
+  }
+  return ::mkdir(target.c_str(), 0755) == 0 || isDirectoryPath(target);
+}
+
+bool HalStorage::exists(const char* path) { return isPathPresent(hostPath(path)); }
+
+bool HalStorage::remove(const char* path) { return unlink(hostPath(path).c_str()) == 0; }
+
+bool HalStorage::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+bool HalStorage::rename(const char* oldPath, const char* newPath) {
+  return ::rename(hostPath(oldPath).c_str(), hostPath(newPath).c_str()) == 0;
+}
+
+bool HalStorage::openFileForRead(const char* moduleName, const char* path, FsFile& file) {
+  if (!file.openHost(hostPath(path), O_RDONLY) || file.isDir()) {
+    file.close();
+    Serial.printf("[%lu] [%s] File does not exist: %s\n", millis(), moduleName, path);
+    return false;
+  }
+  return true;
+}
+
+bool HalStorage::openFileForWrite(const char* moduleName, const char* path, FsFile& file) {
+  if (!file.openHost(hostPath(path), O_RDWR | O_CREAT | O_TRUNC) || file.isDir()) {
+    file.close();
+    Serial.printf("[%lu] [%s] Failed to open file for writing: %s\n", millis(), moduleName, path);
+    return false;
+  }
+  return true;
+}
+
+bool HalStorage::removeDir(const char* path) {
+  const std::string target = hostPath(path);
+  DIR* dir = opendir(target.c_str());
+  if (!dir) {
+    return false;
+  }
+  std::vector<std::string> names;
+  while (const dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      names.emplace_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+
+  bool removed = true;
+  for (const auto& name : names) {
+    const std::string child = std::string(path) + "/" + name;
+    if (isDirectoryPath(hostPath(child.c_str()))) {
+      removed &= removeDir(child.c_str());
+    } else {
+      removed &= remove(child.c_str());
+    }
+  }
+  return rmdir(path) && removed;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// Host stand-in for the firmware's HalStorage.h. Device paths ("/.crosspoint/...") are mapped below a directory on
+// the PC holding a copy of the SD card (or the card itself), set with setRoot() before anything is opened.
+//
+// FsFile keeps the SdFat behaviour the firmware relies on: copies share the open file, directories are opened like
+// files and listed with openNextFile() / openNext(), and files are Print sinks.
+
+// Like SdFat, this brings in the Arduino core for everything that logs
+#include <Arduino.h>
+#include <dirent.h>
+#include <fcntl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using oflag_t = int;
+
+class FsFile : public Print {
+  struct Handle {
+    FILE* fp = nullptr;
+    DIR* dir = nullptr;
+    // Directory entries read so far, the position of a directory. SdFat uses the entry's byte offset instead.
+    uint64_t dirPosition = 0;
+    std::string path;  // Host path
+    ~Handle();
+  };
+  std::shared_ptr<Handle> handle;
+
+ public:
+  // Open a path on the PC, used by HalStorage
+  bool openHost(const std::string& hostPath, oflag_t oflag);
+
+  bool openNext(FsFile* dir, oflag_t oflag = O_RDONLY);
+  FsFile openNextFile();
+  bool close();
+  explicit operator bool() const { return handle != nullptr; }
+  bool isOpen() const { return handle != nullptr; }
+  bool isDir() const { return handle && handle->dir; }
+  bool isDirectory() const { return isDir(); }
+  size_t getName(char* name, size_t size) const;
+
+  int read(void* buf, size_t count);
+  int read();
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t count) override;
+  size_t write(const void* buf, const size_t count) { return write(static_cast<const uint8_t*>(buf), count); }
+  bool seek(uint64_t pos);
+  bool seekSet(const uint64_t pos) { return seek(pos); }
+  bool seekCur(int64_t offset);
+  uint64_t position() const;
+  uint64_t curPosition() const { return position(); }
+  uint64_t size() const;
+  uint64_t fileSize() const { return size(); }
+  // Modification time in FAT format, local time
+  bool getModifyDateTime(uint16_t* date, uint16_t* time) const;
+  int available() const { return static_cast<int>(size() - position()); }
+  void flush() override { sync(); }
+  bool sync();
+  bool truncate(uint64_t length);
+  // SdFat reserves contiguous clusters for an empty file, the host has nothing to reserve
+  bool preAllocate(uint64_t) { return handle && handle->fp && size() == 0; }
+  bool rename(const char* newPath);
+};
+
+class HalStorage {
+ public:
+  // Directory on the PC that stands for the root of the SD card
+  void setRoot(std::string root) { this->root = std::move(root); }
+  std::string hostPath(const char* path) const;
+
+  // Makes every file write take `latencyUs` plus the time to move the data at `bytesPerSecond`, like a card would,
+  // for measuring code that overlaps card writes with other work. 0 turns either part off.
+  void simulateCardWrites(const uint32_t latencyUs, const uint32_t bytesPerSecond) {
+    writeLatencyUs = latencyUs;
+    writeBytesPerSecond = bytesPerSecond;
+  }
+  uint32_t writeLatencyUs = 0;
+  uint32_t writeBytesPerSecond = 0;
+
+  bool begin() { return true; }
+  bool ready() const { return true; }
+
+  FsFile open(const char* path, oflag_t oflag = O_RDONLY);
+  bool mkdir(const char* path, bool pFlag = true);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rmdir(const char* path);
+  bool rename(const char* oldPath, const char* newPath);
+
+  bool openFileForRead(const char* moduleName, const char* path, FsFile& file);
+  bool openFileForRead(const char* moduleName, const std::string& path, FsFile& file) {
+    return openFileForRead(moduleName, path.c_str(), file);
+  }
+  bool openFileForWrite(const char* moduleName, const char* path, FsFile& file);
+  bool openFileForWrite(const char* moduleName, const std::string& path, FsFile& file) {
+    return openFileForWrite(moduleName, path.c_str(), file);
+  }
+  bool removeDir(const char* path);
+
+  static HalStorage& getInstance() { return instance; }
+
+ private:
+  static HalStorage instance;
+
+  std::string root = ".";
+};
+
+#define Storage HalStorage::getInstance()
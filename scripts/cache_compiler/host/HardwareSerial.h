@@ -0,0 +1,33 @@
+#pragma once
+
+// Host stand-in for the Arduino serial log and clock. The firmware logs a lot while building caches, so the log is
+// off unless a tool runs with --verbose.
+
+// The serial header brings in the whole core on the device as well
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+inline unsigned long millis() {
+  static const auto start = std::chrono::steady_clock::now();
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+struct HostSerial {
+  bool quiet = true;
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    if (quiet) {
+      return;
+    }
+    // One vfprintf per line, stdio keeps lines from different threads apart
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+  }
+};
+
+inline HostSerial Serial;
@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for the Arduino Print interface, the byte sink the firmware streams book contents and images into
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+      written++;
+    }
+    return written;
+  }
+  virtual void flush() {}
+};
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host stand-in for the SD card driver header, FsFile comes from the HalStorage stand-in
+#include <HalStorage.h>
@@ -0,0 +1,23 @@
+#pragma once
+
+// Host stand-in for the Arduino Stream interface: a Print sink that can also be read from
+
+#include <Print.h>
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  virtual size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      const int c = read();
+      if (c < 0) {
+        break;
+      }
+      buffer[count++] = static_cast<uint8_t>(c);
+    }
+    return count;
+  }
+};
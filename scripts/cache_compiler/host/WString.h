@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for Arduino's String, just what util/StringUtils.h and the network code need
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+class String {
+  std::string value;
+
+ public:
+  String(const char* text = "") : value(text) {}
+  size_t length() const { return value.size(); }
+  const char* c_str() const { return value.c_str(); }
+  void toLowerCase() {
+    std::transform(value.begin(), value.end(), value.begin(), [](const unsigned char c) { return std::tolower(c); });
+  }
+  bool endsWith(const String& suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+  }
+  friend String operator+(const char* lhs, const String& rhs) { return String((lhs + rhs.value).c_str()); }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for the ESP32 flash access macros, flash and RAM are the same address space on a PC
+
+#include <cstdint>
+#include <cstring>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t*>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t*>(addr))
+#define pgm_read_ptr(addr) (*reinterpret_cast<const void* const*>(addr))
+#define memcpy_P memcpy
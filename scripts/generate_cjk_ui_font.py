@@ -32,7 +32,7 @@ abcdefghijklmnopqrstuvwxyz|«»
 简体中文日本語启动休眠进入浏览件传输设置书库继续阅读无打开的籍从下方始未找到选择章节已末空索引内存错误页面加载超出范围失败卡网络个扫描连接时忘记保密码删除按确定重新任意键左右认式创建热点现有供他人模将备此在器或用手机维线地址作为检查字正搜等待指令试断收更多容需要显示控制系统屏幕封状态栏隐藏电量百分比段落额外间距抗锯齿源短向前钮布局侧边长跳转大小行母数汉颜色对齐符刷频率同步语言壁纸清理缓户名服务档匹配证请先凭据成功就绪完这所度丢当再次项看串口了解详情深浅自义适应裁剪整不终忽略翻竖横顺针倒逆返回上特紧凑常宽松两端居钟版可是最禁条目命获取订析退主切换消否关写起動覧転送設続読開書見選択終込範囲敗削押確認法参既暗号化済力検機試受信必画隠追間隔電側長漢余白時頻期紙去証初報利能進捗項詳細無視縦計反戻狭普通広両揃え央現部蔵効題得替決
 远程本应置账户配来自
 リモートローカルセクションアップロード元
-仅付位修光典刻含哈埋复射嵌希提映样滤界移算经缩褪计过近適镜阳题首（）
+仅付位修光典刻含哈埋复射嵌希提映样滤界移算经缩褪计过近適镜阳题首（）者著致结果結表
 """
 
 # Extract unique characters
@@ -0,0 +1,354 @@
+#include "BookCacheManager.h"
+
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "CrossPointSettings.h"
+
+namespace {
+constexpr uint8_t CACHE_INDEX_FILE_VERSION = 1;
+constexpr char CACHE_ROOT[] = "/.crosspoint";
+constexpr char CACHE_INDEX_FILE[] = "/.crosspoint/cache.idx";
+constexpr uint8_t NEVER_EVICTED = 0xFF;
+
+struct IndexHeader {
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t accessCounter;
+};
+static_assert(sizeof(IndexHeader) == 8, "Cache index header must stay 8 bytes");
+
+bool isBookCacheDirectory(const char* name) {
+  return strncmp(name, "epub_", 5) == 0 || strncmp(name, "xtc_", 4) == 0 || strncmp(name, "txt_", 4) == 0;
+}
+
+bool startsWith(const char* name, const char* prefix) { return strncmp(name, prefix, strlen(prefix)) == 0; }
+
+bool endsWith(const char* name, const char* suffix) {
+  const size_t nameLength = strlen(name);
+  const size_t suffixLength = strlen(suffix);
+  return nameLength >= suffixLength && strcmp(name + nameLength - suffixLength, suffix) == 0;
+}
+
+// Stage at which an entry of a book cache directory is removed
+uint8_t removalStage(const char* name, const bool isDirectory) {
+  if (isDirectory) {
+    // sections/ holds the laid-out chapters and their search indexes
+    return strcmp(name, "sections") == 0 ? BookCacheManager::STAGE_NO_LAYOUT : BookCacheManager::STAGE_ONLY_COVERS;
+  }
+  // sleep_*.bin are pre-rendered sleep screens of the cover
+  if (startsWith(name, ".tmp") || startsWith(name, "sleep_") || strcmp(name, "css_rules.cache") == 0 ||
+      strcmp(name, "index.bin") == 0) {
+    return BookCacheManager::STAGE_NO_LAYOUT;
+  }
+  if (endsWith(name, ".bmp") && (startsWith(name, "cover") || startsWith(name, "thumb_"))) {
+    return BookCacheManager::STAGE_EVICTED;
+  }
+  // Reading position saved by firmware from before the progress journal
+  if (strcmp(name, "progress.bin") == 0) {
+    return NEVER_EVICTED;
+  }
+  return BookCacheManager::STAGE_ONLY_COVERS;
+}
+
+// Sum of the file sizes in `path`, descending `depth` levels of subdirectories
+uint64_t directorySize(const std::string& path, const int depth) {
+  auto dir = Storage.open(path.c_str());
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return 0;
+  }
+
+  uint64_t total = 0;
+  char name[128];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    if (!file.isDirectory()) {
+      total += file.size();
+    } else if (depth > 0) {
+      file.getName(name, sizeof(name));
+      file.close();
+      total += directorySize(path + "/" + name, depth - 1);
+      continue;
+    }
+    file.close();
+  }
+  dir.close();
+  return total;
+}
+}  // namespace
+
+BookCacheManager BookCacheManager::instance;
+
+BookCacheManager::Entry* BookCacheManager::find(const char* name) {
+  const auto it =
+      std::find_if(entries.begin(), entries.end(), [name](const Entry& e) { return strcmp(e.name, name) == 0; });
+  return it == entries.end() ? nullptr : &*it;
+}
+
+void BookCacheManager::load() {
+  loaded = true;
+  entries.clear();
+  accessCounter = 0;
+
+  FsFile file;
+  if (!Storage.exists(CACHE_INDEX_FILE) || !Storage.openFileForRead("BCM", CACHE_INDEX_FILE, file)) {
+    return;
+  }
+
+  IndexHeader header{};
+  serialization::readPod(file, header);
+  if (header.version != CACHE_INDEX_FILE_VERSION) {
+    Serial.printf("[%lu] [BCM] Unknown cache index version %u, will be recreated\n", millis(), header.version);
+    file.close();
+    return;
+  }
+
+  const size_t count = (file.size() - sizeof(IndexHeader)) / sizeof(Entry);
+  entries.resize(count);
+  const int bytesRead = file.read(reinterpret_cast<uint8_t*>(entries.data()), count * sizeof(Entry));
+  file.close();
+  entries.resize(bytesRead > 0 ? static_cast<size_t>(bytesRead) / sizeof(Entry) : 0);
+  for (auto& entry : entries) {
+    entry.name[NAME_LENGTH - 1] = '\0';
+  }
+  accessCounter = header.accessCounter;
+}
+
+bool BookCacheManager::save() {
+  dirty = false;
+  Storage.mkdir(CACHE_ROOT);
+
+  FsFile file;
+  if (!Storage.openFileForWrite("BCM", CACHE_INDEX_FILE, file)) {
+    return false;
+  }
+
+  IndexHeader header{};
+  header.version = CACHE_INDEX_FILE_VERSION;
+  header.accessCounter = accessCounter;
+  serialization::writePod(file, header);
+  const size_t bytes = entries.size() * sizeof(Entry);
+  const size_t written = file.write(reinterpret_cast<const uint8_t*>(entries.data()), bytes);
+  file.close();
+  if (written != bytes) {
+    Serial.printf("[%lu] [BCM] Failed to write cache index\n", millis());
+    return false;
+  }
+  return true;
+}
+
+void BookCacheManager::touch(const std::string& cachePath) {
+  if (!loaded) {
+    load();
+  }
+
+  const std::string name = cachePath.substr(cachePath.find_last_of('/') + 1);
+  if (name.size() >= NAME_LENGTH) {
+    Serial.printf("[%lu] [BCM] Cache directory name too long: %s\n", millis(), name.c_str());
+    return;
+  }
+
+  Entry* entry = find(name.c_str());
+  if (!entry) {
+    entries.push_back({});
+    entry = &entries.back();
+    strncpy(entry->name, name.c_str(), NAME_LENGTH - 1);
+  }
+  entry->lastAccess = ++accessCounter;
+  // The reader rebuilds whatever it needs, the new size is measured later
+  entry->stage = STAGE_FULL;
+  entry->flags |= FLAG_STALE;
+  save();
+}
+
+void BookCacheManager::invalidate() { scanned = false; }
+
+void BookCacheManager::scanCacheRoot() {
+  scanned = true;
+
+  auto root = Storage.open(CACHE_ROOT);
+  if (!root || !root.isDirectory()) {
+    if (root) root.close();
+    if (!entries.empty()) {
+      entries.clear();
+      dirty = true;
+    }
+    return;
+  }
+
+  std::vector<bool> seen(entries.size(), false);
+  char name[128];
+  for (auto file = root.openNextFile(); file; file = root.openNextFile()) {
+    const bool isDirectory = file.isDirectory();
+    file.getName(name, sizeof(name));
+    file.close();
+    if (!isDirectory || !isBookCacheDirectory(name) || strlen(name) >= NAME_LENGTH) {
+      continue;
+    }
+
+    const auto it =
+        std::find_if(entries.begin(), entries.end(), [&name](const Entry& e) { return strcmp(e.name, name) == 0; });
+    if (it != entries.end()) {
+      seen[it - entries.begin()] = true;
+      continue;
+    }
+    // Caches from before the index, or written by other firmware: oldest of all
+    Entry entry{};
+    strncpy(entry.name, name, NAME_LENGTH - 1);
+    entry.flags = FLAG_STALE;
+    entries.push_back(entry);
+    seen.push_back(true);
+    dirty = true;
+  }
+  root.close();
+
+  size_t kept = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (seen[i]) {
+      entries[kept++] = entries[i];
+    }
+  }
+  if (kept != entries.size()) {
+    entries.resize(kept);
+    dirty = true;
+  }
+  Serial.printf("[%lu] [BCM] %u book caches\n", millis(), static_cast<unsigned>(entries.size()));
+}
+
+void BookCacheManager::measure(Entry& entry) const {
+  const uint64_t size = directorySize(std::string(CACHE_ROOT) + "/" + entry.name, 1);
+  entry.size = static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX));
+  entry.flags &= ~FLAG_STALE;
+}
+
+uint64_t BookCacheManager::totalSize() const {
+  uint64_t total = 0;
+  for (const auto& entry : entries) {
+    total += entry.size;
+  }
+  return total;
+}
+
+bool BookCacheManager::overQuota() const {
+  const uint64_t quota = SETTINGS.getCacheQuotaBytes();
+  return quota > 0 && totalSize() > quota;
+}
+
+int BookCacheManager::nextEvictionCandidate(uint8_t& targetStage) const {
+  uint32_t newest = 0;
+  for (const auto& entry : entries) {
+    newest = std::max(newest, entry.lastAccess);
+  }
+
+  // Layout caches of all books go before any metadata, covers go last
+  for (uint8_t stage = STAGE_NO_LAYOUT; stage <= STAGE_EVICTED; stage++) {
+    int best = -1;
+    for (size_t i = 0; i < entries.size(); i++) {
+      const Entry& entry = entries[i];
+      if (entry.stage >= stage || (newest > 0 && entry.lastAccess == newest)) {
+        continue;
+      }
+      if (best < 0 || entry.lastAccess < entries[best].lastAccess) {
+        best = static_cast<int>(i);
+      }
+    }
+    if (best >= 0) {
+      targetStage = stage;
+      return best;
+    }
+  }
+  return -1;
+}
+
+void BookCacheManager::evict(const size_t index, const uint8_t targetStage) {
+  Entry& entry = entries[index];
+  const std::string dirPath = std::string(CACHE_ROOT) + "/" + entry.name;
+  dirty = true;
+
+  auto dir = Storage.open(dirPath.c_str());
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    entries.erase(entries.begin() + index);
+    return;
+  }
+
+  // Collect first, removing while iterating the directory is not safe
+  std::vector<std::pair<std::string, bool>> doomed;
+  char name[128];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    const bool isDirectory = file.isDirectory();
+    file.getName(name, sizeof(name));
+    file.close();
+    if (removalStage(name, isDirectory) <= targetStage) {
+      doomed.emplace_back(dirPath + "/" + name, isDirectory);
+    }
+  }
+  dir.close();
+
+  for (const auto& item : doomed) {
+    const bool removed = item.second ? Storage.removeDir(item.first.c_str()) : Storage.remove(item.first.c_str());
+    if (!removed) {
+      Serial.printf("[%lu] [BCM] Failed to remove %s\n", millis(), item.first.c_str());
+    }
+  }
+
+  const uint32_t before = entry.size;
+  entry.stage = targetStage;
+  measure(entry);
+  Serial.printf("[%lu] [BCM] Evicted %s to stage %u, %u -> %u bytes\n", millis(), entry.name,
+                static_cast<unsigned>(targetStage), static_cast<unsigned>(before), static_cast<unsigned>(entry.size));
+
+  if (targetStage == STAGE_EVICTED && entry.size == 0 && Storage.rmdir(dirPath.c_str())) {
+    entries.erase(entries.begin() + index);
+  }
+}
+
+bool BookCacheManager::hasPendingWork() const {
+  if (!loaded || !scanned || dirty) {
+    return true;
+  }
+  if (std::any_of(entries.begin(), entries.end(), [](const Entry& e) { return e.flags & FLAG_STALE; })) {
+    return true;
+  }
+  uint8_t targetStage;
+  return overQuota() && nextEvictionCandidate(targetStage) >= 0;
+}
+
+bool BookCacheManager::runStep() {
+  if (!loaded) {
+    load();
+    return true;
+  }
+  if (!scanned) {
+    scanCacheRoot();
+    return true;
+  }
+
+  for (auto& entry : entries) {
+    if (entry.flags & FLAG_STALE) {
+      measure(entry);
+      dirty = true;
+      return true;
+    }
+  }
+
+  if (overQuota()) {
+    uint8_t targetStage;
+    const int index = nextEvictionCandidate(targetStage);
+    if (index >= 0) {
+      evict(index, targetStage);
+      return true;
+    }
+  }
+
+  if (dirty) {
+    save();
+    Serial.printf("[%lu] [BCM] Book caches use %llu bytes\n", millis(), static_cast<unsigned long long>(totalSize()));
+    return true;
+  }
+  return false;
+}
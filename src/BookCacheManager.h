@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Keeps the per-book cache directories in /.crosspoint (epub_<hash>, xtc_<hash>, txt_<hash>) within the SD quota
+ * selected in the settings.
+ *
+ * A small index (/.crosspoint/cache.idx) records the size and last access of every book cache. Readers report the
+ * book they open through touch(), which marks its size for re-measuring. The actual work happens in runStep(), one
+ * directory listing, measurement or eviction per call, which callers run while the UI is idle.
+ *
+ * When the caches are over quota the least recently read books lose their laid-out sections, CSS and page index
+ * caches first (cheap to rebuild on the next open), then their metadata, and only after that their cover and
+ * thumbnail images. The most recently read book is never evicted.
+ */
+class BookCacheManager {
+ public:
+  // How much of a book cache is left, each stage also removes everything of the earlier ones
+  enum Stage : uint8_t {
+    STAGE_FULL = 0,
+    STAGE_NO_LAYOUT = 1,    // Sections, search indexes, CSS, TXT page caches and sleep screens removed
+    STAGE_ONLY_COVERS = 2,  // book.bin and other metadata removed
+    STAGE_EVICTED = 3,      // Covers and thumbnails removed
+  };
+
+  static constexpr uint8_t FLAG_STALE = 0x01;  // Size has to be measured again
+
+  static constexpr size_t NAME_LENGTH = 20;
+
+  // On-disk entry in cache.idx, one per book cache directory
+  struct Entry {
+    char name[NAME_LENGTH];  // Directory name inside /.crosspoint
+    uint32_t lastAccess;     // Monotonic access counter, 0 if never opened since the index exists
+    uint32_t size;           // Bytes, valid unless FLAG_STALE is set
+    uint8_t stage;
+    uint8_t flags;
+    uint16_t reserved;
+  };
+  static_assert(sizeof(Entry) == 32, "Cache index entries must stay 32 bytes");
+
+ private:
+  // Static instance
+  static BookCacheManager instance;
+
+  std::vector<Entry> entries;
+  uint32_t accessCounter = 0;
+  bool loaded = false;
+  bool scanned = false;
+  bool dirty = false;
+
+  void load();
+  bool save();
+  Entry* find(const char* name);
+  void scanCacheRoot();
+  void measure(Entry& entry) const;
+  // Least recently read entry that can still be evicted further, -1 if there is none
+  int nextEvictionCandidate(uint8_t& targetStage) const;
+  void evict(size_t index, uint8_t targetStage);
+  bool overQuota() const;
+
+ public:
+  ~BookCacheManager() = default;
+
+  // Get singleton instance
+  static BookCacheManager& getInstance() { return instance; }
+
+  // Record that the book with this cache directory was opened
+  void touch(const std::string& cachePath);
+  // Forget what is known about the cache directories, e.g. after they were removed behind our back
+  void invalidate();
+
+  uint64_t totalSize() const;
+
+  // Background maintenance, one step per call. Returns false if there was nothing to do.
+  bool hasPendingWork() const;
+  bool runStep();
+};
+
+// Helper macro to access the book cache manager
+#define BOOK_CACHE BookCacheManager::getInstance()
@@ -0,0 +1,227 @@
+#include "BookPreparer.h"
+
+#include <Arduino.h>
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <GfxRenderer.h>
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "BookCacheManager.h"
+#include "CrossPointSettings.h"
+#include "activities/reader/EpubReaderLayout.h"
+#include "components/UITheme.h"
+#include "util/StringUtils.h"
+
+namespace {
+constexpr uint8_t QUEUE_FILE_VERSION = 1;
+constexpr char CACHE_ROOT[] = "/.crosspoint";
+constexpr char QUEUE_FILE[] = "/.crosspoint/prepare.queue";
+
+const char* stepName(const uint8_t step) {
+  switch (step) {
+    case BookPreparer::STEP_METADATA:
+      return "metadata";
+    case BookPreparer::STEP_THUMBNAIL:
+      return "thumbnail";
+    case BookPreparer::STEP_COVER:
+      return "cover";
+    case BookPreparer::STEP_FIRST_SECTION:
+    default:
+      return "first section";
+  }
+}
+
+// Lays out the chapter the reader opens the book at, as EpubReaderActivity would with the current settings
+bool buildFirstSection(const std::shared_ptr<Epub>& epub, GfxRenderer& renderer,
+                       const std::function<bool()>& shouldAbort) {
+  // The viewport depends on the reader's orientation, which the screen running this doesn't necessarily use
+  const auto screenOrientation = renderer.getOrientation();
+  EpubReaderLayout::applyReaderOrientation(renderer, SETTINGS.orientation);
+  const auto margins = EpubReaderLayout::pageMargins(renderer, SETTINGS, UITheme::getInstance().getMetrics());
+  const uint16_t viewportWidth = EpubReaderLayout::viewportWidth(renderer, margins);
+  const uint16_t viewportHeight = EpubReaderLayout::viewportHeight(renderer, margins);
+  renderer.setOrientation(screenOrientation);
+
+  Section section(epub, epub->getSpineIndexForTextReference(), renderer);
+  if (section.loadSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
+                              SETTINGS.extraParagraphSpacing, SETTINGS.paragraphAlignment, viewportWidth,
+                              viewportHeight, SETTINGS.hyphenationEnabled, SETTINGS.firstLineIndent,
+                              SETTINGS.embeddedStyle)) {
+    return true;
+  }
+  return section.createSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
+                                   SETTINGS.extraParagraphSpacing, SETTINGS.paragraphAlignment, viewportWidth,
+                                   viewportHeight, SETTINGS.hyphenationEnabled, SETTINGS.firstLineIndent,
+                                   SETTINGS.embeddedStyle, nullptr, SETTINGS.searchIndex, shouldAbort);
+}
+}  // namespace
+
+BookPreparer BookPreparer::instance;
+
+void BookPreparer::load() {
+  loaded = true;
+  jobs.clear();
+
+  FsFile file;
+  if (!Storage.exists(QUEUE_FILE) || !Storage.openFileForRead("BPQ", QUEUE_FILE, file)) {
+    return;
+  }
+
+  uint8_t version = 0;
+  uint8_t count = 0;
+  serialization::readPod(file, version);
+  serialization::readPod(file, count);
+  if (version != QUEUE_FILE_VERSION) {
+    Serial.printf("[%lu] [BPQ] Unknown queue version %u, dropped\n", millis(), version);
+    file.close();
+    return;
+  }
+
+  for (uint8_t i = 0; i < count && i < MAX_QUEUED && file.available(); i++) {
+    Job job{};
+    serialization::readString(file, job.path);
+    serialization::readPod(file, job.step);
+    serialization::readPod(file, job.attempts);
+    if (job.path.empty() || job.step >= STEP_DONE) {
+      break;
+    }
+    jobs.push_back(std::move(job));
+  }
+  file.close();
+  Serial.printf("[%lu] [BPQ] %u books to prepare\n", millis(), static_cast<unsigned>(jobs.size()));
+}
+
+bool BookPreparer::save() const {
+  if (jobs.empty()) {
+    if (Storage.exists(QUEUE_FILE)) {
+      Storage.remove(QUEUE_FILE);
+    }
+    return true;
+  }
+
+  Storage.mkdir(CACHE_ROOT);
+  FsFile file;
+  if (!Storage.openFileForWrite("BPQ", QUEUE_FILE, file)) {
+    return false;
+  }
+  serialization::writePod(file, QUEUE_FILE_VERSION);
+  serialization::writePod(file, static_cast<uint8_t>(jobs.size()));
+  for (const auto& job : jobs) {
+    serialization::writeString(file, job.path);
+    serialization::writePod(file, job.step);
+    serialization::writePod(file, job.attempts);
+  }
+  if (!file.close()) {
+    Serial.printf("[%lu] [BPQ] Failed to write queue\n", millis());
+    return false;
+  }
+  return true;
+}
+
+void BookPreparer::enqueue(const std::string& path) {
+  if (!SETTINGS.prepareUploads || !StringUtils::checkFileExtension(path, ".epub")) {
+    return;
+  }
+  if (!loaded) {
+    load();
+  }
+
+  // Replaced by a new upload: whatever was prepared belongs to the old file
+  const auto it = std::find_if(jobs.begin(), jobs.end(), [&path](const Job& job) { return job.path == path; });
+  if (it != jobs.end()) {
+    it->step = STEP_METADATA;
+    it->attempts = 0;
+  } else if (jobs.size() >= MAX_QUEUED) {
+    Serial.printf("[%lu] [BPQ] Queue full, not preparing %s\n", millis(), path.c_str());
+    return;
+  } else {
+    jobs.push_back({path, STEP_METADATA, 0});
+  }
+  save();
+}
+
+bool BookPreparer::hasPendingWork() const { return SETTINGS.prepareUploads && (!loaded || !jobs.empty()); }
+
+bool BookPreparer::runJobStep(const Job& job, GfxRenderer& renderer,
+                              const std::function<bool()>& shouldAbort) const {
+  auto epub = std::make_shared<Epub>(job.path, CACHE_ROOT);
+  // Builds book.bin and the CSS rules in the first step, later ones only read them
+  if (!epub->load(job.step == STEP_METADATA)) {
+    return false;
+  }
+
+  switch (job.step) {
+    case STEP_METADATA:
+      return true;
+    case STEP_THUMBNAIL:
+      // Books without a cover image are prepared all the same
+      epub->generateThumbBmp(UITheme::getInstance().getMetrics().homeCoverHeight);
+      return true;
+    case STEP_COVER:
+      if (SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER ||
+          SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER_CUSTOM) {
+        epub->generateCoverBmp(SETTINGS.sleepScreenCoverMode == CrossPointSettings::SLEEP_SCREEN_COVER_MODE::CROP);
+      }
+      return true;
+    case STEP_FIRST_SECTION:
+    default:
+      return buildFirstSection(epub, renderer, shouldAbort);
+  }
+}
+
+bool BookPreparer::runStep(GfxRenderer& renderer, const std::function<bool()>& shouldAbort) {
+  if (!loaded) {
+    load();
+    return true;
+  }
+  if (jobs.empty()) {
+    return false;
+  }
+  if (ESP.getMaxAllocHeap() < MIN_FREE_BLOCK) {
+    return false;
+  }
+
+  Job& job = jobs.front();
+  if (job.attempts >= MAX_ATTEMPTS) {
+    Serial.printf("[%lu] [BPQ] Giving up on %s, %s step was interrupted %u times\n", millis(), job.path.c_str(),
+                  stepName(job.step), job.attempts);
+    jobs.erase(jobs.begin());
+    save();
+    return true;
+  }
+  // Recorded first, so a step that takes the device down is not retried forever
+  job.attempts++;
+  save();
+
+  const unsigned long start = millis();
+  bool aborted = false;
+  const bool success = runJobStep(job, renderer, [&shouldAbort, &aborted] {
+    aborted = aborted || (shouldAbort && shouldAbort());
+    return aborted;
+  });
+  if (aborted) {
+    Serial.printf("[%lu] [BPQ] %s of %s stopped for input after %lu ms\n", millis(), stepName(job.step),
+                  job.path.c_str(), millis() - start);
+    // Not the step's fault, it starts over next time
+    job.attempts = 0;
+    save();
+    return true;
+  }
+  Serial.printf("[%lu] [BPQ] %s of %s: %s in %lu ms\n", millis(), stepName(job.step), job.path.c_str(),
+                success ? "done" : "failed", millis() - start);
+
+  job.attempts = 0;
+  job.step++;
+  if (!success || job.step >= STEP_DONE) {
+    jobs.erase(jobs.begin());
+    // The cache manager only looks for new book caches when it scans again
+    BOOK_CACHE.invalidate();
+  }
+  save();
+  return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class GfxRenderer;
+
+/**
+ * Builds the caches of newly uploaded EPUBs before they are first opened: book.bin and the CSS rules, the home screen
+ * thumbnail, the sleep screen cover when the sleep screen shows one, and the chapter the reader opens at, laid out for
+ * the current reader settings.
+ *
+ * The web server queues every EPUB it receives through enqueue(). The queue lives in /.crosspoint/prepare.queue and
+ * records how far each book got, so work cut short by leaving the screen or a reboot continues where it stopped.
+ * runStep() does one step of the first book per call; callers run it while the UI and the web server are idle. Laying
+ * out the first chapter stops as soon as `shouldAbort` returns true and starts over in a later call. A step the device
+ * didn't survive twice is skipped together with the rest of its book.
+ */
+class BookPreparer {
+ public:
+  enum Step : uint8_t {
+    STEP_METADATA = 0,  // book.bin and CSS rules
+    STEP_THUMBNAIL = 1,
+    STEP_COVER = 2,
+    STEP_FIRST_SECTION = 3,
+    STEP_DONE = 4,
+  };
+
+  static constexpr size_t MAX_QUEUED = 32;
+  static constexpr uint8_t MAX_ATTEMPTS = 2;
+  // Largest free heap block a step needs to start, the ZIP inflater's dictionary alone is one 32 KB block
+  static constexpr uint32_t MIN_FREE_BLOCK = 40 * 1024;
+  // Quiet time of the web server before books are prepared next to it
+  static constexpr unsigned long SERVER_IDLE_MS = 5000;
+  // Time without input before books are prepared behind a screen in use, the steps block its input handling
+  static constexpr unsigned long UI_IDLE_MS = 5000;
+
+ private:
+  struct Job {
+    std::string path;
+    uint8_t step;
+    uint8_t attempts;  // Starts of the current step, counted before it runs
+  };
+
+  // Static instance
+  static BookPreparer instance;
+
+  std::vector<Job> jobs;
+  bool loaded = false;
+
+  void load();
+  bool save() const;
+  // Runs `step` of the first book. False if the book can't be prepared.
+  bool runJobStep(const Job& job, GfxRenderer& renderer, const std::function<bool()>& shouldAbort) const;
+
+ public:
+  ~BookPreparer() = default;
+
+  // Get singleton instance
+  static BookPreparer& getInstance() { return instance; }
+
+  // Queue a book that was just written to the card, from the start if it is queued already. Only EPUBs are
+  // prepared, and nothing is queued while "Prepare Uploaded Books" is off.
+  void enqueue(const std::string& path);
+
+  // Background work, one step per call. Returns false if there was nothing to do or not enough heap for it.
+  bool hasPendingWork() const;
+  bool runStep(GfxRenderer& renderer, const std::function<bool()>& shouldAbort = nullptr);
+};
+
+// Helper macro to access the book preparer
+#define BOOK_PREPARER BookPreparer::getInstance()
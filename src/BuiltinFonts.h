@@ -0,0 +1,7 @@
+#pragma once
+
+class GfxRenderer;
+
+// Register the fonts compiled into the firmware under their ids from fontIds.h. Reader fonts other than Bookerly 14
+// are left out when building with OMIT_FONTS.
+void registerBuiltinFonts(GfxRenderer& renderer);
@@ -12,7 +12,7 @@
 // Initialize the static instance
 CrossPointSettings CrossPointSettings::instance;
 
-void readAndValidate(FsFile& file, uint8_t& member, const uint8_t maxValue) {
+void readAndValidate(BufferedFile& file, uint8_t& member, const uint8_t maxValue) {
   uint8_t tempValue;
   serialization::readPod(file, tempValue);
   if (tempValue < maxValue) {
@@ -23,7 +23,7 @@ void readAndValidate(FsFile& file, uint8_t& member, const uint8_t maxValue) {
 namespace {
 constexpr uint8_t SETTINGS_FILE_VERSION = 1;
 // Increment this when adding new persisted settings fields
-constexpr uint8_t SETTINGS_COUNT = 33;
+constexpr uint8_t SETTINGS_COUNT = 38;
 constexpr char SETTINGS_FILE[] = "/.crosspoint/settings.bin";
 
 // Validate front button mapping to ensure each hardware button is unique.
@@ -82,10 +82,11 @@ bool CrossPointSettings::saveToFile() const {
   // Make sure the directory exists
   Storage.mkdir("/.crosspoint");
 
-  FsFile outputFile;
-  if (!Storage.openFileForWrite("CPS", SETTINGS_FILE, outputFile)) {
+  FsFile file;
+  if (!Storage.openFileForWrite("CPS", SETTINGS_FILE, file)) {
     return false;
   }
+  BufferedFile outputFile(file);
 
   serialization::writePod(outputFile, SETTINGS_FILE_VERSION);
   serialization::writePod(outputFile, SETTINGS_COUNT);
@@ -123,17 +124,26 @@ bool CrossPointSettings::saveToFile() const {
   serialization::writePod(outputFile, uiOrientation);
   serialization::writePod(outputFile, firstLineIndent);
   serialization::writePod(outputFile, colorMode);
-  outputFile.close();
+  serialization::writePod(outputFile, searchIndex);
+  serialization::writePod(outputFile, cacheQuota);
+  serialization::writePod(outputFile, skimPageTurns);
+  serialization::writePod(outputFile, prepareUploads);
+  serialization::writePod(outputFile, opdsOffline);
+  if (!outputFile.close()) {
+    Serial.printf("[%lu] [CPS] Failed to write settings\n", millis());
+    return false;
+  }
 
   Serial.printf("[%lu] [CPS] Settings saved to file\n", millis());
   return true;
 }
 
 bool CrossPointSettings::loadFromFile() {
-  FsFile inputFile;
-  if (!Storage.openFileForRead("CPS", SETTINGS_FILE, inputFile)) {
+  FsFile file;
+  if (!Storage.openFileForRead("CPS", SETTINGS_FILE, file)) {
     return false;
   }
+  BufferedFile inputFile(file);
 
   uint8_t version;
   serialization::readPod(inputFile, version);
@@ -234,6 +244,16 @@ bool CrossPointSettings::loadFromFile() {
     if (++settingsRead >= fileSettingsCount) break;
     serialization::readPod(inputFile, colorMode);
     if (++settingsRead >= fileSettingsCount) break;
+    serialization::readPod(inputFile, searchIndex);
+    if (++settingsRead >= fileSettingsCount) break;
+    readAndValidate(inputFile, cacheQuota, CACHE_QUOTA_COUNT);
+    if (++settingsRead >= fileSettingsCount) break;
+    serialization::readPod(inputFile, skimPageTurns);
+    if (++settingsRead >= fileSettingsCount) break;
+    serialization::readPod(inputFile, prepareUploads);
+    if (++settingsRead >= fileSettingsCount) break;
+    serialization::readPod(inputFile, opdsOffline);
+    if (++settingsRead >= fileSettingsCount) break;
   } while (false);
 
   if (frontButtonMappingRead) {
@@ -315,6 +335,25 @@ int CrossPointSettings::getRefreshFrequency() const {
   }
 }
 
+uint64_t CrossPointSettings::getCacheQuotaBytes() const {
+  constexpr uint64_t MB = 1024 * 1024;
+  switch (cacheQuota) {
+    case CACHE_QUOTA_UNLIMITED:
+      return 0;
+    case CACHE_QUOTA_64MB:
+      return 64 * MB;
+    case CACHE_QUOTA_128MB:
+      return 128 * MB;
+    case CACHE_QUOTA_256MB:
+    default:
+      return 256 * MB;
+    case CACHE_QUOTA_512MB:
+      return 512 * MB;
+    case CACHE_QUOTA_1GB:
+      return 1024 * MB;
+  }
+}
+
 int CrossPointSettings::getReaderFontId() const {
   const FontManager& fm = FontManager::getInstance();
   if (fm.isExternalFontEnabled()) {
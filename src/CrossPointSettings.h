@@ -127,6 +127,17 @@ class CrossPointSettings {
   // Color mode (light/dark)
   enum COLOR_MODE { LIGHT_MODE = 0, DARK_MODE = 1 };
 
+  // SD space for book caches before the least recently read ones are evicted
+  enum CACHE_QUOTA {
+    CACHE_QUOTA_UNLIMITED = 0,
+    CACHE_QUOTA_64MB = 1,
+    CACHE_QUOTA_128MB = 2,
+    CACHE_QUOTA_256MB = 3,
+    CACHE_QUOTA_512MB = 4,
+    CACHE_QUOTA_1GB = 5,
+    CACHE_QUOTA_COUNT
+  };
+
   // Sleep screen settings
   uint8_t sleepScreen = DARK;
   // Sleep screen cover mode settings
@@ -188,6 +199,16 @@ class CrossPointSettings {
   uint8_t firstLineIndent = 0;
   // Color mode (light/dark) for reader
   uint8_t colorMode = LIGHT_MODE;
+  // Build a full-text search index alongside each laid-out chapter
+  uint8_t searchIndex = 1;
+  // Book cache quota
+  uint8_t cacheQuota = CACHE_QUOTA_256MB;
+  // Show pages turned in quick succession with fast black and white refreshes only
+  uint8_t skimPageTurns = 0;
+  // Build the caches of books received over the web server in the background
+  uint8_t prepareUploads = 1;
+  // Browse OPDS catalogues from the feed cache only, without connecting to Wi-Fi
+  uint8_t opdsOffline = 0;
 
   ~CrossPointSettings() = default;
 
@@ -206,6 +227,8 @@ class CrossPointSettings {
   float getReaderLineCompression() const;
   unsigned long getSleepTimeoutMs() const;
   int getRefreshFrequency() const;
+  // 0 when unlimited
+  uint64_t getCacheQuotaBytes() const;
 };
 
 // Helper macro to access settings
@@ -0,0 +1,702 @@
+#include "LibraryCatalog.h"
+
+#include <Epub.h>
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+#include <Xtc.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "ProgressJournal.h"
+#include "util/StringUtils.h"
+
+namespace {
+constexpr uint8_t LIBRARY_CATALOG_FILE_VERSION = 1;
+constexpr char LIBRARY_RECORDS_FILE[] = "/.crosspoint/library.bin";
+constexpr char LIBRARY_INDEX_FILE[] = "/.crosspoint/library.idx";
+constexpr size_t INDEX_HEADER_SIZE = 8;
+constexpr size_t INDEX_CHUNK_ENTRIES = 32;
+constexpr uint16_t MAX_SLOTS = 0xFFFF;
+
+using Record = LibraryCatalog::Record;
+using IndexEntry = LibraryCatalog::IndexEntry;
+
+// Copy into a fixed-size field without splitting a UTF-8 sequence. Returns false if the value was truncated.
+bool copyField(char* dest, const size_t capacity, const std::string& value) {
+  size_t length = std::min(value.size(), capacity - 1);
+  const bool truncated = length < value.size();
+  if (truncated) {
+    while (length > 0 && (static_cast<uint8_t>(value[length]) & 0xC0) == 0x80) {
+      length--;
+    }
+  }
+  memcpy(dest, value.data(), length);
+  memset(dest + length, 0, capacity - length);
+  return !truncated;
+}
+
+void makeSortKey(char* key, const char* text) {
+  memset(key, 0, LibraryCatalog::SORT_KEY_LENGTH);
+  for (size_t i = 0; i < LibraryCatalog::SORT_KEY_LENGTH && text[i] != '\0'; i++) {
+    key[i] = static_cast<char>(tolower(static_cast<unsigned char>(text[i])));
+  }
+}
+
+int compareKeys(const char* a, const char* b) { return memcmp(a, b, LibraryCatalog::SORT_KEY_LENGTH); }
+
+IndexEntry indexFromRecord(const Record& record, const uint32_t lastOpened) {
+  IndexEntry entry = {};
+  entry.pathHash = record.pathHash;
+  entry.dirHash = record.dirHash;
+  entry.lastOpened = lastOpened;
+  entry.flags = record.flags;
+  entry.progress = record.progress;
+  makeSortKey(entry.titleKey, record.title[0] != '\0' ? record.title : record.name);
+  makeSortKey(entry.authorKey, record.author);
+  return entry;
+}
+
+uint32_t getModifyStamp(FsFile& file) {
+  uint16_t date = 0;
+  uint16_t time = 0;
+  if (!file.getModifyDateTime(&date, &time)) {
+    return 0;
+  }
+  return (static_cast<uint32_t>(date) << 16) | time;
+}
+
+std::string parentDirectory(const std::string& path) {
+  const auto lastSlash = path.find_last_of('/');
+  if (lastSlash == std::string::npos || lastSlash == 0) {
+    return "/";
+  }
+  return path.substr(0, lastSlash);
+}
+
+std::string joinPath(const std::string& dirPath, const std::string& name) {
+  return dirPath == "/" ? "/" + name : dirPath + "/" + name;
+}
+
+bool readRecordAt(FsFile& file, const uint16_t slot, Record& record) {
+  if (!file.seek(static_cast<uint32_t>(slot) * sizeof(Record))) {
+    return false;
+  }
+  return file.read(reinterpret_cast<uint8_t*>(&record), sizeof(Record)) == sizeof(Record);
+}
+
+bool writeRecordAt(FsFile& file, const uint16_t slot, const Record& record) {
+  if (!file.seek(static_cast<uint32_t>(slot) * sizeof(Record))) {
+    return false;
+  }
+  return file.write(reinterpret_cast<const uint8_t*>(&record), sizeof(Record)) == sizeof(Record);
+}
+
+bool readIndexAt(FsFile& file, const uint16_t slot, IndexEntry& entry) {
+  if (!file.seek(INDEX_HEADER_SIZE + static_cast<uint32_t>(slot) * sizeof(IndexEntry))) {
+    return false;
+  }
+  return file.read(reinterpret_cast<uint8_t*>(&entry), sizeof(IndexEntry)) == sizeof(IndexEntry);
+}
+
+bool writeIndexAt(FsFile& file, const uint16_t slot, const IndexEntry& entry) {
+  if (!file.seek(INDEX_HEADER_SIZE + static_cast<uint32_t>(slot) * sizeof(IndexEntry))) {
+    return false;
+  }
+  return file.write(reinterpret_cast<const uint8_t*>(&entry), sizeof(IndexEntry)) == sizeof(IndexEntry);
+}
+
+uint16_t slotCountOf(FsFile& indexFile) {
+  const size_t size = indexFile.size();
+  if (size <= INDEX_HEADER_SIZE) {
+    return 0;
+  }
+  return static_cast<uint16_t>(std::min<size_t>((size - INDEX_HEADER_SIZE) / sizeof(IndexEntry), MAX_SLOTS));
+}
+
+// Stream the whole index in chunks, calling `visit` for every slot
+template <typename Visitor>
+bool forEachIndexEntry(Visitor visit) {
+  FsFile indexFile;
+  if (!Storage.openFileForRead("LCT", LIBRARY_INDEX_FILE, indexFile)) {
+    return false;
+  }
+  const uint16_t slotCount = slotCountOf(indexFile);
+  indexFile.seek(INDEX_HEADER_SIZE);
+
+  IndexEntry chunk[INDEX_CHUNK_ENTRIES];
+  uint16_t slot = 0;
+  while (slot < slotCount) {
+    const size_t wanted = std::min<size_t>(INDEX_CHUNK_ENTRIES, slotCount - slot);
+    const size_t bytes = indexFile.read(reinterpret_cast<uint8_t*>(chunk), wanted * sizeof(IndexEntry));
+    if (bytes != wanted * sizeof(IndexEntry)) {
+      break;
+    }
+    for (size_t i = 0; i < wanted; i++, slot++) {
+      visit(slot, chunk[i]);
+    }
+  }
+  indexFile.close();
+  return true;
+}
+}  // namespace
+
+LibraryCatalog LibraryCatalog::instance;
+
+uint32_t LibraryCatalog::hashPath(const std::string& path) {
+  return static_cast<uint32_t>(std::hash<std::string>{}(path));
+}
+
+std::string LibraryCatalog::normalizeDirectory(const std::string& dirPath) {
+  std::string normalized = dirPath.empty() ? "/" : dirPath;
+  while (normalized.size() > 1 && normalized.back() == '/') {
+    normalized.pop_back();
+  }
+  return normalized;
+}
+
+bool LibraryCatalog::isSupportedBook(const std::string& fileName) {
+  return StringUtils::checkFileExtension(fileName, ".epub") || StringUtils::checkFileExtension(fileName, ".xtch") ||
+         StringUtils::checkFileExtension(fileName, ".xtc") || StringUtils::checkFileExtension(fileName, ".txt") ||
+         StringUtils::checkFileExtension(fileName, ".md");
+}
+
+bool LibraryCatalog::ensureFiles() const {
+  FsFile indexFile;
+  if (Storage.openFileForRead("LCT", LIBRARY_INDEX_FILE, indexFile)) {
+    uint8_t version = 0;
+    serialization::readPod(indexFile, version);
+    indexFile.close();
+    if (version == LIBRARY_CATALOG_FILE_VERSION && Storage.exists(LIBRARY_RECORDS_FILE)) {
+      return true;
+    }
+    Serial.printf("[%lu] [LCT] Catalog version %u unsupported, rebuilding\n", millis(), version);
+  }
+
+  Storage.mkdir("/.crosspoint");
+
+  FsFile recordsFile;
+  if (!Storage.openFileForWrite("LCT", LIBRARY_RECORDS_FILE, recordsFile)) {
+    return false;
+  }
+  recordsFile.close();
+
+  if (!Storage.openFileForWrite("LCT", LIBRARY_INDEX_FILE, indexFile)) {
+    return false;
+  }
+  uint8_t header[INDEX_HEADER_SIZE] = {LIBRARY_CATALOG_FILE_VERSION};
+  indexFile.write(header, sizeof(header));
+  indexFile.close();
+  Serial.printf("[%lu] [LCT] Created empty library catalog\n", millis());
+  return true;
+}
+
+bool LibraryCatalog::readRecord(const uint16_t slot, Record& record) const {
+  FsFile recordsFile;
+  if (!Storage.openFileForRead("LCT", LIBRARY_RECORDS_FILE, recordsFile)) {
+    return false;
+  }
+  const bool ok = readRecordAt(recordsFile, slot, record);
+  recordsFile.close();
+  return ok;
+}
+
+bool LibraryCatalog::readIndex(const uint16_t slot, IndexEntry& entry) const {
+  FsFile indexFile;
+  if (!Storage.openFileForRead("LCT", LIBRARY_INDEX_FILE, indexFile)) {
+    return false;
+  }
+  const bool ok = readIndexAt(indexFile, slot, entry);
+  indexFile.close();
+  return ok;
+}
+
+bool LibraryCatalog::writeSlot(const uint16_t slot, const Record& record, const IndexEntry& entry) const {
+  FsFile recordsFile = Storage.open(LIBRARY_RECORDS_FILE, O_RDWR | O_CREAT);
+  FsFile indexFile = Storage.open(LIBRARY_INDEX_FILE, O_RDWR | O_CREAT);
+  bool ok = recordsFile && indexFile;
+  if (ok) {
+    ok = writeRecordAt(recordsFile, slot, record) && writeIndexAt(indexFile, slot, entry);
+  }
+  if (recordsFile) recordsFile.close();
+  if (indexFile) indexFile.close();
+  if (!ok) {
+    Serial.printf("[%lu] [LCT] Failed to write catalog slot %u\n", millis(), slot);
+  }
+  return ok;
+}
+
+bool LibraryCatalog::findSlot(const uint32_t pathHash, uint16_t& slot, IndexEntry& entry) {
+  bool found = false;
+  forEachIndexEntry([&](const uint16_t s, const IndexEntry& e) {
+    if (e.lastOpened > openCounter) {
+      openCounter = e.lastOpened;
+    }
+    if (!found && (e.flags & FLAG_IN_USE) && e.pathHash == pathHash) {
+      slot = s;
+      entry = e;
+      found = true;
+    }
+  });
+  return found;
+}
+
+bool LibraryCatalog::listDirectory(const std::string& dirPath, std::vector<Entry>& entries, bool& stale) {
+  entries.clear();
+  pending.clear();
+  stale = true;
+
+  const std::string directory = normalizeDirectory(dirPath);
+  auto dir = Storage.open(directory.c_str());
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return false;
+  }
+  const uint32_t dirMtime = getModifyStamp(dir);
+  dir.close();
+
+  if (!ensureFiles()) {
+    return true;
+  }
+
+  const uint32_t dirHash = hashPath(directory);
+  int selfSlot = -1;
+  forEachIndexEntry([&](const uint16_t slot, const IndexEntry& entry) {
+    if (entry.lastOpened > openCounter) {
+      openCounter = entry.lastOpened;
+    }
+    if (!(entry.flags & FLAG_IN_USE)) {
+      return;
+    }
+    if (entry.pathHash == dirHash && (entry.flags & FLAG_DIRECTORY)) {
+      selfSlot = slot;
+    } else if (entry.dirHash == dirHash) {
+      entries.push_back({slot, entry});
+    }
+  });
+
+  // Directories without a usable mtime (e.g. the FAT root) are always revalidated
+  if (selfSlot >= 0 && dirMtime != 0) {
+    Record self;
+    if (readRecord(static_cast<uint16_t>(selfSlot), self) && self.mtime == dirMtime) {
+      stale = false;
+    }
+  }
+
+  queueMissingMetadata(directory, entries);
+  Serial.printf("[%lu] [LCT] Listed %s from catalog (%zu entries, %s)\n", millis(), directory.c_str(), entries.size(),
+                stale ? "stale" : "current");
+  return true;
+}
+
+bool LibraryCatalog::rescanDirectory(const std::string& dirPath, std::vector<Entry>& entries) {
+  const std::string directory = normalizeDirectory(dirPath);
+  const uint32_t dirHash = hashPath(directory);
+  const unsigned long scanStart = millis();
+
+  auto dir = Storage.open(directory.c_str());
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return false;
+  }
+  const uint32_t dirMtime = getModifyStamp(dir);
+
+  if (!ensureFiles()) {
+    dir.close();
+    return false;
+  }
+
+  // Current catalog state of this directory
+  std::vector<Entry> known;
+  std::vector<uint16_t> freeSlots;
+  int selfSlot = -1;
+  uint16_t slotCount = 0;
+  forEachIndexEntry([&](const uint16_t slot, const IndexEntry& entry) {
+    slotCount = slot + 1;
+    if (!(entry.flags & FLAG_IN_USE)) {
+      freeSlots.push_back(slot);
+    } else if (entry.pathHash == dirHash && (entry.flags & FLAG_DIRECTORY)) {
+      selfSlot = slot;
+    } else if (entry.dirHash == dirHash) {
+      known.push_back({slot, entry});
+    }
+  });
+  std::vector<bool> seen(known.size(), false);
+
+  FsFile recordsFile = Storage.open(LIBRARY_RECORDS_FILE, O_RDWR | O_CREAT);
+  FsFile indexFile = Storage.open(LIBRARY_INDEX_FILE, O_RDWR | O_CREAT);
+  if (!recordsFile || !indexFile) {
+    if (recordsFile) recordsFile.close();
+    if (indexFile) indexFile.close();
+    dir.close();
+    return false;
+  }
+
+  auto allocateSlot = [&](uint16_t& slot) {
+    if (!freeSlots.empty()) {
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+      return true;
+    }
+    if (slotCount == MAX_SLOTS) {
+      return false;
+    }
+    slot = slotCount++;
+    return true;
+  };
+
+  bool changed = false;
+  entries.clear();
+  dir.rewindDirectory();
+
+  char name[500];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (name[0] == '.' || strcmp(name, "System Volume Information") == 0) {
+      file.close();
+      continue;
+    }
+
+    const bool isDirectory = file.isDirectory();
+    if (!isDirectory && !isSupportedBook(name)) {
+      file.close();
+      continue;
+    }
+
+    const std::string childPath = joinPath(directory, name);
+    const uint32_t pathHash = hashPath(childPath);
+    const uint32_t fileSize = isDirectory ? 0 : static_cast<uint32_t>(file.size());
+    const uint32_t mtime = isDirectory ? 0 : getModifyStamp(file);
+    file.close();
+
+    auto it = std::find_if(known.begin(), known.end(), [&](const Entry& e) { return e.index.pathHash == pathHash; });
+    if (it != known.end()) {
+      seen[it - known.begin()] = true;
+      if (isDirectory || it->isDirectory()) {
+        entries.push_back(*it);
+        continue;
+      }
+
+      Record record;
+      if (!readRecordAt(recordsFile, it->slot, record) || (record.fileSize == fileSize && record.mtime == mtime)) {
+        entries.push_back(*it);
+        continue;
+      }
+
+      // Same path but different contents: keep reading stats, redo the metadata
+      record.fileSize = fileSize;
+      record.mtime = mtime;
+      record.flags &= ~FLAG_METADATA;
+      record.title[0] = '\0';
+      record.author[0] = '\0';
+      record.language[0] = '\0';
+      const IndexEntry entry = indexFromRecord(record, it->index.lastOpened);
+      writeRecordAt(recordsFile, it->slot, record);
+      writeIndexAt(indexFile, it->slot, entry);
+      entries.push_back({it->slot, entry});
+      changed = true;
+      continue;
+    }
+
+    uint16_t slot;
+    if (!allocateSlot(slot)) {
+      Serial.printf("[%lu] [LCT] Catalog full, not adding %s\n", millis(), childPath.c_str());
+      continue;
+    }
+
+    Record record = {};
+    record.pathHash = pathHash;
+    record.dirHash = dirHash;
+    record.fileSize = fileSize;
+    record.mtime = mtime;
+    record.flags = FLAG_IN_USE | (isDirectory ? FLAG_DIRECTORY : 0);
+    if (!copyField(record.name, sizeof(record.name), isDirectory ? std::string(name) + "/" : std::string(name))) {
+      record.flags |= FLAG_NAME_TRUNCATED;
+    }
+    const IndexEntry entry = indexFromRecord(record, 0);
+    writeRecordAt(recordsFile, slot, record);
+    writeIndexAt(indexFile, slot, entry);
+    entries.push_back({slot, entry});
+    changed = true;
+  }
+  dir.close();
+
+  // Free slots of entries that disappeared. Removed folders leave their children behind; those are purged below.
+  std::vector<uint32_t> removedDirs;
+  const IndexEntry emptyEntry = {};
+  for (size_t i = 0; i < known.size(); i++) {
+    if (seen[i]) continue;
+    if (known[i].isDirectory()) {
+      removedDirs.push_back(known[i].index.pathHash);
+    }
+    writeIndexAt(indexFile, known[i].slot, emptyEntry);
+    changed = true;
+  }
+
+  // Remember the scanned mtime on the directory's own record
+  Record self = {};
+  if (selfSlot < 0 || !readRecordAt(recordsFile, static_cast<uint16_t>(selfSlot), self)) {
+    uint16_t slot;
+    if (allocateSlot(slot)) {
+      selfSlot = slot;
+      self = {};
+      self.pathHash = dirHash;
+      self.dirHash = directory == "/" ? 0 : hashPath(parentDirectory(directory));
+      self.flags = FLAG_IN_USE | FLAG_DIRECTORY;
+      const std::string dirName = directory.substr(directory.find_last_of('/') + 1) + "/";
+      if (!copyField(self.name, sizeof(self.name), dirName)) {
+        self.flags |= FLAG_NAME_TRUNCATED;
+      }
+    }
+  }
+  if (selfSlot >= 0) {
+    self.mtime = dirMtime;
+    IndexEntry selfEntry;
+    if (!readIndexAt(indexFile, static_cast<uint16_t>(selfSlot), selfEntry) || !(selfEntry.flags & FLAG_IN_USE)) {
+      selfEntry = indexFromRecord(self, 0);
+    }
+    writeRecordAt(recordsFile, static_cast<uint16_t>(selfSlot), self);
+    writeIndexAt(indexFile, static_cast<uint16_t>(selfSlot), selfEntry);
+  }
+
+  // Purge descendants of removed folders, one level per pass
+  while (!removedDirs.empty()) {
+    std::vector<uint16_t> orphans;
+    std::vector<uint32_t> nextRemoved;
+    indexFile.seek(INDEX_HEADER_SIZE);
+    IndexEntry entry;
+    for (uint16_t slot = 0; slot < slotCount; slot++) {
+      if (indexFile.read(reinterpret_cast<uint8_t*>(&entry), sizeof(entry)) != sizeof(entry)) break;
+      if (!(entry.flags & FLAG_IN_USE)) continue;
+      const bool orphaned = std::find(removedDirs.begin(), removedDirs.end(), entry.dirHash) != removedDirs.end() ||
+                            (std::find(removedDirs.begin(), removedDirs.end(), entry.pathHash) != removedDirs.end() &&
+                             (entry.flags & FLAG_DIRECTORY));
+      if (!orphaned) continue;
+      orphans.push_back(slot);
+      if ((entry.flags & FLAG_DIRECTORY) &&
+          std::find(removedDirs.begin(), removedDirs.end(), entry.pathHash) == removedDirs.end()) {
+        nextRemoved.push_back(entry.pathHash);
+      }
+    }
+    for (const auto slot : orphans) {
+      writeIndexAt(indexFile, slot, emptyEntry);
+    }
+    removedDirs = std::move(nextRemoved);
+  }
+
+  recordsFile.close();
+  indexFile.close();
+
+  queueMissingMetadata(directory, entries);
+  Serial.printf("[%lu] [LCT] Rescanned %s in %lu ms (%zu entries%s)\n", millis(), directory.c_str(),
+                millis() - scanStart, entries.size(), changed ? ", changed" : "");
+  return changed;
+}
+
+void LibraryCatalog::queueMissingMetadata(const std::string& dirPath, const std::vector<Entry>& children) {
+  pendingDirectory = dirPath;
+  pending.clear();
+  for (const auto& child : children) {
+    if (!child.isDirectory() && !(child.index.flags & FLAG_METADATA)) {
+      pending.push_back(child.slot);
+    }
+  }
+}
+
+std::string LibraryCatalog::resolvePath(const std::string& dirPath, const Record& record) const {
+  const std::string directory = normalizeDirectory(dirPath);
+  std::string name = record.name;
+  if (!name.empty() && name.back() == '/') {
+    name.pop_back();
+  }
+  if (!(record.flags & FLAG_NAME_TRUNCATED)) {
+    return joinPath(directory, name);
+  }
+
+  // Name did not fit into the record, find the directory entry with the matching path hash
+  auto dir = Storage.open(directory.c_str());
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return joinPath(directory, name);
+  }
+  char fullName[500];
+  std::string resolved = joinPath(directory, name);
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(fullName, sizeof(fullName));
+    file.close();
+    const std::string candidate = joinPath(directory, fullName);
+    if (hashPath(candidate) == record.pathHash) {
+      resolved = candidate;
+      break;
+    }
+  }
+  dir.close();
+  return resolved;
+}
+
+std::string LibraryCatalog::displayTitle(const Record& record) {
+  if (!(record.flags & FLAG_DIRECTORY) && record.title[0] != '\0') {
+    return record.title;
+  }
+  return record.name;
+}
+
+void LibraryCatalog::sortEntries(std::vector<Entry>& entries, const SortMode mode) const {
+  auto byName = [](const Entry& a, const Entry& b) {
+    const int cmp = compareKeys(a.index.titleKey, b.index.titleKey);
+    return cmp != 0 ? cmp < 0 : a.slot < b.slot;
+  };
+
+  std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+    if (a.isDirectory() != b.isDirectory()) return a.isDirectory();
+    if (a.isDirectory()) return byName(a, b);
+
+    switch (mode) {
+      case SortMode::AUTHOR: {
+        const int cmp = compareKeys(a.index.authorKey, b.index.authorKey);
+        if (cmp != 0) return cmp < 0;
+        break;
+      }
+      case SortMode::RECENT:
+        if (a.index.lastOpened != b.index.lastOpened) return a.index.lastOpened > b.index.lastOpened;
+        break;
+      default:
+        break;
+    }
+    return byName(a, b);
+  });
+
+  // Sort keys only hold a short prefix; settle runs of equal keys (e.g. book series) by their full titles
+  auto sameKeys = [mode](const Entry& a, const Entry& b) {
+    if (a.isDirectory() != b.isDirectory()) return false;
+    if (compareKeys(a.index.titleKey, b.index.titleKey) != 0) return false;
+    if (a.isDirectory()) return true;
+    if (mode == SortMode::AUTHOR) return compareKeys(a.index.authorKey, b.index.authorKey) == 0;
+    if (mode == SortMode::RECENT) return a.index.lastOpened == b.index.lastOpened;
+    return true;
+  };
+
+  size_t runStart = 0;
+  while (runStart < entries.size()) {
+    size_t runEnd = runStart + 1;
+    while (runEnd < entries.size() && sameKeys(entries[runStart], entries[runEnd])) {
+      runEnd++;
+    }
+    if (runEnd - runStart > 1) {
+      std::vector<std::pair<std::string, Entry>> run;
+      run.reserve(runEnd - runStart);
+      Record record;
+      for (size_t i = runStart; i < runEnd; i++) {
+        run.emplace_back(readRecord(entries[i].slot, record) ? displayTitle(record) : "", entries[i]);
+      }
+      std::stable_sort(run.begin(), run.end(), [](const auto& a, const auto& b) {
+        return std::lexicographical_compare(a.first.begin(), a.first.end(), b.first.begin(), b.first.end(),
+                                            [](const char c1, const char c2) { return tolower(c1) < tolower(c2); });
+      });
+      for (size_t i = runStart; i < runEnd; i++) {
+        entries[i] = run[i - runStart].second;
+      }
+    }
+    runStart = runEnd;
+  }
+}
+
+int LibraryCatalog::extractNextMetadata() {
+  while (!pending.empty()) {
+    const uint16_t slot = pending.front();
+    pending.erase(pending.begin());
+
+    Record record;
+    IndexEntry entry;
+    if (!readRecord(slot, record) || !readIndex(slot, entry) || !(entry.flags & FLAG_IN_USE) ||
+        entry.pathHash != record.pathHash || (record.flags & FLAG_METADATA)) {
+      continue;
+    }
+    const std::string path = resolvePath(pendingDirectory, record);
+
+    const unsigned long extractStart = millis();
+    std::string title, author, language, thumbPath;
+    float progress = 0.0f;
+
+    if (StringUtils::checkFileExtension(path, ".epub")) {
+      Epub epub(path, "/.crosspoint");
+      if (epub.load(true, true)) {
+        title = epub.getTitle();
+        author = epub.getAuthor();
+        language = epub.getLanguage();
+        thumbPath = epub.getThumbBmpPath();
+
+        uint8_t data[6];
+        if (PROGRESS_JOURNAL.get(epub.getCachePath(), data, sizeof(data)) == 6 && epub.getBookSize() > 0) {
+          const int spineIndex = data[0] + (data[1] << 8);
+          const int page = data[2] + (data[3] << 8);
+          const int pageCount = data[4] + (data[5] << 8);
+          if (pageCount > 0) {
+            progress = epub.calculateProgress(spineIndex, static_cast<float>(page) / pageCount) * 100.0f;
+          }
+        }
+      }
+    } else if (StringUtils::checkFileExtension(path, ".xtch") || StringUtils::checkFileExtension(path, ".xtc")) {
+      Xtc xtc(path, "/.crosspoint");
+      if (xtc.load()) {
+        title = xtc.getTitle();
+        author = xtc.getAuthor();
+        thumbPath = xtc.getThumbBmpPath();
+
+        uint8_t data[4];
+        if (PROGRESS_JOURNAL.get(xtc.getCachePath(), data, sizeof(data)) == 4) {
+          progress = xtc.calculateProgress(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
+        }
+      }
+    }
+
+    // Text files (and books that failed to load) keep their file name as title
+    copyField(record.title, sizeof(record.title), title);
+    copyField(record.author, sizeof(record.author), author);
+    copyField(record.language, sizeof(record.language), language);
+    copyField(record.thumbPath, sizeof(record.thumbPath), thumbPath);
+    record.progress = static_cast<uint8_t>(std::min(100.0f, std::max(0.0f, progress + 0.5f)));
+    record.flags |= FLAG_METADATA;
+
+    writeSlot(slot, record, indexFromRecord(record, entry.lastOpened));
+    Serial.printf("[%lu] [LCT] Extracted metadata for %s in %lu ms\n", millis(), path.c_str(), millis() - extractStart);
+    return slot;
+  }
+  return -1;
+}
+
+void LibraryCatalog::markBookRead(const std::string& path, const uint8_t progressPercent) {
+  uint16_t slot;
+  IndexEntry entry;
+  if (!findSlot(hashPath(path), slot, entry)) {
+    // Not catalogued yet, it will be picked up on the next visit of its directory
+    return;
+  }
+
+  Record record;
+  if (!readRecord(slot, record)) {
+    return;
+  }
+  record.progress = std::min<uint8_t>(progressPercent, 100);
+  writeSlot(slot, record, indexFromRecord(record, ++openCounter));
+}
+
+void LibraryCatalog::invalidateDirectory(const std::string& dirPath) {
+  uint16_t slot;
+  IndexEntry entry;
+  if (!findSlot(hashPath(normalizeDirectory(dirPath)), slot, entry)) {
+    return;
+  }
+
+  Record record;
+  if (readRecord(slot, record) && record.mtime != 0) {
+    record.mtime = 0;
+    writeSlot(slot, record, entry);
+  }
+}
+
+void LibraryCatalog::invalidateParentOf(const std::string& path) {
+  invalidateDirectory(parentDirectory(normalizeDirectory(path)));
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Persistent library catalog stored on the SD card.
+ *
+ * Every book and folder seen while browsing gets one fixed-size record in /.crosspoint/library.bin, keyed by
+ * the hash of its full path (the same hash used for the epub_/xtc_ cache directories). A compact companion
+ * index (/.crosspoint/library.idx, 32 bytes per slot) carries the path/parent hashes and short sort keys, so a
+ * directory listing only needs one sequential read of the index instead of opening every file.
+ *
+ * Directories are rescanned only when their modification time differs from the one recorded on the last scan
+ * (or when invalidated after an on-device change). Books whose metadata has not been extracted yet are queued
+ * and filled in one at a time by extractNextMetadata(), which callers run while the UI is idle.
+ */
+class LibraryCatalog {
+ public:
+  enum class SortMode : uint8_t { TITLE = 0, AUTHOR, RECENT, SORT_MODE_COUNT };
+
+  static constexpr uint8_t FLAG_IN_USE = 0x01;
+  static constexpr uint8_t FLAG_DIRECTORY = 0x02;
+  static constexpr uint8_t FLAG_METADATA = 0x04;        // Metadata extraction finished (successfully or not)
+  static constexpr uint8_t FLAG_NAME_TRUNCATED = 0x08;  // File name did not fit the record, resolve by hash
+
+  static constexpr size_t SORT_KEY_LENGTH = 8;
+
+  // On-disk record in library.bin, one per slot
+  struct Record {
+    uint32_t pathHash;
+    uint32_t dirHash;
+    uint32_t fileSize;
+    uint32_t mtime;  // FAT date << 16 | FAT time
+    uint8_t flags;
+    uint8_t progress;  // 0-100
+    uint16_t reserved;
+    char name[200];  // File name within its directory, folders end with '/'
+    char title[112];
+    char author[80];
+    char language[16];
+    char thumbPath[84];
+  };
+  static_assert(sizeof(Record) == 512, "Library catalog records must stay 512 bytes");
+
+  // On-disk entry in library.idx, one per slot
+  struct IndexEntry {
+    uint32_t pathHash;
+    uint32_t dirHash;
+    uint32_t lastOpened;  // Monotonic open counter, 0 if never opened
+    uint8_t flags;
+    uint8_t progress;
+    uint16_t reserved;
+    char titleKey[SORT_KEY_LENGTH];
+    char authorKey[SORT_KEY_LENGTH];
+  };
+  static_assert(sizeof(IndexEntry) == 32, "Library catalog index entries must stay 32 bytes");
+
+  // In-memory row of a directory listing; the full record is read on demand
+  struct Entry {
+    uint16_t slot;
+    IndexEntry index;
+
+    bool isDirectory() const { return index.flags & FLAG_DIRECTORY; }
+  };
+
+ private:
+  // Static instance
+  static LibraryCatalog instance;
+
+  // Books of the last listed directory still waiting for metadata extraction
+  std::string pendingDirectory;
+  std::vector<uint16_t> pending;
+  uint32_t openCounter = 0;
+
+  bool ensureFiles() const;
+  bool writeSlot(uint16_t slot, const Record& record, const IndexEntry& entry) const;
+  bool findSlot(uint32_t pathHash, uint16_t& slot, IndexEntry& entry);
+  void queueMissingMetadata(const std::string& dirPath, const std::vector<Entry>& children);
+
+ public:
+  ~LibraryCatalog() = default;
+
+  // Get singleton instance
+  static LibraryCatalog& getInstance() { return instance; }
+
+  static uint32_t hashPath(const std::string& path);
+  static std::string normalizeDirectory(const std::string& dirPath);
+  static bool isSupportedBook(const std::string& fileName);
+
+  // Fill `entries` with the catalogued folders and books in `dirPath` without enumerating the directory.
+  // `stale` is set when the directory changed since its last scan and rescanDirectory() should be run.
+  // Returns false if the directory cannot be opened.
+  bool listDirectory(const std::string& dirPath, std::vector<Entry>& entries, bool& stale);
+  // Enumerate `dirPath` and reconcile the catalog with it. Returns true if anything was added, changed or removed.
+  bool rescanDirectory(const std::string& dirPath, std::vector<Entry>& entries);
+
+  // Folders always come first, books are ordered by the selected mode
+  void sortEntries(std::vector<Entry>& entries, SortMode mode) const;
+
+  bool readRecord(uint16_t slot, Record& record) const;
+  bool readIndex(uint16_t slot, IndexEntry& entry) const;
+  // Full path of a catalog record in `dirPath`, resolving names that did not fit into the record
+  std::string resolvePath(const std::string& dirPath, const Record& record) const;
+  static std::string displayTitle(const Record& record);
+
+  // Background metadata extraction, one book per call. Returns the updated slot or -1 if nothing was done.
+  bool hasPendingMetadata() const { return !pending.empty(); }
+  int extractNextMetadata();
+
+  // Record that a book was read, updating its position in the "recent" sort and its progress
+  void markBookRead(const std::string& path, uint8_t progressPercent);
+
+  // Force the next listing of `dirPath` to rescan it (used after uploads, renames and deletions)
+  void invalidateDirectory(const std::string& dirPath);
+  // Invalidate the directory containing `path`
+  void invalidateParentOf(const std::string& path);
+};
+
+// Helper macro to access the library catalog
+#define LIBRARY_CATALOG LibraryCatalog::getInstance()
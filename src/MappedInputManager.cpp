@@ -123,6 +123,16 @@ MappedInputManager::Labels MappedInputManager::mapLabels(const char* back, const
           labelForHardware(HalGPIO::BTN_LEFT), labelForHardware(HalGPIO::BTN_RIGHT)};
 }
 
+void MappedInputManager::queuePageTurn(const int delta) {
+  const unsigned long now = millis();
+  lastPageTurnGap = now - lastPageTurnTime.exchange(now);
+  pendingPageTurns += delta;
+}
+
+bool MappedInputManager::isPageTurnBurst() const {
+  return lastPageTurnGap < PAGE_TURN_BURST_MS && millis() - lastPageTurnTime < PAGE_TURN_BURST_MS;
+}
+
 int MappedInputManager::getPressedFrontButton() const {
   // Scan the raw front buttons in hardware order.
   // This bypasses remapping so the remap activity can capture physical presses.
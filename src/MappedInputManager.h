@@ -2,6 +2,9 @@
 
 #include <HalGPIO.h>
 
+#include <atomic>
+#include <climits>
+
 class MappedInputManager {
  public:
   enum class Button { Back, Confirm, Left, Right, Up, Down, Power, PageBack, PageForward };
@@ -24,6 +27,8 @@ class MappedInputManager {
   bool wasAnyPressed() const;
   bool wasAnyReleased() const;
   unsigned long getHeldTime() const;
+  // For long work on the loop task: true once a button was pressed or released, the loop still gets that input
+  bool pollAnyInput() { return gpio.pollAnyInput(); }
   Labels mapLabels(const char* back, const char* confirm, const char* previous, const char* next) const;
   // Returns the raw front button index that was pressed this frame (or -1 if none).
   int getPressedFrontButton() const;
@@ -34,9 +39,24 @@ class MappedInputManager {
   // by a landscape setting.
   void setEffectiveOrientation(Orientation o) { effectiveOrientation = o; }
 
+  // Page turns, queued by a reader's input handling and taken by its display task when it renders. Turns queued while
+  // a page is being drawn and refreshed add up to one net delta, so only the page they end on gets rendered.
+  static constexpr unsigned long PAGE_TURN_BURST_MS = 600;
+  void queuePageTurn(int delta);
+  // Hand back turns a render couldn't apply yet, e.g. past the end of a chapter. Not a new turn for isPageTurnBurst().
+  void requeuePageTurns(const int delta) { pendingPageTurns += delta; }
+  int takePageTurns() { return pendingPageTurns.exchange(0); }
+  void clearPageTurns() { pendingPageTurns = 0; }
+  // True while page turns follow each other less than PAGE_TURN_BURST_MS apart, readers may skim such pages
+  bool isPageTurnBurst() const;
+
  private:
   HalGPIO& gpio;
   Orientation effectiveOrientation = Orientation::Portrait;
+  std::atomic<int> pendingPageTurns{0};
+  // Written by the input handling only, read by display tasks as well
+  std::atomic<unsigned long> lastPageTurnTime{0};
+  std::atomic<unsigned long> lastPageTurnGap{ULONG_MAX};
 
   bool mapButton(Button button, bool (HalGPIO::*fn)(uint8_t) const) const;
 };
@@ -0,0 +1,325 @@
+#include "ProgressJournal.h"
+
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+constexpr uint8_t PROGRESS_JOURNAL_FILE_VERSION = 1;
+constexpr uint32_t PROGRESS_JOURNAL_MAGIC = 0x4A505043;  // "CPPJ"
+constexpr char PROGRESS_JOURNAL_FILE[] = "/.crosspoint/progress.jnl";
+constexpr char PROGRESS_JOURNAL_TMP_FILE[] = "/.crosspoint/progress.jnl.tmp";
+constexpr uint32_t HEADER_SIZE = 16;
+constexpr uint32_t JOURNAL_RECORDS = 1024;
+// Records left free by a compaction, so the flushes after it append again
+constexpr uint32_t APPEND_HEADROOM_RECORDS = 128;
+constexpr size_t READ_CHUNK_RECORDS = 32;
+
+// On-disk journal record. An all-zero record marks the end of the journal.
+struct Record {
+  uint32_t key;
+  uint8_t data[ProgressJournal::MAX_DATA_SIZE];
+  uint8_t size;
+  uint8_t reserved;
+  uint16_t checksum;
+};
+static_assert(sizeof(Record) == 16, "Progress journal records must stay 16 bytes");
+constexpr uint32_t FILE_SIZE = HEADER_SIZE + JOURNAL_RECORDS * sizeof(Record);
+
+// Fletcher-16 over everything but the checksum itself
+uint16_t recordChecksum(const Record& record) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+  for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+    sum1 = (sum1 + bytes[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return static_cast<uint16_t>(sum2 << 8 | sum1);
+}
+
+// FNV-1a of the book's cache directory, never 0 so it cannot be mistaken for the end marker
+uint32_t keyFor(const std::string& cachePath) {
+  uint32_t hash = 2166136261u;
+  for (const char c : cachePath) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash == 0 ? 1 : hash;
+}
+}  // namespace
+
+ProgressJournal ProgressJournal::instance;
+
+ProgressJournal::Entry* ProgressJournal::find(const uint32_t key) {
+  const auto it = std::find_if(entries.begin(), entries.end(), [key](const Entry& e) { return e.key == key; });
+  return it == entries.end() ? nullptr : &*it;
+}
+
+void ProgressJournal::load() {
+  loaded = true;
+  entries.clear();
+  writeOffset = 0;
+  useCounter = 0;
+
+  // A compaction interrupted between removing the old journal and renaming the new one
+  if (!Storage.exists(PROGRESS_JOURNAL_FILE) && Storage.exists(PROGRESS_JOURNAL_TMP_FILE)) {
+    FsFile tmp = Storage.open(PROGRESS_JOURNAL_TMP_FILE, O_RDWR);
+    if (tmp) {
+      tmp.rename(PROGRESS_JOURNAL_FILE);
+      tmp.close();
+    }
+  }
+
+  FsFile file;
+  if (!Storage.exists(PROGRESS_JOURNAL_FILE) || !Storage.openFileForRead("PRJ", PROGRESS_JOURNAL_FILE, file)) {
+    return;
+  }
+
+  uint32_t magic = 0;
+  uint8_t version = 0;
+  serialization::readPod(file, magic);
+  serialization::readPod(file, version);
+  if (magic != PROGRESS_JOURNAL_MAGIC || version != PROGRESS_JOURNAL_FILE_VERSION || file.size() < FILE_SIZE) {
+    Serial.printf("[%lu] [PRJ] Unknown journal format, will be recreated\n", millis());
+    file.close();
+    return;
+  }
+
+  file.seek(HEADER_SIZE);
+  Record chunk[READ_CHUNK_RECORDS];
+  uint32_t records = 0;
+  bool done = false;
+  while (!done && records < JOURNAL_RECORDS) {
+    const size_t wanted = std::min<size_t>(READ_CHUNK_RECORDS, JOURNAL_RECORDS - records);
+    const int bytesRead = file.read(reinterpret_cast<uint8_t*>(chunk), wanted * sizeof(Record));
+    const size_t count = bytesRead > 0 ? static_cast<size_t>(bytesRead) / sizeof(Record) : 0;
+    if (count == 0) {
+      break;
+    }
+    for (size_t i = 0; i < count; i++) {
+      const Record& record = chunk[i];
+      if (record.key == 0 || record.size > MAX_DATA_SIZE || record.checksum != recordChecksum(record)) {
+        done = true;
+        break;
+      }
+      Entry* entry = find(record.key);
+      if (!entry) {
+        entries.push_back({record.key, 0, false, {}});
+        entry = &entries.back();
+      }
+      entry->size = record.size;
+      memcpy(entry->data, record.data, MAX_DATA_SIZE);
+      // Later records are newer, compaction writes the books in the order they were read
+      entry->lastUsed = ++useCounter;
+      records++;
+    }
+  }
+  file.close();
+
+  writeOffset = HEADER_SIZE + records * sizeof(Record);
+  Serial.printf("[%lu] [PRJ] Loaded %u records for %u books\n", millis(), static_cast<unsigned>(records),
+                static_cast<unsigned>(entries.size()));
+}
+
+size_t ProgressJournal::get(const std::string& cachePath, uint8_t* data, const size_t size) {
+  if (!loaded) {
+    load();
+  }
+
+  const uint32_t key = keyFor(cachePath);
+  if (const Entry* entry = find(key)) {
+    const size_t count = std::min<size_t>(size, entry->size);
+    memcpy(data, entry->data, count);
+    return count;
+  }
+
+  // Position saved by firmware from before the journal
+  FsFile legacy;
+  const std::string legacyPath = cachePath + "/progress.bin";
+  if (!Storage.exists(legacyPath.c_str()) || !Storage.openFileForRead("PRJ", legacyPath, legacy)) {
+    return 0;
+  }
+  uint8_t buffer[MAX_DATA_SIZE] = {};
+  const int bytesRead = legacy.read(buffer, std::min(size, MAX_DATA_SIZE));
+  legacy.close();
+  if (bytesRead <= 0) {
+    return 0;
+  }
+
+  Entry entry{key, static_cast<uint8_t>(bytesRead), false, {}};
+  memcpy(entry.data, buffer, MAX_DATA_SIZE);
+  entry.lastUsed = ++useCounter;
+  entries.push_back(entry);
+  memcpy(data, buffer, bytesRead);
+  return bytesRead;
+}
+
+void ProgressJournal::put(const std::string& cachePath, const uint8_t* data, size_t size) {
+  if (!loaded) {
+    load();
+  }
+  size = std::min(size, MAX_DATA_SIZE);
+
+  const uint32_t key = keyFor(cachePath);
+  Entry* entry = find(key);
+  if (!entry) {
+    entries.push_back({key, 0, false, {}});
+    entry = &entries.back();
+  } else if (entry->size == size && memcmp(entry->data, data, size) == 0) {
+    // Re-render of the same page
+    return;
+  }
+
+  entry->size = static_cast<uint8_t>(size);
+  memset(entry->data, 0, MAX_DATA_SIZE);
+  memcpy(entry->data, data, size);
+  entry->dirty = true;
+  entry->lastUsed = ++useCounter;
+  pendingTurns++;
+  lastPutTime = millis();
+
+  if (pendingTurns >= FLUSH_EVERY_TURNS) {
+    flush();
+  }
+}
+
+void ProgressJournal::flushIfIdle() {
+  if (pendingTurns > 0 && millis() - lastPutTime >= IDLE_FLUSH_MS) {
+    flush();
+  }
+}
+
+bool ProgressJournal::flush() {
+  if (pendingTurns == 0) {
+    return true;
+  }
+
+  const auto dirtyCount =
+      static_cast<uint32_t>(std::count_if(entries.begin(), entries.end(), [](const Entry& e) { return e.dirty; }));
+  const bool fits = writeOffset != 0 && writeOffset + dirtyCount * sizeof(Record) <= FILE_SIZE;
+  if (!(fits ? append() : compact())) {
+    // Retry after the next idle period instead of on every loop
+    lastPutTime = millis();
+    return false;
+  }
+
+  for (auto& entry : entries) {
+    entry.dirty = false;
+  }
+  pendingTurns = 0;
+  return true;
+}
+
+bool ProgressJournal::append() {
+  std::vector<Record> records;
+  for (const auto& entry : entries) {
+    if (!entry.dirty) {
+      continue;
+    }
+    Record record{};
+    record.key = entry.key;
+    memcpy(record.data, entry.data, MAX_DATA_SIZE);
+    record.size = entry.size;
+    record.checksum = recordChecksum(record);
+    records.push_back(record);
+  }
+
+  FsFile file = Storage.open(PROGRESS_JOURNAL_FILE, O_RDWR);
+  if (!file) {
+    Serial.printf("[%lu] [PRJ] Could not open journal\n", millis());
+    return false;
+  }
+  file.seek(writeOffset);
+  const size_t bytes = records.size() * sizeof(Record);
+  const size_t written = file.write(reinterpret_cast<const uint8_t*>(records.data()), bytes);
+  file.close();
+  if (written != bytes) {
+    Serial.printf("[%lu] [PRJ] Short write to journal\n", millis());
+    return false;
+  }
+
+  writeOffset += bytes;
+  Serial.printf("[%lu] [PRJ] Appended %u records\n", millis(), static_cast<unsigned>(records.size()));
+  return true;
+}
+
+bool ProgressJournal::compact() {
+  Storage.mkdir("/.crosspoint");
+  if (Storage.exists(PROGRESS_JOURNAL_TMP_FILE)) {
+    Storage.remove(PROGRESS_JOURNAL_TMP_FILE);
+  }
+
+  FsFile file;
+  if (!Storage.openFileForWrite("PRJ", PROGRESS_JOURNAL_TMP_FILE, file)) {
+    return false;
+  }
+
+  uint8_t block[512] = {};
+  memcpy(block, &PROGRESS_JOURNAL_MAGIC, sizeof(PROGRESS_JOURNAL_MAGIC));
+  block[sizeof(PROGRESS_JOURNAL_MAGIC)] = PROGRESS_JOURNAL_FILE_VERSION;
+  size_t used = HEADER_SIZE;
+
+  // Latest record of every book from the least to the most recently read, then zeros up to the full size so later
+  // appends stay inside the allocation. The least recently read books are dropped to leave room for those appends;
+  // pending positions were just put and are never among them.
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+  constexpr size_t maxBooks = JOURNAL_RECORDS - APPEND_HEADROOM_RECORDS;
+  if (entries.size() > maxBooks) {
+    Serial.printf("[%lu] [PRJ] Journal full, dropping %u books\n", millis(),
+                  static_cast<unsigned>(entries.size() - maxBooks));
+    entries.erase(entries.begin(), entries.end() - maxBooks);
+  }
+  const size_t count = entries.size();
+  size_t written = 0;
+  for (size_t i = 0; i < count; i++) {
+    Record record{};
+    record.key = entries[i].key;
+    memcpy(record.data, entries[i].data, MAX_DATA_SIZE);
+    record.size = entries[i].size;
+    record.checksum = recordChecksum(record);
+    memcpy(block + used, &record, sizeof(Record));
+    used += sizeof(Record);
+    if (used == sizeof(block)) {
+      written += file.write(block, used);
+      memset(block, 0, sizeof(block));
+      used = 0;
+    }
+  }
+  while (written < FILE_SIZE) {
+    const size_t chunk = std::min<size_t>(sizeof(block), FILE_SIZE - written);
+    const size_t bytes = file.write(block, chunk);
+    if (bytes == 0) {
+      break;
+    }
+    written += bytes;
+    memset(block, 0, sizeof(block));
+  }
+  file.close();
+  if (written != FILE_SIZE) {
+    Serial.printf("[%lu] [PRJ] Failed to write compacted journal\n", millis());
+    Storage.remove(PROGRESS_JOURNAL_TMP_FILE);
+    return false;
+  }
+
+  if (Storage.exists(PROGRESS_JOURNAL_FILE)) {
+    Storage.remove(PROGRESS_JOURNAL_FILE);
+  }
+  FsFile tmp = Storage.open(PROGRESS_JOURNAL_TMP_FILE, O_RDWR);
+  const bool renamed = tmp && tmp.rename(PROGRESS_JOURNAL_FILE);
+  if (tmp) {
+    tmp.close();
+  }
+  if (!renamed) {
+    Serial.printf("[%lu] [PRJ] Failed to replace journal\n", millis());
+    return false;
+  }
+
+  writeOffset = HEADER_SIZE + count * sizeof(Record);
+  Serial.printf("[%lu] [PRJ] Compacted journal to %u records\n", millis(), static_cast<unsigned>(count));
+  return true;
+}
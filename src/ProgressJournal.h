@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Reading positions of all books, kept in one preallocated append-only file (/.crosspoint/progress.jnl).
+ *
+ * Readers report every page turn through put(), which only updates RAM. Pending positions are appended as 16-byte
+ * records once the reader has been idle for a moment, every FLUSH_EVERY_TURNS page turns, when a book is closed and
+ * before deep sleep. Appending into the preallocated area never touches the FAT. When the file is full it is
+ * rewritten with just the latest record of each book, dropping the least recently read books if needed to leave room
+ * for appending again.
+ *
+ * On load the journal is replayed and the last record of a book wins. Replay stops at the first empty or damaged
+ * record, so a write torn by power loss only costs the positions of that flush. Books without a journal record
+ * fall back to the per-book progress.bin written by earlier firmware.
+ */
+class ProgressJournal {
+ public:
+  static constexpr size_t MAX_DATA_SIZE = 8;
+  static constexpr int FLUSH_EVERY_TURNS = 20;
+  static constexpr unsigned long IDLE_FLUSH_MS = 3000;
+
+ private:
+  struct Entry {
+    uint32_t key;
+    uint8_t size;
+    bool dirty;
+    uint8_t data[MAX_DATA_SIZE];
+    uint32_t lastUsed = 0;  // Value of `useCounter` when it was last put
+  };
+
+  // Static instance
+  static ProgressJournal instance;
+
+  std::vector<Entry> entries;
+  bool loaded = false;
+  uint32_t writeOffset = 0;  // End of the valid records, 0 if the file has to be (re)created
+  uint32_t useCounter = 0;
+  int pendingTurns = 0;
+  unsigned long lastPutTime = 0;
+
+  void load();
+  Entry* find(uint32_t key);
+  bool append();
+  bool compact();
+
+ public:
+  ~ProgressJournal() = default;
+
+  // Get singleton instance
+  static ProgressJournal& getInstance() { return instance; }
+
+  // Copy the saved position of the book with this cache directory into `data`. Returns the number of bytes saved
+  // (at most `size`), 0 if the book has no saved position.
+  size_t get(const std::string& cachePath, uint8_t* data, size_t size);
+  // Remember the position of a book. Only written to the SD card by one of the flushes.
+  void put(const std::string& cachePath, const uint8_t* data, size_t size);
+
+  bool hasPending() const { return pendingTurns > 0; }
+  // Write pending positions if nothing was reported for IDLE_FLUSH_MS
+  void flushIfIdle();
+  // Write pending positions now
+  bool flush();
+};
+
+// Helper macro to access the progress journal
+#define PROGRESS_JOURNAL ProgressJournal::getInstance()
@@ -20,6 +20,14 @@ RecentBooksStore RecentBooksStore::instance;
 
 void RecentBooksStore::addBook(const std::string& path, const std::string& title, const std::string& author,
                                const std::string& coverBmpPath) {
+  // Reopening the most recent book changes nothing, skip the rewrite
+  if (!recentBooks.empty()) {
+    const RecentBook& first = recentBooks.front();
+    if (first.path == path && first.title == title && first.author == author && first.coverBmpPath == coverBmpPath) {
+      return;
+    }
+  }
+
   // Remove existing entry if present
   auto it =
       std::find_if(recentBooks.begin(), recentBooks.end(), [&](const RecentBook& book) { return book.path == path; });
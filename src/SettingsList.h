@@ -50,18 +50,23 @@ inline std::vector<SettingInfo> getSettingsList() {
                           "extraParagraphSpacing", "Reader"),
       SettingInfo::Toggle("Text Anti-Aliasing", &CrossPointSettings::textAntiAliasing, "textAntiAliasing", "Reader"),
       SettingInfo::Toggle("First Line Indent", &CrossPointSettings::firstLineIndent, "firstLineIndent", "Reader"),
+      SettingInfo::Toggle("Search Index", &CrossPointSettings::searchIndex, "searchIndex", "Reader"),
 
       // --- Controls ---
       SettingInfo::Enum("Side Button Layout (reader)", &CrossPointSettings::sideButtonLayout,
                         {"Prev, Next", "Next, Prev"}, "sideButtonLayout", "Controls"),
       SettingInfo::Toggle("Long-press Chapter Skip", &CrossPointSettings::longPressChapterSkip, "longPressChapterSkip",
                           "Controls"),
+      SettingInfo::Toggle("Fast Page Skimming", &CrossPointSettings::skimPageTurns, "skimPageTurns", "Controls"),
       SettingInfo::Enum("Short Power Button Click", &CrossPointSettings::shortPwrBtn, {"Ignore", "Sleep", "Page Turn"},
                         "shortPwrBtn", "Controls"),
 
       // --- System ---
       SettingInfo::Enum("Time to Sleep", &CrossPointSettings::sleepTimeout,
                         {"1 min", "5 min", "10 min", "15 min", "30 min"}, "sleepTimeout", "System"),
+      SettingInfo::Enum("Book Cache Limit", &CrossPointSettings::cacheQuota,
+                        {"Unlimited", "64 MB", "128 MB", "256 MB", "512 MB", "1 GB"}, "cacheQuota", "System"),
+      SettingInfo::Toggle("Prepare Uploaded Books", &CrossPointSettings::prepareUploads, "prepareUploads", "System"),
 
       // --- KOReader Sync (web-only, uses KOReaderCredentialStore) ---
       SettingInfo::DynamicString(
@@ -101,5 +106,6 @@ inline std::vector<SettingInfo> getSettingsList() {
                           "OPDS Browser"),
       SettingInfo::String("OPDS Password", SETTINGS.opdsPassword, sizeof(SETTINGS.opdsPassword), "opdsPassword",
                           "OPDS Browser"),
+      SettingInfo::Toggle("Offline Mode", &CrossPointSettings::opdsOffline, "opdsOffline", "OPDS Browser"),
   };
 }
@@ -5,6 +5,8 @@
 #include <string>
 #include <utility>
 
+#include "RenderRequest.h"
+
 class MappedInputManager;
 class GfxRenderer;
 
@@ -13,6 +15,8 @@ class Activity {
   std::string name;
   GfxRenderer& renderer;
   MappedInputManager& mappedInput;
+  // Raised by input handling, taken by the activity's display task
+  RenderRequest updateRequired;
 
  public:
   explicit Activity(std::string name, GfxRenderer& renderer, MappedInputManager& mappedInput)
@@ -10,6 +10,8 @@ void ActivityWithSubactivity::exitActivity() {
     // 1. Returning from a landscape reader to a portrait UI activity.
     // 2. Returning from settings where the user changed orientation.
     OrientationHelper::applyOrientation(renderer, mappedInput, this);
+    // Display tasks hold back renders while a subactivity is open
+    updateRequired.wake();
   }
 }
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+
+/**
+ * Render requests from an activity's input handling to its display task.
+ *
+ * request() marks the screen as out of date and wakes the display task with a task notification, so the task sleeps
+ * in wait() instead of polling a flag. Requests made before the task takes them collapse into a single render.
+ *
+ *   while (true) {
+ *     if (updateRequired.take()) { render(); }
+ *     updateRequired.wait();
+ *   }
+ */
+class RenderRequest {
+  std::atomic<bool> pending{false};
+  std::atomic<TaskHandle_t> waiter{nullptr};
+
+ public:
+  void request() {
+    pending = true;
+    wake();
+  }
+
+  // Drop a request that has not been taken yet
+  void cancel() { pending = false; }
+
+  bool isPending() const { return pending; }
+
+  // Wake the display task without requesting a render, so it re-checks what held back a pending request
+  void wake() {
+    if (const TaskHandle_t task = waiter) {
+      xTaskNotifyGive(task);
+    }
+  }
+
+  // Display task only: clears the request and returns true if there was one
+  bool take() { return pending.exchange(false); }
+
+  // Display task only: sleeps until woken or `timeout` ticks pass. Returns at once if woken since the last call.
+  void wait(const TickType_t timeout = portMAX_DELAY) {
+    // Requests made before the task was known woke no one, the first call only publishes it so the loop checks again
+    if (waiter.exchange(xTaskGetCurrentTaskHandle()) == nullptr) {
+      return;
+    }
+    ulTaskNotifyTake(pdTRUE, timeout);
+  }
+
+  // Forget the display task once it has been deleted
+  void detach() { waiter = nullptr; }
+};
@@ -4,9 +4,14 @@
 #include <GfxRenderer.h>
 #include <HalStorage.h>
 #include <I18n.h>
+#include <Serialization.h>
 #include <Txt.h>
 #include <Xtc.h>
 
+#include <functional>
+#include <vector>
+
+#include "BookCacheManager.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "components/UITheme.h"
@@ -14,6 +19,146 @@
 #include "images/Logo120.h"
 #include "util/StringUtils.h"
 
+namespace {
+// Dithered sleep screens are cached as raw panel planes: a BW plane, followed by the grayscale LSB and MSB planes
+// when the image has grays. Showing a cached image is then a sequential read straight into the frame buffer.
+constexpr uint8_t SLEEP_CACHE_VERSION = 2;
+constexpr char SLEEP_CACHE_DIR[] = "/.crosspoint/sleep";
+constexpr uint8_t SLEEP_CACHE_FLAG_GRAYSCALE = 0x01;
+// Custom images are picked at random, so which ones stay cached doesn't matter, only how many
+constexpr size_t MAX_CUSTOM_SLEEP_CACHES = 8;
+
+// Everything the rendered planes depend on besides the image contents
+struct SleepCacheKey {
+  uint32_t sourceSize = 0;
+  uint32_t sourceTime = 0;
+  uint16_t width = 0;
+  uint16_t height = 0;
+  // Portrait and inverted portrait have the same size but store the planes upside down to each other
+  uint8_t orientation = 0;
+  uint8_t coverMode = 0;
+  uint8_t coverFilter = 0;
+  uint8_t colorMode = 0;
+
+  bool operator==(const SleepCacheKey& other) const {
+    return sourceSize == other.sourceSize && sourceTime == other.sourceTime && width == other.width &&
+           height == other.height && orientation == other.orientation && coverMode == other.coverMode &&
+           coverFilter == other.coverFilter && colorMode == other.colorMode;
+  }
+};
+
+// Book cache directory (epub_<hash>, xtc_<hash>, txt_<hash>) a cover was generated in, empty for other images
+std::string bookCacheDir(const std::string& sourcePath) {
+  constexpr char root[] = "/.crosspoint/";
+  const size_t slash = sourcePath.find('/', sizeof(root) - 1);
+  if (sourcePath.rfind(root, 0) != 0 || slash == std::string::npos) {
+    return "";
+  }
+  const std::string dir = sourcePath.substr(0, slash);
+  const std::string name = dir.substr(sizeof(root) - 1);
+  const bool isBookCache = name.rfind("epub_", 0) == 0 || name.rfind("xtc_", 0) == 0 || name.rfind("txt_", 0) == 0;
+  return isBookCache ? dir : "";
+}
+
+// Covers are cached next to the cover in the book's cache, which counts them against the cache limit and removes them
+// with the book. Custom images go to SLEEP_CACHE_DIR.
+std::string sleepCachePath(const std::string& sourcePath) {
+  const std::string bookDir = bookCacheDir(sourcePath);
+  if (!bookDir.empty()) {
+    const size_t nameStart = sourcePath.find_last_of('/') + 1;
+    const size_t nameEnd = sourcePath.find_last_of('.');
+    const size_t nameLength = nameEnd > nameStart ? nameEnd - nameStart : std::string::npos;
+    return bookDir + "/sleep_" + sourcePath.substr(nameStart, nameLength) + ".bin";
+  }
+  return std::string(SLEEP_CACHE_DIR) + "/" + std::to_string(std::hash<std::string>{}(sourcePath)) + ".bin";
+}
+
+// Remove cached custom images other than `keep` until at most MAX_CUSTOM_SLEEP_CACHES are left
+void trimCustomSleepCaches(const std::string& keep) {
+  auto dir = Storage.open(SLEEP_CACHE_DIR);
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    return;
+  }
+  std::vector<std::string> paths;
+  char name[64];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    const std::string path = std::string(SLEEP_CACHE_DIR) + "/" + name;
+    if (!file.isDirectory() && path != keep) {
+      paths.push_back(path);
+    }
+    file.close();
+  }
+  dir.close();
+
+  for (size_t i = 0; i + MAX_CUSTOM_SLEEP_CACHES <= paths.size(); i++) {
+    Serial.printf("[%lu] [SLP] Dropping cached sleep screen %s\n", millis(), paths[i].c_str());
+    Storage.remove(paths[i].c_str());
+  }
+}
+
+bool makeSleepCacheKey(const GfxRenderer& renderer, const std::string& sourcePath, SleepCacheKey& key) {
+  FsFile source = Storage.open(sourcePath.c_str());
+  if (!source) {
+    return false;
+  }
+  uint16_t date = 0, time = 0;
+  source.getModifyDateTime(&date, &time);
+  key.sourceSize = source.size();
+  key.sourceTime = static_cast<uint32_t>(date) << 16 | time;
+  source.close();
+
+  key.width = renderer.getScreenWidth();
+  key.height = renderer.getScreenHeight();
+  key.orientation = static_cast<uint8_t>(renderer.getOrientation());
+  key.coverMode = SETTINGS.sleepScreenCoverMode;
+  key.coverFilter = SETTINGS.sleepScreenCoverFilter;
+  key.colorMode = SETTINGS.colorMode;
+  return true;
+}
+
+void writeSleepCacheHeader(FsFile& file, const SleepCacheKey& key, const uint8_t flags) {
+  serialization::writePod(file, SLEEP_CACHE_VERSION);
+  serialization::writePod(file, flags);
+  serialization::writePod(file, key.sourceSize);
+  serialization::writePod(file, key.sourceTime);
+  serialization::writePod(file, key.width);
+  serialization::writePod(file, key.height);
+  serialization::writePod(file, key.orientation);
+  serialization::writePod(file, key.coverMode);
+  serialization::writePod(file, key.coverFilter);
+  serialization::writePod(file, key.colorMode);
+}
+
+bool readSleepCacheHeader(FsFile& file, SleepCacheKey& key, uint8_t& flags) {
+  uint8_t version;
+  serialization::readPod(file, version);
+  if (version != SLEEP_CACHE_VERSION) {
+    return false;
+  }
+  serialization::readPod(file, flags);
+  serialization::readPod(file, key.sourceSize);
+  serialization::readPod(file, key.sourceTime);
+  serialization::readPod(file, key.width);
+  serialization::readPod(file, key.height);
+  serialization::readPod(file, key.orientation);
+  serialization::readPod(file, key.coverMode);
+  serialization::readPod(file, key.coverFilter);
+  serialization::readPod(file, key.colorMode);
+  return true;
+}
+
+bool writePlane(FsFile& file, const GfxRenderer& renderer) {
+  return file && file.write(renderer.getFrameBuffer(), GfxRenderer::getBufferSize()) == GfxRenderer::getBufferSize();
+}
+
+bool readPlane(FsFile& file, const GfxRenderer& renderer) {
+  const int size = static_cast<int>(GfxRenderer::getBufferSize());
+  return file.read(renderer.getFrameBuffer(), size) == size;
+}
+}  // namespace
+
 void SleepActivity::onEnter() {
   Activity::onEnter();
   GUI.drawPopup(renderer, TR(ENTERING_SLEEP));
@@ -75,13 +220,17 @@ void SleepActivity::renderCustomSleepScreen() const {
       APP_STATE.lastSleepImage = randomFileIndex;
       APP_STATE.saveToFile();
       const auto filename = "/sleep/" + files[randomFileIndex];
+      if (renderCachedSleepScreen(filename)) {
+        dir.close();
+        return;
+      }
       FsFile file;
       if (Storage.openFileForRead("SLP", filename, file)) {
         Serial.printf("[%lu] [SLP] Randomly loading: /sleep/%s\n", millis(), files[randomFileIndex].c_str());
         delay(100);
         Bitmap bitmap(file, true);
         if (bitmap.parseHeaders() == BmpReaderError::Ok) {
-          renderBitmapSleepScreen(bitmap);
+          renderBitmapSleepScreen(bitmap, filename);
           dir.close();
           return;
         }
@@ -92,12 +241,15 @@ void SleepActivity::renderCustomSleepScreen() const {
 
   // Look for sleep.bmp on the root of the sd card to determine if we should
   // render a custom sleep screen instead of the default.
+  if (renderCachedSleepScreen("/sleep.bmp")) {
+    return;
+  }
   FsFile file;
   if (Storage.openFileForRead("SLP", "/sleep.bmp", file)) {
     Bitmap bitmap(file, true);
     if (bitmap.parseHeaders() == BmpReaderError::Ok) {
       Serial.printf("[%lu] [SLP] Loading: /sleep.bmp\n", millis());
-      renderBitmapSleepScreen(bitmap);
+      renderBitmapSleepScreen(bitmap, "/sleep.bmp");
       return;
     }
   }
@@ -122,7 +274,7 @@ void SleepActivity::renderDefaultSleepScreen() const {
   renderer.displayBuffer(HalDisplay::HALF_REFRESH);
 }
 
-void SleepActivity::renderBitmapSleepScreen(const Bitmap& bitmap) const {
+void SleepActivity::renderBitmapSleepScreen(const Bitmap& bitmap, const std::string& sourcePath) const {
   int x, y;
   const auto pageWidth = renderer.getScreenWidth();
   const auto pageHeight = renderer.getScreenHeight();
@@ -169,11 +321,27 @@ void SleepActivity::renderBitmapSleepScreen(const Bitmap& bitmap) const {
   const bool hasGreyscale = bitmap.hasGreyscale() &&
                             SETTINGS.sleepScreenCoverFilter == CrossPointSettings::SLEEP_SCREEN_COVER_FILTER::NO_FILTER;
 
+  // Capture the dithered planes as they are produced so the next sleep can skip decoding and dithering
+  FsFile cacheFile;
+  SleepCacheKey cacheKey;
+  const std::string cachePath = sourcePath.empty() ? "" : sleepCachePath(sourcePath);
+  const std::string bookDir = bookCacheDir(sourcePath);
+  if (!sourcePath.empty() && makeSleepCacheKey(renderer, sourcePath, cacheKey)) {
+    if (bookDir.empty()) {
+      Storage.mkdir(SLEEP_CACHE_DIR);
+    }
+    if (Storage.openFileForWrite("SLP", cachePath, cacheFile)) {
+      writeSleepCacheHeader(cacheFile, cacheKey, hasGreyscale ? SLEEP_CACHE_FLAG_GRAYSCALE : 0);
+    }
+  }
+  bool caching = static_cast<bool>(cacheFile);
+
   renderer.drawBitmap(bitmap, x, y, pageWidth, pageHeight, cropX, cropY);
 
   if (SETTINGS.sleepScreenCoverFilter == CrossPointSettings::SLEEP_SCREEN_COVER_FILTER::INVERTED_BLACK_AND_WHITE) {
     renderer.invertScreen();
   }
+  caching = caching && writePlane(cacheFile, renderer);
 
   renderer.displayBuffer(HalDisplay::HALF_REFRESH);
 
@@ -182,17 +350,65 @@ void SleepActivity::renderBitmapSleepScreen(const Bitmap& bitmap) const {
     renderer.clearScreen(0x00);
     renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
     renderer.drawBitmap(bitmap, x, y, pageWidth, pageHeight, cropX, cropY);
+    caching = caching && writePlane(cacheFile, renderer);
     renderer.copyGrayscaleLsbBuffers();
 
     bitmap.rewindToData();
     renderer.clearScreen(0x00);
     renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
     renderer.drawBitmap(bitmap, x, y, pageWidth, pageHeight, cropX, cropY);
+    caching = caching && writePlane(cacheFile, renderer);
     renderer.copyGrayscaleMsbBuffers();
 
     renderer.displayGrayBuffer();
     renderer.setRenderMode(GfxRenderer::BW);
   }
+
+  if (cacheFile) {
+    cacheFile.close();
+    if (!caching) {
+      Serial.printf("[%lu] [SLP] Failed to cache sleep screen planes\n", millis());
+      Storage.remove(cachePath.c_str());
+    } else if (bookDir.empty()) {
+      trimCustomSleepCaches(cachePath);
+    } else {
+      // The book cache grew, have its size measured again
+      BOOK_CACHE.touch(bookDir);
+    }
+  }
+}
+
+bool SleepActivity::renderCachedSleepScreen(const std::string& sourcePath) const {
+  const auto cachePath = sleepCachePath(sourcePath);
+  SleepCacheKey expected;
+  if (!Storage.exists(cachePath.c_str()) || !makeSleepCacheKey(renderer, sourcePath, expected)) {
+    return false;
+  }
+
+  FsFile file;
+  if (!Storage.openFileForRead("SLP", cachePath, file)) {
+    return false;
+  }
+  SleepCacheKey cached;
+  uint8_t flags = 0;
+  if (!readSleepCacheHeader(file, cached, flags) || !(cached == expected) || !readPlane(file, renderer)) {
+    Serial.printf("[%lu] [SLP] Sleep screen cache outdated: %s\n", millis(), sourcePath.c_str());
+    file.close();
+    return false;
+  }
+
+  Serial.printf("[%lu] [SLP] Rendering cached sleep screen: %s\n", millis(), sourcePath.c_str());
+  renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+
+  if ((flags & SLEEP_CACHE_FLAG_GRAYSCALE) && readPlane(file, renderer)) {
+    renderer.copyGrayscaleLsbBuffers();
+    if (readPlane(file, renderer)) {
+      renderer.copyGrayscaleMsbBuffers();
+      renderer.displayGrayBuffer();
+    }
+  }
+  file.close();
+  return true;
 }
 
 void SleepActivity::renderCoverSleepScreen() const {
@@ -262,12 +478,15 @@ void SleepActivity::renderCoverSleepScreen() const {
     return (this->*renderNoCoverSleepScreen)();
   }
 
+  if (renderCachedSleepScreen(coverBmpPath)) {
+    return;
+  }
   FsFile file;
   if (Storage.openFileForRead("SLP", coverBmpPath, file)) {
     Bitmap bitmap(file);
     if (bitmap.parseHeaders() == BmpReaderError::Ok) {
       Serial.printf("[SLP] Rendering sleep cover: %s\n", coverBmpPath.c_str());
-      renderBitmapSleepScreen(bitmap);
+      renderBitmapSleepScreen(bitmap, coverBmpPath);
       return;
     }
   }
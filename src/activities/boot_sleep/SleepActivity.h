@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+
 #include "../Activity.h"
 
 class Bitmap;
@@ -13,6 +15,9 @@ class SleepActivity final : public Activity {
   void renderDefaultSleepScreen() const;
   void renderCustomSleepScreen() const;
   void renderCoverSleepScreen() const;
-  void renderBitmapSleepScreen(const Bitmap& bitmap) const;
+  // Renders a bitmap sleep screen; when `sourcePath` is given the resulting panel planes are cached for next time
+  void renderBitmapSleepScreen(const Bitmap& bitmap, const std::string& sourcePath = "") const;
+  // Renders the cached panel planes of `sourcePath`. Returns false if there is no up-to-date cache entry
+  bool renderCachedSleepScreen(const std::string& sourcePath) const;
   void renderBlankSleepScreen() const;
 };
@@ -4,10 +4,10 @@
 #include <GfxRenderer.h>
 #include <HardwareSerial.h>
 #include <I18n.h>
-#include <OpdsStream.h>
 #include <WiFi.h>
 
 #include "CrossPointSettings.h"
+#include "LibraryCatalog.h"
 #include "MappedInputManager.h"
 #include "activities/network/WifiSelectionActivity.h"
 #include "components/UITheme.h"
@@ -18,6 +18,7 @@
 
 namespace {
 constexpr int PAGE_ITEMS = 23;
+constexpr char ENTRIES_FILE[] = "/.crosspoint/opds/entries.bin";
 }  // namespace
 
 void OpdsBookBrowserActivity::taskTrampoline(void* param) {
@@ -29,14 +30,22 @@ void OpdsBookBrowserActivity::onEnter() {
   ActivityWithSubactivity::onEnter();
 
   renderingMutex = xSemaphoreCreateMutex();
+  // The display task reads fonts and the entry list from the card while a feed comes in
+  feedCache.setCardLock([this](const bool locked) {
+    if (locked) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    } else {
+      xSemaphoreGive(renderingMutex);
+    }
+  });
   state = BrowserState::CHECK_WIFI;
-  entries.clear();
+  entries.begin(ENTRIES_FILE, PAGE_ITEMS);
   navigationHistory.clear();
   currentPath = "";  // Root path - user provides full URL in settings
   selectorIndex = 0;
   errorMessage.clear();
   statusMessage = TR(CHECKING_WIFI);
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&OpdsBookBrowserActivity::taskTrampoline, "OpdsBookBrowserTask",
               4096,               // Stack size (larger for HTTP operations)
@@ -46,7 +55,15 @@ void OpdsBookBrowserActivity::onEnter() {
   );
 
   // Check WiFi and connect if needed, then fetch feed
-  checkAndConnectWifi();
+  if (SETTINGS.opdsOffline) {
+    Serial.printf("[%lu] [OPDS] Offline mode, browsing cached feeds\n", millis());
+    state = BrowserState::LOADING;
+    statusMessage = TR(LOADING);
+    updateRequired.request();
+    fetchFeed(currentPath);
+  } else {
+    checkAndConnectWifi();
+  }
 }
 
 void OpdsBookBrowserActivity::onExit() {
@@ -58,11 +75,12 @@ void OpdsBookBrowserActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
-  entries.clear();
+  entries.end();
   navigationHistory.clear();
 }
 
@@ -76,13 +94,13 @@ void OpdsBookBrowserActivity::loop() {
   // Handle error state - Confirm retries, Back goes back or home
   if (state == BrowserState::ERROR) {
     if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
-      // Check if WiFi is still connected
-      if (WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0)) {
+      // Check if WiFi is still connected, offline mode doesn't need it
+      if (SETTINGS.opdsOffline || (WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0))) {
         // WiFi connected - just retry fetching the feed
         Serial.printf("[%lu] [OPDS] Retry: WiFi connected, retrying fetch\n", millis());
         state = BrowserState::LOADING;
         statusMessage = TR(LOADING);
-        updateRequired = true;
+        updateRequired.request();
         fetchFeed(currentPath);
       } else {
         // WiFi not connected - launch WiFi selection
@@ -119,8 +137,12 @@ void OpdsBookBrowserActivity::loop() {
   // Handle browsing state
   if (state == BrowserState::BROWSING) {
     if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
-      if (!entries.empty()) {
-        const auto& entry = entries[selectorIndex];
+      // A copy, the display task may bring in another window of the list
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      const OpdsEntry* selected = entries.get(selectorIndex);
+      const OpdsEntry entry = selected ? *selected : OpdsEntry{};
+      xSemaphoreGive(renderingMutex);
+      if (!entry.href.empty()) {
         if (entry.type == OpdsEntryType::BOOK) {
           downloadBook(entry);
         } else {
@@ -134,23 +156,31 @@ void OpdsBookBrowserActivity::loop() {
     // Handle navigation
     if (!entries.empty()) {
       buttonNavigator.onNextRelease([this] {
+        if (selectorIndex + 1 == static_cast<int>(entries.size()) && !nextPageHref.empty()) {
+          fetchNextPage();
+          return;
+        }
         selectorIndex = ButtonNavigator::nextIndex(selectorIndex, entries.size());
-        updateRequired = true;
+        updateRequired.request();
       });
 
       buttonNavigator.onPreviousRelease([this] {
         selectorIndex = ButtonNavigator::previousIndex(selectorIndex, entries.size());
-        updateRequired = true;
+        updateRequired.request();
       });
 
       buttonNavigator.onNextContinuous([this] {
+        if (onLastScreen() && !nextPageHref.empty()) {
+          fetchNextPage();
+          return;
+        }
         selectorIndex = ButtonNavigator::nextPageIndex(selectorIndex, entries.size(), PAGE_ITEMS);
-        updateRequired = true;
+        updateRequired.request();
       });
 
       buttonNavigator.onPreviousContinuous([this] {
         selectorIndex = ButtonNavigator::previousPageIndex(selectorIndex, entries.size(), PAGE_ITEMS);
-        updateRequired = true;
+        updateRequired.request();
       });
     }
   }
@@ -158,17 +188,16 @@ void OpdsBookBrowserActivity::loop() {
 
 void OpdsBookBrowserActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
-void OpdsBookBrowserActivity::render() const {
+void OpdsBookBrowserActivity::render() {
   renderer.clearScreen();
 
   const auto pageWidth = renderer.getScreenWidth();
@@ -210,6 +239,11 @@ void OpdsBookBrowserActivity::render() const {
       constexpr int barX = 50;
       const int barY = pageHeight / 2 + 20;
       GUI.drawProgressBar(renderer, Rect{barX, barY, barWidth, barHeight}, downloadProgress, downloadTotal);
+
+      char transferred[48];
+      snprintf(transferred, sizeof(transferred), "%.1f / %.1f MB, %u KB/s", downloadProgress / 1048576.0f,
+               downloadTotal / 1048576.0f, static_cast<unsigned>(downloadRate / 1024));
+      renderer.drawCenteredText(UI_10_FONT_ID, barY + barHeight + 20, transferred);
     }
     renderer.displayBuffer();
     return;
@@ -218,7 +252,8 @@ void OpdsBookBrowserActivity::render() const {
   // Browsing state
   // Show appropriate button hint based on selected entry type
   const char* confirmLabel = TR(OPEN);
-  if (!entries.empty() && entries[selectorIndex].type == OpdsEntryType::BOOK) {
+  const OpdsEntry* selected = entries.get(selectorIndex);
+  if (selected && selected->type == OpdsEntryType::BOOK) {
     confirmLabel = TR(DOWNLOAD);
   }
   const auto labels = mappedInput.mapLabels(TR(BACK), confirmLabel, "", "");
@@ -234,7 +269,11 @@ void OpdsBookBrowserActivity::render() const {
   renderer.fillRect(0, 60 + (selectorIndex % PAGE_ITEMS) * 30 - 2, pageWidth - 1, 30);
 
   for (size_t i = pageStartIndex; i < entries.size() && i < static_cast<size_t>(pageStartIndex + PAGE_ITEMS); i++) {
-    const auto& entry = entries[i];
+    const OpdsEntry* listed = entries.get(i);
+    if (!listed) {
+      break;
+    }
+    const auto& entry = *listed;
 
     // Format display text with type indicator
     std::string displayText;
@@ -256,50 +295,111 @@ void OpdsBookBrowserActivity::render() const {
   renderer.displayBuffer();
 }
 
-void OpdsBookBrowserActivity::fetchFeed(const std::string& path) {
+bool OpdsBookBrowserActivity::onLastScreen() const {
+  return entries.empty() || selectorIndex / PAGE_ITEMS == static_cast<int>((entries.size() - 1) / PAGE_ITEMS);
+}
+
+bool OpdsBookBrowserActivity::appendFeed(const std::string& path) {
   const char* serverUrl = SETTINGS.opdsServerUrl;
   if (strlen(serverUrl) == 0) {
-    state = BrowserState::ERROR;
     errorMessage = TR(NO_SERVER_URL);
-    updateRequired = true;
-    return;
+    return false;
   }
 
   std::string url = UrlUtils::buildUrl(serverUrl, path);
   Serial.printf("[%lu] [OPDS] Fetching: %s\n", millis(), url.c_str());
 
+  // The list is shown as soon as the screen holding the first new entry is complete, the rest keeps arriving
+  // behind it
+  const size_t firstNew = entries.size();
+  const size_t firstScreenEnd = (firstNew / PAGE_ITEMS + 1) * PAGE_ITEMS;
+  const unsigned long start = millis();
   OpdsParser parser;
-
-  {
-    OpdsParserStream stream{parser};
-    if (!HttpDownloader::fetchUrl(url, stream)) {
-      state = BrowserState::ERROR;
-      errorMessage = TR(FETCH_FEED_FAILED);
-      updateRequired = true;
-      return;
+  parser.onEntry([this, firstNew, firstScreenEnd, start](const OpdsEntry& entry) {
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    entries.add(entry);
+    const bool screenComplete = entries.size() == firstScreenEnd;
+    if (screenComplete) {
+      selectorIndex = static_cast<int>(firstNew);
+      state = BrowserState::BROWSING;
+    }
+    xSemaphoreGive(renderingMutex);
+    if (screenComplete) {
+      Serial.printf("[%lu] [OPDS] First screen after %lu ms\n", millis(), millis() - start);
+      updateRequired.request();
+    }
+  });
+
+  const auto result = feedCache.fetch(url, parser, SETTINGS.opdsOffline);
+  parser.flush();
+  const bool fetched = result == OpdsFeedCache::Result::DOWNLOADED || result == OpdsFeedCache::Result::NOT_MODIFIED ||
+                       result == OpdsFeedCache::Result::CACHED;
+
+  const size_t added = entries.size() - firstNew;
+  Serial.printf("[%lu] [OPDS] Found %u entries in %lu ms\n", millis(), static_cast<unsigned>(added), millis() - start);
+  if (!fetched || !parser) {
+    if (added == 0) {
+      if (result == OpdsFeedCache::Result::NOT_CACHED) {
+        errorMessage = TR(NOT_AVAILABLE_OFFLINE);
+      } else {
+        errorMessage = fetched ? TR(PARSE_FEED_FAILED) : TR(FETCH_FEED_FAILED);
+      }
+      return false;
     }
+    // Cut short: what arrived is shown, a next page link may not have been reached
+    Serial.printf("[%lu] [OPDS] Feed incomplete, keeping %u entries\n", millis(), static_cast<unsigned>(added));
+    nextPageHref.clear();
+  } else {
+    nextPageHref = parser.getNextHref();
   }
 
-  if (!parser) {
-    state = BrowserState::ERROR;
-    errorMessage = TR(PARSE_FEED_FAILED);
-    updateRequired = true;
-    return;
+  if (added > 0 && state != BrowserState::BROWSING) {
+    selectorIndex = static_cast<int>(firstNew);
   }
+  return true;
+}
 
-  entries = std::move(parser).getEntries();
-  Serial.printf("[%lu] [OPDS] Found %d entries\n", millis(), entries.size());
+void OpdsBookBrowserActivity::fetchFeed(const std::string& path) {
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  entries.clear();
+  xSemaphoreGive(renderingMutex);
+  nextPageHref.clear();
   selectorIndex = 0;
 
+  if (!appendFeed(path)) {
+    state = BrowserState::ERROR;
+    updateRequired.request();
+    return;
+  }
+
   if (entries.empty()) {
     state = BrowserState::ERROR;
     errorMessage = TR(NO_ENTRIES);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
-  state = BrowserState::BROWSING;
-  updateRequired = true;
+  // Already on screen unless the feed is shorter than a screen
+  if (state != BrowserState::BROWSING) {
+    state = BrowserState::BROWSING;
+    updateRequired.request();
+  }
+}
+
+void OpdsBookBrowserActivity::fetchNextPage() {
+  const std::string path = nextPageHref;
+  state = BrowserState::LOADING;
+  statusMessage = TR(LOADING);
+  updateRequired.request();
+
+  // On failure the list stays as it was, scrolling past its end tries again
+  if (!appendFeed(path)) {
+    Serial.printf("[%lu] [OPDS] Next page failed: %s\n", millis(), errorMessage.c_str());
+  }
+  if (state != BrowserState::BROWSING) {
+    state = BrowserState::BROWSING;
+    updateRequired.request();
+  }
 }
 
 void OpdsBookBrowserActivity::navigateToEntry(const OpdsEntry& entry) {
@@ -309,9 +409,7 @@ void OpdsBookBrowserActivity::navigateToEntry(const OpdsEntry& entry) {
 
   state = BrowserState::LOADING;
   statusMessage = "Loading...";
-  entries.clear();
-  selectorIndex = 0;
-  updateRequired = true;
+  updateRequired.request();
 
   fetchFeed(currentPath);
 }
@@ -327,20 +425,26 @@ void OpdsBookBrowserActivity::navigateBack() {
 
     state = BrowserState::LOADING;
     statusMessage = TR(LOADING);
-    entries.clear();
-    selectorIndex = 0;
-    updateRequired = true;
+    updateRequired.request();
 
     fetchFeed(currentPath);
   }
 }
 
 void OpdsBookBrowserActivity::downloadBook(const OpdsEntry& book) {
+  if (SETTINGS.opdsOffline) {
+    state = BrowserState::ERROR;
+    errorMessage = TR(OFFLINE_DOWNLOAD_DISABLED);
+    updateRequired.request();
+    return;
+  }
+
   state = BrowserState::DOWNLOADING;
   statusMessage = book.title;
   downloadProgress = 0;
   downloadTotal = 0;
-  updateRequired = true;
+  downloadRate = 0;
+  updateRequired.request();
 
   // Build full download URL
   std::string downloadUrl = UrlUtils::buildUrl(SETTINGS.opdsServerUrl, book.href);
@@ -354,11 +458,20 @@ void OpdsBookBrowserActivity::downloadBook(const OpdsEntry& book) {
 
   Serial.printf("[%lu] [OPDS] Downloading: %s -> %s\n", millis(), downloadUrl.c_str(), filename.c_str());
 
-  const auto result =
-      HttpDownloader::downloadToFile(downloadUrl, filename, [this](const size_t downloaded, const size_t total) {
+  // The first report is where a resumed download picks up. A retry the server answers from the start begins again.
+  unsigned long startTime = millis();
+  size_t startBytes = SIZE_MAX;
+  const auto result = HttpDownloader::downloadToFile(
+      downloadUrl, filename, [this, &startTime, &startBytes](const size_t downloaded, const size_t total) {
+        if (startBytes == SIZE_MAX || downloaded < startBytes) {
+          startBytes = downloaded;
+          startTime = millis();
+        }
+        const unsigned long elapsed = millis() - startTime;
+        downloadRate = elapsed > 0 ? static_cast<uint64_t>(downloaded - startBytes) * 1000 / elapsed : 0;
         downloadProgress = downloaded;
         downloadTotal = total;
-        updateRequired = true;
+        updateRequired.request();
       });
 
   if (result == HttpDownloader::OK) {
@@ -368,13 +481,14 @@ void OpdsBookBrowserActivity::downloadBook(const OpdsEntry& book) {
     Epub epub(filename, "/.crosspoint");
     epub.clearCache();
     Serial.printf("[%lu] [OPDS] Cleared cache for: %s\n", millis(), filename.c_str());
+    LIBRARY_CATALOG.invalidateParentOf(filename);
 
     state = BrowserState::BROWSING;
-    updateRequired = true;
+    updateRequired.request();
   } else {
     state = BrowserState::ERROR;
     errorMessage = TR(DOWNLOAD_FAILED);
-    updateRequired = true;
+    updateRequired.request();
   }
 }
 
@@ -383,7 +497,7 @@ void OpdsBookBrowserActivity::checkAndConnectWifi() {
   if (WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0)) {
     state = BrowserState::LOADING;
     statusMessage = TR(LOADING);
-    updateRequired = true;
+    updateRequired.request();
     fetchFeed(currentPath);
     return;
   }
@@ -394,7 +508,7 @@ void OpdsBookBrowserActivity::checkAndConnectWifi() {
 
 void OpdsBookBrowserActivity::launchWifiSelection() {
   state = BrowserState::WIFI_SELECTION;
-  updateRequired = true;
+  updateRequired.request();
 
   enterNewActivity(new WifiSelectionActivity(renderer, mappedInput,
                                              [this](const bool connected) { onWifiSelectionComplete(connected); }));
@@ -407,7 +521,7 @@ void OpdsBookBrowserActivity::onWifiSelectionComplete(const bool connected) {
     Serial.printf("[%lu] [OPDS] WiFi connected via selection, fetching feed\n", millis());
     state = BrowserState::LOADING;
     statusMessage = TR(LOADING);
-    updateRequired = true;
+    updateRequired.request();
     fetchFeed(currentPath);
   } else {
     Serial.printf("[%lu] [OPDS] WiFi selection cancelled/failed\n", millis());
@@ -417,6 +531,6 @@ void OpdsBookBrowserActivity::onWifiSelectionComplete(const bool connected) {
     WiFi.mode(WIFI_OFF);
     state = BrowserState::ERROR;
     errorMessage = TR(WIFI_CONN_FAILED);
-    updateRequired = true;
+    updateRequired.request();
   }
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <OpdsEntryList.h>
 #include <OpdsParser.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
@@ -9,12 +10,16 @@
 #include <vector>
 
 #include "../ActivityWithSubactivity.h"
+#include "network/OpdsFeedCache.h"
 #include "util/ButtonNavigator.h"
 
 /**
  * Activity for browsing and downloading books from an OPDS server.
  * Supports navigation through catalog hierarchy and downloading EPUBs.
  * When WiFi connection fails, launches WiFi selection to let user connect.
+ * Feeds are parsed as they download and shown once the first screen is complete. Entries go to an OpdsEntryList, so
+ * only the screen on display is in memory, and scrolling past the end of a paginated feed fetches its next page.
+ * Feeds go through an OpdsFeedCache; with "Offline Mode" on, Wi-Fi stays off and only cached feeds are shown.
  */
 class OpdsBookBrowserActivity final : public ActivityWithSubactivity {
  public:
@@ -39,28 +44,33 @@ class OpdsBookBrowserActivity final : public ActivityWithSubactivity {
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
   ButtonNavigator buttonNavigator;
-  bool updateRequired = false;
 
   BrowserState state = BrowserState::LOADING;
-  std::vector<OpdsEntry> entries;
+  OpdsEntryList entries;
+  OpdsFeedCache feedCache;
   std::vector<std::string> navigationHistory;  // Stack of previous feed paths for back navigation
   std::string currentPath;                     // Current feed path being displayed
+  std::string nextPageHref;                    // rel="next" of the last page in `entries`, empty if there is none
   int selectorIndex = 0;
   std::string errorMessage;
   std::string statusMessage;
   size_t downloadProgress = 0;
   size_t downloadTotal = 0;
+  size_t downloadRate = 0;  // Bytes per second received so far, resumed bytes not counted
 
   const std::function<void()> onGoHome;
 
   static void taskTrampoline(void* param);
   [[noreturn]] void displayTaskLoop();
-  void render() const;
+  void render();
 
   void checkAndConnectWifi();
   void launchWifiSelection();
   void onWifiSelectionComplete(bool connected);
   void fetchFeed(const std::string& path);
+  void fetchNextPage();
+  bool appendFeed(const std::string& path);
+  bool onLastScreen() const;
   void navigateToEntry(const OpdsEntry& entry);
   void navigateBack();
   void downloadBook(const OpdsEntry& book);
@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "Battery.h"
+#include "BookCacheManager.h"
+#include "BookPreparer.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "MappedInputManager.h"
@@ -20,6 +22,11 @@
 #include "fontIds.h"
 #include "util/StringUtils.h"
 
+namespace {
+// Cache quota upkeep only runs once the buttons have been idle for this long
+constexpr unsigned long BACKGROUND_IDLE_MS = 400;
+}  // namespace
+
 void HomeActivity::taskTrampoline(void* param) {
   auto* self = static_cast<HomeActivity*>(param);
   self->displayTaskLoop();
@@ -91,7 +98,7 @@ void HomeActivity::loadRecentCovers(int coverHeight) {
             }
           }
           coverRendered = false;
-          updateRequired = true;
+          updateRequired.request();
         } else if (StringUtils::checkFileExtension(book.path, ".xtch") ||
                    StringUtils::checkFileExtension(book.path, ".xtc")) {
           // Handle XTC file
@@ -112,7 +119,7 @@ void HomeActivity::loadRecentCovers(int coverHeight) {
               }
             }
             coverRendered = false;
-            updateRequired = true;
+            updateRequired.request();
           }
         }
       }
@@ -138,7 +145,8 @@ void HomeActivity::onEnter() {
   loadRecentBooks(metrics.homeRecentBooksCount);
 
   // Trigger first update
-  updateRequired = true;
+  updateRequired.request();
+  lastInputTime = millis();
 
   xTaskCreate(&HomeActivity::taskTrampoline, "HomeActivityTask",
               8192,               // Stack size
@@ -155,6 +163,7 @@ void HomeActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -207,18 +216,24 @@ void HomeActivity::freeCoverBuffer() {
 }
 
 void HomeActivity::loop() {
+  if (mappedInput.wasAnyPressed() || mappedInput.wasAnyReleased()) {
+    lastInputTime = millis();
+  }
+
   const int menuCount = getMenuItemCount();
 
   buttonNavigator.onNext([this, menuCount] {
     selectorIndex = ButtonNavigator::nextIndex(selectorIndex, menuCount);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPrevious([this, menuCount] {
     selectorIndex = ButtonNavigator::previousIndex(selectorIndex, menuCount);
-    updateRequired = true;
+    updateRequired.request();
   });
 
+  runBackgroundWork();
+
   if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
     // Calculate dynamic indices based on which options are available
     int idx = 0;
@@ -245,15 +260,34 @@ void HomeActivity::loop() {
   }
 }
 
+void HomeActivity::runBackgroundWork() {
+  // Leave the card to the recent book covers until they are loaded
+  if (!recentsLoaded || updateRequired.isPending() || millis() - lastInputTime < BACKGROUND_IDLE_MS) {
+    return;
+  }
+  // Books waiting since a web server session are prepared first, their caches count towards the quota. Their steps
+  // take seconds, so they wait for a longer pause and lay out chapters only until the next button press.
+  const bool prepare = millis() - lastInputTime >= BookPreparer::UI_IDLE_MS && BOOK_PREPARER.hasPendingWork();
+  if (!prepare && !BOOK_CACHE.hasPendingWork()) {
+    return;
+  }
+
+  // SD access is shared with rendering, so only touch the card while the display task is idle
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  if (!prepare || !BOOK_PREPARER.runStep(renderer, [this] { return mappedInput.pollAnyInput(); })) {
+    BOOK_CACHE.runStep();
+  }
+  xSemaphoreGive(renderingMutex);
+}
+
 void HomeActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -293,7 +327,7 @@ void HomeActivity::render() {
 
   if (!firstRenderDone) {
     firstRenderDone = true;
-    updateRequired = true;
+    updateRequired.request();
   } else if (!recentsLoaded && !recentsLoading) {
     recentsLoading = true;
     // Free the cover buffer before thumbnail generation to reclaim up to
@@ -1,29 +1,32 @@
 #include "MyLibraryActivity.h"
 
 #include <GfxRenderer.h>
-#include <HalStorage.h>
 #include <I18n.h>
 
-#include <algorithm>
-
+#include "BookCacheManager.h"
 #include "MappedInputManager.h"
 #include "components/UITheme.h"
 #include "fontIds.h"
-#include "util/StringUtils.h"
 
 namespace {
 constexpr unsigned long GO_HOME_MS = 1000;
-}  // namespace
-
-void sortFileList(std::vector<std::string>& strs) {
-  std::sort(begin(strs), end(strs), [](const std::string& str1, const std::string& str2) {
-    if (str1.back() == '/' && str2.back() != '/') return true;
-    if (str1.back() != '/' && str2.back() == '/') return false;
-    return lexicographical_compare(
-        begin(str1), end(str1), begin(str2), end(str2),
-        [](const char& char1, const char& char2) { return tolower(char1) < tolower(char2); });
-  });
+constexpr unsigned long SORT_CHANGE_MS = 1000;
+// Background catalog work only runs once the buttons have been idle for this long
+constexpr unsigned long BACKGROUND_IDLE_MS = 400;
+// Re-sort and redraw after this many books got their metadata, instead of after every book
+constexpr int EXTRACTIONS_PER_REFRESH = 8;
+
+const char* sortModeLabel(const LibraryCatalog::SortMode mode) {
+  switch (mode) {
+    case LibraryCatalog::SortMode::AUTHOR:
+      return TR(LIBRARY_SORT_AUTHOR);
+    case LibraryCatalog::SortMode::RECENT:
+      return TR(LIBRARY_SORT_RECENT);
+    default:
+      return TR(LIBRARY_SORT_TITLE);
+  }
 }
+}  // namespace
 
 void MyLibraryActivity::taskTrampoline(void* param) {
   auto* self = static_cast<MyLibraryActivity*>(param);
@@ -31,38 +34,44 @@ void MyLibraryActivity::taskTrampoline(void* param) {
 }
 
 void MyLibraryActivity::loadFiles() {
-  files.clear();
-
-  auto root = Storage.open(basepath.c_str());
-  if (!root || !root.isDirectory()) {
-    if (root) root.close();
-    return;
-  }
-
-  root.rewindDirectory();
-
-  char name[500];
-  for (auto file = root.openNextFile(); file; file = root.openNextFile()) {
-    file.getName(name, sizeof(name));
-    if (name[0] == '.' || strcmp(name, "System Volume Information") == 0) {
-      file.close();
-      continue;
+  // Rendering reads catalog rows from the SD card, don't swap the listing underneath it
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  entries.clear();
+  cachedPageStart = -1;
+  extractedSinceSort = 0;
+
+  bool stale = false;
+  const bool listed = LIBRARY_CATALOG.listDirectory(basepath, entries, stale);
+  if (listed) {
+    if (stale && entries.empty()) {
+      // Nothing catalogued yet, so there is nothing to show while a background rescan runs
+      LIBRARY_CATALOG.rescanDirectory(basepath, entries);
+      stale = false;
     }
+    sortEntries(-1);
+  }
+  rescanPending = listed && stale;
+  xSemaphoreGive(renderingMutex);
+}
 
-    if (file.isDirectory()) {
-      files.emplace_back(std::string(name) + "/");
-    } else {
-      auto filename = std::string(name);
-      if (StringUtils::checkFileExtension(filename, ".epub") || StringUtils::checkFileExtension(filename, ".xtch") ||
-          StringUtils::checkFileExtension(filename, ".xtc") || StringUtils::checkFileExtension(filename, ".txt") ||
-          StringUtils::checkFileExtension(filename, ".md")) {
-        files.emplace_back(filename);
+void MyLibraryActivity::sortEntries(const int keepSlot) {
+  LIBRARY_CATALOG.sortEntries(entries, sortMode);
+  cachedPageStart = -1;
+  if (keepSlot >= 0) {
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (entries[i].slot == keepSlot) {
+        selectorIndex = i;
+        return;
       }
     }
-    file.close();
   }
-  root.close();
-  sortFileList(files);
+  if (selectorIndex >= entries.size()) {
+    selectorIndex = 0;
+  }
+}
+
+int MyLibraryActivity::selectedSlot() const {
+  return selectorIndex < entries.size() ? entries[selectorIndex].slot : -1;
 }
 
 void MyLibraryActivity::onEnter() {
@@ -70,10 +79,11 @@ void MyLibraryActivity::onEnter() {
 
   renderingMutex = xSemaphoreCreateMutex();
 
+  selectorIndex = 0;
   loadFiles();
 
-  selectorIndex = 0;
-  updateRequired = true;
+  lastInputTime = millis();
+  updateRequired.request();
 
   xTaskCreate(&MyLibraryActivity::taskTrampoline, "MyLibraryActivityTask",
               4096,               // Stack size
@@ -90,40 +100,71 @@ void MyLibraryActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
 
-  files.clear();
+  entries.clear();
+  cachedTitles.clear();
+  cachedValues.clear();
 }
 
 void MyLibraryActivity::loop() {
+  if (mappedInput.wasAnyPressed() || mappedInput.wasAnyReleased()) {
+    lastInputTime = millis();
+  }
+
   // Long press BACK (1s+) goes to root folder
   if (mappedInput.isPressed(MappedInputManager::Button::Back) && mappedInput.getHeldTime() >= GO_HOME_MS &&
       basepath != "/") {
     basepath = "/";
-    loadFiles();
     selectorIndex = 0;
-    updateRequired = true;
+    loadFiles();
+    updateRequired.request();
+    return;
+  }
+
+  // Long press CONFIRM (1s+) cycles the sort order
+  if (mappedInput.isPressed(MappedInputManager::Button::Confirm) && mappedInput.getHeldTime() >= SORT_CHANGE_MS &&
+      !sortChangeHandled) {
+    sortChangeHandled = true;
+    sortMode = static_cast<LibraryCatalog::SortMode>((static_cast<uint8_t>(sortMode) + 1) %
+                                                     static_cast<uint8_t>(LibraryCatalog::SortMode::SORT_MODE_COUNT));
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    sortEntries(selectedSlot());
+    xSemaphoreGive(renderingMutex);
+    updateRequired.request();
     return;
   }
 
   const int pageItems = UITheme::getInstance().getNumberOfItemsPerPage(renderer, true, false, true, false);
 
   if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
-    if (files.empty()) {
+    if (sortChangeHandled) {
+      sortChangeHandled = false;
+      return;
+    }
+    if (entries.empty()) {
       return;
     }
 
-    if (basepath.back() != '/') basepath += "/";
-    if (files[selectorIndex].back() == '/') {
-      basepath += files[selectorIndex].substr(0, files[selectorIndex].length() - 1);
-      loadFiles();
+    LibraryCatalog::Record record;
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    const bool recordRead = LIBRARY_CATALOG.readRecord(entries[selectorIndex].slot, record);
+    const std::string path = recordRead ? LIBRARY_CATALOG.resolvePath(basepath, record) : "";
+    xSemaphoreGive(renderingMutex);
+    if (!recordRead) {
+      return;
+    }
+    if (entries[selectorIndex].isDirectory()) {
+      basepath = path;
       selectorIndex = 0;
-      updateRequired = true;
+      loadFiles();
+      updateRequired.request();
     } else {
-      onSelectBook(basepath + files[selectorIndex]);
+      onSelectBook(path);
       return;
     }
   }
@@ -132,55 +173,110 @@ void MyLibraryActivity::loop() {
     // Short press: go up one directory, or go home if at root
     if (mappedInput.getHeldTime() < GO_HOME_MS) {
       if (basepath != "/") {
-        const std::string oldPath = basepath;
+        const std::string oldPath = LibraryCatalog::normalizeDirectory(basepath);
 
+        basepath = oldPath;
         basepath.replace(basepath.find_last_of('/'), std::string::npos, "");
         if (basepath.empty()) basepath = "/";
+        selectorIndex = 0;
         loadFiles();
+        selectorIndex = findEntry(LibraryCatalog::hashPath(oldPath));
 
-        const auto pos = oldPath.find_last_of('/');
-        const std::string dirName = oldPath.substr(pos + 1) + "/";
-        selectorIndex = findEntry(dirName);
-
-        updateRequired = true;
+        updateRequired.request();
       } else {
         onGoHome();
       }
     }
   }
 
-  int listSize = static_cast<int>(files.size());
+  int listSize = static_cast<int>(entries.size());
 
   buttonNavigator.onNextRelease([this, listSize] {
     selectorIndex = ButtonNavigator::nextIndex(static_cast<int>(selectorIndex), listSize);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPreviousRelease([this, listSize] {
     selectorIndex = ButtonNavigator::previousIndex(static_cast<int>(selectorIndex), listSize);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onNextContinuous([this, listSize, pageItems] {
     selectorIndex = ButtonNavigator::nextPageIndex(static_cast<int>(selectorIndex), listSize, pageItems);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPreviousContinuous([this, listSize, pageItems] {
     selectorIndex = ButtonNavigator::previousPageIndex(static_cast<int>(selectorIndex), listSize, pageItems);
-    updateRequired = true;
+    updateRequired.request();
   });
+
+  runBackgroundWork();
+}
+
+void MyLibraryActivity::runBackgroundWork() {
+  if (millis() - lastInputTime < BACKGROUND_IDLE_MS || updateRequired.isPending()) {
+    return;
+  }
+  for (const auto button : {MappedInputManager::Button::Back, MappedInputManager::Button::Confirm,
+                            MappedInputManager::Button::Left, MappedInputManager::Button::Right,
+                            MappedInputManager::Button::Up, MappedInputManager::Button::Down}) {
+    if (mappedInput.isPressed(button)) {
+      return;
+    }
+  }
+
+  if (rescanPending) {
+    rescanPending = false;
+    // SD access is shared with rendering, so only touch the card while the display task is idle
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    const int keepSlot = selectedSlot();
+    if (LIBRARY_CATALOG.rescanDirectory(basepath, entries)) {
+      sortEntries(keepSlot);
+      updateRequired.request();
+    }
+    xSemaphoreGive(renderingMutex);
+    return;
+  }
+
+  if (!LIBRARY_CATALOG.hasPendingMetadata()) {
+    // Cache quota upkeep waits until the catalog is complete
+    if (BOOK_CACHE.hasPendingWork()) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      BOOK_CACHE.runStep();
+      xSemaphoreGive(renderingMutex);
+    }
+    return;
+  }
+
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  const int slot = LIBRARY_CATALOG.extractNextMetadata();
+  if (slot >= 0) {
+    for (auto& entry : entries) {
+      if (entry.slot == slot) {
+        LIBRARY_CATALOG.readIndex(entry.slot, entry.index);
+        break;
+      }
+    }
+    extractedSinceSort++;
+  }
+  if (extractedSinceSort > 0 &&
+      (extractedSinceSort >= EXTRACTIONS_PER_REFRESH || !LIBRARY_CATALOG.hasPendingMetadata())) {
+    extractedSinceSort = 0;
+    sortEntries(selectedSlot());
+    updateRequired.request();
+  }
+  xSemaphoreGive(renderingMutex);
 }
 
 void MyLibraryActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -191,28 +287,57 @@ void MyLibraryActivity::render() const {
   const auto pageHeight = renderer.getScreenHeight();
   auto metrics = UITheme::getInstance().getMetrics();
 
-  auto folderName = basepath == "/" ? TR(SD_CARD) : basepath.substr(basepath.rfind('/') + 1).c_str();
-  GUI.drawHeader(renderer, Rect{0, metrics.topPadding, pageWidth, metrics.headerHeight}, folderName);
+  const std::string folderName = basepath == "/" ? TR(SD_CARD) : basepath.substr(basepath.rfind('/') + 1);
+  const std::string headerTitle = folderName + " (" + sortModeLabel(sortMode) + ")";
+  GUI.drawHeader(renderer, Rect{0, metrics.topPadding, pageWidth, metrics.headerHeight}, headerTitle.c_str());
 
   const int contentTop = metrics.topPadding + metrics.headerHeight + metrics.verticalSpacing;
   const int contentHeight = pageHeight - contentTop - metrics.buttonHintsHeight - metrics.verticalSpacing;
-  if (files.empty()) {
+  if (entries.empty()) {
     renderer.drawText(UI_10_FONT_ID, metrics.contentSidePadding, contentTop + 20, TR(NO_BOOKS_FOUND));
   } else {
+    // Only the rows on the current page are read from the catalog
+    const int pageItems = UITheme::getInstance().getNumberOfItemsPerPage(renderer, true, false, true, false);
+    const int pageStart = pageItems > 0 ? static_cast<int>(selectorIndex) / pageItems * pageItems : 0;
+    loadVisibleRows(pageStart, pageItems);
     GUI.drawList(
-        renderer, Rect{0, contentTop, pageWidth, contentHeight}, files.size(), selectorIndex,
-        [this](int index) { return files[index]; }, nullptr, nullptr, nullptr);
+        renderer, Rect{0, contentTop, pageWidth, contentHeight}, entries.size(), selectorIndex,
+        [this, pageStart](int index) { return cachedTitles[index - pageStart]; }, nullptr, nullptr,
+        [this, pageStart](int index) { return cachedValues[index - pageStart]; });
   }
 
   // Help text
   const auto labels = mappedInput.mapLabels(TR(HOME), TR(OPEN), TR(DIR_UP), TR(DIR_DOWN));
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
 
-  renderer.displayBuffer();
+  renderer.displayChanges();
 }
 
-size_t MyLibraryActivity::findEntry(const std::string& name) const {
-  for (size_t i = 0; i < files.size(); i++)
-    if (files[i] == name) return i;
+void MyLibraryActivity::loadVisibleRows(const int pageStart, const int pageItems) const {
+  if (cachedPageStart == pageStart) {
+    return;
+  }
+
+  cachedTitles.clear();
+  cachedValues.clear();
+  LibraryCatalog::Record record;
+  for (int i = pageStart; i < static_cast<int>(entries.size()) && i < pageStart + pageItems; i++) {
+    const auto& entry = entries[i];
+    if (!LIBRARY_CATALOG.readRecord(entry.slot, record)) {
+      cachedTitles.emplace_back("");
+      cachedValues.emplace_back("");
+      continue;
+    }
+    cachedTitles.push_back(LibraryCatalog::displayTitle(record));
+    cachedValues.push_back(!entry.isDirectory() && entry.index.progress > 0
+                               ? std::to_string(entry.index.progress) + "%"
+                               : std::string());
+  }
+  cachedPageStart = pageStart;
+}
+
+size_t MyLibraryActivity::findEntry(const uint32_t pathHash) const {
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].index.pathHash == pathHash) return i;
   return 0;
-}
\ No newline at end of file
+}
@@ -8,7 +8,7 @@
 #include <vector>
 
 #include "../Activity.h"
-#include "RecentBooksStore.h"
+#include "LibraryCatalog.h"
 #include "util/ButtonNavigator.h"
 
 class MyLibraryActivity final : public Activity {
@@ -18,11 +18,20 @@ class MyLibraryActivity final : public Activity {
   ButtonNavigator buttonNavigator;
 
   size_t selectorIndex = 0;
-  bool updateRequired = false;
+  bool sortChangeHandled = false;
 
-  // Files state
+  // Files state, backed by the library catalog
   std::string basepath = "/";
-  std::vector<std::string> files;
+  std::vector<LibraryCatalog::Entry> entries;
+  LibraryCatalog::SortMode sortMode = LibraryCatalog::SortMode::TITLE;
+  bool rescanPending = false;
+  int extractedSinceSort = 0;
+  unsigned long lastInputTime = 0;
+
+  // Rows of the visible page, read from the catalog on demand
+  mutable int cachedPageStart = -1;
+  mutable std::vector<std::string> cachedTitles;
+  mutable std::vector<std::string> cachedValues;
 
   // Callbacks
   const std::function<void(const std::string& path)> onSelectBook;
@@ -34,7 +43,11 @@ class MyLibraryActivity final : public Activity {
 
   // Data loading
   void loadFiles();
-  size_t findEntry(const std::string& name) const;
+  void sortEntries(int keepSlot);
+  void runBackgroundWork();
+  void loadVisibleRows(int pageStart, int pageItems) const;
+  int selectedSlot() const;
+  size_t findEntry(uint32_t pathHash) const;
 
  public:
   explicit MyLibraryActivity(GfxRenderer& renderer, MappedInputManager& mappedInput,
@@ -18,7 +18,6 @@ class RecentBooksActivity final : public Activity {
   ButtonNavigator buttonNavigator;
 
   size_t selectorIndex = 0;
-  bool updateRequired = false;
 
   // Recent tab state
   std::vector<RecentBook> recentBooks;
@@ -6,6 +6,7 @@
 #include <WiFi.h>
 #include <esp_task_wdt.h>
 
+#include "BookPreparer.h"
 #include "MappedInputManager.h"
 #include "WifiSelectionActivity.h"
 #include "components/UITheme.h"
@@ -24,7 +25,7 @@ void CalibreConnectActivity::onEnter() {
   ActivityWithSubactivity::onEnter();
 
   renderingMutex = xSemaphoreCreateMutex();
-  updateRequired = true;
+  updateRequired.request();
   state = CalibreConnectState::WIFI_SELECTION;
   connectedIP.clear();
   connectedSSID.clear();
@@ -68,6 +69,7 @@ void CalibreConnectActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -93,7 +95,7 @@ void CalibreConnectActivity::onWifiSelectionComplete(const bool connected) {
 
 void CalibreConnectActivity::startWebServer() {
   state = CalibreConnectState::SERVER_STARTING;
-  updateRequired = true;
+  updateRequired.request();
 
   if (MDNS.begin(HOSTNAME)) {
     // mDNS is optional for the Calibre plugin but still helpful for users.
@@ -105,10 +107,10 @@ void CalibreConnectActivity::startWebServer() {
 
   if (webServer->isRunning()) {
     state = CalibreConnectState::SERVER_RUNNING;
-    updateRequired = true;
+    updateRequired.request();
   } else {
     state = CalibreConnectState::ERROR;
-    updateRequired = true;
+    updateRequired.request();
   }
 }
 
@@ -152,6 +154,14 @@ void CalibreConnectActivity::loop() {
     }
     lastHandleClientTime = millis();
 
+    // Prepare received books while no client is using the server
+    if (webServer->idleMs() >= BookPreparer::SERVER_IDLE_MS && BOOK_PREPARER.hasPendingWork()) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      BOOK_PREPARER.runStep(renderer, [this] { return mappedInput.pollAnyInput(); });
+      xSemaphoreGive(renderingMutex);
+      lastHandleClientTime = millis();
+    }
+
     const auto status = webServer->getWsUploadStatus();
     bool changed = false;
     if (status.inProgress) {
@@ -179,7 +189,7 @@ void CalibreConnectActivity::loop() {
       changed = true;
     }
     if (changed) {
-      updateRequired = true;
+      updateRequired.request();
     }
   }
 
@@ -191,13 +201,12 @@ void CalibreConnectActivity::loop() {
 
 void CalibreConnectActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -10,6 +10,7 @@
 
 #include <cstddef>
 
+#include "BookPreparer.h"
 #include "MappedInputManager.h"
 #include "NetworkModeSelectionActivity.h"
 #include "WifiSelectionActivity.h"
@@ -49,7 +50,7 @@ void CrossPointWebServerActivity::onEnter() {
   connectedIP.clear();
   connectedSSID.clear();
   lastHandleClientTime = 0;
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&CrossPointWebServerActivity::taskTrampoline, "WebServerActivityTask",
               2048,               // Stack size
@@ -97,6 +98,7 @@ void CrossPointWebServerActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -144,7 +146,7 @@ void CrossPointWebServerActivity::onNetworkModeSelected(const NetworkMode mode)
   } else {
     // AP mode - start access point
     state = WebServerActivityState::AP_STARTING;
-    updateRequired = true;
+    updateRequired.request();
     startAccessPoint();
   }
 }
@@ -298,7 +300,7 @@ void CrossPointWebServerActivity::loop() {
           Serial.printf("[%lu] [WEBACT] WiFi disconnected! Status: %d\n", millis(), wifiStatus);
           // Show error and exit gracefully
           state = WebServerActivityState::SHUTTING_DOWN;
-          updateRequired = true;
+          updateRequired.request();
           return;
         }
         // Log weak signal warnings
@@ -334,6 +336,14 @@ void CrossPointWebServerActivity::loop() {
         }
       }
       lastHandleClientTime = millis();
+
+      // Prepare received books while no client is using the server
+      if (webServer->idleMs() >= BookPreparer::SERVER_IDLE_MS && BOOK_PREPARER.hasPendingWork()) {
+        xSemaphoreTake(renderingMutex, portMAX_DELAY);
+        BOOK_PREPARER.runStep(renderer, [this] { return mappedInput.pollAnyInput(); });
+        xSemaphoreGive(renderingMutex);
+        lastHandleClientTime = millis();
+      }
     }
 
     // Handle exit on Back button
@@ -346,13 +356,12 @@ void CrossPointWebServerActivity::loop() {
 
 void CrossPointWebServerActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -362,7 +371,7 @@ void CrossPointWebServerActivity::render() const {
   if (state == WebServerActivityState::SERVER_RUNNING) {
     renderer.clearScreen();
     renderServerRunning();
-    renderer.displayBuffer();
+    renderer.displayChanges();
   } else if (state == WebServerActivityState::AP_STARTING) {
     renderer.clearScreen();
     const auto pageHeight = renderer.getScreenHeight();
@@ -48,7 +48,7 @@ void WifiSelectionActivity::onEnter() {
   cachedMacAddress = std::string(macStr);
 
   // Trigger first update to show scanning message
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&WifiSelectionActivity::taskTrampoline, "WifiSelectionTask",
               4096,               // Stack size (larger for WiFi operations)
@@ -83,6 +83,7 @@ void WifiSelectionActivity::onExit() {
   Serial.printf("[%lu] [WIFI] Deleting display task...\n", millis());
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
     Serial.printf("[%lu] [WIFI] Display task deleted\n", millis());
   }
@@ -99,7 +100,7 @@ void WifiSelectionActivity::onExit() {
 void WifiSelectionActivity::startWifiScan() {
   state = WifiSelectionState::SCANNING;
   networks.clear();
-  updateRequired = true;
+  updateRequired.request();
 
   // Set WiFi mode to station
   WiFi.mode(WIFI_STA);
@@ -120,7 +121,7 @@ void WifiSelectionActivity::processWifiScanResults() {
 
   if (scanResult == WIFI_SCAN_FAILED) {
     state = WifiSelectionState::NETWORK_LIST;
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -169,7 +170,7 @@ void WifiSelectionActivity::processWifiScanResults() {
   WiFi.scanDelete();
   state = WifiSelectionState::NETWORK_LIST;
   selectedNetworkIndex = 0;
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void WifiSelectionActivity::selectNetwork(const int index) {
@@ -212,10 +213,10 @@ void WifiSelectionActivity::selectNetwork(const int index) {
         },
         [this] {
           state = WifiSelectionState::NETWORK_LIST;
-          updateRequired = true;
+          updateRequired.request();
           exitActivity();
         }));
-    updateRequired = true;
+    updateRequired.request();
     xSemaphoreGive(renderingMutex);
   } else {
     // Connect directly for open networks
@@ -228,7 +229,7 @@ void WifiSelectionActivity::attemptConnection() {
   connectionStartTime = millis();
   connectedIP.clear();
   connectionError.clear();
-  updateRequired = true;
+  updateRequired.request();
 
   WiFi.mode(WIFI_STA);
 
@@ -258,7 +259,7 @@ void WifiSelectionActivity::checkConnectionStatus() {
     if (!usedSavedPassword && !enteredPassword.empty()) {
       state = WifiSelectionState::SAVE_PROMPT;
       savePromptSelection = 0;  // Default to "Yes"
-      updateRequired = true;
+      updateRequired.request();
     } else {
       // Using saved password or open network - complete immediately
       Serial.printf("[%lu] [WIFI] Connected with saved/open credentials, completing immediately\n", millis());
@@ -273,7 +274,7 @@ void WifiSelectionActivity::checkConnectionStatus() {
       connectionError = TR(WIFI_ERROR_NOT_FOUND);
     }
     state = WifiSelectionState::CONNECTION_FAILED;
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -282,7 +283,7 @@ void WifiSelectionActivity::checkConnectionStatus() {
     WiFi.disconnect();
     connectionError = TR(CONNECTION_TIMEOUT);
     state = WifiSelectionState::CONNECTION_FAILED;
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 }
@@ -317,13 +318,13 @@ void WifiSelectionActivity::loop() {
         mappedInput.wasPressed(MappedInputManager::Button::Left)) {
       if (savePromptSelection > 0) {
         savePromptSelection--;
-        updateRequired = true;
+        updateRequired.request();
       }
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Down) ||
                mappedInput.wasPressed(MappedInputManager::Button::Right)) {
       if (savePromptSelection < 1) {
         savePromptSelection++;
-        updateRequired = true;
+        updateRequired.request();
       }
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Confirm)) {
       if (savePromptSelection == 0) {
@@ -347,13 +348,13 @@ void WifiSelectionActivity::loop() {
         mappedInput.wasPressed(MappedInputManager::Button::Left)) {
       if (forgetPromptSelection > 0) {
         forgetPromptSelection--;
-        updateRequired = true;
+        updateRequired.request();
       }
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Down) ||
                mappedInput.wasPressed(MappedInputManager::Button::Right)) {
       if (forgetPromptSelection < 1) {
         forgetPromptSelection++;
-        updateRequired = true;
+        updateRequired.request();
       }
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Confirm)) {
       if (forgetPromptSelection == 1) {
@@ -370,11 +371,11 @@ void WifiSelectionActivity::loop() {
       }
       // Go back to network list (whether Cancel or Forget network was selected)
       state = WifiSelectionState::NETWORK_LIST;
-      updateRequired = true;
+      updateRequired.request();
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Back)) {
       // Skip forgetting, go back to network list
       state = WifiSelectionState::NETWORK_LIST;
-      updateRequired = true;
+      updateRequired.request();
     }
     return;
   }
@@ -398,7 +399,7 @@ void WifiSelectionActivity::loop() {
         // Go back to network list on failure
         state = WifiSelectionState::NETWORK_LIST;
       }
-      updateRequired = true;
+      updateRequired.request();
       return;
     }
   }
@@ -424,12 +425,12 @@ void WifiSelectionActivity::loop() {
     // Handle navigation
     buttonNavigator.onNext([this] {
       selectedNetworkIndex = ButtonNavigator::nextIndex(selectedNetworkIndex, networks.size());
-      updateRequired = true;
+      updateRequired.request();
     });
 
     buttonNavigator.onPrevious([this] {
       selectedNetworkIndex = ButtonNavigator::previousIndex(selectedNetworkIndex, networks.size());
-      updateRequired = true;
+      updateRequired.request();
     });
   }
 }
@@ -453,26 +454,14 @@ std::string WifiSelectionActivity::getSignalStrengthIndicator(const int32_t rssi
 
 void WifiSelectionActivity::displayTaskLoop() {
   while (true) {
-    // If a subactivity is active, yield CPU time but don't render
-    if (subActivity) {
-      vTaskDelay(10 / portTICK_PERIOD_MS);
-      continue;
-    }
-
-    // Don't render if we're in PASSWORD_ENTRY state - we're just transitioning
-    // from the keyboard subactivity back to the main activity
-    if (state == WifiSelectionState::PASSWORD_ENTRY) {
-      vTaskDelay(10 / portTICK_PERIOD_MS);
-      continue;
-    }
-
-    if (updateRequired) {
-      updateRequired = false;
+    // Don't render while a subactivity is active, or in PASSWORD_ENTRY state - we're just transitioning
+    // from the keyboard subactivity back to the main activity. The request stays pending until then.
+    if (!subActivity && state != WifiSelectionState::PASSWORD_ENTRY && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
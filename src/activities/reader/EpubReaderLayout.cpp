@@ -0,0 +1,122 @@
+#include "EpubReaderLayout.h"
+
+#include <Epub.h>
+#include <I18n.h>
+
+#include <algorithm>
+#include <string>
+
+#include "components/UITheme.h"
+#include "fontIds.h"
+
+namespace EpubReaderLayout {
+
+void renderStatusBar(const GfxRenderer& renderer, const Epub& epub, const int spineIndex, const int currentPage,
+                     const int pageCount, const int orientedMarginRight, const int orientedMarginBottom,
+                     const int orientedMarginLeft, const bool drawBattery) {
+  auto metrics = UITheme::getInstance().getMetrics();
+
+  // determine visible status bar elements
+  const bool showProgressPercentage = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::FULL;
+  const bool showBookProgressBar = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::BOOK_PROGRESS_BAR ||
+                                   SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::ONLY_BOOK_PROGRESS_BAR;
+  const bool showChapterProgressBar = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::CHAPTER_PROGRESS_BAR;
+  const bool showProgressText = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::FULL ||
+                                SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::BOOK_PROGRESS_BAR;
+  const bool showBookPercentage = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::CHAPTER_PROGRESS_BAR;
+  const bool showBattery = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::NO_PROGRESS ||
+                           SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::FULL ||
+                           SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::BOOK_PROGRESS_BAR ||
+                           SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::CHAPTER_PROGRESS_BAR;
+  const bool showChapterTitle = SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::NO_PROGRESS ||
+                                SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::FULL ||
+                                SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::BOOK_PROGRESS_BAR ||
+                                SETTINGS.statusBar == CrossPointSettings::STATUS_BAR_MODE::CHAPTER_PROGRESS_BAR;
+  const bool showBatteryPercentage =
+      SETTINGS.hideBatteryPercentage == CrossPointSettings::HIDE_BATTERY_PERCENTAGE::HIDE_NEVER;
+
+  // Position status bar near the bottom of the logical screen, regardless of orientation
+  const auto screenHeight = renderer.getScreenHeight();
+  const auto textY = screenHeight - orientedMarginBottom - 4;
+  int progressTextWidth = 0;
+
+  // Calculate progress in book
+  const float sectionChapterProg = static_cast<float>(currentPage) / pageCount;
+  const float bookProgress = epub.calculateProgress(spineIndex, sectionChapterProg) * 100;
+
+  if (showProgressText || showProgressPercentage || showBookPercentage) {
+    // Right aligned text for progress counter
+    char progressStr[32];
+
+    // Hide percentage when progress bar is shown to reduce clutter
+    if (showProgressPercentage) {
+      snprintf(progressStr, sizeof(progressStr), "%d/%d  %.0f%%", currentPage + 1, pageCount, bookProgress);
+    } else if (showBookPercentage) {
+      snprintf(progressStr, sizeof(progressStr), "%.0f%%", bookProgress);
+    } else {
+      snprintf(progressStr, sizeof(progressStr), "%d/%d", currentPage + 1, pageCount);
+    }
+
+    progressTextWidth = renderer.getTextWidth(SMALL_FONT_ID, progressStr);
+    renderer.drawText(SMALL_FONT_ID, renderer.getScreenWidth() - orientedMarginRight - progressTextWidth, textY,
+                      progressStr);
+  }
+
+  if (showBookProgressBar) {
+    // Draw progress bar at the very bottom of the screen, from edge to edge of viewable area
+    GUI.drawReadingProgressBar(renderer, static_cast<size_t>(bookProgress));
+  }
+
+  if (showChapterProgressBar) {
+    // Draw chapter progress bar at the very bottom of the screen, from edge to edge of viewable area
+    const float chapterProgress = (pageCount > 0) ? (static_cast<float>(currentPage + 1) / pageCount) * 100 : 0;
+    GUI.drawReadingProgressBar(renderer, static_cast<size_t>(chapterProgress));
+  }
+
+  if (showBattery && drawBattery) {
+    GUI.drawBattery(renderer, Rect{orientedMarginLeft + 1, textY, metrics.batteryWidth, metrics.batteryHeight},
+                    showBatteryPercentage);
+  }
+
+  if (showChapterTitle) {
+    // Centered chatper title text
+    // Page width minus existing content with 30px padding on each side
+    const int rendererableScreenWidth = renderer.getScreenWidth() - orientedMarginLeft - orientedMarginRight;
+
+    const int batterySize = showBattery ? (showBatteryPercentage ? 50 : 20) : 0;
+    const int titleMarginLeft = batterySize + 30;
+    const int titleMarginRight = progressTextWidth + 30;
+
+    // Attempt to center title on the screen, but if title is too wide then later we will center it within the
+    // available space.
+    int titleMarginLeftAdjusted = std::max(titleMarginLeft, titleMarginRight);
+    int availableTitleSpace = rendererableScreenWidth - 2 * titleMarginLeftAdjusted;
+    const int tocIndex = epub.getTocIndexForSpineIndex(spineIndex);
+
+    std::string title;
+    int titleWidth;
+    if (tocIndex == -1) {
+      title = TR(UNNAMED);
+      titleWidth = renderer.getTextWidth(SMALL_FONT_ID, TR(UNNAMED));
+    } else {
+      const auto tocItem = epub.getTocItem(tocIndex);
+      title = tocItem.title;
+      titleWidth = renderer.getTextWidth(SMALL_FONT_ID, title.c_str());
+      if (titleWidth > availableTitleSpace) {
+        // Not enough space to center on the screen, center it within the remaining space instead
+        availableTitleSpace = rendererableScreenWidth - titleMarginLeft - titleMarginRight;
+        titleMarginLeftAdjusted = titleMarginLeft;
+      }
+      if (titleWidth > availableTitleSpace) {
+        title = renderer.truncatedText(SMALL_FONT_ID, title.c_str(), availableTitleSpace);
+        titleWidth = renderer.getTextWidth(SMALL_FONT_ID, title.c_str());
+      }
+    }
+
+    renderer.drawText(SMALL_FONT_ID,
+                      titleMarginLeftAdjusted + orientedMarginLeft + (availableTitleSpace - titleWidth) / 2, textY,
+                      title.c_str());
+  }
+}
+
+}  // namespace EpubReaderLayout
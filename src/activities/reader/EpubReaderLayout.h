@@ -0,0 +1,81 @@
+#pragma once
+
+#include <GfxRenderer.h>
+
+#include "CrossPointSettings.h"
+#include "components/themes/BaseTheme.h"
+
+class Epub;
+
+// Page geometry and status bar of the EPUB reader. Section caches are keyed by the viewport size, so anything that
+// lays out or draws pages ahead of time (scripts/cache_compiler) has to use these instead of its own copy.
+namespace EpubReaderLayout {
+
+constexpr int statusBarMargin = 19;
+constexpr int progressBarMarginTop = 1;
+
+struct Margins {
+  int top;
+  int right;
+  int bottom;
+  int left;
+};
+
+// Apply the logical reader orientation to the renderer.
+// This centralizes orientation mapping so we don't duplicate switch logic elsewhere.
+inline void applyReaderOrientation(GfxRenderer& renderer, const uint8_t orientation) {
+  switch (orientation) {
+    case CrossPointSettings::ORIENTATION::PORTRAIT:
+      renderer.setOrientation(GfxRenderer::Orientation::Portrait);
+      break;
+    case CrossPointSettings::ORIENTATION::LANDSCAPE_CW:
+      renderer.setOrientation(GfxRenderer::Orientation::LandscapeClockwise);
+      break;
+    case CrossPointSettings::ORIENTATION::INVERTED:
+      renderer.setOrientation(GfxRenderer::Orientation::PortraitInverted);
+      break;
+    case CrossPointSettings::ORIENTATION::LANDSCAPE_CCW:
+      renderer.setOrientation(GfxRenderer::Orientation::LandscapeCounterClockwise);
+      break;
+    default:
+      break;
+  }
+}
+
+// Screen viewable areas plus the configured padding and room for the status bar, in the renderer's orientation
+inline Margins pageMargins(const GfxRenderer& renderer, const CrossPointSettings& settings,
+                           const ThemeMetrics& metrics) {
+  Margins margins{};
+  renderer.getOrientedViewableTRBL(&margins.top, &margins.right, &margins.bottom, &margins.left);
+  margins.top += settings.screenMargin;
+  margins.left += settings.screenMargin;
+  margins.right += settings.screenMargin;
+  margins.bottom += settings.screenMargin;
+
+  // Add status bar margin
+  if (settings.statusBar != CrossPointSettings::STATUS_BAR_MODE::NONE) {
+    // Add additional margin for status bar if progress bar is shown
+    const bool showProgressBar = settings.statusBar == CrossPointSettings::STATUS_BAR_MODE::BOOK_PROGRESS_BAR ||
+                                 settings.statusBar == CrossPointSettings::STATUS_BAR_MODE::ONLY_BOOK_PROGRESS_BAR ||
+                                 settings.statusBar == CrossPointSettings::STATUS_BAR_MODE::CHAPTER_PROGRESS_BAR;
+    margins.bottom += statusBarMargin - settings.screenMargin +
+                      (showProgressBar ? (metrics.bookProgressBarHeight + progressBarMarginTop) : 0);
+  }
+  return margins;
+}
+
+inline uint16_t viewportWidth(const GfxRenderer& renderer, const Margins& margins) {
+  return renderer.getScreenWidth() - margins.left - margins.right;
+}
+
+inline uint16_t viewportHeight(const GfxRenderer& renderer, const Margins& margins) {
+  return renderer.getScreenHeight() - margins.top - margins.bottom;
+}
+
+// Status bar of page `currentPage` (0-based) of `pageCount` in spine item `spineIndex`, below the bottom margin.
+// Pages rendered ahead of time pass drawBattery = false, the battery's space stays reserved so the title doesn't move.
+void renderStatusBar(const GfxRenderer& renderer, const Epub& epub, int spineIndex, int currentPage, int pageCount,
+                     int orientedMarginRight, int orientedMarginBottom, int orientedMarginLeft,
+                     bool drawBattery = true);
+
+}  // namespace EpubReaderLayout
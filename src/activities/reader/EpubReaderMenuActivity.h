@@ -15,7 +15,7 @@
 class EpubReaderMenuActivity final : public ActivityWithSubactivity {
  public:
   // Menu actions available from the reader menu.
-  enum class MenuAction { SELECT_CHAPTER, GO_TO_PERCENT, ROTATE_SCREEN, GO_HOME, SYNC, DELETE_CACHE };
+  enum class MenuAction { SELECT_CHAPTER, SEARCH, GO_TO_PERCENT, ROTATE_SCREEN, GO_HOME, SYNC, DELETE_CACHE };
 
   explicit EpubReaderMenuActivity(GfxRenderer& renderer, MappedInputManager& mappedInput, const std::string& title,
                                   const int currentPage, const int totalPages, const int bookProgressPercent,
@@ -42,6 +42,7 @@ class EpubReaderMenuActivity final : public ActivityWithSubactivity {
 
   // Fixed menu layout (order matters for up/down navigation).
   const std::vector<MenuItem> menuItems = {{MenuAction::SELECT_CHAPTER, TR(SELECT_CHAPTER)},
+                                           {MenuAction::SEARCH, TR(SEARCH_BOOK)},
                                            {MenuAction::ROTATE_SCREEN, TR(ORIENTATION)},
                                            {MenuAction::GO_TO_PERCENT, TR(GO_TO_PERCENT)},
                                            {MenuAction::GO_HOME, TR(GO_HOME_MENU)},
@@ -49,7 +50,6 @@ class EpubReaderMenuActivity final : public ActivityWithSubactivity {
                                            {MenuAction::DELETE_CACHE, TR(DELETE_BOOK_CACHE)}};
 
   int selectedIndex = 0;
-  bool updateRequired = false;
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
   ButtonNavigator buttonNavigator;
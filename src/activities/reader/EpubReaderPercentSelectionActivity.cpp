@@ -17,7 +17,7 @@ void EpubReaderPercentSelectionActivity::onEnter() {
   ActivityWithSubactivity::onEnter();
   // Set up rendering task and mark first frame dirty.
   renderingMutex = xSemaphoreCreateMutex();
-  updateRequired = true;
+  updateRequired.request();
   xTaskCreate(&EpubReaderPercentSelectionActivity::taskTrampoline, "EpubPercentSlider", 4096, this, 1,
               &displayTaskHandle);
 }
@@ -28,6 +28,7 @@ void EpubReaderPercentSelectionActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -42,13 +43,12 @@ void EpubReaderPercentSelectionActivity::taskTrampoline(void* param) {
 void EpubReaderPercentSelectionActivity::displayTaskLoop() {
   while (true) {
     // Render only when the view is dirty and no subactivity is running.
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       renderScreen();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -60,7 +60,7 @@ void EpubReaderPercentSelectionActivity::adjustPercent(const int delta) {
   } else if (percent > 100) {
     percent = 100;
   }
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void EpubReaderPercentSelectionActivity::loop() {
@@ -122,5 +122,5 @@ void EpubReaderPercentSelectionActivity::renderScreen() {
   const auto labels = mappedInput.mapLabels(TR(BACK), TR(SELECT), "-", "+");
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
 
-  renderer.displayBuffer();
+  renderer.displayChanges();
 }
@@ -28,7 +28,6 @@ class EpubReaderPercentSelectionActivity final : public ActivityWithSubactivity
   // Current percent value (0-100) shown on the slider.
   int percent = 0;
   // Render dirty flag for the task loop.
-  bool updateRequired = false;
   // FreeRTOS task and mutex for rendering.
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
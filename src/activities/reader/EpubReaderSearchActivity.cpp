@@ -0,0 +1,315 @@
+#include "EpubReaderSearchActivity.h"
+
+#include <Epub/Page.h>
+#include <Epub/SearchIndex.h>
+#include <Epub/parsers/XhtmlSearchMatcher.h>
+#include <GfxRenderer.h>
+#include <I18n.h>
+
+#include "MappedInputManager.h"
+#include "activities/util/KeyboardEntryActivity.h"
+#include "components/UITheme.h"
+#include "fontIds.h"
+
+namespace {
+constexpr size_t MAX_HITS = 100;
+// Pages verified per loop() call, keeps Back responsive while scanning unindexed chapters
+constexpr size_t PAGES_PER_STEP = 4;
+constexpr size_t SNIPPET_CONTEXT = 32;
+constexpr unsigned long PROGRESS_REFRESH_MS = 1000;
+}  // namespace
+
+void EpubReaderSearchActivity::taskTrampoline(void* param) {
+  auto* self = static_cast<EpubReaderSearchActivity*>(param);
+  self->displayTaskLoop();
+}
+
+void EpubReaderSearchActivity::onEnter() {
+  ActivityWithSubactivity::onEnter();
+
+  renderingMutex = xSemaphoreCreateMutex();
+  xTaskCreate(&EpubReaderSearchActivity::taskTrampoline, "EpubReaderSearchTask", 4096, this, 1, &displayTaskHandle);
+
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  openQueryEntry();
+  xSemaphoreGive(renderingMutex);
+}
+
+void EpubReaderSearchActivity::onExit() {
+  ActivityWithSubactivity::onExit();
+
+  // Wait until not rendering to delete task to avoid killing mid-instruction to EPD
+  xSemaphoreTake(renderingMutex, portMAX_DELAY);
+  if (displayTaskHandle) {
+    vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
+    displayTaskHandle = nullptr;
+  }
+  vSemaphoreDelete(renderingMutex);
+  renderingMutex = nullptr;
+  section.reset();
+  hits.clear();
+}
+
+void EpubReaderSearchActivity::openQueryEntry() {
+  exitActivity();
+  enterNewActivity(new KeyboardEntryActivity(
+      renderer, mappedInput, TR(SEARCH_BOOK), query, 10,
+      64,     // maxLength
+      false,  // not password
+      [this](const std::string& text) {
+        exitActivity();
+        startSearch(text);
+      },
+      [this]() {
+        exitActivity();
+        if (hits.empty()) {
+          onGoBack();
+          return;
+        }
+        updateRequired.request();
+      }));
+}
+
+void EpubReaderSearchActivity::startSearch(const std::string& text) {
+  query = text;
+  hits.clear();
+  selectorIndex = 0;
+  section.reset();
+  candidatePages.clear();
+  spineCursor = 0;
+
+  const std::string normalized = SearchIndex::normalize(query);
+  searching = !normalized.empty() && epub && epub->getSpineItemsCount() > 0;
+  if (searching) {
+    Serial.printf("[%lu] [ESR] Searching for \"%s\"\n", millis(), normalized.c_str());
+  }
+  lastProgressRender = 0;
+  updateRequired.request();
+}
+
+void EpubReaderSearchActivity::loop() {
+  if (subActivity) {
+    subActivity->loop();
+    return;
+  }
+
+  if (searching) {
+    if (mappedInput.wasReleased(MappedInputManager::Button::Back)) {
+      // Stop early and keep the hits found so far
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      searching = false;
+      section.reset();
+      xSemaphoreGive(renderingMutex);
+      updateRequired.request();
+      return;
+    }
+
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
+    searchStep();
+    xSemaphoreGive(renderingMutex);
+    if (!searching || millis() - lastProgressRender >= PROGRESS_REFRESH_MS) {
+      lastProgressRender = millis();
+      updateRequired.request();
+    }
+    return;
+  }
+
+  if (mappedInput.wasReleased(MappedInputManager::Button::Back)) {
+    onGoBack();
+    return;
+  }
+
+  if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
+    if (hits.empty()) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      openQueryEntry();
+      xSemaphoreGive(renderingMutex);
+    } else {
+      onSelectHit(hits[selectorIndex]);
+    }
+    return;
+  }
+
+  const int totalItems = static_cast<int>(hits.size());
+  const int pageItems = UITheme::getInstance().getNumberOfItemsPerPage(renderer, true, false, true, true);
+
+  buttonNavigator.onNextRelease([this, totalItems] {
+    selectorIndex = ButtonNavigator::nextIndex(selectorIndex, totalItems);
+    updateRequired.request();
+  });
+
+  buttonNavigator.onPreviousRelease([this, totalItems] {
+    selectorIndex = ButtonNavigator::previousIndex(selectorIndex, totalItems);
+    updateRequired.request();
+  });
+
+  buttonNavigator.onNextContinuous([this, totalItems, pageItems] {
+    selectorIndex = ButtonNavigator::nextPageIndex(selectorIndex, totalItems, pageItems);
+    updateRequired.request();
+  });
+
+  buttonNavigator.onPreviousContinuous([this, totalItems, pageItems] {
+    selectorIndex = ButtonNavigator::previousPageIndex(selectorIndex, totalItems, pageItems);
+    updateRequired.request();
+  });
+}
+
+void EpubReaderSearchActivity::searchStep() {
+  if (section) {
+    checkCandidatePages();
+    return;
+  }
+
+  if (spineCursor >= epub->getSpineItemsCount() || hits.size() >= MAX_HITS) {
+    searching = false;
+    Serial.printf("[%lu] [ESR] Search finished: %u hits\n", millis(), static_cast<uint32_t>(hits.size()));
+    return;
+  }
+  beginSpine();
+}
+
+void EpubReaderSearchActivity::beginSpine() {
+  currentChapter = chapterLabel(spineCursor);
+  section.reset(new Section(epub, spineCursor, renderer));
+
+  // Never laid out: match the chapter's XHTML directly instead of building it
+  if (!section->loadPageCount()) {
+    section.reset();
+    scanSpineContents();
+    spineCursor++;
+    return;
+  }
+
+  // Laid out: the index narrows the pages to check, without one every page is checked
+  candidatePages.clear();
+  candidateCursor = 0;
+  if (!SearchIndex::findPages(section->getSearchIndexPath(), SearchIndex::normalize(query), candidatePages)) {
+    for (uint16_t page = 0; page < section->pageCount; page++) {
+      candidatePages.push_back(page);
+    }
+  }
+  if (candidatePages.empty()) {
+    section.reset();
+    spineCursor++;
+  }
+}
+
+void EpubReaderSearchActivity::checkCandidatePages() {
+  const std::string normalizedQuery = SearchIndex::normalize(query);
+  std::string text;
+  for (size_t n = 0; n < PAGES_PER_STEP && candidateCursor < candidatePages.size(); n++, candidateCursor++) {
+    section->currentPage = candidatePages[candidateCursor];
+    if (section->currentPage >= section->pageCount) {
+      continue;
+    }
+    const auto page = section->loadPageFromSectionFile();
+    if (!page) {
+      continue;
+    }
+
+    text.clear();
+    page->appendText(text);
+    const std::string normalized = SearchIndex::normalize(text);
+    const size_t pos = SearchIndex::findMatch(normalized, normalizedQuery);
+    if (pos != std::string::npos) {
+      addHit(section->currentPage, section->pageCount, 0.0f,
+             SearchIndex::snippet(normalized, pos, normalizedQuery.size(), SNIPPET_CONTEXT));
+    }
+  }
+
+  if (candidateCursor >= candidatePages.size() || hits.size() >= MAX_HITS) {
+    section.reset();
+    candidatePages.clear();
+    spineCursor++;
+  }
+}
+
+void EpubReaderSearchActivity::scanSpineContents() {
+  XhtmlSearchMatcher matcher(SearchIndex::normalize(query), MAX_HITS - hits.size());
+  if (!epub->readItemContentsToStream(epub->getSpineItem(spineCursor).href, matcher, 1024)) {
+    Serial.printf("[%lu] [ESR] Failed to stream spine item %d\n", millis(), spineCursor);
+    return;
+  }
+  matcher.finish();
+
+  const uint32_t total = matcher.getBytesProcessed();
+  for (const auto& match : matcher.getMatches()) {
+    addHit(-1, 0, total > 0 ? static_cast<float>(match.offset) / static_cast<float>(total) : 0.0f, match.snippet);
+  }
+}
+
+void EpubReaderSearchActivity::addHit(const int page, const int pageCount, const float progress, std::string snippet) {
+  hits.push_back(Hit{spineCursor, page, pageCount, progress, std::move(snippet), currentChapter});
+}
+
+std::string EpubReaderSearchActivity::chapterLabel(const int spineIndex) const {
+  const int tocIndex = epub->getTocIndexForSpineIndex(spineIndex);
+  if (tocIndex >= 0) {
+    const auto item = epub->getTocItem(tocIndex);
+    if (!item.title.empty()) {
+      return item.title;
+    }
+  }
+  return "#" + std::to_string(spineIndex + 1);
+}
+
+void EpubReaderSearchActivity::displayTaskLoop() {
+  while (true) {
+    if (!subActivity && updateRequired.take()) {
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      renderScreen();
+      xSemaphoreGive(renderingMutex);
+    }
+    updateRequired.wait();
+  }
+}
+
+void EpubReaderSearchActivity::renderScreen() {
+  renderer.clearScreen();
+
+  const auto pageWidth = renderer.getScreenWidth();
+  const auto pageHeight = renderer.getScreenHeight();
+  auto metrics = UITheme::getInstance().getMetrics();
+  const int contentTop = metrics.topPadding + metrics.headerHeight + metrics.verticalSpacing;
+
+  if (searching) {
+    GUI.drawHeader(renderer, Rect{0, metrics.topPadding, pageWidth, metrics.headerHeight}, TR(SEARCHING));
+    const std::string status = "\"" + query + "\"  (" + std::to_string(hits.size()) + ")";
+    renderer.drawCenteredText(UI_10_FONT_ID, pageHeight / 2 - 10, status.c_str());
+    const int barWidth = pageWidth - 100;
+    constexpr int barHeight = 20;
+    constexpr int barX = 50;
+    const int barY = pageHeight / 2 + 20;
+    GUI.drawProgressBar(renderer, Rect{barX, barY, barWidth, barHeight}, spineCursor, epub->getSpineItemsCount());
+
+    const auto labels = mappedInput.mapLabels(TR(BACK), "", "", "");
+    GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
+    renderer.displayBuffer();
+    return;
+  }
+
+  char title[64];
+  if (hits.size() >= MAX_HITS) {
+    snprintf(title, sizeof(title), TR(SEARCH_MORE_RESULTS), static_cast<int>(MAX_HITS));
+  } else {
+    snprintf(title, sizeof(title), "%s (%d)", TR(SEARCH_RESULTS), static_cast<int>(hits.size()));
+  }
+  GUI.drawHeader(renderer, Rect{0, metrics.topPadding, pageWidth, metrics.headerHeight}, title);
+
+  const int contentHeight = pageHeight - contentTop - metrics.buttonHintsHeight - metrics.verticalSpacing;
+  if (hits.empty()) {
+    renderer.drawText(UI_10_FONT_ID, metrics.contentSidePadding, contentTop + 20, TR(SEARCH_NO_MATCHES));
+  } else {
+    GUI.drawList(
+        renderer, Rect{0, contentTop, pageWidth, contentHeight}, hits.size(), selectorIndex,
+        [this](int index) { return hits[index].snippet; }, [this](int index) { return hits[index].chapter; }, nullptr,
+        nullptr);
+  }
+
+  const auto labels =
+      mappedInput.mapLabels(TR(BACK), hits.empty() ? TR(SEARCH_BOOK) : TR(SELECT), TR(DIR_UP), TR(DIR_DOWN));
+  GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
+
+  renderer.displayBuffer();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../ActivityWithSubactivity.h"
+#include "util/ButtonNavigator.h"
+
+/**
+ * Full-text search through the current book.
+ *
+ * Chapters with a search index only have their candidate pages checked, chapters laid out without one are scanned
+ * page by page, and chapters that were never opened are matched directly against their XHTML. The search runs a
+ * small step per loop() call so the progress display and the Back button stay responsive.
+ */
+class EpubReaderSearchActivity final : public ActivityWithSubactivity {
+ public:
+  struct Hit {
+    int spineIndex;
+    int page;        // Page in the section file the hit was found in, -1 if the chapter is not laid out
+    int pageCount;   // Page count of that section file, used to map the page onto the current layout
+    float progress;  // Position within the spine item when page is -1
+    std::string snippet;
+    std::string chapter;
+  };
+
+ private:
+  std::shared_ptr<Epub> epub;
+  TaskHandle_t displayTaskHandle = nullptr;
+  SemaphoreHandle_t renderingMutex = nullptr;
+  ButtonNavigator buttonNavigator;
+  std::string query;
+  std::vector<Hit> hits;
+  int selectorIndex = 0;
+  bool searching = false;
+  unsigned long lastProgressRender = 0;
+
+  // Search cursor
+  int spineCursor = 0;
+  std::unique_ptr<Section> section;
+  std::vector<uint16_t> candidatePages;
+  size_t candidateCursor = 0;
+  std::string currentChapter;
+
+  const std::function<void()> onGoBack;
+  const std::function<void(const Hit& hit)> onSelectHit;
+
+  static void taskTrampoline(void* param);
+  [[noreturn]] void displayTaskLoop();
+  void renderScreen();
+  void openQueryEntry();
+  void startSearch(const std::string& text);
+  void searchStep();
+  void beginSpine();
+  void scanSpineContents();
+  void checkCandidatePages();
+  void addHit(int page, int pageCount, float progress, std::string snippet);
+  std::string chapterLabel(int spineIndex) const;
+
+ public:
+  explicit EpubReaderSearchActivity(GfxRenderer& renderer, MappedInputManager& mappedInput,
+                                    const std::shared_ptr<Epub>& epub, const std::function<void()>& onGoBack,
+                                    const std::function<void(const Hit& hit)>& onSelectHit)
+      : ActivityWithSubactivity("EpubReaderSearch", renderer, mappedInput),
+        epub(epub),
+        onGoBack(onGoBack),
+        onSelectHit(onSelectHit) {}
+  void onEnter() override;
+  void onExit() override;
+  void loop() override;
+  bool supportsLandscape() const override { return true; }
+};
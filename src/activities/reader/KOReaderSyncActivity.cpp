@@ -60,7 +60,7 @@ void KOReaderSyncActivity::onWifiSelectionComplete(const bool success) {
   state = SYNCING;
   statusMessage = TR(SYNCING_TIME);
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 
   // Sync time with NTP before making API requests
   syncTimeWithNTP();
@@ -68,7 +68,7 @@ void KOReaderSyncActivity::onWifiSelectionComplete(const bool success) {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   statusMessage = TR(CALCULATING_HASH);
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 
   performSync();
 }
@@ -85,7 +85,7 @@ void KOReaderSyncActivity::performSync() {
     state = SYNC_FAILED;
     statusMessage = TR(HASH_CALC_FAILED);
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -94,7 +94,7 @@ void KOReaderSyncActivity::performSync() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   statusMessage = TR(FETCHING_PROGRESS);
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
   vTaskDelay(10 / portTICK_PERIOD_MS);
 
   // Fetch remote progress
@@ -106,7 +106,7 @@ void KOReaderSyncActivity::performSync() {
     state = NO_REMOTE_PROGRESS;
     hasRemoteProgress = false;
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -115,7 +115,7 @@ void KOReaderSyncActivity::performSync() {
     state = SYNC_FAILED;
     statusMessage = KOReaderSyncClient::errorString(result);
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -132,7 +132,7 @@ void KOReaderSyncActivity::performSync() {
   state = SHOWING_RESULT;
   selectedOption = 0;  // Default to "Apply"
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void KOReaderSyncActivity::performUpload() {
@@ -140,7 +140,7 @@ void KOReaderSyncActivity::performUpload() {
   state = UPLOADING;
   statusMessage = TR(UPLOADING_PROGRESS);
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
   vTaskDelay(10 / portTICK_PERIOD_MS);
 
   // Convert current position to KOReader format
@@ -159,14 +159,14 @@ void KOReaderSyncActivity::performUpload() {
     state = SYNC_FAILED;
     statusMessage = KOReaderSyncClient::errorString(result);
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   state = UPLOAD_COMPLETE;
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void KOReaderSyncActivity::onEnter() {
@@ -184,7 +184,7 @@ void KOReaderSyncActivity::onEnter() {
   // Check for credentials first
   if (!KOREADER_STORE.hasCredentials()) {
     state = NO_CREDENTIALS;
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -197,7 +197,7 @@ void KOReaderSyncActivity::onEnter() {
     Serial.printf("[%lu] [KOSync] Already connected to WiFi\n", millis());
     state = SYNCING;
     statusMessage = TR(SYNCING_TIME);
-    updateRequired = true;
+    updateRequired.request();
 
     // Perform sync directly (will be handled in loop)
     xTaskCreate(
@@ -208,7 +208,7 @@ void KOReaderSyncActivity::onEnter() {
           xSemaphoreTake(self->renderingMutex, portMAX_DELAY);
           self->statusMessage = TR(CALCULATING_HASH);
           xSemaphoreGive(self->renderingMutex);
-          self->updateRequired = true;
+          self->updateRequired.request();
           self->performSync();
           vTaskDelete(nullptr);
         },
@@ -235,6 +235,7 @@ void KOReaderSyncActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -243,13 +244,12 @@ void KOReaderSyncActivity::onExit() {
 
 void KOReaderSyncActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -389,11 +389,11 @@ void KOReaderSyncActivity::loop() {
     if (mappedInput.wasPressed(MappedInputManager::Button::Up) ||
         mappedInput.wasPressed(MappedInputManager::Button::Left)) {
       selectedOption = (selectedOption + 1) % 2;  // Wrap around among 2 options
-      updateRequired = true;
+      updateRequired.request();
     } else if (mappedInput.wasPressed(MappedInputManager::Button::Down) ||
                mappedInput.wasPressed(MappedInputManager::Button::Right)) {
       selectedOption = (selectedOption + 1) % 2;  // Wrap around among 2 options
-      updateRequired = true;
+      updateRequired.request();
     }
 
     if (mappedInput.wasPressed(MappedInputManager::Button::Confirm)) {
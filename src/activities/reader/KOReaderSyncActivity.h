@@ -69,7 +69,6 @@ class KOReaderSyncActivity final : public ActivityWithSubactivity {
 
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
-  bool updateRequired = false;
 
   State state = WIFI_SELECTION;
   std::string statusMessage;
@@ -7,9 +7,12 @@
 #include <Serialization.h>
 #include <Utf8.h>
 
+#include "BookCacheManager.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
+#include "LibraryCatalog.h"
 #include "MappedInputManager.h"
+#include "ProgressJournal.h"
 #include "RecentBooksStore.h"
 #include "components/UITheme.h"
 #include "fontIds.h"
@@ -52,9 +55,11 @@ void TxtReaderActivity::onEnter() {
   APP_STATE.openEpubPath = filePath;
   APP_STATE.saveToFile();
   RECENT_BOOKS.addBook(filePath, fileName, "", "");
+  BOOK_CACHE.touch(txt->getCachePath());
+  mappedInput.clearPageTurns();
 
   // Trigger first update
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&TxtReaderActivity::taskTrampoline, "TxtReaderActivityTask",
               6144,               // Stack size
@@ -73,14 +78,20 @@ void TxtReaderActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
+  mappedInput.clearPageTurns();
+  PROGRESS_JOURNAL.flush();
   pageOffsets.clear();
   currentPageLines.clear();
   APP_STATE.readerActivityLoadCount = 0;
   APP_STATE.saveToFile();
+  if (txt && totalPages > 0) {
+    LIBRARY_CATALOG.markBookRead(txt->getPath(), static_cast<uint8_t>((currentPage + 1) * 100 / totalPages));
+  }
   txt.reset();
 }
 
@@ -120,24 +131,35 @@ void TxtReaderActivity::loop() {
     return;
   }
 
+  // Turned by the display task, so presses made while a page refreshes skip the pages in between
   if (prevTriggered && currentPage > 0) {
-    currentPage--;
-    updateRequired = true;
+    mappedInput.queuePageTurn(-1);
+    updateRequired.request();
   } else if (nextTriggered && currentPage < totalPages - 1) {
-    currentPage++;
-    updateRequired = true;
+    mappedInput.queuePageTurn(1);
+    updateRequired.request();
   }
 }
 
 void TxtReaderActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take() || (skimmedPage && !mappedInput.isPageTurnBurst())) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       renderScreen();
       xSemaphoreGive(renderingMutex);
+    } else if (PROGRESS_JOURNAL.hasPending()) {
+      // Write the position once the reader has stopped turning pages, on this task so it cannot race a render
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      PROGRESS_JOURNAL.flushIfIdle();
+      xSemaphoreGive(renderingMutex);
+    }
+    // Every page turn requests a render, so a pending position is idle once a whole flush period passes unwoken
+    if (skimmedPage) {
+      updateRequired.wait(pdMS_TO_TICKS(MappedInputManager::PAGE_TURN_BURST_MS));
+    } else {
+      updateRequired.wait(PROGRESS_JOURNAL.hasPending() ? pdMS_TO_TICKS(ProgressJournal::IDLE_FLUSH_MS)
+                                                        : portMAX_DELAY);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
   }
 }
 
@@ -365,6 +387,7 @@ void TxtReaderActivity::renderScreen() {
   if (!txt) {
     return;
   }
+  skimmedPage = false;
 
   // Initialize reader if not done
   if (!initialized) {
@@ -378,7 +401,8 @@ void TxtReaderActivity::renderScreen() {
     return;
   }
 
-  // Bounds check
+  // Apply the page turns queued since the last render, then bounds check
+  currentPage += mappedInput.takePageTurns();
   if (currentPage < 0) currentPage = 0;
   if (currentPage >= totalPages) currentPage = totalPages - 1;
 
@@ -446,6 +470,12 @@ void TxtReaderActivity::renderPage() {
   renderLines();
   renderStatusBar(orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
 
+  if (SETTINGS.skimPageTurns && mappedInput.isPageTurnBurst()) {
+    // Black and white only and not counted towards the full refresh, the display task redraws it when turning stops
+    renderer.displayBuffer();
+    skimmedPage = true;
+    return;
+  }
   if (pagesUntilFullRefresh <= 1) {
     renderer.displayBuffer(HalDisplay::HALF_REFRESH);
     pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
@@ -556,33 +586,25 @@ void TxtReaderActivity::renderStatusBar(const int orientedMarginRight, const int
 }
 
 void TxtReaderActivity::saveProgress() const {
-  FsFile f;
-  if (Storage.openFileForWrite("TRS", txt->getCachePath() + "/progress.bin", f)) {
-    uint8_t data[4];
-    data[0] = currentPage & 0xFF;
-    data[1] = (currentPage >> 8) & 0xFF;
-    data[2] = 0;
-    data[3] = 0;
-    f.write(data, 4);
-    f.close();
-  }
+  uint8_t data[4];
+  data[0] = currentPage & 0xFF;
+  data[1] = (currentPage >> 8) & 0xFF;
+  data[2] = 0;
+  data[3] = 0;
+  PROGRESS_JOURNAL.put(txt->getCachePath(), data, sizeof(data));
 }
 
 void TxtReaderActivity::loadProgress() {
-  FsFile f;
-  if (Storage.openFileForRead("TRS", txt->getCachePath() + "/progress.bin", f)) {
-    uint8_t data[4];
-    if (f.read(data, 4) == 4) {
-      currentPage = data[0] + (data[1] << 8);
-      if (currentPage >= totalPages) {
-        currentPage = totalPages - 1;
-      }
-      if (currentPage < 0) {
-        currentPage = 0;
-      }
-      Serial.printf("[%lu] [TRS] Loaded progress: page %d/%d\n", millis(), currentPage, totalPages);
+  uint8_t data[4];
+  if (PROGRESS_JOURNAL.get(txt->getCachePath(), data, sizeof(data)) == 4) {
+    currentPage = data[0] + (data[1] << 8);
+    if (currentPage >= totalPages) {
+      currentPage = totalPages - 1;
     }
-    f.close();
+    if (currentPage < 0) {
+      currentPage = 0;
+    }
+    Serial.printf("[%lu] [TRS] Loaded progress: page %d/%d\n", millis(), currentPage, totalPages);
   }
 }
 
@@ -600,11 +622,12 @@ bool TxtReaderActivity::loadPageIndexCache() {
   // - N * uint32_t: page offsets
 
   std::string cachePath = txt->getCachePath() + "/index.bin";
-  FsFile f;
-  if (!Storage.openFileForRead("TRS", cachePath, f)) {
+  FsFile file;
+  if (!Storage.openFileForRead("TRS", cachePath, file)) {
     Serial.printf("[%lu] [TRS] No page index cache found\n", millis());
     return false;
   }
+  BufferedFile f(file);
 
   // Read and validate header using serialization module
   uint32_t magic;
@@ -692,11 +715,12 @@ bool TxtReaderActivity::loadPageIndexCache() {
 
 void TxtReaderActivity::savePageIndexCache() const {
   std::string cachePath = txt->getCachePath() + "/index.bin";
-  FsFile f;
-  if (!Storage.openFileForWrite("TRS", cachePath, f)) {
+  FsFile file;
+  if (!Storage.openFileForWrite("TRS", cachePath, file)) {
     Serial.printf("[%lu] [TRS] Failed to save page index cache\n", millis());
     return;
   }
+  BufferedFile f(file);
 
   // Write header using serialization module
   serialization::writePod(f, CACHE_MAGIC);
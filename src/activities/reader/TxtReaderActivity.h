@@ -17,7 +17,8 @@ class TxtReaderActivity final : public ActivityWithSubactivity {
   int currentPage = 0;
   int totalPages = 1;
   int pagesUntilFullRefresh = 0;
-  bool updateRequired = false;
+  // The page on screen was shown with a fast refresh while skimming, redraw it once the page turns stop
+  bool skimmedPage = false;
   const std::function<void()> onGoBack;
   const std::function<void()> onGoHome;
 
@@ -12,9 +12,14 @@
 #include <HalStorage.h>
 #include <I18n.h>
 
+#include <algorithm>
+
+#include "BookCacheManager.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
+#include "LibraryCatalog.h"
 #include "MappedInputManager.h"
+#include "ProgressJournal.h"
 #include "RecentBooksStore.h"
 #include "XtcReaderChapterSelectionActivity.h"
 #include "components/UITheme.h"
@@ -48,9 +53,11 @@ void XtcReaderActivity::onEnter() {
   APP_STATE.openEpubPath = xtc->getPath();
   APP_STATE.saveToFile();
   RECENT_BOOKS.addBook(xtc->getPath(), xtc->getTitle(), xtc->getAuthor(), xtc->getThumbBmpPath());
+  BOOK_CACHE.touch(xtc->getCachePath());
+  mappedInput.clearPageTurns();
 
   // Trigger first update
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&XtcReaderActivity::taskTrampoline, "XtcReaderActivityTask",
               4096,               // Stack size (smaller than EPUB since no parsing needed)
@@ -67,12 +74,18 @@ void XtcReaderActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
   renderingMutex = nullptr;
+  mappedInput.clearPageTurns();
+  PROGRESS_JOURNAL.flush();
   APP_STATE.readerActivityLoadCount = 0;
   APP_STATE.saveToFile();
+  if (xtc) {
+    LIBRARY_CATALOG.markBookRead(xtc->getPath(), xtc->calculateProgress(currentPage));
+  }
   xtc.reset();
 }
 
@@ -92,12 +105,12 @@ void XtcReaderActivity::loop() {
           this->renderer, this->mappedInput, xtc, currentPage,
           [this] {
             exitActivity();
-            updateRequired = true;
+            updateRequired.request();
           },
           [this](const uint32_t newPage) {
             currentPage = newPage;
             exitActivity();
-            updateRequired = true;
+            updateRequired.request();
           }));
       xSemaphoreGive(renderingMutex);
     }
@@ -135,39 +148,41 @@ void XtcReaderActivity::loop() {
 
   // Handle end of book
   if (currentPage >= xtc->getPageCount()) {
+    xSemaphoreTake(renderingMutex, portMAX_DELAY);
     currentPage = xtc->getPageCount() - 1;
-    updateRequired = true;
+    mappedInput.clearPageTurns();
+    xSemaphoreGive(renderingMutex);
+    updateRequired.request();
     return;
   }
 
   const bool skipPages = SETTINGS.longPressChapterSkip && mappedInput.getHeldTime() > skipPageMs;
   const int skipAmount = skipPages ? 10 : 1;
 
-  if (prevTriggered) {
-    if (currentPage >= static_cast<uint32_t>(skipAmount)) {
-      currentPage -= skipAmount;
-    } else {
-      currentPage = 0;
-    }
-    updateRequired = true;
-  } else if (nextTriggered) {
-    currentPage += skipAmount;
-    if (currentPage >= xtc->getPageCount()) {
-      currentPage = xtc->getPageCount();  // Allow showing "End of book"
-    }
-    updateRequired = true;
-  }
+  // Turned by the display task, so presses made while a page refreshes skip the pages in between
+  mappedInput.queuePageTurn(prevTriggered ? -skipAmount : skipAmount);
+  updateRequired.request();
 }
 
 void XtcReaderActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take() || (skimmedPage && !mappedInput.isPageTurnBurst())) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       renderScreen();
       xSemaphoreGive(renderingMutex);
+    } else if (PROGRESS_JOURNAL.hasPending()) {
+      // Write the position once the reader has stopped turning pages, on this task so it cannot race a render
+      xSemaphoreTake(renderingMutex, portMAX_DELAY);
+      PROGRESS_JOURNAL.flushIfIdle();
+      xSemaphoreGive(renderingMutex);
+    }
+    // Every page turn requests a render, so a pending position is idle once a whole flush period passes unwoken
+    if (skimmedPage) {
+      updateRequired.wait(pdMS_TO_TICKS(MappedInputManager::PAGE_TURN_BURST_MS));
+    } else {
+      updateRequired.wait(PROGRESS_JOURNAL.hasPending() ? pdMS_TO_TICKS(ProgressJournal::IDLE_FLUSH_MS)
+                                                        : portMAX_DELAY);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
   }
 }
 
@@ -175,6 +190,11 @@ void XtcReaderActivity::renderScreen() {
   if (!xtc) {
     return;
   }
+  skimmedPage = false;
+
+  // Apply the page turns queued since the last render, going no further than the end of book screen
+  const int64_t targetPage = static_cast<int64_t>(currentPage) + mappedInput.takePageTurns();
+  currentPage = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(targetPage, 0), xtc->getPageCount()));
 
   // Bounds check
   if (currentPage >= xtc->getPageCount()) {
@@ -278,6 +298,14 @@ void XtcReaderActivity::renderPage() {
       }
     }
 
+    if (SETTINGS.skimPageTurns && mappedInput.isPageTurnBurst()) {
+      // Skimming: black and white only, the display task redraws the page in grayscale when turning stops
+      renderer.displayBuffer();
+      skimmedPage = true;
+      free(pageBuffer);
+      return;
+    }
+
     // Display BW with conditional refresh based on pagesUntilFullRefresh
     if (pagesUntilFullRefresh <= 1) {
       renderer.displayBuffer(HalDisplay::HALF_REFRESH);
@@ -372,31 +400,23 @@ void XtcReaderActivity::renderPage() {
 }
 
 void XtcReaderActivity::saveProgress() const {
-  FsFile f;
-  if (Storage.openFileForWrite("XTR", xtc->getCachePath() + "/progress.bin", f)) {
-    uint8_t data[4];
-    data[0] = currentPage & 0xFF;
-    data[1] = (currentPage >> 8) & 0xFF;
-    data[2] = (currentPage >> 16) & 0xFF;
-    data[3] = (currentPage >> 24) & 0xFF;
-    f.write(data, 4);
-    f.close();
-  }
+  uint8_t data[4];
+  data[0] = currentPage & 0xFF;
+  data[1] = (currentPage >> 8) & 0xFF;
+  data[2] = (currentPage >> 16) & 0xFF;
+  data[3] = (currentPage >> 24) & 0xFF;
+  PROGRESS_JOURNAL.put(xtc->getCachePath(), data, sizeof(data));
 }
 
 void XtcReaderActivity::loadProgress() {
-  FsFile f;
-  if (Storage.openFileForRead("XTR", xtc->getCachePath() + "/progress.bin", f)) {
-    uint8_t data[4];
-    if (f.read(data, 4) == 4) {
-      currentPage = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
-      Serial.printf("[%lu] [XTR] Loaded progress: page %lu\n", millis(), currentPage);
-
-      // Validate page number
-      if (currentPage >= xtc->getPageCount()) {
-        currentPage = 0;
-      }
+  uint8_t data[4];
+  if (PROGRESS_JOURNAL.get(xtc->getCachePath(), data, sizeof(data)) == 4) {
+    currentPage = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+    Serial.printf("[%lu] [XTR] Loaded progress: page %lu\n", millis(), currentPage);
+
+    // Validate page number
+    if (currentPage >= xtc->getPageCount()) {
+      currentPage = 0;
     }
-    f.close();
   }
 }
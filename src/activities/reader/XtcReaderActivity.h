@@ -20,7 +20,8 @@ class XtcReaderActivity final : public ActivityWithSubactivity {
   SemaphoreHandle_t renderingMutex = nullptr;
   uint32_t currentPage = 0;
   int pagesUntilFullRefresh = 0;
-  bool updateRequired = false;
+  // The page on screen was shown with a fast refresh while skimming, redraw it once the page turns stop
+  bool skimmedPage = false;
   const std::function<void()> onGoBack;
   const std::function<void()> onGoHome;
 
@@ -33,7 +33,7 @@ void ButtonRemapActivity::onEnter() {
   tempMapping[3] = kUnassigned;
   errorMessage.clear();
   errorUntil = 0;
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&ButtonRemapActivity::taskTrampoline, "ButtonRemapTask", 4096, this, 1, &displayTaskHandle);
 }
@@ -45,6 +45,7 @@ void ButtonRemapActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -74,7 +75,7 @@ void ButtonRemapActivity::loop() {
 
   // Wait for the UI to refresh before accepting another assignment.
   // This avoids rapid double-presses that can advance the step without a visible redraw.
-  if (updateRequired) {
+  if (updateRequired.isPending()) {
     return;
   }
 
@@ -87,7 +88,7 @@ void ButtonRemapActivity::loop() {
   // Update temporary mapping and advance the remap step.
   // Only accept the press if this hardware button isn't already assigned elsewhere.
   if (!validateUnassigned(static_cast<uint8_t>(pressedButton))) {
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
   tempMapping[currentStep] = static_cast<uint8_t>(pressedButton);
@@ -101,16 +102,17 @@ void ButtonRemapActivity::loop() {
     return;
   }
 
-  updateRequired = true;
+  updateRequired.request();
 }
 
 [[noreturn]] void ButtonRemapActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
+    if (updateRequired.isPending()) {
       // Ensure render calls are serialized with UI thread changes.
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
-      updateRequired = false;
+      // Taken only after rendering, loop() ignores presses until the screen shows the last assignment
+      updateRequired.take();
       xSemaphoreGive(renderingMutex);
     }
 
@@ -118,10 +120,10 @@ void ButtonRemapActivity::loop() {
     if (errorUntil > 0 && millis() > errorUntil) {
       errorMessage.clear();
       errorUntil = 0;
-      updateRequired = true;
+      updateRequired.request();
     }
 
-    vTaskDelay(50 / portTICK_PERIOD_MS);
+    updateRequired.wait(errorUntil > 0 ? pdMS_TO_TICKS(50) : portMAX_DELAY);
   }
 }
 
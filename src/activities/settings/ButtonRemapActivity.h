@@ -22,7 +22,6 @@ class ButtonRemapActivity final : public Activity {
   // Rendering task state.
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
-  bool updateRequired = false;
 
   // Callback used to exit the remap flow back to the settings list.
   const std::function<void()> onBack;
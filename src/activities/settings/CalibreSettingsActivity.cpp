@@ -13,7 +13,7 @@
 #include "fontIds.h"
 
 namespace {
-constexpr int MENU_ITEMS = 3;
+constexpr int MENU_ITEMS = 4;
 }  // namespace
 
 void CalibreSettingsActivity::taskTrampoline(void* param) {
@@ -26,7 +26,7 @@ void CalibreSettingsActivity::onEnter() {
 
   renderingMutex = xSemaphoreCreateMutex();
   selectedIndex = 0;
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&CalibreSettingsActivity::taskTrampoline, "CalibreSettingsTask",
               4096,               // Stack size
@@ -42,6 +42,7 @@ void CalibreSettingsActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -67,12 +68,12 @@ void CalibreSettingsActivity::loop() {
   // Handle navigation
   buttonNavigator.onNext([this] {
     selectedIndex = (selectedIndex + 1) % MENU_ITEMS;
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPrevious([this] {
     selectedIndex = (selectedIndex + MENU_ITEMS - 1) % MENU_ITEMS;
-    updateRequired = true;
+    updateRequired.request();
   });
 }
 
@@ -91,11 +92,11 @@ void CalibreSettingsActivity::handleSelection() {
           SETTINGS.opdsServerUrl[sizeof(SETTINGS.opdsServerUrl) - 1] = '\0';
           SETTINGS.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
   } else if (selectedIndex == 1) {
     // Username
@@ -109,11 +110,11 @@ void CalibreSettingsActivity::handleSelection() {
           SETTINGS.opdsUsername[sizeof(SETTINGS.opdsUsername) - 1] = '\0';
           SETTINGS.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
   } else if (selectedIndex == 2) {
     // Password
@@ -127,12 +128,17 @@ void CalibreSettingsActivity::handleSelection() {
           SETTINGS.opdsPassword[sizeof(SETTINGS.opdsPassword) - 1] = '\0';
           SETTINGS.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
+  } else if (selectedIndex == 3) {
+    // Offline mode
+    SETTINGS.opdsOffline = SETTINGS.opdsOffline ? 0 : 1;
+    SETTINGS.saveToFile();
+    updateRequired.request();
   }
 
   xSemaphoreGive(renderingMutex);
@@ -140,13 +146,12 @@ void CalibreSettingsActivity::handleSelection() {
 
 void CalibreSettingsActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -165,7 +170,7 @@ void CalibreSettingsActivity::render() {
   renderer.fillRect(0, 70 + selectedIndex * 30 - 2, pageWidth - 1, 30);
 
   // Draw menu items
-  const char* menuNames[MENU_ITEMS] = {"OPDS Server URL", TR(USERNAME), TR(PASSWORD)};
+  const char* menuNames[MENU_ITEMS] = {"OPDS Server URL", TR(USERNAME), TR(PASSWORD), TR(OFFLINE_MODE)};
   for (int i = 0; i < MENU_ITEMS; i++) {
     const int settingY = 70 + i * 30;
     const bool isSelected = (i == selectedIndex);
@@ -183,6 +188,8 @@ void CalibreSettingsActivity::render() {
     } else if (i == 2) {
       statusStr =
           (strlen(SETTINGS.opdsPassword) > 0) ? std::string("[") + TR(SET) + "]" : std::string("[") + TR(NOT_SET) + "]";
+    } else if (i == 3) {
+      statusStr = std::string("[") + (SETTINGS.opdsOffline ? TR(ON) : TR(OFF)) + "]";
     }
     const auto width = renderer.getTextWidth(UI_10_FONT_ID, statusStr.c_str());
     renderer.drawText(UI_10_FONT_ID, pageWidth - 20 - width, settingY, statusStr.c_str(), !isSelected);
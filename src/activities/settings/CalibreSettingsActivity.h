@@ -26,7 +26,6 @@ class CalibreSettingsActivity final : public ActivityWithSubactivity {
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
   ButtonNavigator buttonNavigator;
-  bool updateRequired = false;
 
   int selectedIndex = 0;
   const std::function<void()> onBack;
@@ -5,6 +5,7 @@
 #include <HardwareSerial.h>
 #include <I18n.h>
 
+#include "BookCacheManager.h"
 #include "MappedInputManager.h"
 #include "components/UITheme.h"
 #include "fontIds.h"
@@ -19,7 +20,7 @@ void ClearCacheActivity::onEnter() {
 
   renderingMutex = xSemaphoreCreateMutex();
   state = WARNING;
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&ClearCacheActivity::taskTrampoline, "ClearCacheActivityTask",
               4096,               // Stack size
@@ -36,6 +37,7 @@ void ClearCacheActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -44,13 +46,12 @@ void ClearCacheActivity::onExit() {
 
 void ClearCacheActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -112,7 +113,7 @@ void ClearCacheActivity::clearCache() {
     Serial.printf("[%lu] [CLEAR_CACHE] Failed to open cache directory\n", millis());
     if (root) root.close();
     state = FAILED;
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -125,8 +126,9 @@ void ClearCacheActivity::clearCache() {
     file.getName(name, sizeof(name));
     String itemName(name);
 
-    // Only delete directories starting with epub_ or xtc_
-    if (file.isDirectory() && (itemName.startsWith("epub_") || itemName.startsWith("xtc_"))) {
+    // Only delete book caches (epub_, xtc_) and the pre-rendered sleep screens
+    if (file.isDirectory() &&
+        (itemName.startsWith("epub_") || itemName.startsWith("xtc_") || itemName.equals("sleep"))) {
       String fullPath = "/.crosspoint/" + itemName;
       Serial.printf("[%lu] [CLEAR_CACHE] Removing cache: %s\n", millis(), fullPath.c_str());
 
@@ -143,11 +145,12 @@ void ClearCacheActivity::clearCache() {
     }
   }
   root.close();
+  BOOK_CACHE.invalidate();
 
   Serial.printf("[%lu] [CLEAR_CACHE] Cache cleared: %d removed, %d failed\n", millis(), clearedCount, failedCount);
 
   state = SUCCESS;
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void ClearCacheActivity::loop() {
@@ -157,7 +160,7 @@ void ClearCacheActivity::loop() {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       state = CLEARING;
       xSemaphoreGive(renderingMutex);
-      updateRequired = true;
+      updateRequired.request();
       vTaskDelay(10 / portTICK_PERIOD_MS);
 
       clearCache();
@@ -25,7 +25,6 @@ class ClearCacheActivity final : public ActivityWithSubactivity {
   TaskHandle_t displayTaskHandle = nullptr;
   TaskHandle_t clearCacheTaskHandle = nullptr;  // Track clearCache task
   SemaphoreHandle_t renderingMutex = nullptr;
-  bool updateRequired = false;
   bool isExiting = false;  // Flag to prevent new operations during exit
   const std::function<void()> goBack;
 
@@ -24,7 +24,7 @@ void FontSelectActivity::onEnter() {
   // Wait 500ms to be safe and avoid race conditions with parent activity
   vTaskDelay(500 / portTICK_PERIOD_MS);
 
-  // Scan fonts
+  // Font list from the registry, /fonts/ is only rescanned when it changed
   FontMgr.scanFonts();
 
   if (mode == SelectMode::Reader) {
@@ -24,7 +24,7 @@ void KOReaderAuthActivity::onWifiSelectionComplete(const bool success) {
     state = FAILED;
     errorMessage = TR(WIFI_CONN_FAILED);
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -32,7 +32,7 @@ void KOReaderAuthActivity::onWifiSelectionComplete(const bool success) {
   state = AUTHENTICATING;
   statusMessage = TR(AUTHENTICATING);
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 
   performAuthentication();
 }
@@ -49,7 +49,7 @@ void KOReaderAuthActivity::performAuthentication() {
     errorMessage = KOReaderSyncClient::errorString(result);
   }
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void KOReaderAuthActivity::onEnter() {
@@ -71,7 +71,7 @@ void KOReaderAuthActivity::onEnter() {
   if (WiFi.status() == WL_CONNECTED) {
     state = AUTHENTICATING;
     statusMessage = TR(AUTHENTICATING);
-    updateRequired = true;
+    updateRequired.request();
 
     // Perform authentication in a separate task
     xTaskCreate(
@@ -101,6 +101,7 @@ void KOReaderAuthActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -109,13 +110,12 @@ void KOReaderAuthActivity::onExit() {
 
 void KOReaderAuthActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -27,7 +27,6 @@ class KOReaderAuthActivity final : public ActivityWithSubactivity {
 
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
-  bool updateRequired = false;
 
   State state = WIFI_SELECTION;
   std::string statusMessage;
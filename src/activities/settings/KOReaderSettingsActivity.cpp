@@ -27,7 +27,7 @@ void KOReaderSettingsActivity::onEnter() {
 
   renderingMutex = xSemaphoreCreateMutex();
   selectedIndex = 0;
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&KOReaderSettingsActivity::taskTrampoline, "KOReaderSettingsTask",
               4096,               // Stack size
@@ -43,6 +43,7 @@ void KOReaderSettingsActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -68,12 +69,12 @@ void KOReaderSettingsActivity::loop() {
   // Handle navigation
   buttonNavigator.onNext([this] {
     selectedIndex = (selectedIndex + 1) % MENU_ITEMS;
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPrevious([this] {
     selectedIndex = (selectedIndex + MENU_ITEMS - 1) % MENU_ITEMS;
-    updateRequired = true;
+    updateRequired.request();
   });
 }
 
@@ -91,11 +92,11 @@ void KOReaderSettingsActivity::handleSelection() {
           KOREADER_STORE.setCredentials(username, KOREADER_STORE.getPassword());
           KOREADER_STORE.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
   } else if (selectedIndex == 1) {
     // Password
@@ -108,11 +109,11 @@ void KOReaderSettingsActivity::handleSelection() {
           KOREADER_STORE.setCredentials(KOREADER_STORE.getUsername(), password);
           KOREADER_STORE.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
   } else if (selectedIndex == 2) {
     // Sync Server URL - prefill with https:// if empty to save typing
@@ -129,11 +130,11 @@ void KOReaderSettingsActivity::handleSelection() {
           KOREADER_STORE.setServerUrl(urlToSave);
           KOREADER_STORE.saveToFile();
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         },
         [this]() {
           exitActivity();
-          updateRequired = true;
+          updateRequired.request();
         }));
   } else if (selectedIndex == 3) {
     // Document Matching - toggle between Filename and Binary
@@ -142,7 +143,7 @@ void KOReaderSettingsActivity::handleSelection() {
         (current == DocumentMatchMethod::FILENAME) ? DocumentMatchMethod::BINARY : DocumentMatchMethod::FILENAME;
     KOREADER_STORE.setMatchMethod(newMethod);
     KOREADER_STORE.saveToFile();
-    updateRequired = true;
+    updateRequired.request();
   } else if (selectedIndex == 4) {
     // Authenticate
     if (!KOREADER_STORE.hasCredentials()) {
@@ -153,7 +154,7 @@ void KOReaderSettingsActivity::handleSelection() {
     exitActivity();
     enterNewActivity(new KOReaderAuthActivity(renderer, mappedInput, [this] {
       exitActivity();
-      updateRequired = true;
+      updateRequired.request();
     }));
   }
 
@@ -162,13 +163,12 @@ void KOReaderSettingsActivity::handleSelection() {
 
 void KOReaderSettingsActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -20,7 +20,7 @@ void LanguageSelectActivity::onEnter() {
   // Set current selection based on current language
   selectedIndex = static_cast<int>(I18N.getLanguage());
 
-  updateRequired = false;  // Don't trigger render immediately to avoid race with parent activity
+  updateRequired.cancel();  // Don't trigger render immediately to avoid race with parent activity
 
   xTaskCreate(&LanguageSelectActivity::taskTrampoline, "LanguageSelectTask", 4096, this, 1, &displayTaskHandle);
 }
@@ -31,6 +31,7 @@ void LanguageSelectActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -56,11 +57,11 @@ void LanguageSelectActivity::loop() {
   if (mappedInput.wasPressed(MappedInputManager::Button::Up) ||
       mappedInput.wasPressed(MappedInputManager::Button::Left)) {
     selectedIndex = (selectedIndex + totalItems - 1) % totalItems;
-    updateRequired = true;
+    updateRequired.request();
   } else if (mappedInput.wasPressed(MappedInputManager::Button::Down) ||
              mappedInput.wasPressed(MappedInputManager::Button::Right)) {
     selectedIndex = (selectedIndex + 1) % totalItems;
-    updateRequired = true;
+    updateRequired.request();
   }
 }
 
@@ -80,16 +81,15 @@ void LanguageSelectActivity::displayTaskLoop() {
   // Wait for parent activity's rendering to complete (screen refresh takes ~422ms)
   // Wait 500ms to be safe and avoid race conditions with parent activity
   vTaskDelay(500 / portTICK_PERIOD_MS);
-  updateRequired = true;
+  updateRequired.request();
 
   while (true) {
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -34,5 +34,4 @@ class LanguageSelectActivity final : public ActivityWithSubactivity {
 
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
-  volatile bool updateRequired = false;
 };
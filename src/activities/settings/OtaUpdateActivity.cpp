@@ -29,7 +29,7 @@ void OtaUpdateActivity::onWifiSelectionComplete(const bool success) {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   state = CHECKING_FOR_UPDATE;
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
   vTaskDelay(10 / portTICK_PERIOD_MS);
   const auto res = updater.checkForUpdate();
   if (res != OtaUpdater::OK) {
@@ -37,7 +37,7 @@ void OtaUpdateActivity::onWifiSelectionComplete(const bool success) {
     xSemaphoreTake(renderingMutex, portMAX_DELAY);
     state = FAILED;
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
@@ -46,14 +46,14 @@ void OtaUpdateActivity::onWifiSelectionComplete(const bool success) {
     xSemaphoreTake(renderingMutex, portMAX_DELAY);
     state = NO_UPDATE;
     xSemaphoreGive(renderingMutex);
-    updateRequired = true;
+    updateRequired.request();
     return;
   }
 
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   state = WAITING_CONFIRMATION;
   xSemaphoreGive(renderingMutex);
-  updateRequired = true;
+  updateRequired.request();
 }
 
 void OtaUpdateActivity::onEnter() {
@@ -91,6 +91,7 @@ void OtaUpdateActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -99,13 +100,14 @@ void OtaUpdateActivity::onExit() {
 
 void OtaUpdateActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired || updater.getRender()) {
-      updateRequired = false;
+    // take() first, so a request is consumed even while the updater asks for progress renders
+    if (updateRequired.take() || updater.getRender()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    // The updater only raises a flag for download progress, keep polling it while an install runs
+    updateRequired.wait(updater.getRender() ? pdMS_TO_TICKS(10) : portMAX_DELAY);
   }
 }
 
@@ -195,7 +197,7 @@ void OtaUpdateActivity::loop() {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       state = UPDATE_IN_PROGRESS;
       xSemaphoreGive(renderingMutex);
-      updateRequired = true;
+      updateRequired.request();
       vTaskDelay(10 / portTICK_PERIOD_MS);
       const auto res = updater.installUpdate();
 
@@ -204,14 +206,14 @@ void OtaUpdateActivity::loop() {
         xSemaphoreTake(renderingMutex, portMAX_DELAY);
         state = FAILED;
         xSemaphoreGive(renderingMutex);
-        updateRequired = true;
+        updateRequired.request();
         return;
       }
 
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       state = FINISHED;
       xSemaphoreGive(renderingMutex);
-      updateRequired = true;
+      updateRequired.request();
     }
 
     if (mappedInput.wasPressed(MappedInputManager::Button::Back)) {
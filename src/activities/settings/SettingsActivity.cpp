@@ -43,6 +43,7 @@ const char* translateSettingName(const char* name) {
   if (strcmp(name, "Paragraph Alignment") == 0) return TR(PARA_ALIGNMENT);
   if (strcmp(name, "Book's Embedded Style") == 0) return TR(EMBEDDED_STYLE);
   if (strcmp(name, "Hyphenation") == 0) return TR(HYPHENATION);
+  if (strcmp(name, "Search Index") == 0) return TR(SEARCH_INDEX);
   if (strcmp(name, "Reading Orientation") == 0) return TR(ORIENTATION);
   if (strcmp(name, "Extra Paragraph Spacing") == 0) return TR(EXTRA_SPACING);
   if (strcmp(name, "Text Anti-Aliasing") == 0) return TR(TEXT_AA);
@@ -185,7 +186,7 @@ void SettingsActivity::onEnter() {
   settingsCount = static_cast<int>(displaySettings.size());
 
   // Trigger first update
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&SettingsActivity::taskTrampoline, "SettingsActivityTask",
               4096,               // Stack size
@@ -202,6 +203,7 @@ void SettingsActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -222,10 +224,10 @@ void SettingsActivity::loop() {
     if (selectedSettingIndex == 0) {
       selectedCategoryIndex = (selectedCategoryIndex < categoryCount - 1) ? (selectedCategoryIndex + 1) : 0;
       hasChangedCategory = true;
-      updateRequired = true;
+      updateRequired.request();
     } else {
       toggleCurrentSetting();
-      updateRequired = true;
+      updateRequired.request();
       return;
     }
   }
@@ -239,24 +241,24 @@ void SettingsActivity::loop() {
   // Handle navigation
   buttonNavigator.onNextRelease([this] {
     selectedSettingIndex = ButtonNavigator::nextIndex(selectedSettingIndex, settingsCount + 1);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPreviousRelease([this] {
     selectedSettingIndex = ButtonNavigator::previousIndex(selectedSettingIndex, settingsCount + 1);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onNextContinuous([this, &hasChangedCategory] {
     hasChangedCategory = true;
     selectedCategoryIndex = ButtonNavigator::nextIndex(selectedCategoryIndex, categoryCount);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPreviousContinuous([this, &hasChangedCategory] {
     hasChangedCategory = true;
     selectedCategoryIndex = ButtonNavigator::previousIndex(selectedCategoryIndex, categoryCount);
-    updateRequired = true;
+    updateRequired.request();
   });
 
   if (hasChangedCategory) {
@@ -302,7 +304,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new FontSelectActivity(renderer, mappedInput, FontSelectActivity::SelectMode::Reader, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
       return;
@@ -322,7 +324,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new ButtonRemapActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "KOReader Sync") == 0) {
@@ -330,7 +332,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new KOReaderSettingsActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "OPDS Browser") == 0) {
@@ -338,7 +340,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new CalibreSettingsActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "Clear Cache") == 0) {
@@ -346,7 +348,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new ClearCacheActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "Language") == 0) {
@@ -354,7 +356,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new LanguageSelectActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "Check for updates") == 0) {
@@ -362,7 +364,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new OtaUpdateActivity(renderer, mappedInput, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     } else if (strcmp(setting.name, "UI Font") == 0) {
@@ -370,7 +372,7 @@ void SettingsActivity::toggleCurrentSetting() {
       exitActivity();
       enterNewActivity(new FontSelectActivity(renderer, mappedInput, FontSelectActivity::SelectMode::UI, [this] {
         exitActivity();
-        updateRequired = true;
+        updateRequired.request();
       }));
       xSemaphoreGive(renderingMutex);
     }
@@ -389,13 +391,12 @@ void SettingsActivity::toggleCurrentSetting() {
 
 void SettingsActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired && !subActivity) {
-      updateRequired = false;
+    if (!subActivity && updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -26,13 +26,12 @@ void KeyboardEntryActivity::taskTrampoline(void* param) {
 
 void KeyboardEntryActivity::displayTaskLoop() {
   while (true) {
-    if (updateRequired) {
-      updateRequired = false;
+    if (updateRequired.take()) {
       xSemaphoreTake(renderingMutex, portMAX_DELAY);
       render();
       xSemaphoreGive(renderingMutex);
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    updateRequired.wait();
   }
 }
 
@@ -42,7 +41,7 @@ void KeyboardEntryActivity::onEnter() {
   renderingMutex = xSemaphoreCreateMutex();
 
   // Trigger first update
-  updateRequired = true;
+  updateRequired.request();
 
   xTaskCreate(&KeyboardEntryActivity::taskTrampoline, "KeyboardEntryActivity",
               2048,               // Stack size
@@ -59,6 +58,7 @@ void KeyboardEntryActivity::onExit() {
   xSemaphoreTake(renderingMutex, portMAX_DELAY);
   if (displayTaskHandle) {
     vTaskDelete(displayTaskHandle);
+    updateRequired.detach();
     displayTaskHandle = nullptr;
   }
   vSemaphoreDelete(renderingMutex);
@@ -150,7 +150,7 @@ void KeyboardEntryActivity::loop() {
 
     const int maxCol = getRowLength(selectedRow) - 1;
     if (selectedCol > maxCol) selectedCol = maxCol;
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPressAndContinuous({MappedInputManager::Button::Down}, [this] {
@@ -158,7 +158,7 @@ void KeyboardEntryActivity::loop() {
 
     const int maxCol = getRowLength(selectedRow) - 1;
     if (selectedCol > maxCol) selectedCol = maxCol;
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPressAndContinuous({MappedInputManager::Button::Left}, [this] {
@@ -184,7 +184,7 @@ void KeyboardEntryActivity::loop() {
       selectedCol = ButtonNavigator::previousIndex(selectedCol, maxCol + 1);
     }
 
-    updateRequired = true;
+    updateRequired.request();
   });
 
   buttonNavigator.onPressAndContinuous({MappedInputManager::Button::Right}, [this] {
@@ -209,13 +209,13 @@ void KeyboardEntryActivity::loop() {
     } else {
       selectedCol = ButtonNavigator::nextIndex(selectedCol, maxCol + 1);
     }
-    updateRequired = true;
+    updateRequired.request();
   });
 
   // Selection
   if (mappedInput.wasPressed(MappedInputManager::Button::Confirm)) {
     handleKeyPress();
-    updateRequired = true;
+    updateRequired.request();
   }
 
   // Cancel
@@ -223,7 +223,7 @@ void KeyboardEntryActivity::loop() {
     if (onCancel) {
       onCancel();
     }
-    updateRequired = true;
+    updateRequired.request();
   }
 }
 
@@ -339,7 +339,7 @@ void KeyboardEntryActivity::render() const {
   // Draw side button hints for Up/Down navigation
   GUI.drawSideButtonHints(renderer, TR(DIR_UP), TR(DIR_DOWN));
 
-  renderer.displayBuffer();
+  renderer.displayChanges();
 }
 
 void KeyboardEntryActivity::renderItemWithSelector(const int x, const int y, const char* item,
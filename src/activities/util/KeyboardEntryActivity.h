@@ -67,7 +67,6 @@ class KeyboardEntryActivity : public Activity {
   TaskHandle_t displayTaskHandle = nullptr;
   SemaphoreHandle_t renderingMutex = nullptr;
   ButtonNavigator buttonNavigator;
-  bool updateRequired = false;
 
   // Keyboard state
   int selectedRow = 0;
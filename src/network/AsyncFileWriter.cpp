@@ -0,0 +1,160 @@
+#include "AsyncFileWriter.h"
+
+#include <HardwareSerial.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void AsyncFileWriter::taskTrampoline(void* param) {
+  auto* self = static_cast<AsyncFileWriter*>(param);
+  self->writerLoop();
+}
+
+bool AsyncFileWriter::begin() {
+  end();
+
+  bool allocated = true;
+  for (uint8_t i = 0; i < bufferCount; i++) {
+    buffers[i] = static_cast<uint8_t*>(malloc(bufferSize));
+    allocated = allocated && buffers[i];
+  }
+  fullQueue = xQueueCreate(bufferCount, sizeof(int8_t));
+  // Room for every index and the STOP answer
+  freeQueue = xQueueCreate(bufferCount + 1, sizeof(int8_t));
+  if (!allocated || !fullQueue || !freeQueue) {
+    Serial.printf("[%lu] [AFW] Not enough memory for %u write buffers of %u bytes\n", millis(), bufferCount,
+                  bufferSize);
+    release();
+    return false;
+  }
+
+  for (int8_t i = 0; i < bufferCount; i++) {
+    used[i] = 0;
+    xQueueSend(freeQueue, &i, 0);
+  }
+  filling = STOP;
+  writeFailed = false;
+  waited = 0;
+
+  if (xTaskCreate(&AsyncFileWriter::taskTrampoline, "AsyncFileWriter",
+                  4096,  // Stack size
+                  this,  // Parameters
+                  1,     // Priority
+                  nullptr) != pdPASS) {
+    Serial.printf("[%lu] [AFW] Failed to start the writer task\n", millis());
+    release();
+    return false;
+  }
+  running = true;
+  return true;
+}
+
+bool AsyncFileWriter::write(const uint8_t* data, size_t size) {
+  if (!running) {
+    return false;
+  }
+
+  while (size > 0) {
+    if (filling == STOP && xQueueReceive(freeQueue, &filling, 0) != pdTRUE) {
+      const unsigned long waitStart = millis();
+      xQueueReceive(freeQueue, &filling, portMAX_DELAY);
+      waited += millis() - waitStart;
+    }
+    if (writeFailed) {
+      return false;
+    }
+
+    const size_t count = std::min(size, bufferSize - used[filling]);
+    memcpy(buffers[filling] + used[filling], data, count);
+    used[filling] += count;
+    data += count;
+    size -= count;
+
+    if (used[filling] == bufferSize) {
+      submit();
+    }
+  }
+  return !writeFailed;
+}
+
+bool AsyncFileWriter::flush() {
+  if (!running) {
+    return false;
+  }
+
+  if (filling != STOP && used[filling] > 0) {
+    submit();
+  }
+
+  // The task is idle once the caller holds every buffer
+  int8_t held[MAX_BUFFERS];
+  const int pending = filling == STOP ? bufferCount : bufferCount - 1;
+  for (int i = 0; i < pending; i++) {
+    xQueueReceive(freeQueue, &held[i], portMAX_DELAY);
+  }
+  for (int i = 0; i < pending; i++) {
+    xQueueSend(freeQueue, &held[i], portMAX_DELAY);
+  }
+
+  if (writeFailed) {
+    Serial.printf("[%lu] [AFW] Write failed\n", millis());
+    return false;
+  }
+  // SdFat's flush() returns nothing, sync() reports whether the data reached the card
+  return file.sync();
+}
+
+bool AsyncFileWriter::end() {
+  if (!running) {
+    release();
+    return !writeFailed;
+  }
+
+  const bool flushed = flush();
+
+  xQueueSend(fullQueue, &STOP, portMAX_DELAY);
+  int8_t index;
+  do {
+    xQueueReceive(freeQueue, &index, portMAX_DELAY);
+  } while (index != STOP);
+
+  running = false;
+  release();
+  return flushed;
+}
+
+void AsyncFileWriter::submit() {
+  xQueueSend(fullQueue, &filling, portMAX_DELAY);
+  filling = STOP;
+}
+
+void AsyncFileWriter::writerLoop() {
+  int8_t index;
+  while (xQueueReceive(fullQueue, &index, portMAX_DELAY) == pdTRUE && index != STOP) {
+    if (!writeFailed && file.write(buffers[index], used[index]) != used[index]) {
+      writeFailed = true;
+    }
+    used[index] = 0;
+    xQueueSend(freeQueue, &index, portMAX_DELAY);
+  }
+
+  xQueueSend(freeQueue, &STOP, portMAX_DELAY);
+  vTaskDelete(nullptr);
+}
+
+void AsyncFileWriter::release() {
+  for (auto*& buffer : buffers) {
+    free(buffer);
+    buffer = nullptr;
+  }
+  if (fullQueue) {
+    vQueueDelete(fullQueue);
+    fullQueue = nullptr;
+  }
+  if (freeQueue) {
+    vQueueDelete(freeQueue);
+    freeQueue = nullptr;
+  }
+  filling = STOP;
+}
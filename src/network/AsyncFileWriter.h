@@ -0,0 +1,64 @@
+#pragma once
+#include <HalStorage.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Writes to an open SD file from a task of its own, so the caller can keep receiving from the network while the
+ * card is busy. Data is collected in one of `bufferCount` buffers; a full buffer is handed to the writer task and
+ * filling goes on in the next one.
+ */
+class AsyncFileWriter {
+ public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 4096;
+  static constexpr uint8_t MAX_BUFFERS = 4;
+
+  explicit AsyncFileWriter(FsFile& file, const size_t bufferSize = DEFAULT_BUFFER_SIZE, const uint8_t bufferCount = 2)
+      : file(file), bufferSize(bufferSize), bufferCount(bufferCount < 2 ? 2 : std::min(bufferCount, MAX_BUFFERS)) {}
+  ~AsyncFileWriter() { end(); }
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  // Allocates the buffers and starts the writer task. False if there is not enough memory for either.
+  bool begin();
+
+  // Copies `size` bytes into the buffers, waiting while all are being written. False once a write has failed.
+  bool write(const uint8_t* data, size_t size);
+
+  // Waits until everything given to write() is in the file, then flushes the file
+  bool flush();
+
+  // flush() and stops the task. The file stays open.
+  bool end();
+
+  // Time write() spent waiting for the card since begin()
+  unsigned long waitedMs() const { return waited; }
+
+ private:
+  static constexpr int8_t STOP = -1;
+
+  FsFile& file;
+  const size_t bufferSize;
+  const uint8_t bufferCount;
+  uint8_t* buffers[MAX_BUFFERS] = {};
+  size_t used[MAX_BUFFERS] = {};
+  int8_t filling = STOP;  // Buffer being filled by the caller, STOP while the caller holds none
+  // Buffer indexes waiting for the writer task, and indexes the caller may fill. The task answers STOP with STOP.
+  QueueHandle_t fullQueue = nullptr;
+  QueueHandle_t freeQueue = nullptr;
+  bool running = false;
+  unsigned long waited = 0;
+  // Set by the writer task before it hands the buffer back, so the caller sees it with the next free buffer
+  std::atomic<bool> writeFailed{false};
+
+  static void taskTrampoline(void* param);
+  void writerLoop();
+  void submit();
+  void release();
+};
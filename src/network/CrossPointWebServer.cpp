@@ -2,6 +2,7 @@
 
 #include <ArduinoJson.h>
 #include <Epub.h>
+#include <FontManager.h>
 #include <FsHelpers.h>
 #include <HalStorage.h>
 #include <WiFi.h>
@@ -10,7 +11,10 @@
 #include <algorithm>
 #include <map>
 
+#include "BookPreparer.h"
 #include "CrossPointSettings.h"
+#include "DirectoryIndex.h"
+#include "LibraryCatalog.h"
 #include "SettingsList.h"
 #include "WifiCredentialStore.h"
 #include "html/ApHomePageHtml.generated.h"
@@ -26,12 +30,19 @@ const char* HIDDEN_ITEMS[] = {"System Volume Information", "XTCache"};
 constexpr size_t HIDDEN_ITEMS_COUNT = sizeof(HIDDEN_ITEMS) / sizeof(HIDDEN_ITEMS[0]);
 constexpr uint16_t UDP_PORTS[] = {54982, 48123, 39001, 44044, 59678};
 constexpr uint16_t LOCAL_UDP_PORT = 8134;
+// File listings go out in chunks of about this many bytes, and pages hold at most MAX_LISTING_PAGE entries
+constexpr size_t LISTING_CHUNK_SIZE = 1024;
+constexpr size_t LISTING_ENTRY_SIZE = 512;
+constexpr uint32_t MAX_LISTING_PAGE = 500;
+// WebSocket uploads are acknowledged every WS_PROGRESS_INTERVAL bytes. The page keeps up to 64 KB unacknowledged, more
+// than the upload writer buffers, so the card never waits for the network.
+constexpr size_t WS_PROGRESS_INTERVAL = 16384;
 
 // Static pointer for WebSocket callback (WebSocketsServer requires C-style callback)
 CrossPointWebServer* wsInstance = nullptr;
 
 // WebSocket upload state
-FsFile wsUploadFile;
+UploadWriter wsUploadWriter;
 String wsUploadFileName;
 String wsUploadPath;
 size_t wsUploadSize = 0;
@@ -51,6 +62,18 @@ void clearEpubCacheIfNeeded(const String& filePath) {
   }
 }
 
+// Helper function to make the on-device library rescan a folder whose contents changed
+void invalidateLibraryFolder(const String& itemPath) {
+  LIBRARY_CATALOG.invalidateParentOf(itemPath.c_str());
+  DirectoryIndex::invalidateParentOf(itemPath.c_str());
+
+  // Writing a file doesn't necessarily change its directory's modification time, which the font registry relies on
+  const char* path = itemPath.c_str();
+  if (strncasecmp(path, "/fonts", 6) == 0 && (path[6] == '\0' || path[6] == '/')) {
+    FontMgr.invalidateRegistry();
+  }
+}
+
 String normalizeWebPath(const String& inputPath) {
   if (inputPath.isEmpty() || inputPath == "/") {
     return "/";
@@ -80,6 +103,75 @@ bool isProtectedItemName(const String& name) {
   }
   return false;
 }
+
+bool isHiddenItemName(const char* name) { return isProtectedItemName(String(name)); }
+
+// Streams a JSON file listing with chunked transfer encoding, LISTING_CHUNK_SIZE bytes at a time, so a listing
+// takes the same memory for any number of entries. The response starts with the first chunk, until then the handler
+// can still answer with an error. Sending stops once the client has gone instead of writing into a dead connection.
+class ListingStream {
+ public:
+  ListingStream(WebServer& server, const bool paged) : server(server) {
+    chunk.reserve(LISTING_CHUNK_SIZE + LISTING_ENTRY_SIZE);
+    chunk = paged ? "{\"entries\":[" : "[";
+  }
+
+  // False once the client has disconnected
+  bool add(const char* name, const size_t size, const bool isDirectory, const bool isEpub) {
+    doc.clear();
+    doc["name"] = name;
+    doc["size"] = size;
+    doc["isDirectory"] = isDirectory;
+    doc["isEpub"] = isEpub;
+    char output[LISTING_ENTRY_SIZE];
+    const size_t written = serializeJson(doc, output, sizeof(output));
+    if (written >= sizeof(output)) {
+      Serial.printf("[%lu] [WEB] Skipping file entry with oversized JSON for name: %s\n", millis(), name);
+      return true;
+    }
+    if (count++ > 0) {
+      chunk += ",";
+    }
+    chunk += output;
+    return chunk.length() < LISTING_CHUNK_SIZE || flush();
+  }
+
+  // Closes the array, `trailer` finishes a paged listing's object
+  void finish(const char* trailer) {
+    chunk += "]";
+    chunk += trailer;
+    if (flush()) {
+      server.sendContent("");
+    }
+  }
+
+  uint32_t entries() const { return count; }
+
+ private:
+  WebServer& server;
+  JsonDocument doc;
+  String chunk;
+  uint32_t count = 0;
+  bool started = false;
+  bool disconnected = false;
+
+  bool flush() {
+    if (!started) {
+      server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+      server.send(200, "application/json", "");
+      started = true;
+    }
+    if (!disconnected && !server.client().connected()) {
+      Serial.printf("[%lu] [WEB] Client left during file listing\n", millis());
+      disconnected = true;
+    }
+    if (!disconnected) {
+      server.sendContent(chunk);
+    }
+    chunk = "";
+    return !disconnected;
+  }
+};
 }  // namespace
 
 // File listing page template - now using generated headers:
@@ -110,6 +202,9 @@ void CrossPointWebServer::begin() {
   // Store AP mode flag for later use (e.g., in handleStatus)
   apMode = isInApMode;
 
+  // The card may have been changed while the server was off, sorted listings are indexed again when asked for
+  DirectoryIndex::clear();
+
   Serial.printf("[%lu] [WEB] [MEM] Free heap before begin: %d bytes\n", millis(), ESP.getFreeHeap());
   Serial.printf("[%lu] [WEB] Network mode: %s\n", millis(), apMode ? "AP" : "STA");
 
@@ -201,6 +296,7 @@ void CrossPointWebServer::begin() {
   }
 
   running = true;
+  lastActivityTime = millis();
 
   Serial.printf("[%lu] [WEB] Web server started on port %d\n", millis(), port);
   // Show the correct IP based on network mode
@@ -217,9 +313,9 @@ void CrossPointWebServer::stop() {
 
   running = false;  // Set FIRST to prevent handleClient from using server
 
-  // Close any in-progress WebSocket upload
-  if (wsUploadInProgress && wsUploadFile) {
-    wsUploadFile.close();
+  // Drop any in-progress WebSocket upload
+  if (wsUploadInProgress) {
+    wsUploadWriter.abort();
     wsUploadInProgress = false;
   }
 
@@ -272,6 +368,10 @@ void CrossPointWebServer::handleClient() {
     wsServer->loop();
   }
 
+  if (server->client().connected() || upload.writer.isOpen() || wsUploadInProgress) {
+    lastActivityTime = millis();
+  }
+
   // Respond to discovery broadcasts
   if (udpActive) {
     int packetSize = udp.parsePacket();
@@ -408,7 +508,7 @@ void CrossPointWebServer::handleStatus() const {
   server->send(200, "application/json", json);
 }
 
-void CrossPointWebServer::scanFiles(const char* path, const std::function<void(FileInfo)>& callback) const {
+void CrossPointWebServer::scanFiles(const char* path, const std::function<bool(const FileInfo&)>& callback) const {
   FsFile root = Storage.open(path);
   if (!root) {
     Serial.printf("[%lu] [WEB] Failed to open directory: %s\n", millis(), path);
@@ -455,7 +555,10 @@ void CrossPointWebServer::scanFiles(const char* path, const std::function<void(F
         info.isEpub = isEpubFile(info.name);
       }
 
-      callback(info);
+      if (!callback(info)) {
+        file.close();
+        break;
+      }
     }
 
     file.close();
@@ -493,40 +596,60 @@ void CrossPointWebServer::handleFileListData() const {
     }
   }
 
-  // Collect all file entries first, then send as a single response.
-  // This avoids chunked transfer which can block indefinitely if the client
-  // disconnects mid-stream, causing the device to freeze.
-  String json = "[";
-  bool seenFirst = false;
-  JsonDocument doc;
-  char output[512];
-  constexpr size_t outputSize = sizeof(output);
-
-  scanFiles(currentPath.c_str(), [&json, &doc, &output, &seenFirst](const FileInfo& info) mutable {
-    doc.clear();
-    doc["name"] = info.name;
-    doc["size"] = info.size;
-    doc["isDirectory"] = info.isDirectory;
-    doc["isEpub"] = info.isEpub;
+  // Without paging arguments the whole directory goes out as a bare array, which the AP page and the move dialog
+  // read. With offset, limit or sort the answer is an object with the page of entries and whether more follow.
+  const bool paged = server->hasArg("offset") || server->hasArg("limit") || server->hasArg("sort");
+  const uint32_t offset = server->hasArg("offset") ? std::max<long>(0, server->arg("offset").toInt()) : 0;
+  uint32_t limit = UINT32_MAX;
+  if (server->hasArg("limit")) {
+    limit = std::min<uint32_t>(std::max<long>(1, server->arg("limit").toInt()), MAX_LISTING_PAGE);
+  }
+  DirectoryIndex::SortKey sortKey = DirectoryIndex::SortKey::NAME;
+  const bool sorted = server->hasArg("sort");
+  if (sorted && !DirectoryIndex::parseSortKey(server->arg("sort").c_str(), sortKey)) {
+    server->send(400, "text/plain", "Invalid sort");
+    return;
+  }
 
-    const size_t written = serializeJson(doc, output, outputSize);
-    if (written >= outputSize) {
-      Serial.printf("[%lu] [WEB] Skipping file entry with oversized JSON for name: %s\n", millis(), info.name.c_str());
+  ListingStream stream(*server, paged);
+  char trailer[128];
+  if (sorted) {
+    // Sorted pages come from an index on the card, only the entries on the page are opened
+    DirectoryIndex::Summary summary;
+    const bool listed = DirectoryIndex::forEachSorted(
+        currentPath.c_str(), sortKey, offset, limit, isHiddenItemName,
+        [this, &stream](const DirectoryIndex::Entry& entry) {
+          return stream.add(entry.name, entry.size, entry.isDirectory,
+                            !entry.isDirectory && isEpubFile(String(entry.name)));
+        },
+        summary);
+    if (!listed) {
+      server->send(404, "text/plain", "Failed to list directory");
       return;
     }
-
-    if (seenFirst) {
-      json += ",";
-    } else {
-      seenFirst = true;
-    }
-    json += output;
-  });
-  json += "]";
-
-  server->send(200, "application/json", json);
-  Serial.printf("[%lu] [WEB] Served file listing page for path: %s (%d bytes)\n", millis(), currentPath.c_str(),
-                json.length());
+    snprintf(trailer, sizeof(trailer), ",\"more\":%s,\"total\":%u,\"folders\":%u,\"bytes\":%llu}",
+             limit < summary.count && offset < summary.count - limit ? "true" : "false", summary.count,
+             summary.folders, static_cast<unsigned long long>(summary.totalBytes));
+  } else {
+    // Directory order, the entries before `offset` are skipped on the way
+    uint32_t skipped = 0;
+    bool more = false;
+    scanFiles(currentPath.c_str(), [&](const FileInfo& info) {
+      if (skipped < offset) {
+        skipped++;
+        return true;
+      }
+      if (stream.entries() == limit) {
+        more = true;
+        return false;
+      }
+      return stream.add(info.name.c_str(), info.size, info.isDirectory, info.isEpub);
+    });
+    snprintf(trailer, sizeof(trailer), ",\"more\":%s}", more ? "true" : "false");
+  }
+  stream.finish(paged ? trailer : "");
+  Serial.printf("[%lu] [WEB] Served file listing for path: %s (%u entries)\n", millis(), currentPath.c_str(),
+                stream.entries());
 }
 
 void CrossPointWebServer::handleDownload() const {
@@ -593,30 +716,8 @@ void CrossPointWebServer::handleDownload() const {
   file.close();
 }
 
-// Diagnostic counters for upload performance analysis
+// Start of the current HTTP upload, for the diagnostics
 static unsigned long uploadStartTime = 0;
-static unsigned long totalWriteTime = 0;
-static size_t writeCount = 0;
-
-static bool flushUploadBuffer(CrossPointWebServer::UploadState& state) {
-  if (state.bufferPos > 0 && state.file) {
-    esp_task_wdt_reset();  // Reset watchdog before potentially slow SD write
-    const unsigned long writeStart = millis();
-    const size_t written = state.file.write(state.buffer.data(), state.bufferPos);
-    totalWriteTime += millis() - writeStart;
-    writeCount++;
-    esp_task_wdt_reset();  // Reset watchdog after SD write
-
-    if (written != state.bufferPos) {
-      Serial.printf("[%lu] [WEB] [UPLOAD] Buffer flush failed: expected %d, wrote %d\n", millis(), state.bufferPos,
-                    written);
-      state.bufferPos = 0;
-      return false;
-    }
-    state.bufferPos = 0;
-  }
-  return true;
-}
 
 void CrossPointWebServer::handleUpload(UploadState& state) const {
   static size_t lastLoggedSize = 0;
@@ -642,10 +743,6 @@ void CrossPointWebServer::handleUpload(UploadState& state) const {
     state.error = "";
     uploadStartTime = millis();
     lastLoggedSize = 0;
-    state.bufferPos = 0;
-    state.ensureBuffer();  // Lazy-allocate upload buffer on first upload
-    totalWriteTime = 0;
-    writeCount = 0;
 
     // Get upload path from query parameter (defaults to root if not specified)
     // Note: We use query parameter instead of form data because multipart form
@@ -672,17 +769,12 @@ void CrossPointWebServer::handleUpload(UploadState& state) const {
     if (!filePath.endsWith("/")) filePath += "/";
     filePath += state.fileName;
 
-    // Check if file already exists - SD operations can be slow
-    esp_task_wdt_reset();
-    if (Storage.exists(filePath.c_str())) {
-      Serial.printf("[%lu] [WEB] [UPLOAD] Overwriting existing file: %s\n", millis(), filePath.c_str());
-      esp_task_wdt_reset();
-      Storage.remove(filePath.c_str());
-    }
+    // The page sends the file size along so the file can be preallocated, multipart bodies don't announce it
+    const size_t expectedSize = server->hasArg("size") ? server->arg("size").toInt() : 0;
 
-    // Open file for writing - this can be slow due to FAT cluster allocation
+    // Replacing, creating and preallocating the file can be slow
     esp_task_wdt_reset();
-    if (!Storage.openFileForWrite("WEB", filePath, state.file)) {
+    if (!state.writer.begin("WEB", filePath.c_str(), expectedSize)) {
       state.error = "Failed to create file on SD card";
       Serial.printf("[%lu] [WEB] [UPLOAD] FAILED to create file: %s\n", millis(), filePath.c_str());
       return;
@@ -691,29 +783,12 @@ void CrossPointWebServer::handleUpload(UploadState& state) const {
 
     Serial.printf("[%lu] [WEB] [UPLOAD] File created successfully: %s\n", millis(), filePath.c_str());
   } else if (upload.status == UPLOAD_FILE_WRITE) {
-    if (state.file && state.error.isEmpty()) {
-      // Buffer incoming data and flush when buffer is full
-      // This reduces SD card write operations and improves throughput
-      const uint8_t* data = upload.buf;
-      size_t remaining = upload.currentSize;
-
-      while (remaining > 0) {
-        const size_t space = UploadState::UPLOAD_BUFFER_SIZE - state.bufferPos;
-        const size_t toCopy = (remaining < space) ? remaining : space;
-
-        memcpy(state.buffer.data() + state.bufferPos, data, toCopy);
-        state.bufferPos += toCopy;
-        data += toCopy;
-        remaining -= toCopy;
-
-        // Flush buffer when full
-        if (state.bufferPos >= UploadState::UPLOAD_BUFFER_SIZE) {
-          if (!flushUploadBuffer(state)) {
-            state.error = "Failed to write to SD card - disk may be full";
-            state.file.close();
-            return;
-          }
-        }
+    if (state.writer.isOpen() && state.error.isEmpty()) {
+      // Copied into the writer's buffers, the writer task puts them on the card while the next part arrives
+      if (!state.writer.write(upload.buf, upload.currentSize)) {
+        state.error = "Failed to write to SD card - disk may be full";
+        state.writer.abort();
+        return;
       }
 
       state.size += upload.currentSize;
@@ -722,46 +797,42 @@ void CrossPointWebServer::handleUpload(UploadState& state) const {
       if (state.size - lastLoggedSize >= 102400) {
         const unsigned long elapsed = millis() - uploadStartTime;
         const float kbps = (elapsed > 0) ? (state.size / 1024.0) / (elapsed / 1000.0) : 0;
-        Serial.printf("[%lu] [WEB] [UPLOAD] %d bytes (%.1f KB), %.1f KB/s, %d writes\n", millis(), state.size,
-                      state.size / 1024.0, kbps, writeCount);
+        Serial.printf("[%lu] [WEB] [UPLOAD] %d bytes (%.1f KB), %.1f KB/s\n", millis(), state.size,
+                      state.size / 1024.0, kbps);
         lastLoggedSize = state.size;
       }
     }
   } else if (upload.status == UPLOAD_FILE_END) {
-    if (state.file) {
-      // Flush any remaining buffered data
-      if (!flushUploadBuffer(state)) {
+    if (state.writer.isOpen()) {
+      // Write out what is still buffered
+      esp_task_wdt_reset();
+      if (!state.writer.finish()) {
         state.error = "Failed to write final data to SD card";
       }
-      state.file.close();
 
       if (state.error.isEmpty()) {
         state.success = true;
         const unsigned long elapsed = millis() - uploadStartTime;
         const float avgKbps = (elapsed > 0) ? (state.size / 1024.0) / (elapsed / 1000.0) : 0;
-        const float writePercent = (elapsed > 0) ? (totalWriteTime * 100.0 / elapsed) : 0;
+        const unsigned long waited = state.writer.waitedMs();
+        const float waitPercent = (elapsed > 0) ? (waited * 100.0 / elapsed) : 0;
         Serial.printf("[%lu] [WEB] [UPLOAD] Complete: %s (%d bytes in %lu ms, avg %.1f KB/s)\n", millis(),
                       state.fileName.c_str(), state.size, elapsed, avgKbps);
-        Serial.printf("[%lu] [WEB] [UPLOAD] Diagnostics: %d writes, total write time: %lu ms (%.1f%%)\n", millis(),
-                      writeCount, totalWriteTime, writePercent);
+        Serial.printf("[%lu] [WEB] [UPLOAD] Diagnostics: waited %lu ms for the SD card (%.1f%%)\n", millis(), waited,
+                      waitPercent);
 
         // Clear epub cache to prevent stale metadata issues when overwriting files
         String filePath = state.path;
         if (!filePath.endsWith("/")) filePath += "/";
         filePath += state.fileName;
         clearEpubCacheIfNeeded(filePath);
+        invalidateLibraryFolder(filePath);
+        BOOK_PREPARER.enqueue(filePath.c_str());
       }
     }
   } else if (upload.status == UPLOAD_FILE_ABORTED) {
-    state.bufferPos = 0;  // Discard buffered data
-    if (state.file) {
-      state.file.close();
-      // Try to delete the incomplete file
-      String filePath = state.path;
-      if (!filePath.endsWith("/")) filePath += "/";
-      filePath += state.fileName;
-      Storage.remove(filePath.c_str());
-    }
+    // Discards buffered data and deletes the incomplete file
+    state.writer.abort();
     state.error = "Upload aborted";
     Serial.printf("[%lu] [WEB] Upload aborted\n", millis());
   }
@@ -821,6 +892,7 @@ void CrossPointWebServer::handleCreateFolder() const {
   // Create the folder
   if (Storage.mkdir(folderPath.c_str())) {
     Serial.printf("[%lu] [WEB] Folder created successfully: %s\n", millis(), folderPath.c_str());
+    invalidateLibraryFolder(folderPath);
     server->send(200, "text/plain", "Folder created: " + folderName);
   } else {
     Serial.printf("[%lu] [WEB] Failed to create folder: %s\n", millis(), folderPath.c_str());
@@ -904,6 +976,7 @@ void CrossPointWebServer::handleRename() const {
 
   if (success) {
     Serial.printf("[%lu] [WEB] Renamed file: %s -> %s\n", millis(), itemPath.c_str(), newPath.c_str());
+    invalidateLibraryFolder(itemPath);
     server->send(200, "text/plain", "Renamed successfully");
   } else {
     Serial.printf("[%lu] [WEB] Failed to rename file: %s -> %s\n", millis(), itemPath.c_str(), newPath.c_str());
@@ -998,6 +1071,8 @@ void CrossPointWebServer::handleMove() const {
 
   if (success) {
     Serial.printf("[%lu] [WEB] Moved file: %s -> %s\n", millis(), itemPath.c_str(), newPath.c_str());
+    invalidateLibraryFolder(itemPath);
+    invalidateLibraryFolder(newPath);
     server->send(200, "text/plain", "Moved successfully");
   } else {
     Serial.printf("[%lu] [WEB] Failed to move file: %s -> %s\n", millis(), itemPath.c_str(), newPath.c_str());
@@ -1081,6 +1156,7 @@ void CrossPointWebServer::handleDelete() const {
 
   if (success) {
     Serial.printf("[%lu] [WEB] Successfully deleted: %s\n", millis(), itemPath.c_str());
+    invalidateLibraryFolder(itemPath);
     server->send(200, "text/plain", "Deleted successfully");
   } else {
     Serial.printf("[%lu] [WEB] Failed to delete: %s\n", millis(), itemPath.c_str());
@@ -1263,21 +1339,15 @@ void CrossPointWebServer::wsEventCallback(uint8_t num, WStype_t type, uint8_t* p
 // Protocol:
 //   1. Client sends TEXT message: "START:<filename>:<size>:<path>"
 //   2. Client sends BINARY messages with file data chunks
-//   3. Server sends TEXT "PROGRESS:<received>:<total>" after each chunk
+//   3. Server sends TEXT "PROGRESS:<received>:<total>" every WS_PROGRESS_INTERVAL bytes, the client's flow control
 //   4. Server sends TEXT "DONE" or "ERROR:<message>" when complete
 void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
   switch (type) {
     case WStype_DISCONNECTED:
       Serial.printf("[%lu] [WS] Client %u disconnected\n", millis(), num);
-      // Clean up any in-progress upload
-      if (wsUploadInProgress && wsUploadFile) {
-        wsUploadFile.close();
-        // Delete incomplete file
-        String filePath = wsUploadPath;
-        if (!filePath.endsWith("/")) filePath += "/";
-        filePath += wsUploadFileName;
-        Storage.remove(filePath.c_str());
-        Serial.printf("[%lu] [WS] Deleted incomplete upload: %s\n", millis(), filePath.c_str());
+      // Delete any incomplete upload
+      if (wsUploadInProgress) {
+        wsUploadWriter.abort();
       }
       wsUploadInProgress = false;
       break;
@@ -1318,15 +1388,9 @@ void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t*
           Serial.printf("[%lu] [WS] Starting upload: %s (%d bytes) to %s\n", millis(), wsUploadFileName.c_str(),
                         wsUploadSize, filePath.c_str());
 
-          // Check if file exists and remove it
-          esp_task_wdt_reset();
-          if (Storage.exists(filePath.c_str())) {
-            Storage.remove(filePath.c_str());
-          }
-
-          // Open file for writing
+          // Replace any existing file, preallocated to the announced size
           esp_task_wdt_reset();
-          if (!Storage.openFileForWrite("WS", filePath, wsUploadFile)) {
+          if (!wsUploadWriter.begin("WS", filePath.c_str(), wsUploadSize)) {
             wsServer->sendTXT(num, "ERROR:Failed to create file");
             wsUploadInProgress = false;
             return;
@@ -1343,28 +1407,25 @@ void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t*
     }
 
     case WStype_BIN: {
-      if (!wsUploadInProgress || !wsUploadFile) {
+      if (!wsUploadInProgress || !wsUploadWriter.isOpen()) {
         wsServer->sendTXT(num, "ERROR:No upload in progress");
         return;
       }
 
-      // Write binary data directly to file
+      // Handed to the writer task, this only waits when all its buffers are still being written
       esp_task_wdt_reset();
-      size_t written = wsUploadFile.write(payload, length);
-      esp_task_wdt_reset();
-
-      if (written != length) {
-        wsUploadFile.close();
+      if (!wsUploadWriter.write(payload, length)) {
+        wsUploadWriter.abort();
         wsUploadInProgress = false;
         wsServer->sendTXT(num, "ERROR:Write failed - disk full?");
         return;
       }
 
-      wsUploadReceived += written;
+      wsUploadReceived += length;
 
-      // Send progress update (every 64KB or at end)
+      // Acknowledge every WS_PROGRESS_INTERVAL bytes and at the end
       static size_t lastProgressSent = 0;
-      if (wsUploadReceived - lastProgressSent >= 65536 || wsUploadReceived >= wsUploadSize) {
+      if (wsUploadReceived - lastProgressSent >= WS_PROGRESS_INTERVAL || wsUploadReceived >= wsUploadSize) {
         String progress = "PROGRESS:" + String(wsUploadReceived) + ":" + String(wsUploadSize);
         wsServer->sendTXT(num, progress);
         lastProgressSent = wsUploadReceived;
@@ -1372,8 +1433,14 @@ void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t*
 
       // Check if upload complete
       if (wsUploadReceived >= wsUploadSize) {
-        wsUploadFile.close();
+        esp_task_wdt_reset();
+        const bool written = wsUploadWriter.finish();
         wsUploadInProgress = false;
+        lastProgressSent = 0;
+        if (!written) {
+          wsServer->sendTXT(num, "ERROR:Write failed - disk full?");
+          return;
+        }
 
         wsLastCompleteName = wsUploadFileName;
         wsLastCompleteSize = wsUploadSize;
@@ -1382,14 +1449,16 @@ void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t*
         unsigned long elapsed = millis() - wsUploadStartTime;
         float kbps = (elapsed > 0) ? (wsUploadSize / 1024.0) / (elapsed / 1000.0) : 0;
 
-        Serial.printf("[%lu] [WS] Upload complete: %s (%d bytes in %lu ms, %.1f KB/s)\n", millis(),
-                      wsUploadFileName.c_str(), wsUploadSize, elapsed, kbps);
+        Serial.printf("[%lu] [WS] Upload complete: %s (%d bytes in %lu ms, %.1f KB/s, waited %lu ms for the SD card)\n",
+                      millis(), wsUploadFileName.c_str(), wsUploadSize, elapsed, kbps, wsUploadWriter.waitedMs());
 
         // Clear epub cache to prevent stale metadata issues when overwriting files
         String filePath = wsUploadPath;
         if (!filePath.endsWith("/")) filePath += "/";
         filePath += wsUploadFileName;
         clearEpubCacheIfNeeded(filePath);
+        invalidateLibraryFolder(filePath);
+        BOOK_PREPARER.enqueue(filePath.c_str());
 
         wsServer->sendTXT(num, "DONE");
         lastProgressSent = 0;
@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 
+#include "UploadWriter.h"
+
 // Structure to hold file information
 struct FileInfo {
   String name;
@@ -31,24 +33,13 @@ class CrossPointWebServer {
 
   // Used by POST upload handler
   struct UploadState {
-    FsFile file;
+    // Buffers only while an upload is running
+    UploadWriter writer;
     String fileName;
     String path = "/";
     size_t size = 0;
     bool success = false;
     String error = "";
-
-    // Upload write buffer - batches small writes into larger SD card operations
-    // 4KB is a good balance: large enough to reduce syscall overhead, small enough
-    // to keep individual write times short and avoid watchdog issues
-    static constexpr size_t UPLOAD_BUFFER_SIZE = 4096;  // 4KB buffer
-    std::vector<uint8_t> buffer;
-    size_t bufferPos = 0;
-
-    // Lazy-allocate buffer on first upload to save ~4KB when idle
-    void ensureBuffer() {
-      if (buffer.empty()) buffer.resize(UPLOAD_BUFFER_SIZE);
-    }
   } upload;
 
   CrossPointWebServer();
@@ -68,6 +59,9 @@ class CrossPointWebServer {
 
   WsUploadStatus getWsUploadStatus() const;
 
+  // Time since a client was last connected or an upload was running
+  unsigned long idleMs() const { return millis() - lastActivityTime; }
+
   // Get the port number
   uint16_t getPort() const { return port; }
 
@@ -80,13 +74,14 @@ class CrossPointWebServer {
   uint16_t wsPort = 81;  // WebSocket port
   WiFiUDP udp;
   bool udpActive = false;
+  unsigned long lastActivityTime = 0;
 
   // WebSocket upload state
   void onWebSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
   static void wsEventCallback(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
 
-  // File scanning
-  void scanFiles(const char* path, const std::function<void(FileInfo)>& callback) const;
+  // File scanning, in directory order. The callback returns false to stop.
+  void scanFiles(const char* path, const std::function<bool(const FileInfo&)>& callback) const;
   String formatFileSize(size_t bytes) const;
   bool isEpubFile(const String& filename) const;
 
@@ -0,0 +1,463 @@
+#include "DirectoryIndex.h"
+
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <esp_task_wdt.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr uint8_t INDEX_FILE_VERSION = 2;
+constexpr char INDEX_DIR[] = "/.crosspoint/web";
+constexpr size_t SORT_KEY_LENGTH = 19;
+// Records each merge input and the output buffer hold
+constexpr size_t MERGE_BUFFER_RECORDS = 16;
+constexpr uint8_t FLAG_DIRECTORY = 0x01;
+constexpr uint8_t FLAG_EPUB = 0x02;
+constexpr size_t MAX_NAME_LENGTH = 256;
+
+using SortKey = DirectoryIndex::SortKey;
+
+struct IndexHeader {
+  uint8_t version;
+  uint8_t sortKey;
+  uint16_t reserved;
+  uint32_t dirMtime;
+  uint32_t count;
+  uint32_t folders;
+  uint64_t totalBytes;
+};
+static_assert(sizeof(IndexHeader) == 24, "IndexHeader layout is part of the file format");
+
+struct IndexRecord {
+  uint32_t position;  // Directory position before the entry, for seekSet() + openNext()
+  uint32_t nameHash;
+  uint32_t size;
+  uint8_t flags;
+  char key[SORT_KEY_LENGTH];  // Lower-cased start of the name, NUL padded
+};
+static_assert(sizeof(IndexRecord) == 32, "IndexRecord layout is part of the file format");
+
+uint32_t getModifyStamp(FsFile& file) {
+  uint16_t date = 0;
+  uint16_t time = 0;
+  if (!file.getModifyDateTime(&date, &time)) {
+    return 0;
+  }
+  return (static_cast<uint32_t>(date) << 16) | time;
+}
+
+uint32_t hashName(const char* name) { return static_cast<uint32_t>(std::hash<std::string>{}(name)); }
+
+std::string indexPath(const std::string& dirPath, const SortKey key) {
+  return std::string(INDEX_DIR) + "/" + std::to_string(static_cast<uint32_t>(std::hash<std::string>{}(dirPath))) +
+         (key == SortKey::SIZE ? ".size" : ".name");
+}
+
+bool hasEpubExtension(const char* name) {
+  const size_t length = strlen(name);
+  return length >= 5 && strcasecmp(name + length - 5, ".epub") == 0;
+}
+
+uint8_t group(const IndexRecord& record, const SortKey key) {
+  if (record.flags & FLAG_DIRECTORY) {
+    return 0;
+  }
+  return key == SortKey::NAME && !(record.flags & FLAG_EPUB) ? 2 : 1;
+}
+
+// Order by group, size and sort key, 0 if the records are tied on all three
+int compareRecords(const IndexRecord& a, const IndexRecord& b, const SortKey key) {
+  const uint8_t groupA = group(a, key);
+  const uint8_t groupB = group(b, key);
+  if (groupA != groupB) {
+    return groupA < groupB ? -1 : 1;
+  }
+  if (key == SortKey::SIZE && a.size != b.size && !(a.flags & FLAG_DIRECTORY)) {
+    return a.size > b.size ? -1 : 1;
+  }
+  return memcmp(a.key, b.key, SORT_KEY_LENGTH);
+}
+
+// A name longer than the sort key, records tied with it are ordered by their full names
+bool keyTruncated(const IndexRecord& record) { return record.key[SORT_KEY_LENGTH - 1] != '\0'; }
+
+// Lower-cased byte order, the order of the sort keys carried on to the whole name
+int compareNames(const std::string& a, const std::string& b) {
+  for (size_t i = 0;; i++) {
+    const int charA = i < a.size() ? tolower(static_cast<unsigned char>(a[i])) : 0;
+    const int charB = i < b.size() ? tolower(static_cast<unsigned char>(b[i])) : 0;
+    if (charA != charB || charA == 0) {
+      return charA - charB;
+    }
+  }
+}
+
+// Name of the entry at `position`, leaves `dir` where it was
+std::string readName(FsFile& dir, const uint32_t position) {
+  const uint32_t resume = static_cast<uint32_t>(dir.curPosition());
+  char name[MAX_NAME_LENGTH] = "";
+  FsFile file;
+  if (dir.seekSet(position) && file.openNext(&dir, O_RDONLY)) {
+    file.getName(name, sizeof(name));
+    file.close();
+  }
+  dir.seekSet(resume);
+  return name;
+}
+
+// Reads `count` records from `offset` on, a buffer at a time
+class RunReader {
+ public:
+  explicit RunReader(FsFile& file) : file(file), buffer(MERGE_BUFFER_RECORDS) {}
+
+  void reset(const uint32_t firstRecord, const uint32_t count) {
+    next = firstRecord;
+    remaining = count;
+    index = filled = 0;
+  }
+
+  // Current record, nullptr at the end of the run or on a read error
+  const IndexRecord* peek() {
+    if (index == filled) {
+      if (remaining == 0) {
+        return nullptr;
+      }
+      const size_t wanted = std::min<size_t>(remaining, buffer.size());
+      if (!file.seekSet(static_cast<uint64_t>(next) * sizeof(IndexRecord))) {
+        return nullptr;
+      }
+      const int bytes = file.read(buffer.data(), wanted * sizeof(IndexRecord));
+      if (bytes != static_cast<int>(wanted * sizeof(IndexRecord))) {
+        return nullptr;
+      }
+      next += wanted;
+      remaining -= wanted;
+      index = 0;
+      filled = wanted;
+    }
+    return &buffer[index];
+  }
+
+  void pop() {
+    index++;
+    name.clear();
+  }
+
+  // Full name of the current record, read from the directory the first time it is needed
+  const std::string& currentName(FsFile& dir) {
+    if (name.empty()) {
+      name = readName(dir, buffer[index].position);
+    }
+    return name;
+  }
+
+ private:
+  FsFile& file;
+  std::vector<IndexRecord> buffer;
+  std::string name;
+  uint32_t next = 0;
+  uint32_t remaining = 0;
+  size_t index = 0;
+  size_t filled = 0;
+};
+
+class RecordWriter {
+ public:
+  explicit RecordWriter(FsFile& file) : file(file) { buffer.reserve(MERGE_BUFFER_RECORDS); }
+
+  bool add(const IndexRecord& record) {
+    buffer.push_back(record);
+    return buffer.size() < MERGE_BUFFER_RECORDS || flush();
+  }
+
+  bool flush() {
+    const size_t bytes = buffer.size() * sizeof(IndexRecord);
+    const bool ok = file.write(reinterpret_cast<const uint8_t*>(buffer.data()), bytes) == bytes;
+    buffer.clear();
+    return ok;
+  }
+
+ private:
+  FsFile& file;
+  std::vector<IndexRecord> buffer;
+};
+
+// Whether the current record of `a` goes before that of `b`, the full names settle a tie on the sort key
+bool mergesBefore(RunReader& a, const IndexRecord& recordA, RunReader& b, const IndexRecord& recordB, FsFile& dir,
+                  const SortKey key) {
+  int order = compareRecords(recordA, recordB, key);
+  if (order == 0 && keyTruncated(recordA)) {
+    order = compareNames(a.currentName(dir), b.currentName(dir));
+  }
+  return order != 0 ? order < 0 : recordA.position < recordB.position;
+}
+
+// Merges the sorted runs of `runLength` records in `sourcePath` pairwise into `dest`
+bool mergePass(const std::string& sourcePath, FsFile& dest, FsFile& dir, const uint32_t count,
+               const uint32_t runLength, const SortKey key) {
+  FsFile fileA;
+  FsFile fileB;
+  if (!Storage.openFileForRead("DIX", sourcePath, fileA) || !Storage.openFileForRead("DIX", sourcePath, fileB)) {
+    return false;
+  }
+  RunReader a(fileA);
+  RunReader b(fileB);
+  RecordWriter out(dest);
+  bool ok = true;
+  for (uint32_t start = 0; start < count && ok; start += 2 * runLength) {
+    const uint32_t countA = std::min(runLength, count - start);
+    a.reset(start, countA);
+    b.reset(start + countA, std::min(runLength, count - start - countA));
+    const IndexRecord* recordA = a.peek();
+    const IndexRecord* recordB = b.peek();
+    while (ok && (recordA || recordB)) {
+      if (recordA && (!recordB || !mergesBefore(b, *recordB, a, *recordA, dir, key))) {
+        ok = out.add(*recordA);
+        a.pop();
+        recordA = a.peek();
+      } else {
+        ok = out.add(*recordB);
+        b.pop();
+        recordB = b.peek();
+      }
+    }
+    yield();
+    esp_task_wdt_reset();
+  }
+  return out.flush() && ok;
+}
+
+bool writeRun(FsFile& file, std::vector<IndexRecord>& records, FsFile& dir, const SortKey key) {
+  std::sort(records.begin(), records.end(), [key](const IndexRecord& a, const IndexRecord& b) {
+    const int order = compareRecords(a, b, key);
+    return order != 0 ? order < 0 : a.position < b.position;
+  });
+  // Records tied on a sort key their names don't fit into are put in order by the full names
+  for (size_t start = 0; start < records.size();) {
+    size_t end = start + 1;
+    while (end < records.size() && compareRecords(records[start], records[end], key) == 0) {
+      end++;
+    }
+    if (end - start > 1 && keyTruncated(records[start])) {
+      std::vector<std::pair<std::string, IndexRecord>> tied;
+      tied.reserve(end - start);
+      for (size_t i = start; i < end; i++) {
+        tied.emplace_back(readName(dir, records[i].position), records[i]);
+      }
+      std::sort(tied.begin(), tied.end(), [](const auto& a, const auto& b) {
+        const int order = compareNames(a.first, b.first);
+        return order != 0 ? order < 0 : a.second.position < b.second.position;
+      });
+      for (size_t i = start; i < end; i++) {
+        records[i] = tied[i - start].second;
+      }
+    }
+    start = end;
+  }
+  const size_t bytes = records.size() * sizeof(IndexRecord);
+  const bool ok = file.write(reinterpret_cast<const uint8_t*>(records.data()), bytes) == bytes;
+  records.clear();
+  return ok;
+}
+
+bool buildIndex(const std::string& dirPath, const SortKey key, const DirectoryIndex::HiddenPredicate isHidden,
+                const std::string& path) {
+  FsFile dir = Storage.open(dirPath.c_str());
+  if (!dir || !dir.isDirectory()) {
+    return false;
+  }
+  const unsigned long startTime = millis();
+  Storage.mkdir(INDEX_DIR);
+  IndexHeader header = {};
+  header.version = INDEX_FILE_VERSION;
+  header.sortKey = static_cast<uint8_t>(key);
+  header.dirMtime = getModifyStamp(dir);
+
+  // Sorted runs of RUN_RECORDS go to the first scratch file, merge passes alternate between the two
+  std::string scratch[2] = {path + ".a", path + ".b"};
+  FsFile runs;
+  if (!Storage.openFileForWrite("DIX", scratch[0], runs)) {
+    return false;
+  }
+  std::vector<IndexRecord> records;
+  records.reserve(DirectoryIndex::RUN_RECORDS);
+  bool ok = true;
+  char name[MAX_NAME_LENGTH];
+  while (ok) {
+    const uint32_t position = static_cast<uint32_t>(dir.curPosition());
+    FsFile file;
+    if (!file.openNext(&dir, O_RDONLY)) {
+      break;
+    }
+    file.getName(name, sizeof(name));
+    if (!isHidden(name)) {
+      IndexRecord record = {};
+      record.position = position;
+      record.nameHash = hashName(name);
+      if (file.isDirectory()) {
+        record.flags = FLAG_DIRECTORY;
+        header.folders++;
+      } else {
+        record.size = static_cast<uint32_t>(file.fileSize());
+        record.flags = hasEpubExtension(name) ? FLAG_EPUB : 0;
+        header.totalBytes += record.size;
+      }
+      for (size_t i = 0; i < SORT_KEY_LENGTH && name[i] != '\0'; i++) {
+        record.key[i] = static_cast<char>(tolower(static_cast<unsigned char>(name[i])));
+      }
+      records.push_back(record);
+      header.count++;
+      if (records.size() == DirectoryIndex::RUN_RECORDS) {
+        ok = writeRun(runs, records, dir, key);
+      }
+    }
+    file.close();
+    yield();
+    esp_task_wdt_reset();
+  }
+
+  FsFile index;
+  ok = ok && Storage.openFileForWrite("DIX", path, index) &&
+       index.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header);
+  if (ok && header.count <= DirectoryIndex::RUN_RECORDS) {
+    // A single run goes straight into the index
+    runs.close();
+    ok = writeRun(index, records, dir, key);
+  } else if (ok) {
+    ok = records.empty() || writeRun(runs, records, dir, key);
+    runs.close();
+    int source = 0;
+    for (uint32_t runLength = DirectoryIndex::RUN_RECORDS; ok && runLength < header.count; runLength *= 2) {
+      // The last pass, the one that leaves a single run, writes the index
+      const bool lastPass = runLength * 2 >= header.count;
+      FsFile dest;
+      if (lastPass) {
+        ok = mergePass(scratch[source], index, dir, header.count, runLength, key);
+      } else {
+        ok = Storage.openFileForWrite("DIX", scratch[1 - source], dest) &&
+             mergePass(scratch[source], dest, dir, header.count, runLength, key);
+        dest.close();
+        source = 1 - source;
+      }
+    }
+  }
+  dir.close();
+  runs.close();
+  index.close();
+  Storage.remove(scratch[0].c_str());
+  Storage.remove(scratch[1].c_str());
+  if (!ok) {
+    Serial.printf("[%lu] [DIX] Failed to write index for %s\n", millis(), dirPath.c_str());
+    Storage.remove(path.c_str());
+    return false;
+  }
+  Serial.printf("[%lu] [DIX] Indexed %u entries of %s in %lu ms\n", millis(), header.count, dirPath.c_str(),
+                millis() - startTime);
+  return true;
+}
+
+// Opens an index that is complete and newer than the directory's last change
+bool openIndex(const std::string& path, const SortKey key, const uint32_t dirMtime, FsFile& index,
+               IndexHeader& header) {
+  if (!Storage.exists(path.c_str()) || !Storage.openFileForRead("DIX", path, index)) {
+    return false;
+  }
+  if (index.read(&header, sizeof(header)) != sizeof(header) || header.version != INDEX_FILE_VERSION ||
+      header.sortKey != static_cast<uint8_t>(key) || header.dirMtime != dirMtime ||
+      index.fileSize() != sizeof(header) + static_cast<uint64_t>(header.count) * sizeof(IndexRecord)) {
+    index.close();
+    return false;
+  }
+  return true;
+}
+
+std::string parentDirectory(const std::string& path) {
+  const auto lastSlash = path.find_last_of('/');
+  if (lastSlash == std::string::npos || lastSlash == 0) {
+    return "/";
+  }
+  return path.substr(0, lastSlash);
+}
+}  // namespace
+
+bool DirectoryIndex::parseSortKey(const char* name, SortKey& key) {
+  if (strcmp(name, "name") == 0) {
+    key = SortKey::NAME;
+  } else if (strcmp(name, "size") == 0) {
+    key = SortKey::SIZE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool DirectoryIndex::forEachSorted(const std::string& dirPath, const SortKey key, const uint32_t offset,
+                                   const uint32_t limit, const HiddenPredicate isHidden, const Visitor& visit,
+                                   Summary& summary) {
+  FsFile dir = Storage.open(dirPath.c_str());
+  if (!dir || !dir.isDirectory()) {
+    return false;
+  }
+  const std::string path = indexPath(dirPath, key);
+  const uint32_t dirMtime = getModifyStamp(dir);
+  FsFile index;
+  IndexHeader header = {};
+  if (!openIndex(path, key, dirMtime, index, header) &&
+      (!buildIndex(dirPath, key, isHidden, path) || !openIndex(path, key, dirMtime, index, header))) {
+    return false;
+  }
+  summary.count = header.count;
+  summary.folders = header.folders;
+  summary.totalBytes = header.totalBytes;
+  if (offset >= header.count) {
+    return true;
+  }
+
+  index.seekSet(sizeof(IndexHeader) + static_cast<uint64_t>(offset) * sizeof(IndexRecord));
+  const uint32_t end = offset + std::min(limit, header.count - offset);
+  bool stale = false;
+  char name[MAX_NAME_LENGTH];
+  for (uint32_t i = offset; i < end; i++) {
+    IndexRecord record;
+    if (index.read(&record, sizeof(record)) != sizeof(record)) {
+      stale = true;
+      break;
+    }
+    FsFile file;
+    if (!dir.seekSet(record.position) || !file.openNext(&dir, O_RDONLY)) {
+      stale = true;
+      continue;
+    }
+    file.getName(name, sizeof(name));
+    if (hashName(name) != record.nameHash) {
+      stale = true;
+      continue;
+    }
+    const Entry entry = {name, file.isDirectory() ? 0 : static_cast<uint32_t>(file.fileSize()), file.isDirectory()};
+    file.close();
+    if (!visit(entry)) {
+      break;
+    }
+  }
+  index.close();
+  if (stale) {
+    Serial.printf("[%lu] [DIX] Index of %s is out of date\n", millis(), dirPath.c_str());
+    Storage.remove(path.c_str());
+  }
+  return true;
+}
+
+void DirectoryIndex::invalidateParentOf(const std::string& path) {
+  const std::string dirPath = parentDirectory(path);
+  Storage.remove(indexPath(dirPath, SortKey::NAME).c_str());
+  Storage.remove(indexPath(dirPath, SortKey::SIZE).c_str());
+}
+
+void DirectoryIndex::clear() {
+  if (Storage.exists(INDEX_DIR)) {
+    Storage.removeDir(INDEX_DIR);
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * Sorted listings of SD card directories for the web file manager, handed out a page at a time.
+ *
+ * The first sorted request for a directory writes an index to /.crosspoint/web/: a 32-byte record per entry holding
+ * its position in the directory, a hash of its name, its size and the start of its name as sort key. The records
+ * are sorted on the card, runs of RUN_RECORDS in memory and then merged pairwise, so memory use is the same for ten
+ * entries or ten thousand. Names that share the whole sort key, like a common author or series prefix, are put in
+ * order by reopening their entries for the full names. A page reads its records and reopens only those entries by
+ * position.
+ *
+ * Indexes are dropped when the web server starts and when it changes a directory. A record whose entry no longer
+ * has the recorded name is skipped and the index is rebuilt on the next request.
+ */
+class DirectoryIndex {
+ public:
+  static constexpr size_t RUN_RECORDS = 128;
+
+  enum class SortKey : uint8_t {
+    NAME = 0,  // Folders, EPUBs, other files, each by name
+    SIZE,      // Folders by name, then files largest first
+  };
+
+  struct Entry {
+    const char* name;
+    uint32_t size;  // 0 for folders
+    bool isDirectory;
+  };
+
+  struct Summary {
+    uint32_t count = 0;  // Listed entries, folders included
+    uint32_t folders = 0;
+    uint64_t totalBytes = 0;
+  };
+
+  // True for entries that are not listed
+  using HiddenPredicate = bool (*)(const char* name);
+  // Return false to stop
+  using Visitor = std::function<bool(const Entry& entry)>;
+
+  // "name" or "size"
+  static bool parseSortKey(const char* name, SortKey& key);
+
+  /**
+   * Visit the entries `offset` to `offset + limit - 1` of `dirPath` in `key` order, building the index first if
+   * there is none or the directory's modification time changed.
+   * @param summary Set to the totals of the whole directory
+   * @return false if `dirPath` is not a directory or the index can't be written
+   */
+  static bool forEachSorted(const std::string& dirPath, SortKey key, uint32_t offset, uint32_t limit,
+                            HiddenPredicate isHidden, const Visitor& visit, Summary& summary);
+
+  // Drop the indexes of the directory holding `path`
+  static void invalidateParentOf(const std::string& path);
+  // Drop all indexes
+  static void clear();
+};
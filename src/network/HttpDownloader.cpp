@@ -2,83 +2,126 @@
 
 #include <HTTPClient.h>
 #include <HardwareSerial.h>
+#include <Serialization.h>
 #include <StreamString.h>
 #include <WiFiClient.h>
 #include <WiFiClientSecure.h>
 #include <base64.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <vector>
 
+#include "AsyncFileWriter.h"
 #include "CrossPointSettings.h"
 #include "util/UrlUtils.h"
 
-bool HttpDownloader::fetchUrl(const std::string& url, Stream& outContent) {
-  // Use WiFiClientSecure for HTTPS, regular WiFiClient for HTTP
-  std::unique_ptr<WiFiClient> client;
-  if (UrlUtils::isHttpsUrl(url)) {
-    auto* secureClient = new WiFiClientSecure();
-    secureClient->setInsecure();
-    client.reset(secureClient);
-  } else {
-    client.reset(new WiFiClient());
+namespace {
+constexpr size_t DOWNLOAD_CHUNK_SIZE = 2048;
+constexpr int MAX_ATTEMPTS = 3;
+constexpr unsigned long RETRY_DELAY_MS = 1000;
+// A connection that delivers nothing for this long counts as dropped
+constexpr unsigned long STALL_TIMEOUT_MS = 10000;
+// The sidecar is brought up to date after this many bytes, a resumed download repeats at most that much
+constexpr uint32_t CHECKPOINT_BYTES = 64 * 1024;
+
+constexpr uint8_t PART_INFO_VERSION = 1;
+constexpr size_t MAX_PART_INFO_SIZE = 4096;
+
+// Sidecar of a part file: u8 version, u32 written, u32 total, then the URL and the validator as NUL-terminated strings
+struct PartInfo {
+  std::string url;
+  std::string validator;  // ETag, or Last-Modified if there is no strong ETag; sent as If-Range
+  uint32_t written = 0;   // Bytes at the start of the part file known to be on the card
+  uint32_t total = 0;     // Size of the whole file, 0 if the server didn't say
+};
+
+bool readPartInfo(const std::string& path, PartInfo& info) {
+  FsFile file;
+  if (!Storage.openFileForRead("HTTP", path, file)) {
+    return false;
   }
-  HTTPClient http;
-
-  Serial.printf("[%lu] [HTTP] Fetching: %s\n", millis(), url.c_str());
-
-  http.begin(*client, url.c_str());
-  http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-  http.addHeader("User-Agent", "CrossPoint-ESP32-" CROSSPOINT_VERSION);
-
-  // Add Basic HTTP auth if credentials are configured
-  if (strlen(SETTINGS.opdsUsername) > 0 && strlen(SETTINGS.opdsPassword) > 0) {
-    std::string credentials = std::string(SETTINGS.opdsUsername) + ":" + SETTINGS.opdsPassword;
-    String encoded = base64::encode(credentials.c_str());
-    http.addHeader("Authorization", "Basic " + encoded);
+  const size_t size = file.fileSize();
+  if (size > MAX_PART_INFO_SIZE) {
+    file.close();
+    return false;
   }
-
-  const int httpCode = http.GET();
-  if (httpCode != HTTP_CODE_OK) {
-    Serial.printf("[%lu] [HTTP] Fetch failed: %d\n", millis(), httpCode);
-    http.end();
+  std::vector<uint8_t> data(size);
+  const bool read = file.read(data.data(), size) == static_cast<int>(size);
+  file.close();
+  if (!read) {
     return false;
   }
 
-  http.writeToStream(&outContent);
+  serialization::BufferReader reader(data.data(), data.size());
+  uint8_t version = 0;
+  serialization::readPod(reader, version);
+  serialization::readPod(reader, info.written);
+  serialization::readPod(reader, info.total);
+  const char* url = reader.ok ? serialization::readCString(reader) : nullptr;
+  const char* validator = reader.ok ? serialization::readCString(reader) : nullptr;
+  if (!reader.ok || version != PART_INFO_VERSION) {
+    return false;
+  }
+  info.url = url;
+  info.validator = validator;
+  return true;
+}
 
-  http.end();
+bool writePartInfo(const std::string& path, const PartInfo& info) {
+  FsFile file;
+  if (!Storage.openFileForWrite("HTTP", path, file)) {
+    return false;
+  }
+  serialization::writePod(file, PART_INFO_VERSION);
+  serialization::writePod(file, info.written);
+  serialization::writePod(file, info.total);
+  file.write(reinterpret_cast<const uint8_t*>(info.url.c_str()), info.url.size() + 1);
+  const size_t validatorSize = info.validator.size() + 1;
+  const bool written =
+      file.write(reinterpret_cast<const uint8_t*>(info.validator.c_str()), validatorSize) == validatorSize;
+  file.close();
+  return written;
+}
 
-  Serial.printf("[%lu] [HTTP] Fetch success\n", millis());
-  return true;
+void removePart(const std::string& partPath, const std::string& infoPath) {
+  Storage.remove(partPath.c_str());
+  Storage.remove(infoPath.c_str());
 }
 
-bool HttpDownloader::fetchUrl(const std::string& url, std::string& outContent) {
-  StreamString stream;
-  if (!fetchUrl(url, stream)) {
+// "bytes <first>-<last>/<total>", total may be "*" (left at 0)
+bool parseContentRange(const String& value, uint32_t& first, uint32_t& total) {
+  const char* text = value.c_str();
+  if (strncmp(text, "bytes ", 6) != 0) {
     return false;
   }
-  outContent = stream.c_str();
+  char* end = nullptr;
+  first = strtoul(text + 6, &end, 10);
+  if (*end != '-') {
+    return false;
+  }
+  strtoul(end + 1, &end, 10);
+  if (*end != '/') {
+    return false;
+  }
+  total = end[1] == '*' ? 0 : strtoul(end + 1, nullptr, 10);
   return true;
 }
 
-HttpDownloader::DownloadError HttpDownloader::downloadToFile(const std::string& url, const std::string& destPath,
-                                                             ProgressCallback progress) {
-  // Use WiFiClientSecure for HTTPS, regular WiFiClient for HTTP
-  std::unique_ptr<WiFiClient> client;
+// Use WiFiClientSecure for HTTPS, regular WiFiClient for HTTP
+std::unique_ptr<WiFiClient> createClient(const std::string& url) {
   if (UrlUtils::isHttpsUrl(url)) {
     auto* secureClient = new WiFiClientSecure();
     secureClient->setInsecure();
-    client.reset(secureClient);
-  } else {
-    client.reset(new WiFiClient());
+    return std::unique_ptr<WiFiClient>(secureClient);
   }
-  HTTPClient http;
-
-  Serial.printf("[%lu] [HTTP] Downloading: %s\n", millis(), url.c_str());
-  Serial.printf("[%lu] [HTTP] Destination: %s\n", millis(), destPath.c_str());
+  return std::unique_ptr<WiFiClient>(new WiFiClient());
+}
 
-  http.begin(*client, url.c_str());
+void beginRequest(HTTPClient& http, WiFiClient& client, const std::string& url) {
+  http.begin(client, url.c_str());
   http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
   http.addHeader("User-Agent", "CrossPoint-ESP32-" CROSSPOINT_VERSION);
 
@@ -88,86 +131,305 @@ HttpDownloader::DownloadError HttpDownloader::downloadToFile(const std::string&
     String encoded = base64::encode(credentials.c_str());
     http.addHeader("Authorization", "Basic " + encoded);
   }
+}
+
+// One request for the rest of the file. `dropped` is set when another attempt may get further: the connection broke
+// off or the part file turned out to be unusable and was reset.
+HttpDownloader::DownloadError downloadAttempt(const std::string& url, const std::string& partPath,
+                                              const std::string& infoPath, PartInfo& info,
+                                              const HttpDownloader::ProgressCallback& progress, bool& dropped) {
+  dropped = false;
+  auto client = createClient(url);
+  HTTPClient http;
+  beginRequest(http, *client, url);
+  // The raw stream is read below, HTTP/1.0 keeps servers from sending it chunked
+  http.useHTTP10(true);
+  const char* headerKeys[] = {"ETag", "Last-Modified", "Content-Range"};
+  http.collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
+  if (info.written > 0) {
+    Serial.printf("[%lu] [HTTP] Resuming at %u of %u bytes\n", millis(), info.written, info.total);
+    http.addHeader("Range", ("bytes=" + std::to_string(info.written) + "-").c_str());
+    if (!info.validator.empty()) {
+      http.addHeader("If-Range", info.validator.c_str());
+    }
+  }
 
   const int httpCode = http.GET();
-  if (httpCode != HTTP_CODE_OK) {
+  uint32_t offset = 0;
+  uint32_t total = 0;
+  if (httpCode == HTTP_CODE_PARTIAL_CONTENT && info.written > 0) {
+    uint32_t first = 0;
+    // Without a validator the total size is all there is to tell the same file from a changed one
+    if (!parseContentRange(http.header("Content-Range"), first, total) || first != info.written ||
+        (info.total > 0 && total != info.total)) {
+      Serial.printf("[%lu] [HTTP] Unexpected range %s, starting over\n", millis(),
+                    http.header("Content-Range").c_str());
+      http.end();
+      info.written = 0;
+      dropped = true;
+      return HttpDownloader::HTTP_ERROR;
+    }
+    offset = info.written;
+  } else if (httpCode == HTTP_CODE_OK) {
+    // Also the answer to a Range request when the file changed since the part was written
+    const int size = http.getSize();
+    total = size > 0 ? size : 0;
+    const String etag = http.header("ETag");
+    // If-Range needs a strong validator
+    info.validator = etag.length() > 0 && strncmp(etag.c_str(), "W/", 2) != 0 ? etag.c_str()
+                                                                                : http.header("Last-Modified").c_str();
+  } else {
     Serial.printf("[%lu] [HTTP] Download failed: %d\n", millis(), httpCode);
     http.end();
-    return HTTP_ERROR;
+    if (httpCode == HTTP_CODE_RANGE_NOT_SATISFIABLE && info.written > 0) {
+      info.written = 0;
+      dropped = true;
+    } else {
+      // Negative codes are connection errors
+      dropped = httpCode < 0;
+    }
+    return HttpDownloader::HTTP_ERROR;
   }
+  Serial.printf("[%lu] [HTTP] Receiving from %u, total %u\n", millis(), offset, total);
 
-  const size_t contentLength = http.getSize();
-  Serial.printf("[%lu] [HTTP] Content-Length: %zu\n", millis(), contentLength);
-
-  // Remove existing file if present
-  if (Storage.exists(destPath.c_str())) {
-    Storage.remove(destPath.c_str());
+  FsFile file = Storage.open(partPath.c_str(), O_RDWR | O_CREAT);
+  if (!file || !file.truncate(offset) || !file.seekSet(offset)) {
+    Serial.printf("[%lu] [HTTP] Failed to open %s for writing\n", millis(), partPath.c_str());
+    http.end();
+    return HttpDownloader::FILE_ERROR;
   }
 
-  // Open file for writing
-  FsFile file;
-  if (!Storage.openFileForWrite("HTTP", destPath.c_str(), file)) {
-    Serial.printf("[%lu] [HTTP] Failed to open file for writing\n", millis());
+  info.written = offset;
+  info.total = total;
+  if (!writePartInfo(infoPath, info)) {
+    Serial.printf("[%lu] [HTTP] Failed to write %s\n", millis(), infoPath.c_str());
+    file.close();
     http.end();
-    return FILE_ERROR;
+    return HttpDownloader::FILE_ERROR;
   }
 
   // Get the stream for chunked reading
   WiFiClient* stream = http.getStreamPtr();
-  if (!stream) {
-    Serial.printf("[%lu] [HTTP] Failed to get stream\n", millis());
+  AsyncFileWriter writer(file);
+  if (!stream || !writer.begin()) {
     file.close();
-    Storage.remove(destPath.c_str());
     http.end();
-    return HTTP_ERROR;
+    return stream ? HttpDownloader::FILE_ERROR : HttpDownloader::HTTP_ERROR;
   }
 
-  // Download in chunks
-  uint8_t buffer[DOWNLOAD_CHUNK_SIZE];
-  size_t downloaded = 0;
-  const size_t total = contentLength > 0 ? contentLength : 0;
+  if (progress && total > 0) {
+    progress(offset, total);
+  }
 
-  while (http.connected() && (contentLength == 0 || downloaded < contentLength)) {
+  // Reading goes on while the writer task has the card busy with the previous buffer
+  uint8_t buffer[DOWNLOAD_CHUNK_SIZE];
+  uint32_t received = offset;
+  uint32_t checkpoint = offset;
+  unsigned long lastDataTime = millis();
+  bool writeFailed = false;
+  while (total == 0 || received < total) {
     const size_t available = stream->available();
     if (available == 0) {
+      if (!http.connected()) {
+        break;
+      }
+      if (millis() - lastDataTime > STALL_TIMEOUT_MS) {
+        Serial.printf("[%lu] [HTTP] No data for %lu ms\n", millis(), STALL_TIMEOUT_MS);
+        break;
+      }
       delay(1);
       continue;
     }
 
-    const size_t toRead = available < DOWNLOAD_CHUNK_SIZE ? available : DOWNLOAD_CHUNK_SIZE;
-    const size_t bytesRead = stream->readBytes(buffer, toRead);
-
+    const size_t bytesRead = stream->readBytes(buffer, std::min(available, DOWNLOAD_CHUNK_SIZE));
     if (bytesRead == 0) {
       break;
     }
+    lastDataTime = millis();
 
-    const size_t written = file.write(buffer, bytesRead);
-    if (written != bytesRead) {
-      Serial.printf("[%lu] [HTTP] Write failed: wrote %zu of %zu bytes\n", millis(), written, bytesRead);
-      file.close();
-      Storage.remove(destPath.c_str());
-      http.end();
-      return FILE_ERROR;
+    if (total > 0 && received + bytesRead > total) {
+      Serial.printf("[%lu] [HTTP] Server sent more than %u bytes\n", millis(), total);
+      break;
+    }
+    if (!writer.write(buffer, bytesRead)) {
+      writeFailed = true;
+      break;
+    }
+    received += bytesRead;
+
+    if (received - checkpoint >= CHECKPOINT_BYTES) {
+      if (!writer.flush()) {
+        writeFailed = true;
+        break;
+      }
+      info.written = checkpoint = received;
+      writePartInfo(infoPath, info);
     }
-
-    downloaded += bytesRead;
 
     if (progress && total > 0) {
-      progress(downloaded, total);
+      progress(received, total);
     }
   }
 
-  file.close();
+  writeFailed = !writer.end() || writeFailed;
   http.end();
+  if (writeFailed) {
+    // What was written before the last checkpoint can still be used
+    Serial.printf("[%lu] [HTTP] Write failed at %u bytes\n", millis(), received);
+    file.close();
+    return HttpDownloader::FILE_ERROR;
+  }
+  info.written = received;
+  writePartInfo(infoPath, info);
 
-  Serial.printf("[%lu] [HTTP] Downloaded %zu bytes\n", millis(), downloaded);
+  Serial.printf("[%lu] [HTTP] Received %u bytes\n", millis(), received - offset);
+
+  if (total > 0 && received < total) {
+    file.close();
+    dropped = true;
+    return HttpDownloader::HTTP_ERROR;
+  }
 
   // Verify download size if known
-  if (contentLength > 0 && downloaded != contentLength) {
-    Serial.printf("[%lu] [HTTP] Size mismatch: got %zu, expected %zu\n", millis(), downloaded, contentLength);
+  const uint64_t fileSize = file.fileSize();
+  file.close();
+  if (fileSize != received || (total > 0 && fileSize != total)) {
+    Serial.printf("[%lu] [HTTP] Size mismatch: got %u, expected %u\n", millis(), static_cast<uint32_t>(fileSize),
+                  total);
+    removePart(partPath, infoPath);
+    return HttpDownloader::HTTP_ERROR;
+  }
+  return HttpDownloader::OK;
+}
+
+}  // namespace
+
+bool HttpDownloader::fetchUrl(const std::string& url, Stream& outContent) {
+  auto client = createClient(url);
+  HTTPClient http;
+
+  Serial.printf("[%lu] [HTTP] Fetching: %s\n", millis(), url.c_str());
+
+  beginRequest(http, *client, url);
+
+  const int httpCode = http.GET();
+  if (httpCode != HTTP_CODE_OK) {
+    Serial.printf("[%lu] [HTTP] Fetch failed: %d\n", millis(), httpCode);
+    http.end();
+    return false;
+  }
+
+  http.writeToStream(&outContent);
+
+  http.end();
+
+  Serial.printf("[%lu] [HTTP] Fetch success\n", millis());
+  return true;
+}
+
+HttpDownloader::FetchResult HttpDownloader::fetchIfModified(const std::string& url, Stream& outContent,
+                                                           Validators& validators) {
+  auto client = createClient(url);
+  HTTPClient http;
+
+  Serial.printf("[%lu] [HTTP] Fetching: %s\n", millis(), url.c_str());
+
+  beginRequest(http, *client, url);
+  const char* headerKeys[] = {"ETag", "Last-Modified"};
+  http.collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
+  if (!validators.etag.empty()) {
+    http.addHeader("If-None-Match", validators.etag.c_str());
+  }
+  if (!validators.lastModified.empty()) {
+    http.addHeader("If-Modified-Since", validators.lastModified.c_str());
+  }
+
+  const int httpCode = http.GET();
+  if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+    http.end();
+    Serial.printf("[%lu] [HTTP] Not modified\n", millis());
+    return NOT_MODIFIED;
+  }
+  if (httpCode != HTTP_CODE_OK) {
+    Serial.printf("[%lu] [HTTP] Fetch failed: %d\n", millis(), httpCode);
+    http.end();
+    return FETCH_FAILED;
+  }
+
+  validators.etag = http.header("ETag").c_str();
+  validators.lastModified = http.header("Last-Modified").c_str();
+  const int written = http.writeToStream(&outContent);
+  http.end();
+
+  if (written < 0) {
+    Serial.printf("[%lu] [HTTP] Fetch cut short: %d\n", millis(), written);
+    return FETCH_FAILED;
+  }
+  Serial.printf("[%lu] [HTTP] Fetch success\n", millis());
+  return FETCHED;
+}
+
+bool HttpDownloader::fetchUrl(const std::string& url, std::string& outContent) {
+  StreamString stream;
+  if (!fetchUrl(url, stream)) {
+    return false;
+  }
+  outContent = stream.c_str();
+  return true;
+}
+
+HttpDownloader::DownloadError HttpDownloader::downloadToFile(const std::string& url, const std::string& destPath,
+                                                             ProgressCallback progress) {
+  const std::string partPath = destPath + ".part";
+  const std::string infoPath = partPath + ".info";
+
+  Serial.printf("[%lu] [HTTP] Downloading: %s\n", millis(), url.c_str());
+  Serial.printf("[%lu] [HTTP] Destination: %s\n", millis(), destPath.c_str());
+
+  // Continue a part file left by an earlier download of the same URL, as far as it is on the card
+  PartInfo info;
+  FsFile part;
+  uint64_t partSize = 0;
+  if (readPartInfo(infoPath, info) && info.url == url && Storage.openFileForRead("HTTP", partPath, part)) {
+    partSize = part.fileSize();
+    part.close();
+  }
+  if (info.url != url || partSize < info.written) {
+    info = PartInfo{};
+    info.url = url;
+  }
+  // Complete already if the rename was all that was missing
+  const bool complete = info.total > 0 && info.written == info.total && partSize == info.total;
+
+  DownloadError result = OK;
+  if (!complete) {
+    bool dropped = false;
+    for (int attempt = 1; attempt <= MAX_ATTEMPTS; attempt++) {
+      result = downloadAttempt(url, partPath, infoPath, info, progress, dropped);
+      if (!dropped || attempt == MAX_ATTEMPTS) {
+        break;
+      }
+      Serial.printf("[%lu] [HTTP] Connection lost, attempt %d of %d\n", millis(), attempt + 1, MAX_ATTEMPTS);
+      delay(RETRY_DELAY_MS);
+    }
+  }
+  if (result != OK) {
+    return result;
+  }
+
+  // Replace an existing file only now that the new one is complete
+  if (Storage.exists(destPath.c_str())) {
     Storage.remove(destPath.c_str());
-    return HTTP_ERROR;
   }
+  FsFile file = Storage.open(partPath.c_str(), O_RDWR);
+  const bool renamed = file && file.rename(destPath.c_str());
+  file.close();
+  if (!renamed) {
+    Serial.printf("[%lu] [HTTP] Failed to move %s to %s\n", millis(), partPath.c_str(), destPath.c_str());
+    return FILE_ERROR;
+  }
+  Storage.remove(infoPath.c_str());
 
+  Serial.printf("[%lu] [HTTP] Downloaded %u bytes\n", millis(), info.written);
   return OK;
 }
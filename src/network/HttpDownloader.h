@@ -19,6 +19,18 @@ class HttpDownloader {
     ABORTED,
   };
 
+  enum FetchResult {
+    FETCHED = 0,
+    NOT_MODIFIED,
+    FETCH_FAILED,  // Possibly after part of the body was written
+  };
+
+  // What a response says about the version of the resource it carries
+  struct Validators {
+    std::string etag;
+    std::string lastModified;
+  };
+
   /**
    * Fetch text content from a URL.
    * @param url The URL to fetch
@@ -29,16 +41,26 @@ class HttpDownloader {
 
   static bool fetchUrl(const std::string& url, Stream& stream);
 
+  /**
+   * Fetch content from a URL unless it is unchanged since a copy at hand was fetched.
+   * Sends If-None-Match and If-Modified-Since for the copy's validators; nothing is written to `stream` when the
+   * server answers 304 Not Modified.
+   * @param validators In: those of the copy at hand, may be empty. Out: those of a fetched response.
+   * @return FETCH_FAILED also when the connection broke off before the whole body arrived
+   */
+  static FetchResult fetchIfModified(const std::string& url, Stream& stream, Validators& validators);
+
   /**
    * Download a file to the SD card.
+   * The data goes to `<destPath>.part`, which is renamed once its size matches what the server announced. A
+   * download that breaks off leaves the part file behind with a sidecar (`<destPath>.part.info`: URL, ETag or
+   * Last-Modified and the bytes on the card), and downloading the same URL to the same path again continues it with
+   * a Range request. Dropped connections are retried a few times before giving up.
    * @param url The URL to download
    * @param destPath The destination path on SD card
-   * @param progress Optional progress callback
+   * @param progress Optional progress callback, first called with what a resumed download starts from
    * @return DownloadError indicating success or failure type
    */
   static DownloadError downloadToFile(const std::string& url, const std::string& destPath,
                                       ProgressCallback progress = nullptr);
-
- private:
-  static constexpr size_t DOWNLOAD_CHUNK_SIZE = 1024;
 };
@@ -0,0 +1,334 @@
+#include "OpdsFeedCache.h"
+
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "HttpDownloader.h"
+
+namespace {
+constexpr uint8_t INDEX_FILE_VERSION = 1;
+constexpr char FEEDS_DIR[] = "/.crosspoint/opds/feeds";
+constexpr char INDEX_FILE[] = "/.crosspoint/opds/feeds.idx";
+constexpr size_t READ_CHUNK_SIZE = 1024;
+
+std::string feedPath(const std::string& url) {
+  return std::string(FEEDS_DIR) + "/" + std::to_string(static_cast<uint32_t>(std::hash<std::string>{}(url))) + ".xml";
+}
+
+// Holds the card for as long as it exists
+class CardGuard {
+ public:
+  explicit CardGuard(const OpdsFeedCache::CardLock& lock) : lock(lock) {
+    if (lock) lock(true);
+  }
+  ~CardGuard() {
+    if (lock) lock(false);
+  }
+  CardGuard(const CardGuard&) = delete;
+  CardGuard& operator=(const CardGuard&) = delete;
+
+ private:
+  const OpdsFeedCache::CardLock& lock;
+};
+
+// Passes a download on to `out` and copies it into the cache file
+class CachingStream final : public Stream {
+ public:
+  CachingStream(Print& out, FsFile& file, const bool caching, const OpdsFeedCache::CardLock& cardLock)
+      : out(out), file(file), fileFailed(!caching), cardLock(cardLock) {}
+
+  int available() override { return 0; }
+  int peek() override { return -1; }
+  int read() override { return -1; }
+
+  size_t write(const uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, const size_t size) override {
+    if (!fileFailed) {
+      CardGuard guard(cardLock);
+      fileFailed = file.write(buffer, size) != size;
+    }
+    written += size;
+    return out.write(buffer, size);
+  }
+
+  Print& out;
+  FsFile& file;
+  bool fileFailed;
+  const OpdsFeedCache::CardLock& cardLock;
+  uint32_t written = 0;
+};
+}  // namespace
+
+void OpdsFeedCache::load() {
+  loaded = true;
+  feeds.clear();
+  CardGuard guard(cardLock);
+
+  FsFile file;
+  if (!Storage.exists(INDEX_FILE) || !Storage.openFileForRead("OPDS", INDEX_FILE, file)) {
+    return;
+  }
+
+  uint8_t version = 0;
+  uint8_t count = 0;
+  serialization::readPod(file, version);
+  serialization::readPod(file, clock);
+  serialization::readPod(file, count);
+  if (version != INDEX_FILE_VERSION) {
+    Serial.printf("[%lu] [OPDS] Unknown feed cache version %u, cleared\n", millis(), version);
+    file.close();
+    Storage.removeDir(FEEDS_DIR);
+    Storage.remove(INDEX_FILE);
+    clock = 0;
+    return;
+  }
+
+  for (uint8_t i = 0; i < count && i < MAX_FEEDS && file.available(); i++) {
+    Feed feed;
+    serialization::readString(file, feed.url);
+    serialization::readString(file, feed.etag);
+    serialization::readString(file, feed.lastModified);
+    serialization::readPod(file, feed.size);
+    serialization::readPod(file, feed.lastUsed);
+    if (feed.url.empty()) {
+      break;
+    }
+    feeds.push_back(std::move(feed));
+  }
+  file.close();
+  Serial.printf("[%lu] [OPDS] %u feeds cached, %u bytes\n", millis(), static_cast<unsigned>(feeds.size()),
+                totalBytes());
+}
+
+bool OpdsFeedCache::save() const {
+  CardGuard guard(cardLock);
+  if (feeds.empty()) {
+    if (Storage.exists(INDEX_FILE)) {
+      Storage.remove(INDEX_FILE);
+    }
+    return true;
+  }
+
+  FsFile file;
+  if (!Storage.openFileForWrite("OPDS", INDEX_FILE, file)) {
+    return false;
+  }
+  serialization::writePod(file, INDEX_FILE_VERSION);
+  serialization::writePod(file, clock);
+  serialization::writePod(file, static_cast<uint8_t>(feeds.size()));
+  for (const auto& feed : feeds) {
+    serialization::writeString(file, feed.url);
+    serialization::writeString(file, feed.etag);
+    serialization::writeString(file, feed.lastModified);
+    serialization::writePod(file, feed.size);
+    serialization::writePod(file, feed.lastUsed);
+  }
+  if (!file.close()) {
+    Serial.printf("[%lu] [OPDS] Failed to write feed cache index\n", millis());
+    return false;
+  }
+  return true;
+}
+
+uint32_t OpdsFeedCache::totalBytes() const {
+  uint32_t total = 0;
+  for (const auto& feed : feeds) {
+    total += feed.size;
+  }
+  return total;
+}
+
+OpdsFeedCache::Feed* OpdsFeedCache::find(const std::string& url) {
+  const auto it = std::find_if(feeds.begin(), feeds.end(), [&url](const Feed& feed) { return feed.url == url; });
+  return it != feeds.end() ? &*it : nullptr;
+}
+
+void OpdsFeedCache::remove(const std::string& url) {
+  const auto it = std::find_if(feeds.begin(), feeds.end(), [&url](const Feed& feed) { return feed.url == url; });
+  if (it != feeds.end()) {
+    CardGuard guard(cardLock);
+    Storage.remove(feedPath(url).c_str());
+    feeds.erase(it);
+  }
+}
+
+void OpdsFeedCache::evict(const std::string& keep) {
+  while (feeds.size() > MAX_FEEDS || totalBytes() > MAX_BYTES) {
+    const Feed* oldest = nullptr;
+    for (const auto& feed : feeds) {
+      if (feed.url != keep && (!oldest || feed.lastUsed < oldest->lastUsed)) {
+        oldest = &feed;
+      }
+    }
+    if (!oldest) {
+      return;
+    }
+    Serial.printf("[%lu] [OPDS] Dropping cached feed %s\n", millis(), oldest->url.c_str());
+    remove(std::string(oldest->url));
+  }
+}
+
+bool OpdsFeedCache::readFeed(const Feed& feed, Print& out) const {
+  FsFile file;
+  {
+    CardGuard guard(cardLock);
+    if (!Storage.openFileForRead("OPDS", feedPath(feed.url), file)) {
+      return false;
+    }
+  }
+  uint8_t buffer[READ_CHUNK_SIZE];
+  uint32_t remaining = feed.size;
+  while (remaining > 0) {
+    int count;
+    {
+      CardGuard guard(cardLock);
+      count = file.read(buffer, std::min<uint32_t>(remaining, sizeof(buffer)));
+    }
+    if (count <= 0) {
+      break;
+    }
+    out.write(buffer, count);
+    remaining -= count;
+  }
+  CardGuard guard(cardLock);
+  file.close();
+  return remaining == 0;
+}
+
+OpdsFeedCache::Result OpdsFeedCache::fetch(const std::string& url, Print& out, const bool offline) {
+  if (!loaded) {
+    load();
+  }
+
+  // Served from the card, or dropped if its file is gone. A file that breaks off partway has written to `out`.
+  const auto serve = [this, &url, &out](Feed& feed) {
+    bool exists;
+    {
+      CardGuard guard(cardLock);
+      exists = Storage.exists(feedPath(url).c_str());
+    }
+    if (!exists) {
+      remove(url);
+      save();
+      return Result::NOT_CACHED;
+    }
+    const bool read = readFeed(feed, out);
+    feed.lastUsed = ++clock;
+    if (!read) {
+      Serial.printf("[%lu] [OPDS] Failed to read cached feed %s\n", millis(), url.c_str());
+      remove(url);
+    }
+    save();
+    return read ? Result::CACHED : Result::FAILED;
+  };
+
+  Feed* feed = find(url);
+  if (feed) {
+    const bool fresh = feed->validatedAt != 0 && millis() - feed->validatedAt < freshMs;
+    if (offline || fresh) {
+      Serial.printf("[%lu] [OPDS] Using cached feed %s (%s)\n", millis(), url.c_str(), offline ? "offline" : "fresh");
+      const Result served = serve(*feed);
+      if (served != Result::NOT_CACHED) {
+        return served;
+      }
+      feed = nullptr;
+    }
+  }
+  if (offline) {
+    Serial.printf("[%lu] [OPDS] Not cached for offline use: %s\n", millis(), url.c_str());
+    return Result::NOT_CACHED;
+  }
+
+  HttpDownloader::Validators validators;
+  if (feed) {
+    validators.etag = feed->etag;
+    validators.lastModified = feed->lastModified;
+  }
+  const std::string path = feedPath(url);
+  const std::string tmpPath = path + ".tmp";
+  FsFile file;
+  bool caching;
+  {
+    CardGuard guard(cardLock);
+    Storage.mkdir(FEEDS_DIR);
+    caching = Storage.openFileForWrite("OPDS", tmpPath, file);
+  }
+  CachingStream stream(out, file, caching, cardLock);
+  const auto result = HttpDownloader::fetchIfModified(url, stream, validators);
+  {
+    CardGuard guard(cardLock);
+    if (file.isOpen()) {
+      file.close();
+    }
+    if (result != HttpDownloader::FETCHED || stream.fileFailed) {
+      Storage.remove(tmpPath.c_str());
+    }
+  }
+
+  if (result == HttpDownloader::NOT_MODIFIED) {
+    if (feed) {
+      feed->validatedAt = millis();
+      const Result served = serve(*feed);
+      if (served != Result::NOT_CACHED) {
+        return served == Result::CACHED ? Result::NOT_MODIFIED : served;
+      }
+      // The copy it was revalidated for is gone, ask for the whole feed
+      return fetch(url, out, offline);
+    }
+    return Result::FAILED;
+  }
+
+  if (result == HttpDownloader::FETCH_FAILED) {
+    if (feed && stream.written == 0) {
+      Serial.printf("[%lu] [OPDS] Server unavailable, using cached feed %s\n", millis(), url.c_str());
+      return serve(*feed);
+    }
+    return Result::FAILED;
+  }
+
+  // A copy that couldn't be written is not kept, and the one it replaces is out of date
+  if (stream.fileFailed) {
+    Serial.printf("[%lu] [OPDS] Failed to cache feed %s\n", millis(), url.c_str());
+    remove(url);
+    save();
+    return Result::DOWNLOADED;
+  }
+  // A URL with the same hash shares the file
+  const auto sharesFile = [&url, &path](const Feed& other) { return other.url != url && feedPath(other.url) == path; };
+  feeds.erase(std::remove_if(feeds.begin(), feeds.end(), sharesFile), feeds.end());
+  {
+    CardGuard guard(cardLock);
+    if (Storage.exists(path.c_str())) {
+      Storage.remove(path.c_str());
+    }
+    Storage.rename(tmpPath.c_str(), path.c_str());
+  }
+
+  feed = find(url);
+  if (!feed) {
+    feeds.push_back(Feed{});
+    feed = &feeds.back();
+    feed->url = url;
+  }
+  feed->etag = validators.etag;
+  feed->lastModified = validators.lastModified;
+  feed->size = stream.written;
+  feed->lastUsed = ++clock;
+  feed->validatedAt = millis();
+  evict(url);
+  save();
+  return Result::DOWNLOADED;
+}
+
+void OpdsFeedCache::clear() {
+  CardGuard guard(cardLock);
+  Storage.removeDir(FEEDS_DIR);
+  Storage.remove(INDEX_FILE);
+  feeds.clear();
+  clock = 0;
+  loaded = true;
+}
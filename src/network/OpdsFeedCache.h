@@ -0,0 +1,77 @@
+#pragma once
+#include <Print.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * OPDS feed responses kept on the SD card, so catalogues seen before open without downloading them again.
+ *
+ * A feed is stored in /.crosspoint/opds/feeds/<hash>.xml, <hash> being the hash of its URL, and listed in
+ * /.crosspoint/opds/feeds.idx with its URL, ETag, Last-Modified, size and when it was last used. A cached feed is
+ * revalidated with If-None-Match / If-Modified-Since and read from the card when the server answers 304. Feeds
+ * revalidated less than `freshMs` ago are read from the card without asking the server, which makes going back up a
+ * level immediate. Offline, or when the server can't be reached, cached feeds are served as they are. The least
+ * recently used feeds are dropped to stay within MAX_FEEDS and MAX_BYTES.
+ *
+ * The index is loaded by the first fetch() and kept in memory for the lifetime of the instance. Every access to the
+ * card goes through the lock set with setCardLock(), which is never held while writing to the output.
+ */
+class OpdsFeedCache {
+ public:
+  static constexpr size_t MAX_FEEDS = 32;
+  static constexpr uint32_t MAX_BYTES = 2 * 1024 * 1024;
+  static constexpr unsigned long FRESH_MS = 5 * 60 * 1000;
+
+  enum class Result : uint8_t {
+    DOWNLOADED,    // Fetched from the server and cached
+    NOT_MODIFIED,  // The server answered 304, read from the card
+    CACHED,        // Read from the card without the server: fresh, offline or the server couldn't be reached
+    NOT_CACHED,    // Offline and not in the cache, nothing written
+    FAILED,        // The server couldn't be reached and it isn't cached, or the download broke off partway
+  };
+
+  // Called with true before and false after each access to the SD card
+  using CardLock = std::function<void(bool locked)>;
+
+  explicit OpdsFeedCache(unsigned long freshMs = FRESH_MS) : freshMs(freshMs) {}
+
+  // For sharing the card with another task, e.g. a display task reading fonts from it
+  void setCardLock(CardLock lock) { cardLock = std::move(lock); }
+
+  // Write the feed at `url` to `out`, from the server or the card as described above
+  Result fetch(const std::string& url, Print& out, bool offline);
+
+  // Remove every cached feed
+  void clear();
+
+  size_t size() const { return feeds.size(); }
+  uint32_t totalBytes() const;
+
+ private:
+  struct Feed {
+    std::string url;
+    std::string etag;
+    std::string lastModified;
+    uint32_t size = 0;
+    uint32_t lastUsed = 0;          // Value of `clock` when it was last served
+    unsigned long validatedAt = 0;  // millis() of the last answer from the server, 0 if none since loading
+  };
+
+  const unsigned long freshMs;
+  CardLock cardLock;
+  std::vector<Feed> feeds;
+  uint32_t clock = 0;
+  bool loaded = false;
+
+  void load();
+  bool save() const;
+  Feed* find(const std::string& url);
+  void remove(const std::string& url);
+  // Drop least recently used feeds until the cache fits, never `keep`
+  void evict(const std::string& keep);
+  bool readFeed(const Feed& feed, Print& out) const;
+};
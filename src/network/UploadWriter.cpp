@@ -0,0 +1,90 @@
+#include "UploadWriter.h"
+
+#include <HardwareSerial.h>
+
+bool UploadWriter::begin(const char* moduleName, const std::string& path, const size_t expectedSize) {
+  abort();
+
+  if (Storage.exists(path.c_str())) {
+    Serial.printf("[%lu] [UPW] Overwriting existing file: %s\n", millis(), path.c_str());
+    Storage.remove(path.c_str());
+  }
+  if (!Storage.openFileForWrite(moduleName, path, file)) {
+    return false;
+  }
+  this->path = path;
+  receivedBytes = 0;
+  syncWriteMs = 0;
+  failed = false;
+
+  // Contiguous clusters up front; without them (fragmented card, exFAT quirks) the file just grows as usual
+  if (expectedSize > 0 && !file.preAllocate(expectedSize)) {
+    Serial.printf("[%lu] [UPW] Could not preallocate %u bytes, writing without\n", millis(), expectedSize);
+  }
+
+  writer.reset(new AsyncFileWriter(file, BUFFER_SIZE, BUFFER_COUNT));
+  if (!writer->begin()) {
+    writer.reset(new AsyncFileWriter(file));
+    if (!writer->begin()) {
+      Serial.printf("[%lu] [UPW] No memory for write buffers, writing synchronously\n", millis());
+      writer.reset();
+    }
+  }
+  return true;
+}
+
+bool UploadWriter::write(const uint8_t* data, const size_t size) {
+  if (!file || failed) {
+    return false;
+  }
+  if (writer) {
+    failed = !writer->write(data, size);
+  } else {
+    const unsigned long writeStart = millis();
+    failed = file.write(data, size) != size;
+    syncWriteMs += millis() - writeStart;
+  }
+  if (!failed) {
+    receivedBytes += size;
+  }
+  return !failed;
+}
+
+bool UploadWriter::finish() {
+  if (!file) {
+    return false;
+  }
+  if (writer && !writer->end()) {
+    failed = true;
+  }
+  // Frees preallocated clusters the upload didn't fill
+  if (!failed && !file.truncate(receivedBytes)) {
+    failed = true;
+  }
+  if (failed) {
+    abort();
+    return false;
+  }
+  close();
+  return true;
+}
+
+void UploadWriter::abort() {
+  if (!file) {
+    writer.reset();
+    return;
+  }
+  close();
+  Storage.remove(path.c_str());
+  Serial.printf("[%lu] [UPW] Removed incomplete upload: %s\n", millis(), path.c_str());
+}
+
+unsigned long UploadWriter::waitedMs() const { return writer ? writer->waitedMs() : syncWriteMs; }
+
+void UploadWriter::close() {
+  if (writer) {
+    writer->end();
+  }
+  file.close();
+  // Kept for waitedMs() until the next begin()
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "AsyncFileWriter.h"
+
+/**
+ * Receives a web upload into a file on the SD card. Data goes through an AsyncFileWriter with BUFFER_COUNT buffers of
+ * BUFFER_SIZE, so the network keeps being read while the card writes, with smaller buffers or plain writes when the
+ * heap is short. When the size is announced the file is preallocated, so the card doesn't extend the cluster chain
+ * write by write.
+ */
+class UploadWriter {
+ public:
+  static constexpr size_t BUFFER_SIZE = 8192;
+  static constexpr uint8_t BUFFER_COUNT = 3;
+
+  UploadWriter() = default;
+  ~UploadWriter() { abort(); }
+  UploadWriter(const UploadWriter&) = delete;
+  UploadWriter& operator=(const UploadWriter&) = delete;
+
+  // Creates `path`, replacing an existing file. `expectedSize` is reserved on the card when not 0.
+  bool begin(const char* moduleName, const std::string& path, size_t expectedSize);
+
+  // False once data failed to reach the card
+  bool write(const uint8_t* data, size_t size);
+
+  // Writes out the rest, gives back reserved space past the data and closes the file. If anything failed the file is
+  // removed and the result is false.
+  bool finish();
+
+  // Closes and removes the file
+  void abort();
+
+  bool isOpen() const { return file.isOpen(); }
+  size_t received() const { return receivedBytes; }
+  // Time write() waited for the card, the rest of the upload was spent on the network
+  unsigned long waitedMs() const;
+
+ private:
+  FsFile file;
+  std::unique_ptr<AsyncFileWriter> writer;
+  std::string path;
+  size_t receivedBytes = 0;
+  unsigned long syncWriteMs = 0;
+  bool failed = false;
+
+  void close();
+};
@@ -0,0 +1,200 @@
+#include <Epub.h>
+#include <Epub/Section.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "BookPreparer.h"
+#include "HostTool.h"
+
+// Prepares a generated EPUB on a card directory through BookPreparer and checks that the reader finds what it needs
+// on first open: book.bin, the thumbnail step passed without a cover image, and the text reference chapter laid out
+// for the reader's orientation while the screen keeps its own. Also checked: a queue cut short continues after a
+// "reboot" (a new instance reading prepare.queue), a step interrupted twice is skipped, a layout stopped for input
+// starts over later without counting against the book, a second upload of the same file starts over, and nothing is
+// queued with the setting off or for other files.
+
+namespace {
+
+constexpr char BOOK[] = "/Books/sample.epub";
+constexpr char QUEUE_FILE[] = "/.crosspoint/prepare.queue";
+
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "  FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+std::string cachePath() { return Epub(BOOK, "/.crosspoint").getCachePath(); }
+
+void clearCache() {
+  Storage.removeDir(cachePath().c_str());
+  Storage.remove(QUEUE_FILE);
+}
+
+// Runs steps until there is nothing left, returns how many did something
+int runAll(BookPreparer& preparer, GfxRenderer& renderer) {
+  int steps = 0;
+  while (steps < 100 && preparer.runStep(renderer)) {
+    steps++;
+  }
+  return steps;
+}
+
+// The chapter the reader opens the book at, with the layout it would ask for
+bool firstSectionReady(GfxRenderer& renderer) {
+  const auto screenOrientation = renderer.getOrientation();
+  EpubReaderLayout::applyReaderOrientation(renderer, SETTINGS.orientation);
+  const HostTool::Profile profile = HostTool::readerProfile(renderer);
+  renderer.setOrientation(screenOrientation);
+
+  auto epub = std::make_shared<Epub>(BOOK, "/.crosspoint");
+  if (!epub->load(false)) {
+    return false;
+  }
+  Section section(epub, epub->getSpineIndexForTextReference(), renderer);
+  return section.loadSectionFile(profile.fontId, profile.lineCompression, profile.extraParagraphSpacing,
+                                 profile.paragraphAlignment, profile.viewportWidth, profile.viewportHeight,
+                                 profile.hyphenationEnabled, profile.firstLineIndent, profile.embeddedStyle);
+}
+
+void testPrepare(GfxRenderer& renderer) {
+  std::cout << "uploaded book prepared" << std::endl;
+  clearCache();
+  BookPreparer preparer;
+  preparer.enqueue("/Books/notes.txt");
+  check(!Storage.exists(QUEUE_FILE), "other files not queued");
+  preparer.enqueue(BOOK);
+  check(Storage.exists(QUEUE_FILE), "queue written on upload");
+
+  check(runAll(preparer, renderer) == 4, "four steps");
+  check(!preparer.hasPendingWork(), "nothing left");
+  check(!Storage.exists(QUEUE_FILE), "queue file removed when empty");
+  check(Storage.exists((cachePath() + "/book.bin").c_str()), "book.bin built");
+  // The guide's text reference is the second spine item
+  check(Storage.exists((cachePath() + "/sections/1.bin").c_str()), "text reference chapter laid out");
+  check(!Storage.exists((cachePath() + "/sections/0.bin").c_str()), "no other chapter laid out");
+  check(renderer.getOrientation() == GfxRenderer::Orientation::Portrait, "screen orientation restored");
+  check(firstSectionReady(renderer), "reader finds the chapter for its settings");
+}
+
+void testResume(GfxRenderer& renderer) {
+  std::cout << "queue continues after a reboot" << std::endl;
+  clearCache();
+  {
+    BookPreparer before;
+    before.enqueue(BOOK);
+    check(before.runStep(renderer), "metadata step runs");
+  }
+  BookPreparer after;
+  check(after.hasPendingWork(), "queue found after reboot");
+  // Loading the queue, then thumbnail, cover and section
+  check(runAll(after, renderer) == 4, "continues after the metadata step");
+  check(firstSectionReady(renderer), "book prepared");
+}
+
+void testInterruptedStep(GfxRenderer& renderer) {
+  std::cout << "step interrupted twice" << std::endl;
+  clearCache();
+  {
+    // Left by a device that went down twice in the metadata step
+    Storage.mkdir("/.crosspoint");
+    FsFile file;
+    Storage.openFileForWrite("TEST", QUEUE_FILE, file);
+    const uint8_t header[] = {1, 1};
+    file.write(header, sizeof(header));
+    const uint32_t length = strlen(BOOK);
+    file.write(reinterpret_cast<const uint8_t*>(&length), sizeof(length));
+    file.write(reinterpret_cast<const uint8_t*>(BOOK), length);
+    const uint8_t progress[] = {BookPreparer::STEP_METADATA, BookPreparer::MAX_ATTEMPTS};
+    file.write(progress, sizeof(progress));
+    file.close();
+  }
+  BookPreparer preparer;
+  runAll(preparer, renderer);
+  check(!preparer.hasPendingWork(), "book dropped");
+  check(!Storage.exists((cachePath() + "/book.bin").c_str()), "step not run again");
+}
+
+void testStoppedForInput(GfxRenderer& renderer) {
+  std::cout << "layout stopped for input" << std::endl;
+  clearCache();
+  BookPreparer preparer;
+  preparer.enqueue(BOOK);
+  for (int i = 0; i < 3; i++) {
+    preparer.runStep(renderer);
+  }
+  // More times than a step may be interrupted, each a few chunks into the chapter
+  for (uint8_t i = 0; i <= BookPreparer::MAX_ATTEMPTS; i++) {
+    int checks = 0;
+    check(preparer.runStep(renderer, [&checks] { return ++checks > 3; }), "step stopped");
+    check(checks > 3, "stopped by the check");
+  }
+  check(preparer.hasPendingWork(), "book still queued");
+  check(!Storage.exists((cachePath() + "/sections/1.bin").c_str()), "no partial section file");
+  check(runAll(preparer, renderer) == 1, "laid out once left alone");
+  check(firstSectionReady(renderer), "book prepared");
+}
+
+void testUploadAgain(GfxRenderer& renderer) {
+  std::cout << "same file uploaded again" << std::endl;
+  clearCache();
+  BookPreparer preparer;
+  preparer.enqueue(BOOK);
+  preparer.runStep(renderer);
+  preparer.runStep(renderer);
+  preparer.enqueue(BOOK);
+  check(runAll(preparer, renderer) == 4, "starts over");
+}
+
+void testSettingOff(GfxRenderer& renderer) {
+  std::cout << "setting off" << std::endl;
+  clearCache();
+  SETTINGS.prepareUploads = 0;
+  BookPreparer preparer;
+  preparer.enqueue(BOOK);
+  check(!Storage.exists(QUEUE_FILE), "nothing queued");
+  check(!preparer.hasPendingWork(), "nothing to do");
+  SETTINGS.prepareUploads = 1;
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: BookPreparerTest <card dir> [--verbose]\n");
+    return 2;
+  }
+  Serial.quiet = !(argc > 2 && strcmp(argv[2], "--verbose") == 0);
+  Storage.setRoot(argv[1]);
+
+  HostTool::loadReaderSettings({});
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  HostTool::setUpReaderRenderer(renderer);
+  // Reader in landscape, the screen running the preparation in portrait
+  SETTINGS.orientation = CrossPointSettings::ORIENTATION::LANDSCAPE_CW;
+  renderer.setOrientation(GfxRenderer::Orientation::Portrait);
+
+  testPrepare(renderer);
+  testResume(renderer);
+  testInterruptedStep(renderer);
+  testStoppedForInput(renderer);
+  testUploadAgain(renderer);
+  testSettingOff(renderer);
+
+  if (failures > 0) {
+    std::cout << failures << " failed checks" << std::endl;
+    return 1;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return 0;
+}
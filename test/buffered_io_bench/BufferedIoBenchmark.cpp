@@ -0,0 +1,475 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lib/Epub/Epub/Page.h"
+
+// Counts the SD transactions (FsFile read and write calls) of the cache files written and read field by field,
+// once straight through FsFile as before and once through BufferedFile. Section pages are written with the real
+// Page::serialize() and compared byte for byte against a field-by-field copy of the same format, the other files use
+// the same writer for both. A randomized run of mixed reads, writes and seeks checks BufferedFile against FsFile.
+
+namespace {
+
+const char* kDirectPath = "build/buffered_io_bench/direct.bin";
+const char* kBufferedPath = "build/buffered_io_bench/buffered.bin";
+const char* kReferencePath = "build/buffered_io_bench/reference.bin";
+
+struct Counts {
+  size_t writes = 0;
+  size_t reads = 0;
+};
+
+struct Workload {
+  const char* name;
+  Counts direct;
+  Counts buffered;
+};
+
+bool sameContents(const char* a, const char* b) {
+  std::ifstream fa(a, std::ios::binary);
+  std::ifstream fb(b, std::ios::binary);
+  const std::string ca((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+  const std::string cb((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+  return !ca.empty() && ca == cb;
+}
+
+// ---- Section file (Section::createSectionFile / loadSectionFile) ----
+
+struct GeneratedLine {
+  std::list<std::string> words;
+  std::list<uint16_t> xpos;
+  std::list<EpdFontFamily::Style> styles;
+};
+
+std::vector<std::vector<GeneratedLine>> generatePages(const int pageCount) {
+  static const char* vocabulary[] = {"the",     "reader",  "turned", "another", "page",     "of",   "a",
+                                     "chapter", "written", "long",   "ago",     "quietly",  "and",  "with",
+                                     "care",    "while",   "rain",   "fell",    "outside,", "soft", "grey."};
+  std::vector<std::vector<GeneratedLine>> pages;
+  uint32_t state = 12345;
+  for (int p = 0; p < pageCount; p++) {
+    std::vector<GeneratedLine> page;
+    for (int l = 0; l < 28; l++) {
+      GeneratedLine line;
+      int x = 0;
+      while (true) {
+        state = state * 1664525u + 1013904223u;
+        const std::string word = vocabulary[(state >> 16) % (sizeof(vocabulary) / sizeof(vocabulary[0]))];
+        const int width = static_cast<int>(word.size()) * 8;
+        if (x + width > 440) {
+          break;
+        }
+        line.words.push_back(word);
+        line.xpos.push_back(static_cast<uint16_t>(x));
+        line.styles.push_back((state >> 24) % 13 == 0 ? EpdFontFamily::ITALIC : EpdFontFamily::REGULAR);
+        x += width + 5;
+      }
+      page.push_back(std::move(line));
+    }
+    pages.push_back(std::move(page));
+  }
+  return pages;
+}
+
+template <typename File>
+void writeSectionHeader(File& file) {
+  serialization::writePod(file, static_cast<uint8_t>(17));
+  serialization::writePod(file, static_cast<int>(1818));
+  serialization::writePod(file, 1.0f);
+  serialization::writePod(file, true);
+  serialization::writePod(file, static_cast<uint8_t>(0));
+  serialization::writePod(file, static_cast<uint16_t>(464));
+  serialization::writePod(file, static_cast<uint16_t>(760));
+  serialization::writePod(file, true);
+  serialization::writePod(file, false);
+  serialization::writePod(file, true);
+  serialization::writePod(file, static_cast<uint16_t>(0));
+  serialization::writePod(file, static_cast<uint32_t>(0));
+}
+
+template <typename File>
+void writeSectionTrailer(File& file, const std::vector<std::pair<uint32_t, uint32_t>>& lut) {
+  const auto lutOffset = static_cast<uint32_t>(file.position());
+  for (const auto& entry : lut) {
+    serialization::writePod(file, entry.first);
+    serialization::writePod(file, entry.second);
+  }
+  serialization::writePod(file, static_cast<uint16_t>(lut.size()));
+  for (size_t i = 0; i < lut.size(); i++) {
+    serialization::writePod(file, static_cast<uint32_t>(i * 2654435761u));
+    serialization::writePod(file, static_cast<uint16_t>(i));
+  }
+  file.seek(23);
+  serialization::writePod(file, static_cast<uint16_t>(lut.size()));
+  serialization::writePod(file, lutOffset);
+}
+
+// Field by field copy of Page::serialize() as it goes through a bare FsFile
+void writePageDirect(FsFile& file, const std::vector<GeneratedLine>& page) {
+  serialization::writePod(file, static_cast<uint16_t>(page.size()));
+  int16_t y = 0;
+  const BlockStyle blockStyle;
+  for (const auto& line : page) {
+    serialization::writePod(file, static_cast<uint8_t>(TAG_PageLine));
+    serialization::writePod(file, static_cast<int16_t>(0));
+    serialization::writePod(file, y);
+    y = static_cast<int16_t>(y + 24);
+    serialization::writePod(file, static_cast<uint16_t>(line.words.size()));
+    for (const auto x : line.xpos) serialization::writePod(file, x);
+    for (const auto s : line.styles) serialization::writePod(file, s);
+    serialization::writePod(file, blockStyle.alignment);
+    serialization::writePod(file, blockStyle.textAlignDefined);
+    serialization::writePod(file, blockStyle.marginTop);
+    serialization::writePod(file, blockStyle.marginBottom);
+    serialization::writePod(file, blockStyle.marginLeft);
+    serialization::writePod(file, blockStyle.marginRight);
+    serialization::writePod(file, blockStyle.paddingTop);
+    serialization::writePod(file, blockStyle.paddingBottom);
+    serialization::writePod(file, blockStyle.paddingLeft);
+    serialization::writePod(file, blockStyle.paddingRight);
+    serialization::writePod(file, blockStyle.textIndent);
+    serialization::writePod(file, blockStyle.textIndentDefined);
+    for (const auto& w : line.words) {
+      file.write(reinterpret_cast<const uint8_t*>(w.c_str()), w.size() + 1);
+    }
+  }
+}
+
+void writePageBuffered(BufferedFile& file, const std::vector<GeneratedLine>& page) {
+  Page built;
+  int16_t y = 0;
+  for (const auto& line : page) {
+    auto block = std::make_shared<TextBlock>(line.words, line.xpos, line.styles);
+    built.elements.push_back(std::make_shared<PageLine>(std::move(block), 0, y));
+    y = static_cast<int16_t>(y + 24);
+  }
+  built.serialize(file);
+}
+
+template <typename File>
+void readSectionHeader(File& file) {
+  uint8_t version, alignment;
+  int fontId;
+  float compression;
+  bool spacing, hyphenation, indent, embedded;
+  uint16_t width, height, pageCount;
+  serialization::readPod(file, version);
+  serialization::readPod(file, fontId);
+  serialization::readPod(file, compression);
+  serialization::readPod(file, spacing);
+  serialization::readPod(file, alignment);
+  serialization::readPod(file, width);
+  serialization::readPod(file, height);
+  serialization::readPod(file, hyphenation);
+  serialization::readPod(file, indent);
+  serialization::readPod(file, embedded);
+  serialization::readPod(file, pageCount);
+}
+
+Workload sectionWorkload(const std::vector<std::vector<GeneratedLine>>& pages, bool& ok) {
+  Workload workload{"section file (build + open)", {}, {}};
+
+  {
+    FsFile file;
+    file.open(kDirectPath, "w+b");
+    FsFile::resetCounters();
+    writeSectionHeader(file);
+    std::vector<std::pair<uint32_t, uint32_t>> lut;
+    for (const auto& page : pages) {
+      const auto offset = static_cast<uint32_t>(file.position());
+      writePageDirect(file, page);
+      lut.emplace_back(offset, static_cast<uint32_t>(file.position()) - offset);
+    }
+    writeSectionTrailer(file, lut);
+    file.seek(0);
+    readSectionHeader(file);
+    workload.direct = {FsFile::writeCalls, FsFile::readCalls};
+  }
+
+  {
+    FsFile raw;
+    raw.open(kBufferedPath, "w+b");
+    FsFile::resetCounters();
+    {
+      BufferedFile file(raw);
+      writeSectionHeader(file);
+      std::vector<std::pair<uint32_t, uint32_t>> lut;
+      for (const auto& page : pages) {
+        const auto offset = static_cast<uint32_t>(file.position());
+        writePageBuffered(file, page);
+        lut.emplace_back(offset, static_cast<uint32_t>(file.position()) - offset);
+      }
+      writeSectionTrailer(file, lut);
+      ok = file.flush() && ok;
+    }
+    raw.seek(0);
+    BufferedFile in(raw);
+    readSectionHeader(in);
+    workload.buffered = {FsFile::writeCalls, FsFile::readCalls};
+  }
+
+  if (!sameContents(kDirectPath, kBufferedPath)) {
+    std::cerr << "section file differs between FsFile and BufferedFile\n";
+    ok = false;
+  }
+  return workload;
+}
+
+// ---- book.bin (BookMetadataCache::buildBookBin / load / getSpineEntry) ----
+
+template <typename File>
+void writeBook(File& file, const int spineCount, const int tocCount) {
+  serialization::writePod(file, static_cast<uint8_t>(5));
+  serialization::writePod(file, static_cast<uint32_t>(0));
+  serialization::writePod(file, static_cast<uint16_t>(spineCount));
+  serialization::writePod(file, static_cast<uint16_t>(tocCount));
+  serialization::writeString(file, std::string("A Rather Long Title of a Novel"));
+  serialization::writeString(file, std::string("Some Author"));
+  serialization::writeString(file, std::string("en"));
+  serialization::writeString(file, std::string("OEBPS/images/cover.jpg"));
+  serialization::writeString(file, std::string("OEBPS/text/part0001.xhtml"));
+  for (int i = 0; i < spineCount + tocCount; i++) {
+    serialization::writePod(file, static_cast<uint32_t>(i * 40));
+  }
+  for (int i = 0; i < spineCount; i++) {
+    serialization::writeString(file, "OEBPS/text/part" + std::to_string(1000 + i) + ".xhtml");
+    serialization::writePod(file, static_cast<size_t>(i * 8192));
+    serialization::writePod(file, static_cast<int16_t>(i));
+  }
+  for (int i = 0; i < tocCount; i++) {
+    serialization::writeString(file, "Chapter " + std::to_string(i + 1));
+    serialization::writeString(file, "OEBPS/text/part" + std::to_string(1000 + i) + ".xhtml");
+    serialization::writeString(file, std::string());
+    serialization::writePod(file, static_cast<uint8_t>(1));
+    serialization::writePod(file, static_cast<int16_t>(i));
+  }
+}
+
+template <typename File>
+size_t readBook(File& file, const int spineCount) {
+  uint8_t version;
+  uint32_t lutOffset;
+  uint16_t spines, tocs;
+  std::string value;
+  serialization::readPod(file, version);
+  serialization::readPod(file, lutOffset);
+  serialization::readPod(file, spines);
+  serialization::readPod(file, tocs);
+  for (int i = 0; i < 5; i++) {
+    serialization::readString(file, value);
+  }
+  file.seek(file.position() + sizeof(uint32_t) * (spines + tocs));
+  // The spine walk of the TOC pass and buildBookBin
+  size_t total = 0;
+  for (int i = 0; i < spineCount; i++) {
+    size_t cumulativeSize;
+    int16_t tocIndex;
+    serialization::readString(file, value);
+    serialization::readPod(file, cumulativeSize);
+    serialization::readPod(file, tocIndex);
+    total += value.size() + cumulativeSize + tocIndex;
+  }
+  return total;
+}
+
+Workload bookWorkload(bool& ok) {
+  Workload workload{"book.bin (build + load + spine walk)", {}, {}};
+  constexpr int kSpine = 120;
+  constexpr int kToc = 80;
+  size_t directTotal = 0;
+  size_t bufferedTotal = 0;
+
+  {
+    FsFile file;
+    file.open(kDirectPath, "w+b");
+    FsFile::resetCounters();
+    writeBook(file, kSpine, kToc);
+    file.seek(0);
+    directTotal = readBook(file, kSpine);
+    workload.direct = {FsFile::writeCalls, FsFile::readCalls};
+  }
+  {
+    FsFile raw;
+    raw.open(kBufferedPath, "w+b");
+    FsFile::resetCounters();
+    BufferedFile file(raw);
+    writeBook(file, kSpine, kToc);
+    file.seek(0);
+    bufferedTotal = readBook(file, kSpine);
+    ok = file.flush() && ok;
+    workload.buffered = {FsFile::writeCalls, FsFile::readCalls};
+  }
+
+  if (!sameContents(kDirectPath, kBufferedPath) || directTotal != bufferedTotal) {
+    std::cerr << "book.bin differs between FsFile and BufferedFile\n";
+    ok = false;
+  }
+  return workload;
+}
+
+// ---- settings.bin (CrossPointSettings::saveToFile / loadFromFile) ----
+
+template <typename File>
+void writeSettings(File& file) {
+  serialization::writePod(file, static_cast<uint8_t>(1));
+  serialization::writePod(file, static_cast<uint8_t>(34));
+  for (uint8_t i = 0; i < 31; i++) {
+    serialization::writePod(file, i);
+  }
+  serialization::writeString(file, std::string("https://example.org/opds"));
+  serialization::writeString(file, std::string("reader"));
+  serialization::writeString(file, std::string("secret"));
+}
+
+template <typename File>
+uint32_t readSettings(File& file) {
+  uint32_t sum = 0;
+  uint8_t value;
+  for (int i = 0; i < 33; i++) {
+    serialization::readPod(file, value);
+    sum += value;
+  }
+  std::string text;
+  for (int i = 0; i < 3; i++) {
+    serialization::readString(file, text);
+    sum += text.size();
+  }
+  return sum;
+}
+
+Workload settingsWorkload(bool& ok) {
+  Workload workload{"settings.bin (save + load)", {}, {}};
+  uint32_t directSum = 0;
+  uint32_t bufferedSum = 0;
+  {
+    FsFile file;
+    file.open(kDirectPath, "w+b");
+    FsFile::resetCounters();
+    writeSettings(file);
+    file.seek(0);
+    directSum = readSettings(file);
+    workload.direct = {FsFile::writeCalls, FsFile::readCalls};
+  }
+  {
+    FsFile raw;
+    raw.open(kBufferedPath, "w+b");
+    FsFile::resetCounters();
+    BufferedFile file(raw);
+    writeSettings(file);
+    file.seek(0);
+    bufferedSum = readSettings(file);
+    workload.buffered = {FsFile::writeCalls, FsFile::readCalls};
+  }
+  if (!sameContents(kDirectPath, kBufferedPath) || directSum != bufferedSum) {
+    std::cerr << "settings.bin differs between FsFile and BufferedFile\n";
+    ok = false;
+  }
+  return workload;
+}
+
+// ---- Randomized comparison against a plain FsFile ----
+
+bool randomizedCheck() {
+  FsFile reference;
+  FsFile raw;
+  if (!reference.open(kReferencePath, "w+b") || !raw.open(kBufferedPath, "w+b")) {
+    return false;
+  }
+
+  std::vector<uint8_t> seed(3000);
+  for (size_t i = 0; i < seed.size(); i++) {
+    seed[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  reference.write(seed.data(), seed.size());
+  raw.write(seed.data(), seed.size());
+  reference.seek(0);
+  raw.seek(0);
+
+  BufferedFile buffered(raw);
+  uint32_t state = 99;
+  std::vector<uint8_t> expected(2048);
+  std::vector<uint8_t> actual(2048);
+  for (int op = 0; op < 20000; op++) {
+    state = state * 1664525u + 1013904223u;
+    const size_t count = (state >> 8) % 9 == 0 ? 1 + (state >> 12) % 1500 : 1 + (state >> 12) % 24;
+    switch ((state >> 4) % 4) {
+      case 0: {
+        const uint64_t pos = (state >> 10) % (reference.size() + 1);
+        if (reference.seek(pos) != buffered.seek(pos)) {
+          std::cerr << "seek result differs at op " << op << "\n";
+          return false;
+        }
+        break;
+      }
+      case 1: {
+        for (size_t i = 0; i < count; i++) {
+          expected[i] = static_cast<uint8_t>(state >> (i % 24));
+        }
+        const size_t a = reference.write(expected.data(), count);
+        const size_t b = buffered.write(expected.data(), count);
+        if (a != b) {
+          std::cerr << "write result differs at op " << op << "\n";
+          return false;
+        }
+        break;
+      }
+      default: {
+        const int a = reference.read(expected.data(), count);
+        const int b = buffered.read(actual.data(), count);
+        if (a != b || (a > 0 && memcmp(expected.data(), actual.data(), a) != 0)) {
+          std::cerr << "read differs at op " << op << " (" << a << " vs " << b << " bytes)\n";
+          return false;
+        }
+        break;
+      }
+    }
+    if (reference.position() != buffered.position() || reference.size() != buffered.size()) {
+      std::cerr << "position or size differs at op " << op << "\n";
+      return false;
+    }
+  }
+  if (!buffered.flush()) {
+    return false;
+  }
+  reference.flush();
+  raw.flush();
+  return sameContents(kReferencePath, kBufferedPath);
+}
+
+}  // namespace
+
+int main() {
+  Serial.quiet = true;
+  bool ok = true;
+
+  const auto pages = generatePages(60);
+  const Workload workloads[] = {sectionWorkload(pages, ok), bookWorkload(ok), settingsWorkload(ok)};
+  for (const auto& w : workloads) {
+    std::cout << w.name << "\n";
+    std::cout << "  FsFile:       " << w.direct.writes << " writes, " << w.direct.reads << " reads\n";
+    std::cout << "  BufferedFile: " << w.buffered.writes << " writes, " << w.buffered.reads << " reads\n";
+  }
+
+  if (!randomizedCheck()) {
+    std::cerr << "BufferedFile does not behave like FsFile\n";
+    ok = false;
+  } else {
+    std::cout << "randomized comparison with FsFile: ok\n";
+  }
+
+  std::remove(kDirectPath);
+  std::remove(kBufferedPath);
+  std::remove(kReferencePath);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,322 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "network/DirectoryIndex.h"
+
+// Lists generated directories with DirectoryIndex::forEachSorted() and compares against the order the web page
+// used to sort into itself. Checked: both sort keys, names sharing more than the sort key's 19 characters, hidden
+// entries, pages put together from offsets, entries that vanish after indexing, invalidation, and that building and
+// paging a 5000 entry directory takes no more heap than a 100 entry one.
+
+// Heap in use and its peak, counted for every operator new
+namespace {
+std::atomic<size_t> heapInUse{0};
+std::atomic<size_t> heapPeak{0};
+}  // namespace
+
+void* operator new(const size_t size) {
+  void* block = malloc(size);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  const size_t inUse = heapInUse += malloc_usable_size(block);
+  size_t peak = heapPeak;
+  while (inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse)) {
+  }
+  return block;
+}
+
+void operator delete(void* pointer) noexcept {
+  heapInUse -= malloc_usable_size(pointer);
+  free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+
+namespace {
+
+std::string cardRoot;
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "  FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+bool isHidden(const char* name) { return name[0] == '.' || strcmp(name, "System Volume Information") == 0; }
+
+struct Expected {
+  std::string name;
+  uint32_t size;
+  bool isDirectory;
+};
+
+struct Listed {
+  std::vector<Expected> entries;
+  DirectoryIndex::Summary summary;
+  bool ok;
+};
+
+std::string lower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), [](const unsigned char c) { return tolower(c); });
+  return text;
+}
+
+bool isEpub(const std::string& name) { return name.size() >= 5 && lower(name.substr(name.size() - 5)) == ".epub"; }
+
+// The order FilesPage.html sorted into before the server did it, with byte-wise names and SIZE's largest first
+void sortExpected(std::vector<Expected>& entries, const DirectoryIndex::SortKey key) {
+  std::sort(entries.begin(), entries.end(), [key](const Expected& a, const Expected& b) {
+    if (a.isDirectory != b.isDirectory) {
+      return a.isDirectory;
+    }
+    if (key == DirectoryIndex::SortKey::NAME && !a.isDirectory && isEpub(a.name) != isEpub(b.name)) {
+      return isEpub(a.name);
+    }
+    if (key == DirectoryIndex::SortKey::SIZE && !a.isDirectory && a.size != b.size) {
+      return a.size > b.size;
+    }
+    return lower(a.name) < lower(b.name);
+  });
+}
+
+void makeFile(const std::string& devicePath, const uint32_t size) {
+  const std::string path = cardRoot + devicePath;
+  std::ofstream(path, std::ios::binary).close();
+  if (truncate(path.c_str(), size) != 0) {
+    perror(path.c_str());
+  }
+}
+
+void makeDir(const std::string& devicePath) { Storage.mkdir(devicePath.c_str()); }
+
+Listed list(const std::string& dir, const DirectoryIndex::SortKey key, const uint32_t offset = 0,
+            const uint32_t limit = UINT32_MAX) {
+  Listed listed;
+  listed.ok = DirectoryIndex::forEachSorted(
+      dir, key, offset, limit, isHidden,
+      [&listed](const DirectoryIndex::Entry& entry) {
+        listed.entries.push_back({entry.name, entry.size, entry.isDirectory});
+        return true;
+      },
+      listed.summary);
+  return listed;
+}
+
+bool sameOrder(const std::vector<Expected>& a, const std::vector<Expected>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].name != b[i].name || a[i].size != b[i].size || a[i].isDirectory != b[i].isDirectory) {
+      std::cout << "  first difference at " << i << ": " << a[i].name << " / " << b[i].name << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// `count` entries in `dir`, a tenth of them folders, a third EPUBs, names unique within the sort key's 19 characters
+std::vector<Expected> populate(const std::string& dir, const int count, const unsigned seed) {
+  makeDir(dir);
+  std::mt19937 random(seed);
+  std::vector<Expected> entries;
+  const char* stems[] = {"Alpha", "beta", "Gamma", "delta", "Épsilon", "zeta", "Eta", "theta"};
+  for (int i = 0; i < count; i++) {
+    char name[64];
+    const int kind = random() % 10;
+    const auto number = static_cast<unsigned>(random() % 100000 * 10000 + i);
+    snprintf(name, sizeof(name), "%s %05u%s", stems[random() % 8], number,
+             kind == 0 ? "" : (kind < 4 ? ".EPUB" : (kind < 7 ? ".epub" : ".txt")));
+    if (kind == 0) {
+      makeDir(dir + "/" + name);
+      entries.push_back({name, 0, true});
+    } else {
+      const uint32_t size = random() % 4096;
+      makeFile(dir + "/" + name, size);
+      entries.push_back({name, size, false});
+    }
+  }
+  return entries;
+}
+
+void testSmallDirectory() {
+  std::cout << "small directory, both sort keys" << std::endl;
+  auto expected = populate("/small", 60, 1);
+  makeDir("/small/.hidden");
+  makeFile("/small/.DS_Store", 10);
+  makeDir("/small/System Volume Information");
+
+  for (const auto key : {DirectoryIndex::SortKey::NAME, DirectoryIndex::SortKey::SIZE}) {
+    sortExpected(expected, key);
+    const Listed listed = list("/small", key);
+    check(listed.ok, "listing succeeds");
+    check(sameOrder(listed.entries, expected), "entries in the expected order");
+    uint32_t folders = 0;
+    uint64_t bytes = 0;
+    for (const auto& entry : expected) {
+      folders += entry.isDirectory;
+      bytes += entry.size;
+    }
+    check(listed.summary.count == expected.size() && listed.summary.folders == folders &&
+              listed.summary.totalBytes == bytes,
+          "summary counts the listed entries");
+  }
+  check(!list("/small/.DS_Store", DirectoryIndex::SortKey::NAME).ok, "files can't be listed");
+  check(!list("/nothing", DirectoryIndex::SortKey::NAME).ok, "missing directories can't be listed");
+}
+
+void testCommonPrefixes() {
+  std::cout << "names with long common prefixes" << std::endl;
+  makeDir("/series");
+  std::mt19937 random(5);
+  const char* prefixes[] = {"Brandon Sanderson - ", "brandon sanderson - The Stormlight Archive ",
+                            "Brandon Sanderson - Mistborn ", "Terry Pratchett - Discworld ", "Terry Pratchett - "};
+  std::vector<std::string> names;
+  for (const char* prefix : prefixes) {
+    for (int i = 0; i < 60; i++) {
+      names.push_back(std::string(prefix) + std::to_string(random() % 100000) + "-" + std::to_string(i));
+    }
+  }
+  // Created in shuffled order, more than one run of records
+  std::shuffle(names.begin(), names.end(), random);
+  std::vector<Expected> expected;
+  for (size_t i = 0; i < names.size(); i++) {
+    if (i % 12 == 0) {
+      makeDir("/series/" + names[i]);
+      expected.push_back({names[i], 0, true});
+    } else {
+      // Few sizes, so files of one size tie on it too
+      const uint32_t size = random() % 4 * 100;
+      const std::string name = names[i] + (i % 3 == 0 ? ".txt" : ".epub");
+      makeFile("/series/" + name, size);
+      expected.push_back({name, size, false});
+    }
+  }
+
+  for (const auto key : {DirectoryIndex::SortKey::NAME, DirectoryIndex::SortKey::SIZE}) {
+    sortExpected(expected, key);
+    const Listed listed = list("/series", key);
+    check(listed.ok && sameOrder(listed.entries, expected), "in order of the full names");
+  }
+}
+
+void testPaging() {
+  std::cout << "5000 entries in pages" << std::endl;
+  auto expected = populate("/large", 5000, 2);
+  for (const auto key : {DirectoryIndex::SortKey::NAME, DirectoryIndex::SortKey::SIZE}) {
+    sortExpected(expected, key);
+    const auto start = std::chrono::steady_clock::now();
+    Listed first = list("/large", key, 0, 200);
+    const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    check(first.summary.count == 5000, "summary counts all entries");
+
+    std::vector<Expected> paged = first.entries;
+    double pageMs = 0;
+    for (uint32_t offset = 200; offset < 5200; offset += 200) {
+      const auto pageStart = std::chrono::steady_clock::now();
+      const Listed page = list("/large", key, offset, 200);
+      pageMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pageStart).count();
+      check(page.entries.size() == (offset < 5000 ? 200u : 0u), "pages are full up to the end");
+      paged.insert(paged.end(), page.entries.begin(), page.entries.end());
+    }
+    check(sameOrder(paged, expected), "pages put together give the whole directory in order");
+    // The host reopens an entry by reading its directory from the start, SdFat seeks to the entry's offset
+    printf("  %s: index built with the first page in %.1f ms, further pages %.2f ms each\n",
+           key == DirectoryIndex::SortKey::NAME ? "name" : "size", buildMs, pageMs / 25);
+  }
+}
+
+void testChanges() {
+  std::cout << "changed directory" << std::endl;
+  populate("/changing", 300, 3);
+  Listed before = list("/changing", DirectoryIndex::SortKey::NAME);
+  const std::string removed = before.entries[150].name;
+  const std::string removedPath = cardRoot + "/changing/" + removed;
+  if (before.entries[150].isDirectory) {
+    rmdir(removedPath.c_str());
+  } else {
+    unlink(removedPath.c_str());
+  }
+
+  // Whether or not the directory's time stamp moved on, the entry is gone from the listing
+  Listed after = list("/changing", DirectoryIndex::SortKey::NAME);
+  check(std::none_of(after.entries.begin(), after.entries.end(), [&](const Expected& e) { return e.name == removed; }),
+        "removed entry not listed");
+  check(list("/changing", DirectoryIndex::SortKey::NAME).summary.count == 299, "index rebuilt without it");
+
+  makeFile("/changing/aaa new.epub", 5);
+  DirectoryIndex::invalidateParentOf("/changing/aaa new.epub");
+  after = list("/changing", DirectoryIndex::SortKey::NAME);
+  check(after.summary.count == 300, "new file counted after invalidation");
+  const auto newEntry = std::find_if(after.entries.begin(), after.entries.end(),
+                                     [](const Expected& e) { return e.name == "aaa new.epub"; });
+  check(newEntry != after.entries.end(), "new file listed");
+}
+
+// Peak heap of indexing `dir` and reading every page of it
+size_t peakHeap(const std::string& dir) {
+  DirectoryIndex::clear();
+  const size_t base = heapInUse;
+  heapPeak = base;
+  uint32_t offset = 0;
+  DirectoryIndex::Summary summary;
+  do {
+    DirectoryIndex::forEachSorted(dir, DirectoryIndex::SortKey::NAME, offset, 100, isHidden,
+                                  [](const DirectoryIndex::Entry&) { return true; }, summary);
+    offset += 100;
+  } while (offset < summary.count);
+  return heapPeak - base;
+}
+
+void testConstantMemory() {
+  std::cout << "heap use independent of the directory size" << std::endl;
+  populate("/hundred", 100, 4);
+  const size_t small = peakHeap("/hundred");
+  const size_t large = peakHeap("/large");
+  printf("  peak heap: %zu bytes for 100 entries, %zu bytes for 5000\n", small, large);
+  // The merge buffers come on top of the run buffer once there is more than one run
+  check(large <= small + 2048, "5000 entries take at most the merge buffers more");
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: DirectoryIndexTest <card dir> [--verbose]\n");
+    return 2;
+  }
+  cardRoot = argv[1];
+  Serial.quiet = !(argc > 2 && strcmp(argv[2], "--verbose") == 0);
+  Storage.setRoot(cardRoot);
+
+  testSmallDirectory();
+  testCommonPrefixes();
+  testPaging();
+  testChanges();
+  testConstantMemory();
+
+  if (failures > 0) {
+    std::cout << failures << " failed checks" << std::endl;
+    return 1;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return 0;
+}
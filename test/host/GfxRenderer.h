@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for the renderer: drawing is a no-op, text is measured with a fixed advance per byte
+
+#include <EpdFontFamily.h>
+#include <HardwareSerial.h>
+
+#include <cstring>
+
+class GfxRenderer {
+ public:
+  int getTextWidth(int, const char* text, EpdFontFamily::Style = EpdFontFamily::REGULAR) const {
+    return static_cast<int>(strlen(text)) * 8;
+  }
+  int getTextAdvanceX(int fontId, const char* text) const { return getTextWidth(fontId, text); }
+  int getFontAscenderSize(int) const { return 16; }
+  int getLineHeight(int) const { return 24; }
+  void drawText(int, int, int, const char*, bool = true, EpdFontFamily::Style = EpdFontFamily::REGULAR) const {}
+  void drawLine(int, int, int, int, bool = true) const {}
+};
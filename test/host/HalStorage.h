@@ -0,0 +1,63 @@
+#pragma once
+
+// Host stand-in for the firmware's HalStorage.h: an FsFile backed by stdio that counts the SD transactions
+// (read and write calls) the code under test issues. Only what the host benchmarks compile against is provided.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+class FsFile {
+  FILE* fp = nullptr;
+
+ public:
+  // Calls issued since the last reset, across all files
+  static inline size_t readCalls = 0;
+  static inline size_t writeCalls = 0;
+  static void resetCounters() { readCalls = writeCalls = 0; }
+
+  FsFile() = default;
+  FsFile(const FsFile&) = delete;
+  FsFile& operator=(const FsFile&) = delete;
+  ~FsFile() { close(); }
+
+  bool open(const char* path, const char* mode) {
+    close();
+    fp = fopen(path, mode);
+    return fp != nullptr;
+  }
+  bool close() {
+    if (fp) {
+      fclose(fp);
+      fp = nullptr;
+    }
+    return true;
+  }
+  explicit operator bool() const { return fp != nullptr; }
+
+  int read(void* buf, const size_t n) {
+    readCalls++;
+    return static_cast<int>(fread(buf, 1, n, fp));
+  }
+  int read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  size_t write(const uint8_t* buf, const size_t n) {
+    writeCalls++;
+    return fwrite(buf, 1, n, fp);
+  }
+  size_t write(const void* buf, const size_t n) { return write(static_cast<const uint8_t*>(buf), n); }
+  size_t write(const uint8_t b) { return write(&b, 1); }
+  bool seek(const uint64_t pos) { return fseek(fp, static_cast<long>(pos), SEEK_SET) == 0; }
+  uint64_t position() const { return static_cast<uint64_t>(ftell(fp)); }
+  uint64_t size() const {
+    const long pos = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    const long end = ftell(fp);
+    fseek(fp, pos, SEEK_SET);
+    return static_cast<uint64_t>(end);
+  }
+  int available() const { return static_cast<int>(size() - position()); }
+  void flush() { fflush(fp); }
+};
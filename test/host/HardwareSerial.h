@@ -0,0 +1,28 @@
+#pragma once
+
+// Host stand-in for the Arduino serial log and clock
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+inline unsigned long millis() {
+  static const auto start = std::chrono::steady_clock::now();
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+struct HostSerial {
+  bool quiet = false;
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    if (quiet) {
+      return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+  }
+};
+
+inline HostSerial Serial;
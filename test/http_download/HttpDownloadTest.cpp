@@ -0,0 +1,223 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <StreamString.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "CrossPointSettings.h"
+#include "network/HttpDownloader.h"
+
+// Runs HttpDownloader::downloadToFile() against test/http_download/fixture_server.py, which serves generated files
+// with Range support and breaks connections off where asked. The run script starts the server and passes its port.
+//
+// Checked: plain downloads, downloads that keep losing the connection and are continued from the part file without
+// receiving anything twice, part files of a file that changed on the server, servers that ignore Range, weak
+// ETags, Basic auth, and that a failed download leaves an existing file alone. A larger download is timed.
+
+// The downloader only reads the OPDS credentials, so the settings are the defaults rather than settings.cpp's
+CrossPointSettings CrossPointSettings::instance;
+
+namespace {
+
+std::string baseUrl;
+std::string cardRoot;
+
+// What the server has at `path`, fetched in one piece with fetchUrl(). The string overload stops at the first NUL.
+std::string expectedData(const std::string& path) {
+  StreamString data;
+  if (!HttpDownloader::fetchUrl(baseUrl + path, data)) {
+    return "";
+  }
+  return std::string(data.c_str(), data.length());
+}
+
+std::string readHostFile(const std::string& devicePath) {
+  std::ifstream in(cardRoot + devicePath, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+bool exists(const std::string& devicePath) { return Storage.exists(devicePath.c_str()); }
+
+// Body bytes the server sent since the last call
+long servedBytes(long* ranges = nullptr) {
+  std::string stats;
+  if (!HttpDownloader::fetchUrl(baseUrl + "/stats", stats)) {
+    return -1;
+  }
+  if (ranges) {
+    *ranges = strtol(stats.c_str() + stats.find("\"ranges\": ") + 10, nullptr, 10);
+  }
+  return strtol(stats.c_str() + stats.find("\"bytes\": ") + 9, nullptr, 10);
+}
+
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "  FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+void checkDownloaded(const std::string& dest, const std::string& expected) {
+  check(!expected.empty(), "reference data fetched");
+  check(readHostFile(dest) == expected, "file matches the server's data");
+  check(!exists(dest + ".part") && !exists(dest + ".part.info"), "part file and sidecar removed");
+}
+
+void testPlain() {
+  std::cout << "plain download" << std::endl;
+  const std::string dest = "/plain.epub";
+  const std::string expected = expectedData("/file/300000");
+  servedBytes();
+  check(HttpDownloader::downloadToFile(baseUrl + "/file/300000", dest) == HttpDownloader::OK, "download succeeds");
+  checkDownloaded(dest, expected);
+  check(servedBytes() == 300000, "file sent once");
+}
+
+void testResume() {
+  std::cout << "resume after dropped connections" << std::endl;
+  // Every response stops after 200 KB, three attempts per call get 600 KB of the 1 MB
+  const std::string url = baseUrl + "/file/1000000?drop=200000";
+  const std::string dest = "/dropped.epub";
+  const std::string expected = expectedData("/file/1000000");
+  servedBytes();
+
+  size_t lastReported = 0;
+  size_t firstReported = SIZE_MAX;
+  const auto progress = [&](const size_t downloaded, const size_t total) {
+    if (firstReported == SIZE_MAX) {
+      firstReported = downloaded;
+    }
+    lastReported = downloaded;
+    check(total == 1000000, "progress total is the whole file");
+  };
+  check(HttpDownloader::downloadToFile(url, dest, progress) == HttpDownloader::HTTP_ERROR, "first call gives up");
+  check(exists(dest + ".part") && exists(dest + ".part.info"), "part file and sidecar kept");
+  check(!exists(dest), "destination not created");
+  check(lastReported == 600000, "three attempts' worth received");
+
+  firstReported = SIZE_MAX;
+  check(HttpDownloader::downloadToFile(url, dest, progress) == HttpDownloader::OK, "second call completes");
+  check(firstReported == 600000, "second call reports where it resumed");
+  checkDownloaded(dest, expected);
+  long ranges = 0;
+  check(servedBytes(&ranges) == 1000000, "no byte sent twice");
+  check(ranges == 4, "every request after the first one was a range request");
+}
+
+void testChangedFile() {
+  std::cout << "file changed on the server" << std::endl;
+  const std::string url = baseUrl + "/file/500000?drop=100000";
+  const std::string dest = "/changed.epub";
+  HttpDownloader::downloadToFile(url, dest);
+  check(exists(dest + ".part"), "part file kept");
+
+  // New ETag and Last-Modified: If-Range no longer matches, the server sends the whole new file and the part file
+  // starts over
+  std::string bumped;
+  HttpDownloader::fetchUrl(baseUrl + "/bump", bumped);
+  const std::string expected = expectedData("/file/500000");
+  servedBytes();
+  check(HttpDownloader::downloadToFile(url, dest) == HttpDownloader::HTTP_ERROR, "first call gives up");
+  check(HttpDownloader::downloadToFile(url, dest) == HttpDownloader::OK, "second call completes");
+  checkDownloaded(dest, expected);
+  check(servedBytes() == 500000, "nothing of the old file kept");
+}
+
+void testNoRangeSupport() {
+  std::cout << "server without Range support" << std::endl;
+  const std::string dest = "/norange.epub";
+  // Every answer is the whole file from the start, so each attempt has to start the part file over
+  check(HttpDownloader::downloadToFile(baseUrl + "/norange/200000?drop=80000", dest) == HttpDownloader::HTTP_ERROR,
+        "download fails");
+  check(readHostFile(dest + ".part") == expectedData("/norange/200000").substr(0, 80000),
+        "part file holds the start of the file once");
+}
+
+void testWeakEtag() {
+  std::cout << "weak ETag, resumed with Last-Modified" << std::endl;
+  const std::string dest = "/weak.epub";
+  const std::string expected = expectedData("/weak/400000");
+  servedBytes();
+  check(HttpDownloader::downloadToFile(baseUrl + "/weak/400000?drop=150000", dest) == HttpDownloader::OK,
+        "download succeeds in three attempts");
+  checkDownloaded(dest, expected);
+  long ranges = 0;
+  check(servedBytes(&ranges) == 400000 && ranges == 2, "resumed twice");
+}
+
+void testAuth() {
+  std::cout << "basic auth" << std::endl;
+  const std::string dest = "/auth.epub";
+  check(HttpDownloader::downloadToFile(baseUrl + "/auth/1000", dest) == HttpDownloader::HTTP_ERROR,
+        "refused without credentials");
+  strcpy(SETTINGS.opdsUsername, "user");
+  strcpy(SETTINGS.opdsPassword, "secret");
+  const std::string expected = expectedData("/auth/1000");
+  check(HttpDownloader::downloadToFile(baseUrl + "/auth/1000", dest) == HttpDownloader::OK, "download succeeds");
+  checkDownloaded(dest, expected);
+  SETTINGS.opdsUsername[0] = '\0';
+  SETTINGS.opdsPassword[0] = '\0';
+}
+
+void testExistingFileKept() {
+  std::cout << "failed download keeps the existing file" << std::endl;
+  const std::string dest = "/existing.epub";
+  FsFile file;
+  Storage.openFileForWrite("TEST", dest.c_str(), file);
+  file.write(reinterpret_cast<const uint8_t*>("old"), 3);
+  file.close();
+  check(HttpDownloader::downloadToFile(baseUrl + "/file/300000?drop=1000", dest) == HttpDownloader::HTTP_ERROR,
+        "download fails");
+  check(readHostFile(dest) == "old", "existing file unchanged");
+  check(HttpDownloader::downloadToFile(baseUrl + "/nothing", dest) == HttpDownloader::HTTP_ERROR, "404 fails");
+  check(readHostFile(dest) == "old", "existing file unchanged after 404");
+}
+
+void timeLargeDownload() {
+  constexpr int size = 16 * 1024 * 1024;
+  const std::string dest = "/large.epub";
+  const auto start = std::chrono::steady_clock::now();
+  const auto result = HttpDownloader::downloadToFile(baseUrl + "/file/" + std::to_string(size), dest);
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  check(result == HttpDownloader::OK, "large download succeeds");
+  check(readHostFile(dest).size() == size, "large file complete");
+  printf("16 MB in %.2f s, %.1f MB/s\n", seconds, size / 1048576.0 / seconds);
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "Usage: HttpDownloadTest <port> <card dir> [--verbose]\n");
+    return 2;
+  }
+  baseUrl = std::string("http://127.0.0.1:") + argv[1];
+  cardRoot = argv[2];
+  Serial.quiet = !(argc > 3 && strcmp(argv[3], "--verbose") == 0);
+  Storage.setRoot(cardRoot);
+
+  testPlain();
+  testResume();
+  testChangedFile();
+  testNoRangeSupport();
+  testWeakEtag();
+  testAuth();
+  testExistingFileKept();
+  timeLargeDownload();
+
+  if (failures > 0) {
+    std::cout << failures << " failed checks" << std::endl;
+    return 1;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return 0;
+}
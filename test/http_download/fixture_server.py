@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""HTTP server the download tests run against. Serves generated files with Range and If-Range support and breaks
+connections off on request.
+
+Paths:
+  /file/<size>       <size> bytes of data, ETag and Last-Modified set
+  /norange/<size>    Same data, Range requests are answered with the whole file
+  /weak/<size>       Same data with a weak ETag, so If-Range has to fall back to Last-Modified
+  /auth/<size>       Same data, only with Basic auth user:secret
+  /bump              Changes the data and validators of every file (new ETag and Last-Modified)
+  /stats             Served body bytes, requests and range requests since the last /stats, as JSON
+  /feed/<entries>/<page>/<pages>
+                     Page <page> (from 1) of an OPDS feed of <pages> pages with <entries> entries each, every tenth a
+                     navigation entry and the rest books. Links to the next page with rel="next" unless it is the
+                     last. Sent at about 1 MB/s, like the device's Wi-Fi. ETag and Last-Modified are set and
+                     If-None-Match / If-Modified-Since answered with 304. Titles change with /bump.
+  /outage            Toggles an outage: while it lasts feeds are answered with 503
+
+Adding ?drop=<bytes> to a file or feed path makes every response stop after <bytes> bytes of body and close the
+connection.
+
+The data depends on the size and the generation /bump advances. Prints the port it listens on, then serves until
+killed.
+"""
+
+import base64
+import email.utils
+import hashlib
+import json
+import random
+import re
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+state_lock = threading.Lock()
+state = {"generation": 0, "bytes": 0, "requests": 0, "ranges": 0, "outage": False}
+data_cache = {}
+
+
+def feed_data(entries, page, pages, generation=0):
+    parts = ['<?xml version="1.0" encoding="UTF-8"?>\n<feed xmlns="http://www.w3.org/2005/Atom">'
+             "<id>urn:fixture:feed</id><title>Fixture catalogue</title>"
+             '<link rel="self" href="/feed/%d/%d/%d" type="application/atom+xml;profile=opds-catalog"/>'
+             % (entries, page, pages)]
+    if page < pages:
+        parts.append('<link rel="next" href="/feed/%d/%d/%d" type="application/atom+xml;profile=opds-catalog"/>'
+                     % (entries, page + 1, pages))
+    edition = " (edition %d)" % generation if generation else ""
+    for i in range((page - 1) * entries, page * entries):
+        if i % 10 == 0:
+            parts.append("<entry><title>Shelf %d</title><id>urn:fixture:shelf:%d</id><updated>2024-01-01T00:00:00Z"
+                         '</updated><link rel="subsection" href="/feed/%d/1/1" '
+                         'type="application/atom+xml;profile=opds-catalog;kind=navigation"/></entry>' % (i, i, entries))
+        else:
+            parts.append("<entry><title>Book %d%s</title><author><name>Author %d</name></author>"
+                         "<id>urn:fixture:book:%d</id><updated>2024-01-01T00:00:00Z</updated>"
+                         "<summary>A generated book for the OPDS tests, with a summary the parser skips.</summary>"
+                         '<link rel="http://opds-spec.org/acquisition" href="/file/%d" type="application/epub+zip"/>'
+                         "</entry>" % (i, edition, i % 97, i, 1000 + i))
+    parts.append("</feed>")
+    return "".join(parts).encode()
+
+
+def file_data(size, generation):
+    key = (size, generation)
+    if key not in data_cache:
+        data_cache[key] = random.Random(size * 1000 + generation).randbytes(size)
+    return data_cache[key]
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"
+
+    def log_message(self, format, *args):
+        pass
+
+    def send_json(self, value):
+        body = json.dumps(value).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def send_feed(self, entries, page, pages, drop_after):
+        with state_lock:
+            generation = state["generation"]
+            outage = state["outage"]
+            state["requests"] += 1
+        if outage:
+            self.send_error(503)
+            return
+        etag = '"feed-%d-%d-%d-%d"' % (entries, page, pages, generation)
+        last_modified = email.utils.formatdate(1700000000 + generation * 3600, usegmt=True)
+        if self.headers.get("If-None-Match") == etag or (
+            self.headers.get("If-None-Match") is None and self.headers.get("If-Modified-Since") == last_modified
+        ):
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return
+
+        body = feed_data(entries, page, pages, generation)
+        self.send_response(200)
+        self.send_header("Content-Type", "application/atom+xml;profile=opds-catalog")
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("ETag", etag)
+        self.send_header("Last-Modified", last_modified)
+        self.end_headers()
+        if drop_after is not None:
+            body = body[: int(drop_after)]
+        with state_lock:
+            state["bytes"] += len(body)
+        try:
+            for offset in range(0, len(body), 4096):
+                self.wfile.write(body[offset : offset + 4096])
+                self.wfile.flush()
+                time.sleep(0.004)
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+        self.close_connection = True
+
+    def do_GET(self):
+        if self.path == "/stats":
+            with state_lock:
+                stats = {key: state[key] for key in ("bytes", "requests", "ranges")}
+                state.update(bytes=0, requests=0, ranges=0)
+            self.send_json(stats)
+            return
+        if self.path == "/outage":
+            with state_lock:
+                state["outage"] = not state["outage"]
+            self.send_json({"outage": state["outage"]})
+            return
+        if self.path == "/bump":
+            with state_lock:
+                state["generation"] += 1
+            self.send_json({"generation": state["generation"]})
+            return
+
+        feed_match = re.fullmatch(r"/feed/(\d+)/(\d+)/(\d+)(?:\?drop=(\d+))?", self.path)
+        if feed_match:
+            entries, page, pages = map(int, feed_match.groups()[:3])
+            self.send_feed(entries, page, pages, feed_match.group(4))
+            return
+
+        match = re.fullmatch(r"/(file|norange|weak|auth)/(\d+)(?:\?drop=(\d+))?", self.path)
+        if not match:
+            self.send_error(404)
+            return
+        kind, size, drop_after = match.group(1), int(match.group(2)), match.group(3)
+
+        if kind == "auth":
+            expected = "Basic " + base64.b64encode(b"user:secret").decode()
+            if self.headers.get("Authorization") != expected:
+                self.send_response(401)
+                self.send_header("WWW-Authenticate", 'Basic realm="fixture"')
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
+        with state_lock:
+            generation = state["generation"]
+            state["requests"] += 1
+        data = file_data(size, generation)
+        digest = hashlib.sha1(data).hexdigest()[:16]
+        etag = ('W/"%s"' if kind == "weak" else '"%s"') % digest
+        last_modified = email.utils.formatdate(1700000000 + generation * 3600, usegmt=True)
+
+        start = 0
+        range_header = self.headers.get("Range")
+        if_range = self.headers.get("If-Range")
+        range_match = re.fullmatch(r"bytes=(\d+)-", range_header or "")
+        # A weak ETag never matches If-Range, only the date does
+        validator_ok = if_range is None or if_range == last_modified or (if_range == etag and kind != "weak")
+        if range_match and kind != "norange" and validator_ok:
+            start = int(range_match.group(1))
+            if start >= size:
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % size)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            with state_lock:
+                state["ranges"] += 1
+            self.send_response(206)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, size - 1, size))
+        else:
+            self.send_response(200)
+        self.send_header("Content-Type", "application/epub+zip")
+        self.send_header("Content-Length", str(size - start))
+        self.send_header("ETag", etag)
+        self.send_header("Last-Modified", last_modified)
+        self.end_headers()
+
+        body = data[start:]
+        if drop_after is not None:
+            body = body[: int(drop_after)]
+        # Counted up front, the client may ask for /stats as soon as it has the last byte
+        with state_lock:
+            state["bytes"] += len(body)
+        try:
+            for offset in range(0, len(body), 16384):
+                self.wfile.write(body[offset : offset + 16384])
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+        self.close_connection = True
+
+
+def main():
+    server = ThreadingHTTPServer(("127.0.0.1", int(sys.argv[1]) if len(sys.argv) > 1 else 0), Handler)
+    print(server.server_address[1], flush=True)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
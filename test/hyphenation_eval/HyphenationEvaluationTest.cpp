@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <functional>
@@ -11,6 +12,7 @@
 #include <vector>
 
 #include "lib/Epub/Epub/hyphenation/HyphenationCommon.h"
+#include "lib/Epub/Epub/hyphenation/Hyphenator.h"
 #include "lib/Epub/Epub/hyphenation/LanguageHyphenator.h"
 #include "lib/Epub/Epub/hyphenation/LanguageRegistry.h"
 
@@ -302,9 +304,108 @@ void printResults(const std::string& language, const std::vector<TestCase>& test
   }
 }
 
+// Replays the test words as often as they occur in the source book, in a fixed pseudo-random order, so the word
+// cache sees the same repetition pattern it would while laying out that book.
+std::vector<std::string> buildWordStream(const std::vector<TestCase>& testCases) {
+  std::vector<std::string> stream;
+  for (const auto& testCase : testCases) {
+    for (int i = 0; i < std::max(1, testCase.frequency); i++) {
+      stream.push_back(testCase.word);
+    }
+  }
+
+  uint32_t state = 0x12345678u;
+  for (size_t i = stream.size(); i > 1; i--) {
+    state = state * 1664525u + 1013904223u;
+    std::swap(stream[i - 1], stream[state % i]);
+  }
+  return stream;
+}
+
+template <typename Fn>
+double measureWordsPerSecond(const std::vector<std::string>& stream, const int rounds, Fn&& fn) {
+  size_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (const auto& word : stream) {
+      sink += fn(word);
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  // Keep the optimizer from dropping the calls
+  if (sink == static_cast<size_t>(-1)) {
+    std::cout << sink << std::endl;
+  }
+  return elapsed.count() > 0 ? static_cast<double>(stream.size()) * rounds / elapsed.count() : 0.0;
+}
+
+// Throughput of the raw Liang evaluator against the cached Hyphenator path used during layout. Also checks that
+// both paths agree on every word, so a cache bug shows up as a non-zero exit code.
+int runBenchmark(const std::vector<LanguageConfig>& languages) {
+  constexpr int kRounds = 5;
+  int mismatches = 0;
+
+  for (const auto& lang : languages) {
+    const auto* hyphenator = getLanguageHyphenatorForPrimaryTag(lang.primaryTag);
+    const std::vector<TestCase> testCases = loadTestData(lang.testDataFile);
+    if (!hyphenator || testCases.empty()) {
+      std::cerr << "Skipping benchmark for " << lang.cliName << std::endl;
+      continue;
+    }
+    const std::vector<std::string> stream = buildWordStream(testCases);
+
+    Hyphenator::setPreferredLanguage(lang.primaryTag);
+    int langMismatches = 0;
+    for (const auto& testCase : testCases) {
+      const auto cps = [&] {
+        auto c = collectCodepoints(testCase.word);
+        trimSurroundingPunctuationAndFootnote(c);
+        return c;
+      }();
+      std::vector<size_t> expected;
+      for (const size_t idx : hyphenator->breakIndexes(cps)) {
+        expected.push_back(cps[idx].byteOffset);
+      }
+      // Run twice so the second lookup is served from the cache
+      for (int pass = 0; pass < 2; pass++) {
+        std::vector<size_t> actual;
+        for (const auto& info : Hyphenator::breakOffsets(testCase.word, false)) {
+          actual.push_back(info.byteOffset);
+        }
+        if (actual != expected) {
+          langMismatches++;
+        }
+      }
+    }
+    mismatches += langMismatches;
+
+    const double liang = measureWordsPerSecond(stream, kRounds, [hyphenator](const std::string& word) {
+      return hyphenateWordWithHyphenator(word, *hyphenator).size();
+    });
+    // Layout path with the cache emptied before every word, then with the cache doing its job
+    const double uncached = measureWordsPerSecond(stream, kRounds, [](const std::string& word) {
+      Hyphenator::clearCache();
+      return Hyphenator::breakOffsets(word, false).size();
+    });
+    Hyphenator::clearCache();
+    const double cached = measureWordsPerSecond(
+        stream, kRounds, [](const std::string& word) { return Hyphenator::breakOffsets(word, false).size(); });
+
+    std::cout << lang.cliName << ": " << stream.size() << " words, liang " << static_cast<long>(liang)
+              << " words/s, hyphenator " << static_cast<long>(uncached) << " words/s uncached / "
+              << static_cast<long>(cached) << " words/s cached (" << (uncached > 0 ? cached / uncached : 0)
+              << "x), mismatches " << langMismatches << std::endl;
+  }
+
+  return mismatches == 0 ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
-  const bool summaryMode = argc <= 1;
-  const std::string languageSelection = summaryMode ? "all" : argv[1];
+  // "bench [language]" reports hyphenation throughput instead of accuracy
+  const bool benchMode = argc > 1 && std::string(argv[1]) == "bench";
+  const int languageArg = benchMode ? 2 : 1;
+  const bool summaryMode = argc <= languageArg;
+  const std::string languageSelection = summaryMode ? "all" : argv[languageArg];
 
   std::vector<LanguageConfig> languages = resolveLanguages(languageSelection);
   if (languages.empty()) {
@@ -312,6 +413,10 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  if (benchMode) {
+    return runBenchmark(languages);
+  }
+
   for (const auto& lang : languages) {
     const auto* hyphenator = getLanguageHyphenatorForPrimaryTag(lang.primaryTag);
     if (!hyphenator) {
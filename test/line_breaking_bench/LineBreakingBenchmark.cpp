@@ -0,0 +1,391 @@
+#include <Utf8.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/Epub/Epub/LineBreaker.h"
+#include "lib/Epub/Epub/hyphenation/Hyphenator.h"
+
+// Compares the greedy line breaking the firmware used before LineBreaker (and still falls back to when memory is
+// low) with LineBreaker on generated paragraphs, reporting layout time and how evenly the lines are filled.
+//
+// Widths come from a rough proportional font model, so absolute numbers only mean something relative to each other.
+
+namespace {
+
+constexpr int kLineWidth = 440;
+constexpr int kSpaceWidth = 5;
+constexpr int kHyphenWidth = 6;
+constexpr int kCjkWidth = 24;
+constexpr int kRounds = 20;
+
+struct Paragraph {
+  std::vector<std::string> words;
+  std::vector<uint16_t> wordWidths;
+  std::vector<bool> continuesVec;
+  std::vector<bool> wordIsCjkVec;
+  std::vector<uint8_t> wordClasses;
+  std::vector<LineBreaker::Split> splits;
+};
+
+struct Corpus {
+  std::string name;
+  const char* language;
+  bool justified;
+  std::vector<Paragraph> paragraphs;
+};
+
+struct Metrics {
+  size_t lines = 0;
+  double raggedness = 0.0;  // Mean of (slack / width)^2 over all but the last line of each paragraph
+  double worstSpace = 1.0;  // Widest justified space relative to a normal one
+  size_t hyphenatedLines = 0;
+  size_t kinsokuViolations = 0;
+  size_t overfullLines = 0;
+  double microsPerParagraph = 0.0;
+};
+
+bool isCjk(const uint32_t cp) {
+  return (cp >= 0x2E80 && cp <= 0x9FFF) || (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0xFF00 && cp <= 0xFFEF);
+}
+
+int codepointWidth(const uint32_t cp) {
+  if (isCjk(cp)) {
+    return kCjkWidth;
+  }
+  if (cp == '-') {
+    return kHyphenWidth;
+  }
+  if (std::string("iljtfr.,;:'!|").find(static_cast<char>(cp)) != std::string::npos && cp < 0x80) {
+    return 5;
+  }
+  if (cp == 'm' || cp == 'w' || cp == 'M' || cp == 'W') {
+    return 15;
+  }
+  if (cp >= 'A' && cp <= 'Z') {
+    return 12;
+  }
+  return 9;
+}
+
+int textWidth(const std::string& text) {
+  int width = 0;
+  const auto* ptr = reinterpret_cast<const unsigned char*>(text.c_str());
+  while (*ptr != 0) {
+    const uint32_t cp = utf8NextCodepoint(&ptr);
+    if (cp != 0xAD) {
+      width += codepointWidth(cp);
+    }
+  }
+  return width;
+}
+
+void addWord(Paragraph& paragraph, const std::string& word, const bool attach) {
+  const auto* ptr = reinterpret_cast<const unsigned char*>(word.c_str());
+  const uint32_t first = utf8NextCodepoint(&ptr);
+  const bool cjk = isCjk(first) && *ptr == 0;
+
+  const auto index = static_cast<uint16_t>(paragraph.words.size());
+  paragraph.words.push_back(word);
+  paragraph.wordWidths.push_back(static_cast<uint16_t>(textWidth(word)));
+  paragraph.continuesVec.push_back(attach);
+  paragraph.wordIsCjkVec.push_back(cjk);
+  paragraph.wordClasses.push_back(LineBreaker::classifyWord(word));
+  if (cjk || attach) {
+    return;
+  }
+  for (const auto& info : Hyphenator::breakOffsets(word, false)) {
+    if (info.byteOffset == 0 || info.byteOffset >= word.size()) {
+      continue;
+    }
+    const int prefix = textWidth(word.substr(0, info.byteOffset)) + (info.requiresInsertedHyphen ? kHyphenWidth : 0);
+    paragraph.splits.push_back({index, static_cast<uint16_t>(info.byteOffset), static_cast<uint16_t>(prefix),
+                                static_cast<uint16_t>(textWidth(word.substr(info.byteOffset)))});
+  }
+}
+
+// Words of the hyphenation test data, repeated as often as they occur in the source book, in a fixed shuffled order
+std::vector<std::string> loadWordStream(const std::string& filename) {
+  std::vector<std::string> stream;
+  std::ifstream file(filename);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream iss(line);
+    std::string word, hyphenated, freq;
+    if (std::getline(iss, word, '|') && std::getline(iss, hyphenated, '|') && std::getline(iss, freq, '|')) {
+      for (int i = 0; i < std::max(1, std::stoi(freq)); i++) {
+        stream.push_back(word);
+      }
+    }
+  }
+
+  uint32_t state = 0x9E3779B9u;
+  for (size_t i = stream.size(); i > 1; i--) {
+    state = state * 1664525u + 1013904223u;
+    std::swap(stream[i - 1], stream[state % i]);
+  }
+  return stream;
+}
+
+Corpus buildLatinCorpus(const std::string& name, const char* language, const std::string& file, const bool justified) {
+  Corpus corpus{name, language, justified, {}};
+  Hyphenator::setPreferredLanguage(language);
+  const auto stream = loadWordStream(file);
+  // The test data only lists hyphenatable words, so mix in short ones to get realistic lines
+  const char* shortWords[] = {"a", "the", "of", "and", "to", "in", "it", "was", "he", "she", "on", "at"};
+
+  uint32_t state = 12345;
+  size_t cursor = 0;
+  while (cursor < stream.size() && corpus.paragraphs.size() < 400) {
+    state = state * 1664525u + 1013904223u;
+    const size_t length = 20 + (state >> 8) % 140;
+    Paragraph paragraph;
+    for (size_t i = 0; i < length && cursor < stream.size(); i++) {
+      state = state * 1664525u + 1013904223u;
+      if ((state >> 12) % 3 == 0) {
+        addWord(paragraph, shortWords[(state >> 16) % 12], false);
+      } else {
+        std::string word = stream[cursor++];
+        if ((state >> 20) % 9 == 0) {
+          word += ",";
+        }
+        addWord(paragraph, word, false);
+      }
+    }
+    addWord(paragraph, ".", true);
+    corpus.paragraphs.push_back(std::move(paragraph));
+  }
+  return corpus;
+}
+
+Corpus buildCjkCorpus(const std::string& name, const bool withLatin) {
+  static const char* sentences[] = {
+      "清晨的雨落在小镇的石板路上，街角的面包店已经亮起了灯。",
+      "老板一边揉面，一边哼着不知名的曲子：「今天会是个好日子。」",
+      "孩子们背着书包跑过窗前，笑声在巷子里回荡。",
+      "远处的钟楼敲了七下，卖花的老人推着车慢慢走来，车上的花还带着露水。",
+      "有人停下脚步，买了一束白色的百合；有人只是看了一眼，又匆匆离开。",
+      "《小镇日记》里写道：“生活就是这样，平凡却不平淡。”",
+      "她把信折好，放进抽屉（那里还躺着几张旧照片），然后关上了灯。",
+      "河边的柳树发了新芽，风一吹，细长的枝条便轻轻摇晃。",
+  };
+  static const char* latinWords[] = {"e-ink", "reader", "EPUB", "WiFi", "information", "independent"};
+
+  Corpus corpus{name, "en", true, {}};
+  Hyphenator::setPreferredLanguage("en");
+  uint32_t state = 777;
+  for (int p = 0; p < 300; p++) {
+    Paragraph paragraph;
+    state = state * 1664525u + 1013904223u;
+    const int sentenceCount = 2 + static_cast<int>((state >> 8) % 6);
+    for (int s = 0; s < sentenceCount; s++) {
+      state = state * 1664525u + 1013904223u;
+      const auto* ptr = reinterpret_cast<const unsigned char*>(sentences[(state >> 10) % 8]);
+      while (*ptr != 0) {
+        const auto* start = ptr;
+        utf8NextCodepoint(&ptr);
+        addWord(paragraph, std::string(reinterpret_cast<const char*>(start), reinterpret_cast<const char*>(ptr)),
+                false);
+      }
+      if (withLatin) {
+        state = state * 1664525u + 1013904223u;
+        addWord(paragraph, latinWords[(state >> 12) % 6], false);
+      }
+    }
+    corpus.paragraphs.push_back(std::move(paragraph));
+  }
+  return corpus;
+}
+
+// Mirrors ParsedText::computeHyphenatedLineBreaks: fill each line, splitting the word that overflows at its widest
+// fitting hyphenation point
+std::vector<LineBreaker::Break> greedyBreaks(const Paragraph& paragraph) {
+  std::vector<LineBreaker::Break> breaks;
+  const size_t count = paragraph.wordWidths.size();
+  size_t word = 0;
+  int startRemainder = -1;  // Width of the remainder the line starts with, -1 for a whole word
+  while (word < count) {
+    const size_t lineStart = word;
+    int lineWidth = 0;
+    LineBreaker::Break lineBreak{static_cast<uint16_t>(count), 0};
+    bool ended = false;
+    while (word < count) {
+      const bool first = word == lineStart;
+      const bool cjkAdj = !first && paragraph.wordIsCjkVec[word] && paragraph.wordIsCjkVec[word - 1];
+      const int gap = first || paragraph.continuesVec[word] || cjkAdj ? 0 : kSpaceWidth;
+      const int width = first && startRemainder >= 0 ? startRemainder : paragraph.wordWidths[word];
+      if (lineWidth + gap + width <= kLineWidth) {
+        lineWidth += gap + width;
+        word++;
+        continue;
+      }
+
+      const int available = kLineWidth - lineWidth - gap;
+      const LineBreaker::Split* chosen = nullptr;
+      if (!(first && startRemainder >= 0)) {
+        for (const auto& split : paragraph.splits) {
+          if (split.word == word && split.prefixWidth <= available) {
+            chosen = &split;
+          }
+        }
+      }
+      if (chosen) {
+        lineBreak = {static_cast<uint16_t>(word), chosen->byteOffset};
+        startRemainder = chosen->remainderWidth;
+        ended = true;
+        break;
+      }
+      if (first) {
+        word++;
+      }
+      break;
+    }
+    if (!ended) {
+      // Keep attached words with their predecessor
+      while (word > lineStart + 1 && word < count && paragraph.continuesVec[word]) {
+        word--;
+      }
+      lineBreak = {static_cast<uint16_t>(word), 0};
+      startRemainder = -1;
+    }
+    breaks.push_back(lineBreak);
+  }
+  return breaks;
+}
+
+const LineBreaker::Split* findSplit(const Paragraph& paragraph, const uint16_t word, const uint16_t offset) {
+  for (const auto& split : paragraph.splits) {
+    if (split.word == word && split.byteOffset == offset) {
+      return &split;
+    }
+  }
+  return nullptr;
+}
+
+void measureLayout(const Paragraph& paragraph, const std::vector<LineBreaker::Break>& breaks, Metrics& metrics,
+                   size_t& nonLastLines) {
+  LineBreaker::Break start{0, 0};
+  for (size_t line = 0; line < breaks.size(); line++) {
+    const auto& end = breaks[line];
+    int natural = 0;
+    int gaps = 0;
+    const size_t lastWord = end.byteOffset != 0 ? end.word : end.word - 1;
+    for (size_t w = start.word; w <= lastWord && w < paragraph.wordWidths.size(); w++) {
+      int width = paragraph.wordWidths[w];
+      if (w == start.word && start.byteOffset != 0) {
+        width = findSplit(paragraph, start.word, start.byteOffset)->remainderWidth;
+      }
+      if (w == end.word && end.byteOffset != 0) {
+        width = findSplit(paragraph, end.word, end.byteOffset)->prefixWidth;
+      }
+      if (w > start.word) {
+        const bool cjkAdj = paragraph.wordIsCjkVec[w] && paragraph.wordIsCjkVec[w - 1];
+        natural += paragraph.continuesVec[w] || cjkAdj ? 0 : kSpaceWidth;
+        gaps += paragraph.continuesVec[w] ? 0 : 1;
+      }
+      natural += width;
+    }
+
+    metrics.lines++;
+    if (natural > kLineWidth && lastWord > start.word) {
+      metrics.overfullLines++;
+    }
+    if (end.byteOffset != 0) {
+      metrics.hyphenatedLines++;
+    }
+    if (line + 1 < breaks.size()) {
+      const double slack = std::max(0, kLineWidth - natural);
+      metrics.raggedness += (slack / kLineWidth) * (slack / kLineWidth);
+      nonLastLines++;
+      if (gaps > 0) {
+        metrics.worstSpace = std::max(metrics.worstSpace, (kSpaceWidth + slack / gaps) / kSpaceWidth);
+      }
+      if ((paragraph.wordClasses[lastWord] & LineBreaker::NO_LINE_END) ||
+          (end.byteOffset == 0 && (paragraph.wordClasses[end.word] & LineBreaker::NO_LINE_START))) {
+        metrics.kinsokuViolations++;
+      }
+    }
+    start = end;
+  }
+}
+
+template <typename Fn>
+Metrics evaluate(const Corpus& corpus, Fn&& layout) {
+  Metrics metrics;
+  size_t nonLastLines = 0;
+  for (const auto& paragraph : corpus.paragraphs) {
+    measureLayout(paragraph, layout(paragraph), metrics, nonLastLines);
+  }
+  metrics.raggedness = nonLastLines > 0 ? metrics.raggedness / nonLastLines : 0.0;
+
+  size_t sink = 0;
+  const auto begin = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; round++) {
+    for (const auto& paragraph : corpus.paragraphs) {
+      sink += layout(paragraph).size();
+    }
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+  if (sink == 0) {
+    std::cout << "empty corpus" << std::endl;
+  }
+  metrics.microsPerParagraph = elapsed.count() / (kRounds * corpus.paragraphs.size());
+  return metrics;
+}
+
+void printMetrics(const char* label, const Metrics& metrics) {
+  std::cout << "  " << label << ": " << metrics.lines << " lines, raggedness " << metrics.raggedness * 1000.0
+            << ", widest space " << metrics.worstSpace << "x, hyphenated " << metrics.hyphenatedLines << ", kinsoku "
+            << metrics.kinsokuViolations << ", overfull " << metrics.overfullLines << ", "
+            << metrics.microsPerParagraph << " us/paragraph" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<Corpus> corpora;
+  corpora.push_back(
+      buildLatinCorpus("english", "en", "test/hyphenation_eval/resources/english_hyphenation_tests.txt", true));
+  corpora.push_back(
+      buildLatinCorpus("german", "de", "test/hyphenation_eval/resources/german_hyphenation_tests.txt", true));
+  corpora.push_back(
+      buildLatinCorpus("english-left", "en", "test/hyphenation_eval/resources/english_hyphenation_tests.txt", false));
+  corpora.push_back(buildCjkCorpus("cjk", false));
+  corpora.push_back(buildCjkCorpus("cjk+latin", true));
+
+  int failures = 0;
+  for (const auto& corpus : corpora) {
+    if (corpus.paragraphs.empty()) {
+      std::cerr << "No paragraphs for " << corpus.name << ", run from the repository root" << std::endl;
+      failures++;
+      continue;
+    }
+    const LineBreaker::Params params{kLineWidth, kLineWidth, kSpaceWidth, corpus.justified};
+
+    const Metrics greedy = evaluate(corpus, greedyBreaks);
+    const Metrics optimal = evaluate(corpus, [&params](const Paragraph& paragraph) {
+      std::vector<LineBreaker::Break> breaks;
+      LineBreaker::computeBreaks(paragraph.wordWidths, paragraph.continuesVec, paragraph.wordIsCjkVec,
+                                 paragraph.wordClasses, paragraph.splits, params, breaks);
+      return breaks;
+    });
+
+    std::cout << corpus.name << " (" << corpus.paragraphs.size() << " paragraphs)" << std::endl;
+    printMetrics("greedy ", greedy);
+    printMetrics("optimal", optimal);
+    if (optimal.overfullLines > greedy.overfullLines) {
+      std::cout << "  FAIL: optimal layout has more overfull lines" << std::endl;
+      failures++;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+// Host stand-in for the ESP32 HTTPClient: GET requests over a WiFiClient, which is all a local test server needs.
+// http:// URLs only, no redirects, and chunked bodies are passed on undecoded.
+
+#include <WString.h>
+#include <WiFiClient.h>
+#include <strings.h>
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum followRedirects_t {
+  HTTPC_DISABLE_FOLLOW_REDIRECTS,
+  HTTPC_STRICT_FOLLOW_REDIRECTS,
+  HTTPC_FORCE_FOLLOW_REDIRECTS,
+};
+
+constexpr int HTTPC_ERROR_CONNECTION_REFUSED = -1;
+constexpr int HTTPC_ERROR_SEND_HEADER_FAILED = -2;
+constexpr int HTTPC_ERROR_NOT_CONNECTED = -4;
+constexpr int HTTPC_ERROR_CONNECTION_LOST = -5;
+
+enum t_http_codes {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_PARTIAL_CONTENT = 206,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_RANGE_NOT_SATISFIABLE = 416,
+};
+
+class HTTPClient {
+  WiFiClient* client = nullptr;
+  std::string host;
+  uint16_t port = 80;
+  std::string path;
+  bool http10 = false;
+  std::vector<std::pair<std::string, std::string>> requestHeaders;
+  std::vector<std::pair<std::string, std::string>> collected;
+  int size = -1;
+
+  // One header line without the CRLF, false if the connection closed first
+  bool readLine(std::string& line) {
+    line.clear();
+    while (true) {
+      const int c = client->read();
+      if (c < 0) {
+        return false;
+      }
+      if (c == '\n') {
+        if (!line.empty() && line.back() == '\r') {
+          line.pop_back();
+        }
+        return true;
+      }
+      line.push_back(static_cast<char>(c));
+    }
+  }
+
+ public:
+  ~HTTPClient() { end(); }
+
+  bool begin(WiFiClient& wifiClient, const char* url) {
+    client = &wifiClient;
+    std::string rest(url);
+    if (rest.compare(0, 7, "http://") != 0) {
+      return false;
+    }
+    rest = rest.substr(7);
+    const size_t slash = rest.find('/');
+    path = slash == std::string::npos ? "/" : rest.substr(slash);
+    host = rest.substr(0, slash);
+    const size_t colon = host.find(':');
+    if (colon != std::string::npos) {
+      port = static_cast<uint16_t>(atoi(host.c_str() + colon + 1));
+      host.resize(colon);
+    }
+    return true;
+  }
+
+  void setFollowRedirects(followRedirects_t) {}
+  void useHTTP10(const bool enabled) { http10 = enabled; }
+
+  void addHeader(const String& name, const String& value) { requestHeaders.emplace_back(name.c_str(), value.c_str()); }
+
+  void collectHeaders(const char* keys[], const size_t count) {
+    collected.clear();
+    for (size_t i = 0; i < count; i++) {
+      collected.emplace_back(keys[i], "");
+    }
+  }
+
+  String header(const char* name) const {
+    for (const auto& [key, value] : collected) {
+      if (strcasecmp(key.c_str(), name) == 0) {
+        return String(value.c_str());
+      }
+    }
+    return String("");
+  }
+
+  int GET() {
+    if (!client || !client->connect(host.c_str(), port)) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    std::string request = "GET " + path + (http10 ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n");
+    request += "Host: " + host + "\r\nConnection: close\r\n";
+    for (const auto& [name, value] : requestHeaders) {
+      request += name + ": " + value + "\r\n";
+    }
+    request += "\r\n";
+    if (client->write(reinterpret_cast<const uint8_t*>(request.data()), request.size()) != request.size()) {
+      return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+
+    std::string line;
+    if (!readLine(line) || line.compare(0, 5, "HTTP/") != 0 || line.find(' ') == std::string::npos) {
+      return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    const int code = atoi(line.c_str() + line.find(' ') + 1);
+    while (true) {
+      if (!readLine(line)) {
+        return HTTPC_ERROR_CONNECTION_LOST;
+      }
+      if (line.empty()) {
+        break;
+      }
+      const size_t colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      const std::string name = line.substr(0, colon);
+      const size_t start = line.find_first_not_of(' ', colon + 1);
+      const std::string value = start == std::string::npos ? "" : line.substr(start);
+      if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+        size = atoi(value.c_str());
+      }
+      for (auto& [key, collectedValue] : collected) {
+        if (strcasecmp(key.c_str(), name.c_str()) == 0) {
+          collectedValue = value;
+        }
+      }
+    }
+    return code;
+  }
+
+  int getSize() const { return size; }
+  WiFiClient* getStreamPtr() { return client; }
+  bool connected() { return client && client->connected(); }
+
+  int writeToStream(Stream* stream) {
+    uint8_t buffer[1024];
+    int written = 0;
+    while (size < 0 || written < size) {
+      const size_t count = client->readBytes(buffer, sizeof(buffer));
+      if (count == 0) {
+        if (!client->connected()) {
+          break;
+        }
+        continue;
+      }
+      stream->write(buffer, count);
+      written += static_cast<int>(count);
+    }
+    return size < 0 || written == size ? written : HTTPC_ERROR_CONNECTION_LOST;
+  }
+
+  void end() {
+    if (client) {
+      client->stop();
+      client = nullptr;
+    }
+    requestHeaders.clear();
+    size = -1;
+  }
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// Host stand-in for Arduino's StreamString, a Stream that collects what is written into a string
+
+#include <Stream.h>
+
+#include <string>
+
+class StreamString : public Stream {
+  std::string value;
+  size_t readPos = 0;
+
+ public:
+  size_t write(uint8_t b) override {
+    value.push_back(static_cast<char>(b));
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, const size_t size) override {
+    value.append(reinterpret_cast<const char*>(buffer), size);
+    return size;
+  }
+  int available() override { return static_cast<int>(value.size() - readPos); }
+  int read() override { return readPos < value.size() ? static_cast<uint8_t>(value[readPos++]) : -1; }
+  const char* c_str() const { return value.c_str(); }
+  size_t length() const { return value.size(); }
+};
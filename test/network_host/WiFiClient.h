@@ -0,0 +1,96 @@
+#pragma once
+
+// Host stand-in for the ESP32 WiFiClient: a plain TCP connection over POSIX sockets
+
+#include <Stream.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+class WiFiClient : public Stream {
+  int fd = -1;
+
+ public:
+  WiFiClient() = default;
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+  virtual ~WiFiClient() { stop(); }
+
+  virtual int connect(const char* host, const uint16_t port) {
+    stop();
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) {
+      return 0;
+    }
+    for (const addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+      fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+      if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(addresses);
+    return fd >= 0 ? 1 : 0;
+  }
+
+  size_t write(const uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buffer, const size_t size) override {
+    size_t sent = 0;
+    while (fd >= 0 && sent < size) {
+      const ssize_t count = send(fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+      if (count <= 0) {
+        break;
+      }
+      sent += count;
+    }
+    return sent;
+  }
+
+  int available() override {
+    int count = 0;
+    return fd >= 0 && ioctl(fd, FIONREAD, &count) == 0 ? count : 0;
+  }
+
+  int read() override {
+    uint8_t b;
+    return readBytes(&b, 1) == 1 ? b : -1;
+  }
+
+  // Waits up to a second for the first byte, like Stream's timeout
+  size_t readBytes(uint8_t* buffer, const size_t length) override {
+    pollfd readable{fd, POLLIN, 0};
+    if (fd < 0 || length == 0 || poll(&readable, 1, 1000) <= 0) {
+      return 0;
+    }
+    const ssize_t count = recv(fd, buffer, length, 0);
+    return count > 0 ? count : 0;
+  }
+
+  // Open until the peer has closed and everything it sent was read
+  bool connected() {
+    if (fd < 0) {
+      return false;
+    }
+    uint8_t b;
+    const ssize_t count = recv(fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    return count > 0 || (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+  }
+
+  void stop() {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the ESP32 WiFiClientSecure. The tests only talk plain HTTP to a local server, so this is a
+// WiFiClient that accepts the TLS settings.
+
+#include <WiFiClient.h>
+
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// Host stand-in for the ESP32 core's base64 helper
+
+#include <WString.h>
+
+#include <cstring>
+#include <string>
+
+class base64 {
+ public:
+  static String encode(const String& text) {
+    static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const auto* data = reinterpret_cast<const uint8_t*>(text.c_str());
+    const size_t size = text.length();
+    std::string encoded;
+    for (size_t i = 0; i < size; i += 3) {
+      const uint32_t chunk = data[i] << 16 | (i + 1 < size ? data[i + 1] << 8 : 0) | (i + 2 < size ? data[i + 2] : 0);
+      encoded += alphabet[chunk >> 18 & 63];
+      encoded += alphabet[chunk >> 12 & 63];
+      encoded += i + 1 < size ? alphabet[chunk >> 6 & 63] : '=';
+      encoded += i + 2 < size ? alphabet[chunk & 63] : '=';
+    }
+    return String(encoded.c_str());
+  }
+};
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF task watchdog, which has nothing to watch here
+
+inline void esp_task_wdt_reset() {}
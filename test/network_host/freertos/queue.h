@@ -0,0 +1,64 @@
+#pragma once
+
+// Host stand-in for FreeRTOS queues: fixed-size items copied in and out, guarded by a mutex
+
+#include <freertos/FreeRTOS.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct HostQueue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t itemSize;
+};
+
+using QueueHandle_t = HostQueue*;
+
+inline QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t itemSize) {
+  auto* queue = new HostQueue;
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+inline void vQueueDelete(const QueueHandle_t queue) { delete queue; }
+
+namespace HostQueueDetail {
+template <typename Predicate>
+bool waitFor(HostQueue* queue, std::unique_lock<std::mutex>& lock, const TickType_t ticks, Predicate ready) {
+  if (ticks == portMAX_DELAY) {
+    queue->changed.wait(lock, ready);
+    return true;
+  }
+  return queue->changed.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+}
+}  // namespace HostQueueDetail
+
+inline BaseType_t xQueueSend(const QueueHandle_t queue, const void* item, const TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!HostQueueDetail::waitFor(queue, lock, ticks, [queue] { return queue->items.size() < queue->length; })) {
+    return pdFAIL;
+  }
+  const auto* bytes = static_cast<const uint8_t*>(item);
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+inline BaseType_t xQueueReceive(const QueueHandle_t queue, void* item, const TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!HostQueueDetail::waitFor(queue, lock, ticks, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
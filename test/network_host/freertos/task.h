@@ -0,0 +1,61 @@
+#pragma once
+
+// Host stand-in for FreeRTOS tasks: each task is a detached thread. A task ends with vTaskDelete(nullptr), which here
+// just lets the task function return; deleting another task is not supported. A thread's handle, from
+// xTaskGetCurrentTaskHandle(), is its notification counter.
+
+#include <freertos/FreeRTOS.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using TaskFunction_t = void (*)(void*);
+using TaskHandle_t = void*;
+
+inline BaseType_t xTaskCreate(const TaskFunction_t function, const char*, uint32_t, void* param, UBaseType_t,
+                              TaskHandle_t* handle) {
+  std::thread(function, param).detach();
+  if (handle) {
+    *handle = nullptr;
+  }
+  return pdPASS;
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
+
+inline void vTaskDelay(const TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+struct HostTaskNotification {
+  std::mutex mutex;
+  std::condition_variable given;
+  uint32_t count = 0;
+};
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  thread_local HostTaskNotification notification;
+  return &notification;
+}
+
+inline BaseType_t xTaskNotifyGive(const TaskHandle_t task) {
+  auto* notification = static_cast<HostTaskNotification*>(task);
+  std::lock_guard<std::mutex> lock(notification->mutex);
+  notification->count++;
+  notification->given.notify_one();
+  return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(const BaseType_t clearOnExit, const TickType_t ticks) {
+  auto* notification = static_cast<HostTaskNotification*>(xTaskGetCurrentTaskHandle());
+  std::unique_lock<std::mutex> lock(notification->mutex);
+  const auto given = [notification] { return notification->count > 0; };
+  if (ticks == portMAX_DELAY) {
+    notification->given.wait(lock, given);
+  } else if (!notification->given.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), given)) {
+    return 0;
+  }
+  const uint32_t count = notification->count;
+  notification->count = clearOnExit ? 0 : count - 1;
+  return count;
+}
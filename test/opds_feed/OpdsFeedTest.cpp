@@ -0,0 +1,422 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <OpdsEntryList.h>
+#include <OpdsParser.h>
+#include <OpdsStream.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CrossPointSettings.h"
+#include "network/HttpDownloader.h"
+#include "network/OpdsFeedCache.h"
+
+// Browses paginated feeds from test/http_download/fixture_server.py the way OpdsBookBrowserActivity does, once
+// collecting every entry in a vector as the browser did before and once handing them to an OpdsEntryList as they are
+// parsed. The run script starts the server and passes its port.
+//
+// Checked: both see the same entries, the list hands them back from any window and across appended next pages, the
+// rel="next" link is found, long titles are cut at a character boundary, and the list's peak heap doesn't grow with
+// the feed. Time to the first screen and peak heap of both are printed.
+//
+// Feeds are then browsed through OpdsFeedCache. Checked: a feed opened again shortly after comes from the card without
+// a request, an older copy is revalidated with a 304 and no body, a changed feed is downloaded again, offline mode
+// serves cached feeds only and never connects, a cached copy stands in while the server is down, a feed that broke
+// off is not cached, and the cache keeps to its feed count and size by dropping the least recently used feeds.
+
+// The downloader only reads the OPDS credentials, so the settings are the defaults rather than settings.cpp's
+CrossPointSettings CrossPointSettings::instance;
+
+// Heap in use and its peak, counted for every operator new. Expat allocates with malloc() and isn't counted, it is the
+// same for both ways of browsing.
+namespace {
+std::atomic<size_t> heapInUse{0};
+std::atomic<size_t> heapPeak{0};
+}  // namespace
+
+void* operator new(const size_t size) {
+  void* block = malloc(size);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  const size_t inUse = heapInUse += malloc_usable_size(block);
+  size_t peak = heapPeak;
+  while (inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse)) {
+  }
+  return block;
+}
+
+void operator delete(void* pointer) noexcept {
+  heapInUse -= malloc_usable_size(pointer);
+  free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+
+namespace {
+
+// The browser's PAGE_ITEMS
+constexpr size_t SCREEN_ENTRIES = 23;
+constexpr int FEED_ENTRIES = 2000;
+constexpr int FEED_PAGES = 3;
+constexpr char ENTRIES_FILE[] = "/.crosspoint/opds/entries.bin";
+
+std::string baseUrl;
+std::string cardRoot;
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "  FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+std::string feedPath(const int entries, const int page, const int pages) {
+  return "/feed/" + std::to_string(entries) + "/" + std::to_string(page) + "/" + std::to_string(pages);
+}
+
+double msSince(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Measurement {
+  double firstScreenMs = 0;
+  double totalMs = 0;
+  size_t peakHeap = 0;
+};
+
+// As the browser did before: the whole feed into a vector, shown once it is complete
+Measurement collectAll(const std::string& path, std::vector<OpdsEntry>& entries, std::string& nextHref) {
+  const size_t base = heapInUse;
+  heapPeak = base;
+  const auto start = std::chrono::steady_clock::now();
+  {
+    OpdsParser parser;
+    {
+      OpdsParserStream stream{parser};
+      check(HttpDownloader::fetchUrl(baseUrl + path, stream), "feed fetched");
+    }
+    check(static_cast<bool>(parser), "feed parsed");
+    entries = std::move(parser).getEntries();
+    nextHref = parser.getNextHref();
+  }
+  Measurement result;
+  result.totalMs = msSince(start);
+  result.firstScreenMs = result.totalMs;
+  result.peakHeap = heapPeak - base;
+  return result;
+}
+
+// As the browser does now: entries into the list as they are parsed, shown once a screen of them is there
+Measurement streamToList(const std::string& path, OpdsEntryList& list, std::string& nextHref) {
+  const size_t base = heapInUse;
+  heapPeak = base;
+  const auto start = std::chrono::steady_clock::now();
+  Measurement result;
+  const size_t firstScreenEnd = (list.size() / SCREEN_ENTRIES + 1) * SCREEN_ENTRIES;
+  {
+    OpdsParser parser;
+    parser.onEntry([&](const OpdsEntry& entry) {
+      list.add(entry);
+      if (list.size() == firstScreenEnd) {
+        result.firstScreenMs = msSince(start);
+      }
+    });
+    {
+      OpdsParserStream stream{parser};
+      check(HttpDownloader::fetchUrl(baseUrl + path, stream), "feed fetched");
+    }
+    check(static_cast<bool>(parser), "feed parsed");
+    nextHref = parser.getNextHref();
+  }
+  result.totalMs = msSince(start);
+  result.peakHeap = heapPeak - base;
+  return result;
+}
+
+bool sameEntry(const OpdsEntry* listed, const OpdsEntry& expected) {
+  return listed && listed->type == expected.type && listed->title == expected.title &&
+         listed->author == expected.author && listed->href == expected.href;
+}
+
+void testFirstPage() {
+  std::cout << "first page of a " << FEED_ENTRIES << " entry feed" << std::endl;
+  std::vector<OpdsEntry> expected;
+  std::string expectedNext;
+  const Measurement before = collectAll(feedPath(FEED_ENTRIES, 1, FEED_PAGES), expected, expectedNext);
+
+  OpdsEntryList list;
+  check(list.begin(ENTRIES_FILE, SCREEN_ENTRIES), "spill file opened");
+  std::string next;
+  const Measurement after = streamToList(feedPath(FEED_ENTRIES, 1, FEED_PAGES), list, next);
+
+  check(expected.size() == FEED_ENTRIES, "all entries collected");
+  check(list.size() == expected.size(), "all entries listed");
+  check(expectedNext == feedPath(FEED_ENTRIES, 2, FEED_PAGES) && next == expectedNext, "next page link found");
+  check(expected[0].type == OpdsEntryType::NAVIGATION && expected[1].type == OpdsEntryType::BOOK,
+        "navigation and book entries");
+
+  // Screens in no particular order, as scrolling back and forth reads them
+  std::vector<size_t> order(list.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(7));
+  bool allSame = list.size() == expected.size();
+  for (size_t i = 0; i < order.size() && allSame; i++) {
+    allSame = sameEntry(list.get(order[i]), expected[order[i]]);
+  }
+  check(allSame, "every entry read back from any window");
+  check(list.get(list.size()) == nullptr, "nothing past the end");
+
+  check(after.firstScreenMs > 0 && after.firstScreenMs < after.totalMs / 4, "first screen long before the feed ends");
+  check(after.peakHeap < before.peakHeap / 4, "less heap than collecting the feed");
+  printf("  collected: first screen %.0f ms, peak heap %zu KB\n", before.firstScreenMs, before.peakHeap / 1024);
+  printf("  streamed:  first screen %.0f ms of %.0f ms, peak heap %zu KB\n", after.firstScreenMs, after.totalMs,
+         after.peakHeap / 1024);
+}
+
+void testNextPages() {
+  std::cout << "next pages appended" << std::endl;
+  OpdsEntryList list;
+  list.begin(ENTRIES_FILE, SCREEN_ENTRIES);
+  std::string next = feedPath(FEED_ENTRIES, 1, FEED_PAGES);
+  int pages = 0;
+  size_t firstPagePeak = 0;
+  size_t largestPeak = 0;
+  while (!next.empty() && pages < FEED_PAGES + 1) {
+    const Measurement page = streamToList(std::string(next), list, next);
+    firstPagePeak = pages == 0 ? page.peakHeap : firstPagePeak;
+    largestPeak = std::max(largestPeak, page.peakHeap);
+    pages++;
+  }
+  check(pages == FEED_PAGES, "followed to the last page");
+  check(list.size() == static_cast<size_t>(FEED_ENTRIES * FEED_PAGES), "entries of every page");
+  const OpdsEntry* last = list.get(list.size() - 1);
+  check(last && last->title == "Book " + std::to_string(FEED_ENTRIES * FEED_PAGES - 1), "numbered across pages");
+  const OpdsEntry* first = list.get(0);
+  check(first && first->title == "Shelf 0", "first page still there");
+  // The window offsets are all that grows, 4 bytes a screen
+  check(largestPeak < firstPagePeak + 1024, "later pages take no more heap");
+
+  list.clear();
+  check(list.empty() && list.get(0) == nullptr, "cleared");
+  list.end();
+  check(!Storage.exists(ENTRIES_FILE), "spill file removed");
+}
+
+void testShortFeedAndSmallHeap() {
+  std::cout << "feed size" << std::endl;
+  OpdsEntryList list;
+  list.begin(ENTRIES_FILE, SCREEN_ENTRIES);
+  std::string next;
+  const Measurement small = streamToList(feedPath(100, 1, 1), list, next);
+  check(list.size() == 100 && next.empty(), "single page feed");
+  check(list.get(99) && list.get(99)->title == "Book 99", "last entry of a short window");
+  list.clear();
+  const Measurement large = streamToList(feedPath(FEED_ENTRIES * 2, 1, 1), list, next);
+  check(list.size() == static_cast<size_t>(FEED_ENTRIES * 2), "long feed");
+  check(large.peakHeap < small.peakHeap + 2048, "peak heap independent of the feed length");
+}
+
+void testLongTitle() {
+  std::cout << "long title" << std::endl;
+  // 2-byte characters after an odd number of ASCII ones, so the limit falls inside a character
+  std::string title = "x";
+  for (int i = 0; i < 400; i++) {
+    title += "\xC3\xA9";
+  }
+  const std::string feed = "<feed xmlns=\"http://www.w3.org/2005/Atom\"><entry><title>" + title +
+                           "</title><link rel=\"http://opds-spec.org/acquisition\" href=\"/a.epub\" "
+                           "type=\"application/epub+zip\"/></entry></feed>";
+  OpdsParser parser;
+  parser.write(reinterpret_cast<const uint8_t*>(feed.data()), feed.size());
+  parser.flush();
+  const auto& entries = parser.getEntries();
+  check(entries.size() == 1, "entry parsed");
+  if (!entries.empty()) {
+    const std::string& parsed = entries[0].title;
+    check(parsed.size() <= OpdsParser::MAX_TEXT_LENGTH && parsed.size() >= OpdsParser::MAX_TEXT_LENGTH - 1,
+          "title cut at the limit");
+    check(parsed.size() % 2 == 1 && title.compare(0, parsed.size(), parsed) == 0, "cut between characters");
+  }
+}
+
+using Result = OpdsFeedCache::Result;
+
+// Requests and body bytes the server handled since the last call
+long serverRequests(long* bytes = nullptr) {
+  std::string stats;
+  if (!HttpDownloader::fetchUrl(baseUrl + "/stats", stats)) {
+    return -1;
+  }
+  if (bytes) {
+    *bytes = strtol(stats.c_str() + stats.find("\"bytes\": ") + 9, nullptr, 10);
+  }
+  return strtol(stats.c_str() + stats.find("\"requests\": ") + 12, nullptr, 10);
+}
+
+void serverCall(const char* path) {
+  std::string ignored;
+  HttpDownloader::fetchUrl(baseUrl + path, ignored);
+}
+
+// Stands in for the browser's rendering mutex
+bool cardHeld = false;
+int cardLocks = 0;
+int lockMisuse = 0;
+
+void lockCard(OpdsFeedCache& cache) {
+  cache.setCardLock([](const bool locked) {
+    lockMisuse += cardHeld == locked;
+    cardHeld = locked;
+    cardLocks += locked;
+  });
+}
+
+// Opens a feed the way the browser does, the entry titles in `titles`
+Result browse(OpdsFeedCache& cache, const std::string& path, const bool offline, std::vector<std::string>& titles) {
+  titles.clear();
+  OpdsParser parser;
+  parser.onEntry([&titles](const OpdsEntry& entry) {
+    // The browser takes the mutex itself to add an entry
+    lockMisuse += cardHeld;
+    titles.push_back(entry.title);
+  });
+  const Result result = cache.fetch(baseUrl + path, parser, offline);
+  parser.flush();
+  return result;
+}
+
+size_t cachedFiles() {
+  size_t count = 0;
+  std::error_code missing;
+  for (const auto& file : std::filesystem::directory_iterator(cardRoot + "/.crosspoint/opds/feeds", missing)) {
+    count += file.path().extension() == ".xml";
+  }
+  return count;
+}
+
+void testFeedCache() {
+  std::cout << "feed cache" << std::endl;
+  const std::string path = feedPath(50, 1, 1);
+  std::vector<std::string> first;
+  std::vector<std::string> titles;
+  long bytes = 0;
+  serverRequests();
+
+  OpdsFeedCache cache;
+  lockCard(cache);
+  auto start = std::chrono::steady_clock::now();
+  check(browse(cache, path, false, first) == Result::DOWNLOADED, "downloaded");
+  const double downloadMs = msSince(start);
+  check(first.size() == 50 && serverRequests() == 1, "one request");
+
+  // Back up a level shortly after
+  start = std::chrono::steady_clock::now();
+  check(browse(cache, path, false, titles) == Result::CACHED && titles == first, "opened again from the card");
+  const double cachedMs = msSince(start);
+  check(serverRequests() == 0, "without asking the server");
+  printf("  downloaded in %.0f ms, opened again in %.1f ms\n", downloadMs, cachedMs);
+
+  // Later, after a reboot: the index is read back and the copy revalidated
+  OpdsFeedCache revalidating(0);
+  lockCard(revalidating);
+  check(browse(revalidating, path, false, titles) == Result::NOT_MODIFIED && titles == first, "revalidated");
+  check(serverRequests(&bytes) == 1 && bytes == 0, "304 without a body");
+
+  serverCall("/bump");
+  check(browse(revalidating, path, false, titles) == Result::DOWNLOADED, "changed feed downloaded");
+  check(titles.size() == 50 && titles[1] == "Book 1 (edition 1)", "new entries shown");
+  serverRequests();
+
+  std::cout << "offline mode" << std::endl;
+  OpdsFeedCache offline;
+  check(browse(offline, path, true, titles) == Result::CACHED && titles[1] == "Book 1 (edition 1)",
+        "cached feed shown");
+  check(browse(offline, feedPath(60, 1, 1), true, titles) == Result::NOT_CACHED && titles.empty(),
+        "uncached feed not shown");
+  check(serverRequests() == 0, "no connection");
+
+  std::cout << "server down" << std::endl;
+  serverCall("/outage");
+  check(browse(revalidating, path, false, titles) == Result::CACHED && titles.size() == 50, "cached copy shown");
+  check(browse(revalidating, feedPath(60, 1, 1), false, titles) == Result::FAILED, "uncached feed fails");
+  serverCall("/outage");
+
+  std::cout << "feed cut short" << std::endl;
+  const std::string cutPath = path + "?drop=3000";
+  check(browse(revalidating, cutPath, false, titles) == Result::FAILED, "download fails");
+  check(!titles.empty() && titles.size() < 50, "entries up to the break");
+  check(browse(revalidating, cutPath, true, titles) == Result::NOT_CACHED, "not cached");
+
+  std::cout << "card lock" << std::endl;
+  check(cardLocks > 0 && !cardHeld, "card locked and released");
+  check(lockMisuse == 0, "never nested or held while entries are added");
+}
+
+void testCacheLimits() {
+  std::cout << "cache limits" << std::endl;
+  std::vector<std::string> titles;
+  OpdsFeedCache cache(0);
+  cache.clear();
+  for (size_t i = 1; i <= OpdsFeedCache::MAX_FEEDS; i++) {
+    browse(cache, feedPath(static_cast<int>(i), 1, 1), false, titles);
+  }
+  check(cache.size() == OpdsFeedCache::MAX_FEEDS, "cache full");
+  // The first feed is used again, so the second is the least recently used
+  check(browse(cache, feedPath(1, 1, 1), false, titles) == Result::NOT_MODIFIED, "first feed used again");
+  browse(cache, feedPath(OpdsFeedCache::MAX_FEEDS + 1, 1, 1), false, titles);
+  check(cache.size() == OpdsFeedCache::MAX_FEEDS && cachedFiles() == OpdsFeedCache::MAX_FEEDS, "count kept");
+  check(browse(cache, feedPath(2, 1, 1), true, titles) == Result::NOT_CACHED, "least recently used dropped");
+  check(browse(cache, feedPath(1, 1, 1), true, titles) == Result::CACHED, "recently used kept");
+
+  cache.clear();
+  check(cachedFiles() == 0, "cleared");
+  // About 650 KB each, the fourth doesn't fit
+  for (int i = 0; i < 4; i++) {
+    browse(cache, feedPath(FEED_ENTRIES + i, 1, 1), false, titles);
+  }
+  check(cache.totalBytes() <= OpdsFeedCache::MAX_BYTES, "size kept");
+  check(cache.size() == 3 && cachedFiles() == 3, "oldest large feed dropped");
+  check(browse(cache, feedPath(FEED_ENTRIES, 1, 1), true, titles) == Result::NOT_CACHED, "the oldest one");
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "Usage: OpdsFeedTest <port> <card dir> [--verbose]\n");
+    return 2;
+  }
+  baseUrl = std::string("http://127.0.0.1:") + argv[1];
+  cardRoot = argv[2];
+  Serial.quiet = !(argc > 3 && strcmp(argv[3], "--verbose") == 0);
+  Storage.setRoot(cardRoot);
+
+  testFirstPage();
+  testNextPages();
+  testShortFeedAndSmallHeap();
+  testLongTitle();
+  testFeedCache();
+  testCacheLimits();
+
+  if (failures > 0) {
+    std::cout << failures << " failed checks" << std::endl;
+    return 1;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return 0;
+}
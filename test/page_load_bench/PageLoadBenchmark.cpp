@@ -0,0 +1,429 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/Epub/Epub/Page.h"
+
+// Compares loading pages from a section file the way the firmware did before page blobs (one SD read per field and
+// word, a std::string and three list nodes per word) with the current single-read, in-place parsing.
+//
+// Both layouts are written from the same generated pages. Reported per page: SD read calls, heap allocations and
+// load time. Host reads go through the stdio buffer, so on the device the difference in read calls costs far more
+// than the host timings show.
+
+namespace {
+size_t allocationCount = 0;
+}  // namespace
+
+void* operator new(const size_t size) {
+  allocationCount++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr int kRounds = 20;
+constexpr int kLinesPerPage = 28;
+constexpr int kLineWidth = 440;
+constexpr uint32_t kHeaderLutOffset = 4;  // Both files start with a placeholder u32 and then the LUT offset
+
+const char* kSectionPath = "build/page_load_bench/section.bin";
+const char* kLegacyPath = "build/page_load_bench/legacy.bin";
+
+struct GeneratedLine {
+  std::list<std::string> words;
+  std::list<uint16_t> xpos;
+  std::list<EpdFontFamily::Style> styles;
+};
+
+using GeneratedPage = std::vector<GeneratedLine>;
+
+struct Corpus {
+  std::string name;
+  std::vector<GeneratedPage> pages;
+};
+
+struct Metrics {
+  double readsPerPage = 0.0;
+  double allocationsPerPage = 0.0;
+  double microsPerPage = 0.0;
+};
+
+// Words of the hyphenation test data, repeated as often as they occur in the source book, in a fixed shuffled order
+std::vector<std::string> loadWordStream(const std::string& filename) {
+  std::vector<std::string> stream;
+  std::ifstream file(filename);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream iss(line);
+    std::string word, hyphenated, freq;
+    if (std::getline(iss, word, '|') && std::getline(iss, hyphenated, '|') && std::getline(iss, freq, '|')) {
+      for (int i = 0; i < std::max(1, std::stoi(freq)); i++) {
+        stream.push_back(word);
+      }
+    }
+  }
+
+  uint32_t state = 0x9E3779B9u;
+  for (size_t i = stream.size(); i > 1; i--) {
+    state = state * 1664525u + 1013904223u;
+    std::swap(stream[i - 1], stream[state % i]);
+  }
+  return stream;
+}
+
+Corpus buildLatinCorpus(const std::string& name, const std::string& file) {
+  Corpus corpus{name, {}};
+  const auto stream = loadWordStream(file);
+  const char* shortWords[] = {"a", "the", "of", "and", "to", "in", "it", "was", "he", "she", "on", "at"};
+
+  uint32_t state = 12345;
+  size_t cursor = 0;
+  while (cursor < stream.size() && corpus.pages.size() < 200) {
+    GeneratedPage page;
+    for (int l = 0; l < kLinesPerPage && cursor < stream.size(); l++) {
+      GeneratedLine line;
+      int x = 0;
+      while (cursor < stream.size()) {
+        state = state * 1664525u + 1013904223u;
+        const std::string word = (state >> 12) % 3 == 0 ? shortWords[(state >> 16) % 12] : stream[cursor++];
+        const int width = static_cast<int>(word.size()) * 8;
+        if (x + width > kLineWidth && !line.words.empty()) {
+          break;
+        }
+        line.words.push_back(word);
+        line.xpos.push_back(static_cast<uint16_t>(x));
+        line.styles.push_back((state >> 20) % 17 == 0 ? EpdFontFamily::ITALIC : EpdFontFamily::REGULAR);
+        x += width + 5;
+      }
+      page.push_back(std::move(line));
+    }
+    corpus.pages.push_back(std::move(page));
+  }
+  return corpus;
+}
+
+Corpus buildCjkCorpus(const std::string& name) {
+  static const char* text =
+      "清晨的雨落在小镇的石板路上，街角的面包店已经亮起了灯。"
+      "老板一边揉面，一边哼着不知名的曲子：「今天会是个好日子。」"
+      "孩子们背着书包跑过窗前，笑声在巷子里回荡。"
+      "远处的钟楼敲了七下，卖花的老人推着车慢慢走来，车上的花还带着露水。";
+  std::vector<std::string> chars;
+  for (const char* p = text; *p;) {
+    const auto lead = static_cast<unsigned char>(*p);
+    const size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    chars.emplace_back(p, length);
+    p += length;
+  }
+
+  Corpus corpus{name, {}};
+  size_t cursor = 0;
+  while (corpus.pages.size() < 100) {
+    GeneratedPage page;
+    for (int l = 0; l < kLinesPerPage; l++) {
+      GeneratedLine line;
+      for (int x = 0; x + 24 <= kLineWidth; x += 24) {
+        line.words.push_back(chars[cursor++ % chars.size()]);
+        line.xpos.push_back(static_cast<uint16_t>(x));
+        line.styles.push_back(EpdFontFamily::REGULAR);
+      }
+      page.push_back(std::move(line));
+    }
+    corpus.pages.push_back(std::move(page));
+  }
+  return corpus;
+}
+
+// The page format the firmware used before page blobs: length-prefixed words first, read one field at a time
+namespace legacy {
+
+struct TextBlock {
+  std::list<std::string> words;
+  std::list<uint16_t> wordXpos;
+  std::list<EpdFontFamily::Style> wordStyles;
+  BlockStyle blockStyle;
+};
+
+struct PageLine {
+  int16_t xPos;
+  int16_t yPos;
+  std::shared_ptr<TextBlock> block;
+};
+
+struct Page {
+  std::vector<std::shared_ptr<PageLine>> elements;
+
+  // Same text as ::Page::appendText() for the pages generated here, which have no hyphenated line ends
+  void appendText(std::string& out) const {
+    for (const auto& element : elements) {
+      bool first = true;
+      for (const auto& word : element->block->words) {
+        if (!first) {
+          out += ' ';
+        }
+        out += word;
+        first = false;
+      }
+      out += '\n';
+    }
+  }
+};
+
+void writeBlockStyle(FsFile& file, const BlockStyle& style) {
+  serialization::writePod(file, style.alignment);
+  serialization::writePod(file, style.textAlignDefined);
+  serialization::writePod(file, style.marginTop);
+  serialization::writePod(file, style.marginBottom);
+  serialization::writePod(file, style.marginLeft);
+  serialization::writePod(file, style.marginRight);
+  serialization::writePod(file, style.paddingTop);
+  serialization::writePod(file, style.paddingBottom);
+  serialization::writePod(file, style.paddingLeft);
+  serialization::writePod(file, style.paddingRight);
+  serialization::writePod(file, style.textIndent);
+  serialization::writePod(file, style.textIndentDefined);
+}
+
+void readBlockStyle(FsFile& file, BlockStyle& style) {
+  serialization::readPod(file, style.alignment);
+  serialization::readPod(file, style.textAlignDefined);
+  serialization::readPod(file, style.marginTop);
+  serialization::readPod(file, style.marginBottom);
+  serialization::readPod(file, style.marginLeft);
+  serialization::readPod(file, style.marginRight);
+  serialization::readPod(file, style.paddingTop);
+  serialization::readPod(file, style.paddingBottom);
+  serialization::readPod(file, style.paddingLeft);
+  serialization::readPod(file, style.paddingRight);
+  serialization::readPod(file, style.textIndent);
+  serialization::readPod(file, style.textIndentDefined);
+}
+
+void writePage(FsFile& file, const GeneratedPage& page) {
+  serialization::writePod(file, static_cast<uint16_t>(page.size()));
+  int16_t y = 0;
+  for (const auto& line : page) {
+    serialization::writePod(file, static_cast<uint8_t>(TAG_PageLine));
+    serialization::writePod(file, static_cast<int16_t>(0));
+    serialization::writePod(file, y);
+    y = static_cast<int16_t>(y + 24);
+    serialization::writePod(file, static_cast<uint16_t>(line.words.size()));
+    for (const auto& w : line.words) serialization::writeString(file, w);
+    for (auto x : line.xpos) serialization::writePod(file, x);
+    for (auto s : line.styles) serialization::writePod(file, s);
+    writeBlockStyle(file, BlockStyle());
+  }
+}
+
+std::unique_ptr<Page> readPage(FsFile& file) {
+  auto page = std::unique_ptr<Page>(new Page());
+  uint16_t count;
+  serialization::readPod(file, count);
+  for (uint16_t i = 0; i < count; i++) {
+    uint8_t tag;
+    serialization::readPod(file, tag);
+    auto line = std::make_shared<PageLine>();
+    serialization::readPod(file, line->xPos);
+    serialization::readPod(file, line->yPos);
+    auto block = std::make_shared<TextBlock>();
+    uint16_t wc;
+    serialization::readPod(file, wc);
+    block->words.resize(wc);
+    block->wordXpos.resize(wc);
+    block->wordStyles.resize(wc);
+    for (auto& w : block->words) serialization::readString(file, w);
+    for (auto& x : block->wordXpos) serialization::readPod(file, x);
+    for (auto& s : block->wordStyles) serialization::readPod(file, s);
+    readBlockStyle(file, block->blockStyle);
+    line->block = std::move(block);
+    page->elements.push_back(std::move(line));
+  }
+  return page;
+}
+
+}  // namespace legacy
+
+bool writeSectionFiles(const Corpus& corpus) {
+  FsFile currentFile;
+  FsFile old;
+  if (!currentFile.open(kSectionPath, "wb") || !old.open(kLegacyPath, "wb")) {
+    return false;
+  }
+  BufferedFile current(currentFile);
+  const uint32_t placeholder = 0;
+  serialization::writePod(current, placeholder);
+  serialization::writePod(current, placeholder);
+  serialization::writePod(old, placeholder);
+  serialization::writePod(old, placeholder);
+
+  std::vector<std::pair<uint32_t, uint32_t>> lut;
+  std::vector<uint32_t> legacyLut;
+  for (const auto& generated : corpus.pages) {
+    Page page;
+    int16_t y = 0;
+    for (const auto& line : generated) {
+      auto block = std::make_shared<TextBlock>(line.words, line.xpos, line.styles);
+      page.elements.push_back(std::make_shared<PageLine>(std::move(block), 0, y));
+      y = static_cast<int16_t>(y + 24);
+    }
+    const auto offset = static_cast<uint32_t>(current.position());
+    page.serialize(current);
+    lut.emplace_back(offset, static_cast<uint32_t>(current.position()) - offset);
+
+    legacyLut.push_back(static_cast<uint32_t>(old.position()));
+    legacy::writePage(old, generated);
+  }
+
+  const auto lutOffset = static_cast<uint32_t>(current.position());
+  for (const auto& entry : lut) {
+    serialization::writePod(current, entry.first);
+    serialization::writePod(current, entry.second);
+  }
+  current.seek(kHeaderLutOffset);
+  serialization::writePod(current, lutOffset);
+
+  const auto legacyLutOffset = static_cast<uint32_t>(old.position());
+  for (const auto offset : legacyLut) {
+    serialization::writePod(old, offset);
+  }
+  old.seek(kHeaderLutOffset);
+  serialization::writePod(old, legacyLutOffset);
+  return current.flush();
+}
+
+// Mirrors Section::loadPageFromSectionFile()
+std::unique_ptr<Page> loadPage(FsFile& file, const int pageIndex, std::shared_ptr<std::vector<uint8_t>>& buffer) {
+  file.seek(kHeaderLutOffset);
+  uint32_t lutOffset;
+  serialization::readPod(file, lutOffset);
+  file.seek(lutOffset + 2 * sizeof(uint32_t) * pageIndex);
+  uint32_t offset, length;
+  serialization::readPod(file, offset);
+  serialization::readPod(file, length);
+  if (!buffer || buffer.use_count() > 1) {
+    buffer = std::make_shared<std::vector<uint8_t>>();
+  }
+  buffer->resize(length);
+  file.seek(offset);
+  if (file.read(buffer->data(), length) != static_cast<int>(length)) {
+    return nullptr;
+  }
+  return Page::deserialize(buffer);
+}
+
+// Mirrors the former Section::loadPageFromSectionFile()
+std::unique_ptr<legacy::Page> loadLegacyPage(FsFile& file, const int pageIndex) {
+  file.seek(kHeaderLutOffset);
+  uint32_t lutOffset;
+  serialization::readPod(file, lutOffset);
+  file.seek(lutOffset + sizeof(uint32_t) * pageIndex);
+  uint32_t offset;
+  serialization::readPod(file, offset);
+  file.seek(offset);
+  return legacy::readPage(file);
+}
+
+template <typename LoadFn>
+Metrics measure(const size_t pageCount, LoadFn load) {
+  FsFile::resetCounters();
+  const size_t allocationsBefore = allocationCount;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; round++) {
+    for (size_t p = 0; p < pageCount; p++) {
+      load(static_cast<int>(p));
+    }
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double loads = static_cast<double>(pageCount) * kRounds;
+  Metrics metrics;
+  metrics.readsPerPage = static_cast<double>(FsFile::readCalls) / loads;
+  metrics.allocationsPerPage = static_cast<double>(allocationCount - allocationsBefore) / loads;
+  metrics.microsPerPage = std::chrono::duration<double, std::micro>(elapsed).count() / loads;
+  return metrics;
+}
+
+void printMetrics(const char* label, const Metrics& metrics) {
+  std::cout << "  " << label << ": " << metrics.readsPerPage << " reads, " << metrics.allocationsPerPage
+            << " allocations, " << metrics.microsPerPage << " us per page" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  Serial.quiet = true;
+  std::vector<Corpus> corpora;
+  corpora.push_back(buildLatinCorpus("english", "test/hyphenation_eval/resources/english_hyphenation_tests.txt"));
+  corpora.push_back(buildLatinCorpus("german", "test/hyphenation_eval/resources/german_hyphenation_tests.txt"));
+  corpora.push_back(buildCjkCorpus("cjk"));
+
+  int failures = 0;
+  for (const auto& corpus : corpora) {
+    if (corpus.pages.empty()) {
+      std::cerr << "No pages for " << corpus.name << ", run from the repository root" << std::endl;
+      failures++;
+      continue;
+    }
+    if (!writeSectionFiles(corpus)) {
+      std::cerr << "Could not write " << kSectionPath << std::endl;
+      return 1;
+    }
+
+    FsFile current;
+    FsFile old;
+    current.open(kSectionPath, "rb");
+    old.open(kLegacyPath, "rb");
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+
+    // Both layouts have to decode to the same text
+    size_t mismatches = 0;
+    for (size_t p = 0; p < corpus.pages.size(); p++) {
+      std::string text;
+      std::string legacyText;
+      const auto page = loadPage(current, static_cast<int>(p), buffer);
+      if (page) {
+        page->appendText(text);
+      }
+      loadLegacyPage(old, static_cast<int>(p))->appendText(legacyText);
+      if (!page || text != legacyText) {
+        mismatches++;
+      }
+    }
+
+    const Metrics before = measure(corpus.pages.size(), [&old](const int p) { loadLegacyPage(old, p); });
+    const Metrics after =
+        measure(corpus.pages.size(), [&current, &buffer](const int p) { loadPage(current, p, buffer); });
+
+    std::cout << corpus.name << " (" << corpus.pages.size() << " pages)" << std::endl;
+    printMetrics("per field", before);
+    printMetrics("page blob", after);
+    if (mismatches > 0) {
+      std::cout << "  FAIL: " << mismatches << " pages decode differently" << std::endl;
+      failures++;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,472 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HardwareSerial.h>
+#include <Utf8.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BuiltinFonts.h"
+#include "fontIds.h"
+
+// Compares the span-based rectangle primitives with drawing the same shapes one drawPixel() at a time, which is how
+// fillRect(), drawLine() and drawRect() used to work, in all four orientations.
+//
+// Every shape is drawn both ways and the frame buffers have to match, in light and dark mode, before it is timed.
+// Random rectangles, some of them partly off screen, check the clipping and the byte edge masks.
+//
+// Bitmaps drawn at their own size have to match a drawPixel() per source pixel, bitmaps of 2x2 blocks scaled to half
+// their size have to match the same bitmap drawn at half the size. A large cover is timed scaled down to the screen.
+//
+// truncatedText() has to match dropping one codepoint at a time until the text with its ellipsis measures less than
+// the width, which is how it used to work, for Latin, CJK and mixed titles in the UI, small and reader fonts. Reader
+// fonts are measured by their ink, which a sum of advances misses by a pixel at the cut.
+
+namespace {
+
+constexpr int kRounds = 200;
+constexpr int kRandomRects = 2000;
+constexpr int kBitmapRounds = 20;
+
+struct Orientation {
+  const char* name;
+  GfxRenderer::Orientation value;
+};
+
+constexpr Orientation kOrientations[] = {
+    {"portrait", GfxRenderer::Portrait},
+    {"landscape-cw", GfxRenderer::LandscapeClockwise},
+    {"inverted", GfxRenderer::PortraitInverted},
+    {"landscape-ccw", GfxRenderer::LandscapeCounterClockwise},
+};
+
+using DrawFn = std::function<void(const GfxRenderer&)>;
+
+struct Shape {
+  const char* name;
+  DrawFn perPixel;
+  DrawFn spans;
+};
+
+void fillPerPixel(const GfxRenderer& renderer, const int x, const int y, const int width, const int height,
+                  const bool state) {
+  const int left = std::max(x, 0);
+  const int top = std::max(y, 0);
+  const int right = std::min(x + width, renderer.getScreenWidth());
+  const int bottom = std::min(y + height, renderer.getScreenHeight());
+  for (int py = top; py < bottom; py++) {
+    for (int px = left; px < right; px++) {
+      renderer.drawPixel(px, py, state);
+    }
+  }
+}
+
+void outlinePerPixel(const GfxRenderer& renderer, const int x, const int y, const int width, const int height) {
+  fillPerPixel(renderer, x, y, width, 1, true);
+  fillPerPixel(renderer, x, y + height - 1, width, 1, true);
+  fillPerPixel(renderer, x, y, 1, height, true);
+  fillPerPixel(renderer, x + width - 1, y, 1, height, true);
+}
+
+// Shapes the UI draws, sized for the current orientation
+std::vector<Shape> uiShapes(const GfxRenderer& renderer) {
+  const int w = renderer.getScreenWidth();
+  const int h = renderer.getScreenHeight();
+  return {
+      {"row highlight", [w](const GfxRenderer& r) { fillPerPixel(r, 0, 93, w - 1, 30, true); },
+       [w](const GfxRenderer& r) { r.fillRect(0, 93, w - 1, 30); }},
+      {"popup", [](const GfxRenderer& r) { fillPerPixel(r, 37, 141, 301, 117, false); },
+       [](const GfxRenderer& r) { r.fillRect(37, 141, 301, 117, false); }},
+      {"horizontal line", [w](const GfxRenderer& r) { fillPerPixel(r, 3, 55, w - 6, 1, true); },
+       [w](const GfxRenderer& r) { r.drawLine(3, 55, w - 4, 55); }},
+      {"vertical line", [h](const GfxRenderer& r) { fillPerPixel(r, 21, 5, 1, h - 10, true); },
+       [h](const GfxRenderer& r) { r.drawLine(21, h - 6, 21, 5); }},
+      {"rect outline", [](const GfxRenderer& r) { outlinePerPixel(r, 13, 201, 250, 90); },
+       [](const GfxRenderer& r) { r.drawRect(13, 201, 250, 90); }},
+      {"full screen", [w, h](const GfxRenderer& r) { fillPerPixel(r, 0, 0, w, h, true); },
+       [w, h](const GfxRenderer& r) { r.fillRect(0, 0, w, h); }},
+  };
+}
+
+// Fills the screen with a pattern so that both set and cleared bits around a shape are checked
+void drawBackground(const GfxRenderer& renderer) {
+  uint8_t* buffer = renderer.getFrameBuffer();
+  for (uint32_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+    buffer[i] = static_cast<uint8_t>(i * 37 + (i >> 7));
+  }
+}
+
+bool sameResult(const GfxRenderer& renderer, const DrawFn& expected, const DrawFn& actual) {
+  static std::vector<uint8_t> reference(HalDisplay::BUFFER_SIZE);
+  drawBackground(renderer);
+  expected(renderer);
+  memcpy(reference.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE);
+  drawBackground(renderer);
+  actual(renderer);
+  return memcmp(reference.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE) == 0;
+}
+
+double microsPerCall(const GfxRenderer& renderer, const DrawFn& draw) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; round++) {
+    draw(renderer);
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kRounds;
+}
+
+// Random rectangles, some reaching past the screen edges; fillRect() has to match, invertRect() has to undo itself
+// and turn white into black
+int checkRandomRects(GfxRenderer& renderer, std::mt19937& random) {
+  int failures = 0;
+  std::vector<uint8_t> before(HalDisplay::BUFFER_SIZE);
+  std::uniform_int_distribution<int> position(-20, 820);
+  std::uniform_int_distribution<int> size(1, 120);
+  for (int i = 0; i < kRandomRects; i++) {
+    const int x = position(random);
+    const int y = position(random);
+    const int width = size(random);
+    const int height = i % 3 == 0 ? 1 : size(random);
+    const bool state = i % 2 == 0;
+    if (!sameResult(
+            renderer, [&](const GfxRenderer& r) { fillPerPixel(r, x, y, width, height, state); },
+            [&](const GfxRenderer& r) { r.fillRect(x, y, width, height, state); })) {
+      failures++;
+    }
+
+    drawBackground(renderer);
+    memcpy(before.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE);
+    renderer.invertRect(x, y, width, height);
+    renderer.invertRect(x, y, width, height);
+    if (memcmp(before.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE) != 0) {
+      failures++;
+    }
+    if (!sameResult(
+            renderer,
+            [&](const GfxRenderer& r) {
+              r.clearScreen();
+              fillPerPixel(r, x, y, width, height, true);
+            },
+            [&](const GfxRenderer& r) {
+              r.clearScreen();
+              r.invertRect(x, y, width, height);
+            })) {
+      failures++;
+    }
+  }
+  return failures;
+}
+
+using PixelFn = std::function<uint8_t(int, int)>;
+
+// BMP with a gray palette for 1 and 2 bits per pixel, `pixel` returns the palette index, or the gray value at 24 bits
+bool writeBmp(const std::string& path, const int width, const int height, const int bpp, const bool topDown,
+              const PixelFn& pixel) {
+  const int colors = bpp <= 2 ? 1 << bpp : 0;
+  const int rowBytes = (width * bpp + 31) / 32 * 4;
+  const uint32_t dataOffset = 14 + 40 + colors * 4;
+  std::vector<uint8_t> bytes(dataOffset + static_cast<size_t>(rowBytes) * height);
+  const auto put32 = [&bytes](const size_t at, const uint32_t value) {
+    for (int i = 0; i < 4; i++) bytes[at + i] = static_cast<uint8_t>(value >> (8 * i));
+  };
+  bytes[0] = 'B';
+  bytes[1] = 'M';
+  put32(2, bytes.size());
+  put32(10, dataOffset);
+  put32(14, 40);
+  put32(18, width);
+  put32(22, static_cast<uint32_t>(topDown ? -height : height));
+  bytes[26] = 1;
+  bytes[28] = static_cast<uint8_t>(bpp);
+  put32(46, colors);
+  for (int i = 0; i < colors; i++) {
+    const auto gray = static_cast<uint8_t>(255 * i / (colors - 1));
+    bytes[54 + i * 4] = bytes[55 + i * 4] = bytes[56 + i * 4] = gray;
+  }
+
+  for (int fileRow = 0; fileRow < height; fileRow++) {
+    const int y = topDown ? fileRow : height - 1 - fileRow;
+    uint8_t* row = bytes.data() + dataOffset + static_cast<size_t>(fileRow) * rowBytes;
+    for (int x = 0; x < width; x++) {
+      const uint8_t value = pixel(x, y);
+      if (bpp == 24) {
+        row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = value;
+      } else {
+        const int bit = x * bpp;
+        row[bit / 8] |= value << (8 - bpp - bit % 8);
+      }
+    }
+  }
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  const bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  return fclose(file) == 0 && written;
+}
+
+// The 2-bit level drawBitmap() sees for a palette index
+uint8_t levelOf(const int bpp, const uint8_t index) { return bpp == 1 ? index * 3 : index; }
+
+// What drawBitmap() did before it was scaled in fixed point: a drawPixel() per source pixel
+void drawBitmapPerPixel(const GfxRenderer& renderer, const GfxRenderer::RenderMode mode, const int x, const int y,
+                        const int width, const int height, const int bpp, const float crop, const PixelFn& pixel) {
+  const bool oneBit = bpp == 1 && crop == 0.0f;
+  const int cropPixX = static_cast<int>(std::floor(width * crop / 2.0f));
+  const int cropPixY = static_cast<int>(std::floor(height * crop / 2.0f));
+  for (int by = cropPixY; by < height - cropPixY; by++) {
+    for (int bx = cropPixX; bx < width - cropPixX; bx++) {
+      const int px = x + bx - cropPixX;
+      const int py = y + by - cropPixY;
+      if (px < 0 || py < 0 || px >= renderer.getScreenWidth() || py >= renderer.getScreenHeight()) {
+        continue;
+      }
+      const uint8_t level = levelOf(bpp, pixel(bx, by));
+      if ((oneBit || mode == GfxRenderer::BW) && level < 3) {
+        renderer.drawPixel(px, py, true);
+      } else if (!oneBit && mode == GfxRenderer::GRAYSCALE_MSB && (level == 1 || level == 2)) {
+        renderer.drawPixel(px, py, false);
+      } else if (!oneBit && mode == GfxRenderer::GRAYSCALE_LSB && level == 1) {
+        renderer.drawPixel(px, py, false);
+      }
+    }
+  }
+}
+
+void drawBmpFile(const GfxRenderer& renderer, const std::string& path, const int x, const int y, const int maxWidth,
+                 const int maxHeight, const float cropX = 0, const float cropY = 0) {
+  FsFile file;
+  if (!file.openHost(path, O_RDONLY)) {
+    return;
+  }
+  Bitmap bitmap(file);
+  if (bitmap.parseHeaders() == BmpReaderError::Ok) {
+    renderer.drawBitmap(bitmap, x, y, maxWidth, maxHeight, cropX, cropY);
+  }
+  file.close();
+}
+
+// Random bitmaps drawn at their own size, cropped or not, and at half the size
+int checkBitmaps(GfxRenderer& renderer, std::mt19937& random, const std::string& directory) {
+  int failures = 0;
+  const std::string full = directory + "/full.bmp";
+  const std::string half = directory + "/half.bmp";
+  std::uniform_int_distribution<int> size(1, 150);
+  std::uniform_int_distribution<int> position(-60, 500);
+  for (int round = 0; round < kBitmapRounds; round++) {
+    const int bpp = round % 2 == 0 ? 2 : 1;
+    const bool topDown = round % 4 < 2;
+    const int width = size(random);
+    const int height = size(random);
+    const int x = position(random);
+    const int y = position(random);
+    const float crop = round % 3 == 0 ? 0.2f : 0.0f;
+    std::vector<uint8_t> pixels(width * height);
+    std::uniform_int_distribution<int> index(0, (1 << bpp) - 1);
+    for (auto& value : pixels) {
+      value = static_cast<uint8_t>(index(random));
+    }
+    const PixelFn pixel = [&pixels, width](const int px, const int py) { return pixels[py * width + px]; };
+    const PixelFn doubled = [&pixels, width](const int px, const int py) { return pixels[py / 2 * width + px / 2]; };
+    if (!writeBmp(full, width, height, bpp, topDown, pixel) ||
+        !writeBmp(half, width * 2, height * 2, bpp, !topDown, doubled)) {
+      std::cout << "  could not write " << directory << std::endl;
+      return failures + 1;
+    }
+
+    for (const auto mode : {GfxRenderer::BW, GfxRenderer::GRAYSCALE_LSB, GfxRenderer::GRAYSCALE_MSB}) {
+      renderer.setRenderMode(mode);
+      if (!sameResult(
+              renderer,
+              [&](const GfxRenderer& r) { drawBitmapPerPixel(r, mode, x, y, width, height, bpp, crop, pixel); },
+              [&](const GfxRenderer& r) { drawBmpFile(r, full, x, y, 0, 0, crop, crop); })) {
+        failures++;
+      }
+      if (!sameResult(
+              renderer, [&](const GfxRenderer& r) { drawBmpFile(r, full, x, y, 0, 0); },
+              [&](const GfxRenderer& r) { drawBmpFile(r, half, x, y, width, height); })) {
+        failures++;
+      }
+    }
+    renderer.setRenderMode(GfxRenderer::BW);
+  }
+  remove(full.c_str());
+  remove(half.c_str());
+  return failures;
+}
+
+// 1-bit bitmaps whose 2x2 blocks are exactly half black, drawn at half the size, must come out all black
+int checkHalfBlack(GfxRenderer& renderer, const std::string& directory) {
+  int failures = 0;
+  const std::string path = directory + "/halfblack.bmp";
+  constexpr int width = 40;
+  constexpr int height = 30;
+  // Top row, left column and diagonal halves of each block, in turns
+  const PixelFn halfBlack = [](const int px, const int py) {
+    const int block = px / 2 + py / 2;
+    const int dx = px % 2;
+    const int dy = py % 2;
+    const bool black = block % 3 == 0 ? dy == 0 : block % 3 == 1 ? dx == 0 : dx == dy;
+    return static_cast<uint8_t>(black ? 0 : 1);
+  };
+  const PixelFn allBlack = [](int, int) { return static_cast<uint8_t>(0); };
+  if (!writeBmp(path, width * 2, height * 2, 1, false, halfBlack)) {
+    std::cout << "  could not write " << path << std::endl;
+    return 1;
+  }
+  for (const auto mode : {GfxRenderer::BW, GfxRenderer::GRAYSCALE_LSB, GfxRenderer::GRAYSCALE_MSB}) {
+    renderer.setRenderMode(mode);
+    if (!sameResult(
+            renderer,
+            [&](const GfxRenderer& r) { drawBitmapPerPixel(r, mode, 20, 20, width, height, 1, 0.0f, allBlack); },
+            [&](const GfxRenderer& r) { drawBmpFile(r, path, 20, 20, width, height); })) {
+      failures++;
+    }
+  }
+  renderer.setRenderMode(GfxRenderer::BW);
+  remove(path.c_str());
+  return failures;
+}
+
+// truncatedText() as it used to be
+std::string truncatePerCodepoint(const GfxRenderer& renderer, const int fontId, const char* text, const int maxWidth,
+                                 const EpdFontFamily::Style style) {
+  std::string item = text;
+  const char* ellipsis = "...";
+  if (renderer.getTextWidth(fontId, item.c_str(), style) <= maxWidth) {
+    return item;
+  }
+  while (!item.empty() && renderer.getTextWidth(fontId, (item + ellipsis).c_str(), style) >= maxWidth) {
+    utf8RemoveLastChar(item);
+  }
+  return item.empty() ? ellipsis : item + ellipsis;
+}
+
+int checkTruncation(const GfxRenderer& renderer) {
+  const int fontIds[] = {UI_10_FONT_ID, UI_12_FONT_ID, SMALL_FONT_ID, BOOKERLY_14_FONT_ID};
+  const char* titles[] = {
+      "The Left Hand of Darkness: A Novel of the Hainish Cycle",
+      "AVAWAY Tyrannosaurus, jiffy fjords & quirky wolves",
+      // Glyphs reaching left of their origin, where the ink is narrower than the advances
+      "j'accuse: \"jejune\" fjord tales",
+      "\xE4\xB8\x89\xE4\xBD\x93\xEF\xBC\x9A\xE5\x9C\xB0\xE7\x90\x83\xE5\xBE\x80\xE4\xBA\x8B"
+      "\xE4\xB8\x89\xE9\x83\xA8\xE6\x9B\xB2",
+      "Snow Country \xE9\x9B\xAA\xE5\x9B\xBD (Kawabata)",
+  };
+  int mismatches = 0;
+  for (const int fontId : fontIds) {
+    for (const char* title : titles) {
+      for (const auto style : {EpdFontFamily::REGULAR, EpdFontFamily::BOLD, EpdFontFamily::ITALIC}) {
+        for (int width = 1; width <= 500; width++) {
+          if (renderer.truncatedText(fontId, title, width, style) !=
+              truncatePerCodepoint(renderer, fontId, title, width, style)) {
+            mismatches++;
+          }
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+}  // namespace
+
+int main() {
+  Serial.quiet = true;
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  registerBuiltinFonts(renderer);
+  std::mt19937 random(42);
+  char directoryTemplate[] = "/tmp/render_primitives_XXXXXX";
+  if (!mkdtemp(directoryTemplate)) {
+    std::cout << "could not create a temporary directory" << std::endl;
+    return 1;
+  }
+  const std::string directory = directoryTemplate;
+
+  int failures = 0;
+  for (const auto& orientation : kOrientations) {
+    renderer.setOrientation(orientation.value);
+    std::cout << orientation.name << std::endl;
+
+    for (const bool darkMode : {false, true}) {
+      renderer.setDarkMode(darkMode);
+      const int randomFailures = checkRandomRects(renderer, random);
+      if (randomFailures > 0) {
+        std::cout << "  MISMATCH: " << randomFailures << " random rectangles" << (darkMode ? " (dark mode)" : "")
+                  << std::endl;
+        failures += randomFailures;
+      }
+    }
+
+    for (const auto& shape : uiShapes(renderer)) {
+      bool matches = true;
+      for (const bool darkMode : {false, true}) {
+        renderer.setDarkMode(darkMode);
+        matches = matches && sameResult(renderer, shape.perPixel, shape.spans);
+      }
+      renderer.setDarkMode(false);
+      if (!matches) {
+        std::cout << "  MISMATCH: " << shape.name << std::endl;
+        failures++;
+        continue;
+      }
+      const double perPixel = microsPerCall(renderer, shape.perPixel);
+      const double spans = microsPerCall(renderer, shape.spans);
+      std::cout << "  " << shape.name << ": " << perPixel << " us with drawPixel(), " << spans << " us in spans ("
+                << perPixel / spans << "x)" << std::endl;
+    }
+
+    const int w = renderer.getScreenWidth();
+    const double inverted = microsPerCall(renderer, [w](const GfxRenderer& r) { r.invertRect(0, 93, w - 1, 30); });
+    std::cout << "  row highlight inverted: " << inverted << " us" << std::endl;
+
+    const int bitmapFailures = checkBitmaps(renderer, random, directory) + checkHalfBlack(renderer, directory);
+    if (bitmapFailures > 0) {
+      std::cout << "  MISMATCH: " << bitmapFailures << " bitmaps" << std::endl;
+      failures += bitmapFailures;
+    }
+  }
+
+  // A cover twice the screen's size against one that fits
+  renderer.setOrientation(GfxRenderer::Portrait);
+  const std::string cover = directory + "/cover.bmp";
+  const PixelFn gradient = [](const int px, const int py) { return static_cast<uint8_t>((px * 7 + py * 3) & 0xFF); };
+  const int w = renderer.getScreenWidth();
+  const int h = renderer.getScreenHeight();
+  for (const int scale : {1, 2, 3}) {
+    if (!writeBmp(cover, w * scale, h * scale, 24, false, gradient)) {
+      std::cout << "could not write " << cover << std::endl;
+      return 1;
+    }
+    const double micros = microsPerCall(renderer, [&](const GfxRenderer& r) { drawBmpFile(r, cover, 0, 0, w, h); });
+    std::cout << w * scale << "x" << h * scale << " cover drawn at " << w << "x" << h << ": " << micros / 1000
+              << " ms" << std::endl;
+  }
+  remove(cover.c_str());
+
+  rmdir(directory.c_str());
+
+  const int truncationFailures = checkTruncation(renderer);
+  if (truncationFailures > 0) {
+    std::cout << "MISMATCH: " << truncationFailures << " truncated titles" << std::endl;
+    failures += truncationFailures;
+  }
+
+  if (failures > 0) {
+    std::cout << failures << " mismatches" << std::endl;
+    return 1;
+  }
+  return 0;
+}
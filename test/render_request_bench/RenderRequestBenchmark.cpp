@@ -0,0 +1,204 @@
+#include <freertos/task.h>
+
+#include <activities/RenderRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Runs a display task loop against RenderRequest on host threads: a request made while the first render is still
+// drawing must be picked up, requests made during a render collapse into one, and the time from request() to the
+// render starting is compared with the old loop that polled a flag every 10 ms. Host thread wakeups stand in for the
+// FreeRTOS scheduler, so the latencies show the polling delay that is gone rather than the device's numbers.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    printf("  FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+double msSince(const Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool waitUntil(const std::atomic<int>& value, const int target, const int timeoutMs) {
+  const auto start = Clock::now();
+  while (value < target) {
+    if (msSince(start) > timeoutMs) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  return true;
+}
+
+// The display task loop the activities run, with a render that takes `renderMs`
+struct DisplayTask {
+  RenderRequest updateRequired;
+  std::atomic<int> renders{0};
+  std::atomic<bool> drawing{false};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> done{false};
+  std::atomic<Clock::rep> lastTake{0};
+  int renderMs = 0;
+
+  static void trampoline(void* param) { static_cast<DisplayTask*>(param)->loop(); }
+
+  void loop() {
+    while (!stop) {
+      if (updateRequired.take()) {
+        lastTake = Clock::now().time_since_epoch().count();
+        drawing = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(renderMs));
+        drawing = false;
+        renders++;
+      }
+      updateRequired.wait();
+    }
+    done = true;
+  }
+
+  void start() { xTaskCreate(&DisplayTask::trampoline, "DisplayTask", 4096, this, 1, nullptr); }
+
+  void finish() {
+    stop = true;
+    updateRequired.request();
+    while (!done) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+};
+
+void testRequestDuringFirstRender() {
+  printf("request during the first render\n");
+  DisplayTask task;
+  task.renderMs = 50;
+  // onEnter requests the first render before the task runs
+  task.updateRequired.request();
+  task.start();
+  while (!task.drawing) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  task.updateRequired.request();
+  check(waitUntil(task.renders, 2, 1000), "rendered again without further input");
+  task.finish();
+}
+
+void testCoalescing() {
+  printf("coalescing\n");
+  DisplayTask task;
+  task.renderMs = 30;
+  task.start();
+  task.updateRequired.request();
+  check(waitUntil(task.renders, 1, 1000), "first render");
+  task.updateRequired.request();
+  while (!task.drawing) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  for (int i = 0; i < 5; i++) {
+    task.updateRequired.request();
+  }
+  check(waitUntil(task.renders, 3, 1000), "requests during a render");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  check(task.renders == 3, "collapse into one render");
+  task.finish();
+}
+
+struct Latency {
+  double mean = 0;
+  double max = 0;
+};
+
+template <typename Request, typename Taken>
+Latency measure(Request request, Taken lastTake, const std::atomic<int>& renders) {
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> gapMs(2, 20);
+  std::vector<double> samples;
+  for (int i = 0; i < 200; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(gapMs(random)));
+    const int before = renders;
+    const auto requested = Clock::now();
+    request();
+    if (!waitUntil(renders, before + 1, 1000)) {
+      check(false, "request rendered");
+      break;
+    }
+    const auto taken = Clock::time_point(Clock::duration(lastTake()));
+    samples.push_back(std::chrono::duration<double, std::milli>(taken - requested).count());
+  }
+  Latency latency;
+  for (const double sample : samples) {
+    latency.mean += sample / samples.size();
+    latency.max = std::max(latency.max, sample);
+  }
+  return latency;
+}
+
+// The loop before RenderRequest: a flag checked every 10 ms
+struct PollingTask {
+  std::atomic<bool> updateRequired{false};
+  std::atomic<int> renders{0};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> done{false};
+  std::atomic<Clock::rep> lastTake{0};
+
+  static void trampoline(void* param) { static_cast<PollingTask*>(param)->loop(); }
+
+  void loop() {
+    while (!stop) {
+      if (updateRequired.exchange(false)) {
+        lastTake = Clock::now().time_since_epoch().count();
+        renders++;
+      }
+      vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    done = true;
+  }
+};
+
+void testLatency() {
+  printf("request to render latency\n");
+  PollingTask polling;
+  xTaskCreate(&PollingTask::trampoline, "PollingTask", 4096, &polling, 1, nullptr);
+  const Latency polled = measure([&polling] { polling.updateRequired = true; },
+                                 [&polling] { return polling.lastTake.load(); }, polling.renders);
+  polling.stop = true;
+  while (!polling.done) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  DisplayTask notified;
+  notified.start();
+  const Latency woken = measure([&notified] { notified.updateRequired.request(); },
+                                [&notified] { return notified.lastTake.load(); }, notified.renders);
+  notified.finish();
+
+  printf("  polling every 10 ms: mean %.2f ms, max %.2f ms\n", polled.mean, polled.max);
+  printf("  task notification:   mean %.2f ms, max %.2f ms\n", woken.mean, woken.max);
+  check(woken.mean < polled.mean, "woken sooner than polled");
+}
+
+}  // namespace
+
+int main() {
+  testRequestDuringFirstRender();
+  testCoalescing();
+  testLatency();
+
+  if (failures > 0) {
+    printf("%d failed checks\n", failures);
+    return 1;
+  }
+  printf("All checks passed\n");
+  return 0;
+}
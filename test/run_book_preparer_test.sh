@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/book_preparer_test"
+BINARY="$BUILD_DIR/BookPreparerTest"
+CARD_DIR="$BUILD_DIR/card"
+# The firmware sources come precompiled from the host tools' build
+TOOL_BUILD_DIR="$ROOT_DIR/build/cache_compiler"
+
+mkdir -p "$BUILD_DIR"
+bash "$ROOT_DIR/scripts/cache_compiler/build.sh"
+
+INCLUDES=(
+  -I"$ROOT_DIR/scripts/cache_compiler"
+  -I"$ROOT_DIR/scripts/cache_compiler/host"
+  -I"$ROOT_DIR/src"
+  -I"$ROOT_DIR/lib/Epub"
+  -I"$ROOT_DIR/lib/EpdFont"
+  -I"$ROOT_DIR/lib/ExternalFont"
+  -I"$ROOT_DIR/lib/FsHelpers"
+  -I"$ROOT_DIR/lib/GfxRenderer"
+  -I"$ROOT_DIR/lib/I18n"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/Utf8"
+  -I"$ROOT_DIR/lib/ZipFile"
+)
+CXXFLAGS=(-std=c++20 -O2 -ffp-contract=off -pthread -DCROSSPOINT_HOST_THREADS=1 "${INCLUDES[@]}")
+
+# Warnings for the test only, the firmware sources are checked by the firmware build
+c++ "${CXXFLAGS[@]}" -Wall -Wextra -Wno-unused-parameter -c "$ROOT_DIR/test/book_preparer/BookPreparerTest.cpp" \
+  -o "$BUILD_DIR/BookPreparerTest.o"
+OBJECTS=("$BUILD_DIR/BookPreparerTest.o")
+for source in src/BookPreparer.cpp src/BookCacheManager.cpp src/util/StringUtils.cpp; do
+  object="$BUILD_DIR/$(basename "$source" .cpp).o"
+  c++ "${CXXFLAGS[@]}" -w -c "$ROOT_DIR/$source" -o "$object"
+  OBJECTS+=("$object")
+done
+for object in "$TOOL_BUILD_DIR"/obj/*.o; do
+  case "$object" in
+    *scripts_cache_compiler_CacheCompiler.cpp.o | *scripts_cache_compiler_XtcConverter.cpp.o) ;;
+    *) OBJECTS+=("$object") ;;
+  esac
+done
+c++ -pthread "${OBJECTS[@]}" -o "$BINARY"
+
+rm -rf "$CARD_DIR"
+mkdir -p "$CARD_DIR/Books"
+touch "$CARD_DIR/Books/notes.txt"
+
+# Two chapters, the guide points the reader at the second
+python3 - "$CARD_DIR/Books/sample.epub" <<'EOF'
+import sys
+import zipfile
+
+paragraph = "<p>" + " ".join(["The quick brown fox jumps over the lazy dog."] * 12) + "</p>"
+chapter = ('<?xml version="1.0" encoding="utf-8"?><html xmlns="http://www.w3.org/1999/xhtml"><head><title>{0}</title>'
+           '</head><body><h1>{0}</h1>{1}</body></html>')
+
+with zipfile.ZipFile(sys.argv[1], "w") as epub:
+    epub.writestr("mimetype", "application/epub+zip", compress_type=zipfile.ZIP_STORED)
+    epub.writestr("META-INF/container.xml",
+                  '<?xml version="1.0"?><container version="1.0" '
+                  'xmlns="urn:oasis:names:tc:opendocument:xmlns:container"><rootfiles>'
+                  '<rootfile full-path="OEBPS/content.opf" media-type="application/oebps-package+xml"/>'
+                  '</rootfiles></container>', compress_type=zipfile.ZIP_DEFLATED)
+    epub.writestr("OEBPS/content.opf",
+                  '<?xml version="1.0" encoding="utf-8"?><package xmlns="http://www.idpf.org/2007/opf" version="2.0" '
+                  'unique-identifier="id"><metadata xmlns:dc="http://purl.org/dc/elements/1.1/">'
+                  '<dc:title>Sample</dc:title><dc:creator>Test</dc:creator><dc:identifier id="id">sample</dc:identifier>'
+                  '</metadata><manifest>'
+                  '<item id="front" href="front.xhtml" media-type="application/xhtml+xml"/>'
+                  '<item id="text" href="text.xhtml" media-type="application/xhtml+xml"/>'
+                  '</manifest><spine><itemref idref="front"/><itemref idref="text"/></spine>'
+                  '<guide><reference type="text" href="text.xhtml"/></guide></package>',
+                  compress_type=zipfile.ZIP_DEFLATED)
+    epub.writestr("OEBPS/front.xhtml", chapter.format("Front matter", paragraph), compress_type=zipfile.ZIP_DEFLATED)
+    epub.writestr("OEBPS/text.xhtml", chapter.format("Chapter one", paragraph * 40),
+                  compress_type=zipfile.ZIP_DEFLATED)
+EOF
+
+"$BINARY" "$CARD_DIR" "$@"
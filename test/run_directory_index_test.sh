@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/directory_index_test"
+BINARY="$BUILD_DIR/DirectoryIndexTest"
+CARD_DIR="$BUILD_DIR/card"
+
+mkdir -p "$BUILD_DIR"
+
+TEST_SOURCE="$ROOT_DIR/test/directory_index/DirectoryIndexTest.cpp"
+SOURCES=(
+  "$ROOT_DIR/scripts/cache_compiler/host/HalStorage.cpp"
+  "$ROOT_DIR/src/network/DirectoryIndex.cpp"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -I"$ROOT_DIR/test/network_host"
+  -I"$ROOT_DIR/scripts/cache_compiler/host"
+  -I"$ROOT_DIR/src"
+)
+
+# Warnings for the test only, the firmware sources are checked by the firmware build
+c++ "${CXXFLAGS[@]}" -Wall -Wextra -c "$TEST_SOURCE" -o "$BUILD_DIR/DirectoryIndexTest.o"
+c++ "${CXXFLAGS[@]}" -w "${SOURCES[@]}" "$BUILD_DIR/DirectoryIndexTest.o" -o "$BINARY"
+
+rm -rf "$CARD_DIR"
+mkdir -p "$CARD_DIR"
+
+"$BINARY" "$CARD_DIR" "$@"
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/http_download_test"
+BINARY="$BUILD_DIR/HttpDownloadTest"
+CARD_DIR="$BUILD_DIR/card"
+
+mkdir -p "$BUILD_DIR"
+
+TEST_SOURCE="$ROOT_DIR/test/http_download/HttpDownloadTest.cpp"
+SOURCES=(
+  "$ROOT_DIR/scripts/cache_compiler/host/HalStorage.cpp"
+  "$ROOT_DIR/src/network/AsyncFileWriter.cpp"
+  "$ROOT_DIR/src/network/HttpDownloader.cpp"
+  "$ROOT_DIR/src/util/UrlUtils.cpp"
+)
+
+# test/network_host stands in for the ESP32 network stack and FreeRTOS, on top of the host tools' Arduino core and
+# SD card
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -pthread
+  -DCROSSPOINT_VERSION=\"test\"
+  -I"$ROOT_DIR/test/network_host"
+  -I"$ROOT_DIR/scripts/cache_compiler/host"
+  -I"$ROOT_DIR/src"
+  -I"$ROOT_DIR/lib/Serialization"
+)
+
+# Warnings for the test only, the firmware sources are checked by the firmware build
+c++ "${CXXFLAGS[@]}" -Wall -Wextra -c "$TEST_SOURCE" -o "$BUILD_DIR/HttpDownloadTest.o"
+c++ "${CXXFLAGS[@]}" -w "${SOURCES[@]}" "$BUILD_DIR/HttpDownloadTest.o" -o "$BINARY"
+
+rm -rf "$CARD_DIR"
+mkdir -p "$CARD_DIR"
+
+# The server prints its port once it listens
+coproc SERVER { exec python3 "$ROOT_DIR/test/http_download/fixture_server.py"; }
+trap 'kill "$SERVER_PID" 2>/dev/null || true' EXIT
+read -r PORT <&"${SERVER[0]}"
+
+"$BINARY" "$PORT" "$CARD_DIR" "$@"
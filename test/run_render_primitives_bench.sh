@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/render_primitives_bench"
+BINARY="$BUILD_DIR/RenderPrimitivesBenchmark"
+
+mkdir -p "$BUILD_DIR"
+
+BENCH_SOURCE="$ROOT_DIR/test/render_primitives_bench/RenderPrimitivesBenchmark.cpp"
+SOURCES=(
+  "$ROOT_DIR/scripts/cache_compiler/host/HalStorage.cpp"
+  "$ROOT_DIR"/lib/EpdFont/*.cpp
+  "$ROOT_DIR"/lib/ExternalFont/*.cpp
+  "$ROOT_DIR"/lib/GfxRenderer/*.cpp
+  "$ROOT_DIR/lib/Serialization/BufferedFile.cpp"
+  "$ROOT_DIR/lib/Utf8/Utf8.cpp"
+  "$ROOT_DIR/src/BuiltinFonts.cpp"
+)
+
+# The renderer is built against the host tools' stand-ins for the Arduino core, the SD card and the display, with the
+# firmware's built-in fonts
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -I"$ROOT_DIR/scripts/cache_compiler/host"
+  -I"$ROOT_DIR/lib/EpdFont"
+  -I"$ROOT_DIR/lib/ExternalFont"
+  -I"$ROOT_DIR/lib/GfxRenderer"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/Utf8"
+  -I"$ROOT_DIR/src"
+)
+
+# Warnings for the benchmark only, the firmware sources are checked by the firmware build
+c++ "${CXXFLAGS[@]}" -Wall -Wextra -c "$BENCH_SOURCE" -o "$BUILD_DIR/RenderPrimitivesBenchmark.o"
+c++ "${CXXFLAGS[@]}" -w "${SOURCES[@]}" "$BUILD_DIR/RenderPrimitivesBenchmark.o" -o "$BINARY"
+
+"$BINARY" "$@"
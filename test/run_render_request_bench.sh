@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/render_request_bench"
+BINARY="$BUILD_DIR/RenderRequestBenchmark"
+
+mkdir -p "$BUILD_DIR"
+
+# test/network_host stands in for FreeRTOS tasks and notifications
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -pthread
+  -Wall
+  -Wextra
+  -I"$ROOT_DIR/test/network_host"
+  -I"$ROOT_DIR/src"
+)
+
+c++ "${CXXFLAGS[@]}" "$ROOT_DIR/test/render_request_bench/RenderRequestBenchmark.cpp" -o "$BINARY"
+
+"$BINARY" "$@"
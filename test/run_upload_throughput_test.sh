@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/upload_throughput_test"
+BINARY="$BUILD_DIR/UploadThroughputTest"
+CARD_DIR="$BUILD_DIR/card"
+
+mkdir -p "$BUILD_DIR"
+
+TEST_SOURCE="$ROOT_DIR/test/upload_throughput/UploadThroughputTest.cpp"
+SOURCES=(
+  "$ROOT_DIR/scripts/cache_compiler/host/HalStorage.cpp"
+  "$ROOT_DIR/src/network/AsyncFileWriter.cpp"
+  "$ROOT_DIR/src/network/UploadWriter.cpp"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -I"$ROOT_DIR/test/network_host"
+  -I"$ROOT_DIR/scripts/cache_compiler/host"
+  -I"$ROOT_DIR/src"
+  -pthread
+)
+
+# Warnings for the test only, the firmware sources are checked by the firmware build
+c++ "${CXXFLAGS[@]}" -Wall -Wextra -c "$TEST_SOURCE" -o "$BUILD_DIR/UploadThroughputTest.o"
+c++ "${CXXFLAGS[@]}" -w "${SOURCES[@]}" "$BUILD_DIR/UploadThroughputTest.o" -o "$BINARY"
+
+rm -rf "$CARD_DIR"
+mkdir -p "$CARD_DIR"
+
+"$BINARY" "$CARD_DIR" "$@"
@@ -0,0 +1,261 @@
+#include <HalStorage.h>
+#include <HardwareSerial.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/UploadWriter.h"
+
+// Pushes a 50 MB upload through a socket pair standing in for the WebSocket on port 81, with the page's flow control
+// (8 KB frames, at most 64 KB ahead of the acknowledgements the device sends every 16 KB) and a sender paced like a
+// network link. The receiving side plays the web server's loop, once writing each 4 KB synchronously as uploads did
+// before and once through UploadWriter. The host card is slowed to a fixed time per write plus a transfer rate.
+//
+// Checked: the file arrives complete and intact through UploadWriter, an aborted upload is removed, a short upload
+// gives back the space reserved for it, and an unwritable path is refused. Sustained MB/s of both variants is printed.
+
+namespace {
+
+constexpr size_t UPLOAD_SIZE = 50 * 1024 * 1024;
+// The page's WS_CHUNK_SIZE and WS_WINDOW, the server's WS_PROGRESS_INTERVAL
+constexpr size_t FRAME_SIZE = 8192;
+constexpr size_t WINDOW = 65536;
+constexpr size_t ACK_INTERVAL = 16384;
+// The size of the buffer uploads went through before
+constexpr size_t OLD_BUFFER_SIZE = 4096;
+// Scaled up from the device (about 1 MB/s each) so the test takes seconds
+constexpr double LINK_BYTES_PER_SECOND = 12e6;
+constexpr uint32_t CARD_LATENCY_US = 300;
+constexpr uint32_t CARD_BYTES_PER_SECOND = 32000000;
+
+std::string cardRoot;
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "  FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+uint8_t dataAt(const size_t offset) { return static_cast<uint8_t>((offset * 2654435761u) >> 13); }
+
+bool sendAll(const int fd, const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    const ssize_t sent = send(fd, bytes, size, 0);
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool receiveAll(const int fd, void* data, size_t size) {
+  auto* bytes = static_cast<uint8_t*>(data);
+  while (size > 0) {
+    const ssize_t received = recv(fd, bytes, size, 0);
+    if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
+
+// The browser: length-prefixed frames, paced to the link rate, never more than WINDOW past the last acknowledgement
+void sender(const int fd, const size_t total) {
+  std::vector<uint8_t> frame(FRAME_SIZE);
+  size_t sent = 0;
+  size_t acknowledged = 0;
+  const auto start = std::chrono::steady_clock::now();
+  while (sent < total) {
+    while (sent - acknowledged >= WINDOW) {
+      uint32_t ack;
+      if (!receiveAll(fd, &ack, sizeof(ack))) {
+        return;
+      }
+      acknowledged = ack;
+    }
+    const uint32_t length = static_cast<uint32_t>(std::min(FRAME_SIZE, total - sent));
+    for (uint32_t i = 0; i < length; i++) {
+      frame[i] = dataAt(sent + i);
+    }
+    if (!sendAll(fd, &length, sizeof(length)) || !sendAll(fd, frame.data(), length)) {
+      return;
+    }
+    sent += length;
+    std::this_thread::sleep_until(start + std::chrono::duration<double>(sent / LINK_BYTES_PER_SECOND));
+  }
+  // Drain the remaining acknowledgements so the receiver never blocks on a full socket
+  pollfd pfd = {fd, POLLIN, 0};
+  uint32_t ack;
+  while (poll(&pfd, 1, 1000) > 0 && receiveAll(fd, &ack, sizeof(ack)) && ack < total) {
+  }
+}
+
+struct Result {
+  double seconds = 0;
+  bool ok = false;
+  unsigned long waitedMs = 0;
+};
+
+// The web server's side: frames in, acknowledgements out, data to the card either synchronously or through
+// UploadWriter
+Result receive(const std::string& path, const bool useUploadWriter, const size_t total) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    perror("socketpair");
+    return {};
+  }
+  // About the TCP window the ESP32 offers
+  const int socketBuffer = 16384;
+  setsockopt(fds[0], SOL_SOCKET, SO_RCVBUF, &socketBuffer, sizeof(socketBuffer));
+  setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &socketBuffer, sizeof(socketBuffer));
+
+  Result result;
+  UploadWriter writer;
+  FsFile file;
+  std::vector<uint8_t> oldBuffer(OLD_BUFFER_SIZE);
+  size_t oldBufferUsed = 0;
+  bool ok = useUploadWriter ? writer.begin("TEST", path, total) : Storage.openFileForWrite("TEST", path, file);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::thread browser(sender, fds[1], total);
+  std::vector<uint8_t> frame(FRAME_SIZE);
+  size_t received = 0;
+  size_t lastAck = 0;
+  while (ok && received < total) {
+    uint32_t length;
+    ok = receiveAll(fds[0], &length, sizeof(length)) && length <= FRAME_SIZE &&
+         receiveAll(fds[0], frame.data(), length);
+    if (!ok) {
+      break;
+    }
+    if (useUploadWriter) {
+      ok = writer.write(frame.data(), length);
+    } else {
+      // flushUploadBuffer(): collect 4 KB, then write it while nothing is received
+      for (size_t done = 0; done < length && ok;) {
+        const size_t count = std::min<size_t>(length - done, OLD_BUFFER_SIZE - oldBufferUsed);
+        memcpy(oldBuffer.data() + oldBufferUsed, frame.data() + done, count);
+        oldBufferUsed += count;
+        done += count;
+        if (oldBufferUsed == OLD_BUFFER_SIZE) {
+          ok = file.write(oldBuffer.data(), oldBufferUsed) == oldBufferUsed;
+          oldBufferUsed = 0;
+        }
+      }
+    }
+    received += length;
+    if (received - lastAck >= ACK_INTERVAL || received == total) {
+      const auto ack = static_cast<uint32_t>(received);
+      ok = ok && sendAll(fds[0], &ack, sizeof(ack));
+      lastAck = received;
+    }
+  }
+  if (useUploadWriter) {
+    ok = ok && writer.finish();
+    result.waitedMs = writer.waitedMs();
+  } else {
+    ok = ok && file.write(oldBuffer.data(), oldBufferUsed) == oldBufferUsed;
+    file.close();
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.ok = ok;
+
+  shutdown(fds[0], SHUT_RDWR);
+  browser.join();
+  close(fds[0]);
+  close(fds[1]);
+  return result;
+}
+
+bool fileIntact(const std::string& path, const size_t total) {
+  std::ifstream in(cardRoot + path, std::ios::binary);
+  std::vector<char> chunk(1 << 20);
+  size_t offset = 0;
+  while (in) {
+    in.read(chunk.data(), chunk.size());
+    for (std::streamsize i = 0; i < in.gcount(); i++, offset++) {
+      if (static_cast<uint8_t>(chunk[i]) != dataAt(offset)) {
+        return false;
+      }
+    }
+  }
+  return offset == total;
+}
+
+void testThroughput() {
+  std::cout << "50 MB upload" << std::endl;
+  Storage.simulateCardWrites(CARD_LATENCY_US, CARD_BYTES_PER_SECOND);
+  const Result before = receive("/synchronous.epub", false, UPLOAD_SIZE);
+  const Result after = receive("/buffered.epub", true, UPLOAD_SIZE);
+  Storage.simulateCardWrites(0, 0);
+
+  check(before.ok && fileIntact("/synchronous.epub", UPLOAD_SIZE), "synchronous upload complete");
+  check(after.ok, "upload through UploadWriter succeeds");
+  check(fileIntact("/buffered.epub", UPLOAD_SIZE), "file complete and intact");
+  const double mb = UPLOAD_SIZE / 1048576.0;
+  printf("  link %.0f MB/s, card %u us + %.0f MB/s per write\n", LINK_BYTES_PER_SECOND / 1e6, CARD_LATENCY_US,
+         CARD_BYTES_PER_SECOND / 1e6);
+  printf("  synchronous 4 KB writes: %.2f s, %.1f MB/s\n", before.seconds, mb / before.seconds);
+  printf("  UploadWriter (%u x %zu KB): %.2f s, %.1f MB/s, waited %lu ms for the card\n", UploadWriter::BUFFER_COUNT,
+         UploadWriter::BUFFER_SIZE / 1024, after.seconds, mb / after.seconds, after.waitedMs);
+}
+
+void testAbortAndFailure() {
+  std::cout << "aborted and failed uploads" << std::endl;
+  UploadWriter writer;
+  check(writer.begin("TEST", "/aborted.epub", 100000), "upload starts");
+  std::vector<uint8_t> data(30000, 7);
+  check(writer.write(data.data(), data.size()), "data accepted");
+  writer.abort();
+  check(!Storage.exists("/aborted.epub"), "aborted upload removed");
+
+  // Shorter than announced: the reserved rest is given back
+  check(writer.begin("TEST", "/short.epub", 100000), "upload starts");
+  writer.write(data.data(), data.size());
+  check(writer.finish(), "short upload finishes");
+  FsFile file = Storage.open("/short.epub");
+  check(file.size() == data.size(), "file as long as the data");
+  file.close();
+
+  // A directory where the file should be can't be created
+  Storage.mkdir("/taken.epub");
+  check(!writer.begin("TEST", "/taken.epub/", 10), "unwritable path refused");
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: UploadThroughputTest <card dir> [--verbose]\n");
+    return 2;
+  }
+  cardRoot = argv[1];
+  Serial.quiet = !(argc > 2 && strcmp(argv[2], "--verbose") == 0);
+  Storage.setRoot(cardRoot);
+
+  testThroughput();
+  testAbortAndFailure();
+
+  if (failures > 0) {
+    std::cout << failures << " failed checks" << std::endl;
+    return 1;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return 0;
+}